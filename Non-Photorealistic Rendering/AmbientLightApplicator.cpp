@@ -17,7 +17,10 @@ void AmbientLightApplicator::apply(ShaderProgram &shader, LightSource *light)
 {
 	// - Asignar uniforms
 	shader.setUniform("Ia", light->getIa());
+}
 
-	// - Utilizar subrutina
-	shader.setSubroutine("LightUniform", "AmbientLight", GL_FRAGMENT_SHADER, 1);
+// - Obtener variante de los shader programs para la luz ambiente
+ShaderProgramVariant AmbientLightApplicator::getVariant()
+{
+	return AMBIENT_LIGHT_VARIANT;
 }
\ No newline at end of file
@@ -0,0 +1,709 @@
+#include "BVH.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+#include "Mesh.h"
+
+// - rea de la superficie de una caja (coste de la SAH)
+static float surfaceArea(const AABB &box)
+{
+	if (!box.isValid())
+	{
+		return 0.f;
+	}
+
+	glm::vec3 size = box.max - box.min;
+
+	return 2.f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+// - Interseccin de un rayo con una caja (mtodo de las lminas). Devuelve la distancia de entrada
+static bool intersectBox(const AABB &box, const glm::vec3 &origin, const glm::vec3 &inverseDirection, float maxDistance, float &distance)
+{
+	glm::vec3 t0 = (box.min - origin) * inverseDirection;
+	glm::vec3 t1 = (box.max - origin) * inverseDirection;
+	glm::vec3 tMin = glm::min(t0, t1);
+	glm::vec3 tMax = glm::max(t0, t1);
+
+	float tNear = std::max(std::max(tMin.x, tMin.y), std::max(tMin.z, 0.f));
+	float tFar = std::min(std::min(tMax.x, tMax.y), std::min(tMax.z, maxDistance));
+
+	distance = tNear;
+
+	return tNear <= tFar;
+}
+
+// - Constructor por defecto
+BVH::BVH()
+{
+	this->scene = nullptr;
+	this->maxOutlineMargin = 0.f;
+	this->transformVersion = 0;
+}
+
+// - Mtodo privado: obtener las primitivas de la escena en coordenadas de mundo
+void BVH::collectPrimitives(std::vector<BVHPrimitive> &result)
+{
+	result.clear();
+	scene->collectPrimitives(scene->getModelMatrix(), -1, result);
+}
+
+// - Construir la jerarqua sobre una escena
+void BVH::build(Group3D *scene)
+{
+	this->scene = scene;
+	transformVersion = Element3D::getTransformVersion();
+
+	collectPrimitives(primitives);
+
+	collectionOrder.resize(primitives.size());
+	for (unsigned int i = 0; i < collectionOrder.size(); i++)
+	{
+		collectionOrder[i] = i;
+	}
+
+	nodes.clear();
+	nodes.reserve(2 * primitives.size() + 1);
+
+	if (!primitives.empty())
+	{
+		buildNode(0, (int) primitives.size());
+	}
+
+	// - Las primitivas se guardan en el orden de las hojas
+	std::vector<BVHPrimitive> collected;
+	collected.swap(primitives);
+	primitives.resize(collected.size());
+
+	for (unsigned int i = 0; i < collectionOrder.size(); i++)
+	{
+		primitives[i] = collected[collectionOrder[i]];
+	}
+}
+
+// - Mtodo privado: construir el subrbol de las primitivas [first, first + count). Se elige el
+//   plano de corte que minimiza la SAH evalundola en SAH_BINS intervalos de los centros por eje.
+//   Durante la construccin se reordenan los ndices de collectionOrder, no las primitivas
+int BVH::buildNode(int first, int count)
+{
+	int index = (int) nodes.size();
+	nodes.push_back(BVHNode());
+
+	AABB bounds, centroidBounds;
+
+	for (int i = first; i < first + count; i++)
+	{
+		bounds.expand(primitives[collectionOrder[i]].bounds);
+		centroidBounds.expand(primitives[collectionOrder[i]].bounds.getCenter());
+	}
+
+	nodes[index].bounds = bounds;
+
+	if (count <= MAX_LEAF_PRIMITIVES)
+	{
+		nodes[index].firstPrimitive = first;
+		nodes[index].numPrimitives = count;
+
+		return index;
+	}
+
+	// - Mejor corte: eje e intervalo
+	int bestAxis = -1;
+	int bestSplit = 0;
+	float bestCost = std::numeric_limits<float>::max();
+	glm::vec3 centroidExtent = centroidBounds.max - centroidBounds.min;
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		if (centroidExtent[axis] <= 1e-6f)
+		{
+			continue;
+		}
+
+		int binCount[SAH_BINS] = {};
+		AABB binBounds[SAH_BINS];
+		float scale = SAH_BINS / centroidExtent[axis];
+
+		for (int i = first; i < first + count; i++)
+		{
+			const AABB &box = primitives[collectionOrder[i]].bounds;
+			int bin = std::min(SAH_BINS - 1, (int) ((box.getCenter()[axis] - centroidBounds.min[axis]) * scale));
+
+			binCount[bin]++;
+			binBounds[bin].expand(box);
+		}
+
+		// - Coste de las particiones: barrido de izquierda a derecha y de derecha a izquierda
+		float rightArea[SAH_BINS];
+		int rightCount[SAH_BINS];
+		AABB accumulated;
+		int accumulatedCount = 0;
+
+		for (int bin = SAH_BINS - 1; bin > 0; bin--)
+		{
+			accumulated.expand(binBounds[bin]);
+			accumulatedCount += binCount[bin];
+			rightArea[bin] = surfaceArea(accumulated);
+			rightCount[bin] = accumulatedCount;
+		}
+
+		accumulated = AABB();
+		accumulatedCount = 0;
+
+		for (int split = 1; split < SAH_BINS; split++)
+		{
+			accumulated.expand(binBounds[split - 1]);
+			accumulatedCount += binCount[split - 1];
+
+			if (accumulatedCount == 0 || rightCount[split] == 0)
+			{
+				continue;
+			}
+
+			float cost = surfaceArea(accumulated) * accumulatedCount + rightArea[split] * rightCount[split];
+
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				bestAxis = axis;
+				bestSplit = split;
+			}
+		}
+	}
+
+	int middle;
+
+	if (bestAxis >= 0)
+	{
+		float scale = SAH_BINS / centroidExtent[bestAxis];
+		float minimum = centroidBounds.min[bestAxis];
+
+		std::vector<unsigned int>::iterator split = std::partition(collectionOrder.begin() + first, collectionOrder.begin() + first + count,
+																	[&](unsigned int primitive)
+		{
+			return std::min(SAH_BINS - 1, (int) ((primitives[primitive].bounds.getCenter()[bestAxis] - minimum) * scale)) < bestSplit;
+		});
+
+		middle = (int) (split - collectionOrder.begin());
+	}
+	else
+	{
+		// - Todos los centros coinciden: se reparten por la mitad
+		middle = first + count / 2;
+	}
+
+	buildNode(first, middle - first);
+	nodes[index].rightChild = buildNode(middle, first + count - middle);
+
+	return index;
+}
+
+// - Saber si ha cambiado alguna matriz de modelado desde la ltima construccin o reajuste
+bool BVH::needsRefit()
+{
+	return scene != nullptr && transformVersion != Element3D::getTransformVersion();
+}
+
+// - Mtodo privado: calcular la caja de un nodo a partir de sus primitivas o de sus hijos
+void BVH::refitNode(int node)
+{
+	AABB bounds;
+
+	if (nodes[node].isLeaf())
+	{
+		for (int i = nodes[node].firstPrimitive; i < nodes[node].firstPrimitive + nodes[node].numPrimitives; i++)
+		{
+			bounds.expand(primitives[i].bounds);
+		}
+	}
+	else
+	{
+		bounds.expand(nodes[node + 1].bounds);
+		bounds.expand(nodes[nodes[node].rightChild].bounds);
+	}
+
+	nodes[node].bounds = bounds;
+}
+
+// - Recalcular las cajas de las primitivas y reajustar los nodos. Los hijos siempre tienen un ndice
+//   mayor que el padre, as que basta con recorrer el array de atrs hacia delante
+void BVH::refit()
+{
+	if (scene == nullptr)
+	{
+		return;
+	}
+
+	std::vector<BVHPrimitive> collected;
+	collectPrimitives(collected);
+
+	if (collected.size() != primitives.size())
+	{
+		build(scene);
+		return;
+	}
+
+	for (unsigned int i = 0; i < primitives.size(); i++)
+	{
+		const BVHPrimitive &primitive = collected[collectionOrder[i]];
+
+		primitives[i].bounds = primitive.bounds;
+		primitives[i].mModel = primitive.mModel;
+	}
+
+	for (int i = (int) nodes.size() - 1; i >= 0; i--)
+	{
+		refitNode(i);
+	}
+
+	transformVersion = Element3D::getTransformVersion();
+}
+
+// - Mtodo privado: calcular el mayor margen de los contornos, con el que se amplan las cajas de
+//   los nodos para no descartar contornos que sobresalen del frustum
+void BVH::updateOutlineMargin()
+{
+	maxOutlineMargin = 0.f;
+
+	for (unsigned int i = 0; i < primitives.size(); i++)
+	{
+		float size = 2.f * glm::length(primitives[i].bounds.getExtents());
+		maxOutlineMargin = std::max(maxOutlineMargin, primitives[i].owner->getOutlineMargin(size));
+	}
+}
+
+// - Frustum culling: se recorre la jerarqua descartando subrboles completos. Las mallas y los
+//   elementos que no se alcanzan quedan como no visibles
+void BVH::cullFrustum(const Frustum &frustum, CullingStatistics &statistics)
+{
+	if (scene == nullptr)
+	{
+		return;
+	}
+
+	for (unsigned int i = 0; i < primitives.size(); i++)
+	{
+		primitives[i].owner->setVisibility(false, false);
+
+		if (primitives[i].mesh != nullptr)
+		{
+			primitives[i].mesh->setVisibility(false, false);
+		}
+
+		if (primitives[i].instance >= 0)
+		{
+			primitives[i].owner->setInstanceVisibility(primitives[i].instance, false, false);
+		}
+	}
+
+	// - Los contornos pueden cambiar en cada frame
+	updateOutlineMargin();
+
+	if (!nodes.empty())
+	{
+		// - Pila de recorrido: crece con la profundidad del rbol, que no est acotada
+		std::vector<int> stack;
+		stack.reserve(64);
+		stack.push_back(0);
+
+		while (!stack.empty())
+		{
+			int index = stack.back();
+			stack.pop_back();
+
+			const BVHNode &node = nodes[index];
+
+			if (!frustum.testAABB(node.bounds.inflate(maxOutlineMargin)))
+			{
+				continue;
+			}
+
+			if (!node.isLeaf())
+			{
+				int left = index + 1;
+
+				stack.push_back(node.rightChild);
+				stack.push_back(left);
+
+				continue;
+			}
+
+			for (int i = node.firstPrimitive; i < node.firstPrimitive + node.numPrimitives; i++)
+			{
+				BVHPrimitive &primitive = primitives[i];
+				float margin = primitive.owner->getOutlineMargin(2.f * glm::length(primitive.bounds.getExtents()));
+				bool visible = frustum.testAABB(primitive.bounds);
+				bool outlineVisible = visible || (margin > 0.f && frustum.testAABB(primitive.bounds.inflate(margin)));
+
+				if (primitive.mesh != nullptr)
+				{
+					primitive.mesh->setVisibility(visible, outlineVisible);
+				}
+
+				if (primitive.instance >= 0)
+				{
+					primitive.owner->setInstanceVisibility(primitive.instance, visible, outlineVisible);
+				}
+
+				primitive.owner->setVisibility(primitive.owner->isVisible() || visible,
+											   primitive.owner->isOutlineVisible() || outlineVisible);
+			}
+		}
+	}
+
+	scene->aggregateVisibility();
+
+	// - Estadsticas: mallas y elementos distintos
+	std::vector<Element3D*> owners;
+
+	for (unsigned int i = 0; i < primitives.size(); i++)
+	{
+		if (primitives[i].mesh != nullptr)
+		{
+			statistics.meshesTested++;
+
+			if (!primitives[i].mesh->isVisible())
+			{
+				statistics.meshesCulled++;
+			}
+		}
+
+		owners.push_back(primitives[i].owner);
+	}
+
+	std::sort(owners.begin(), owners.end());
+	owners.erase(std::unique(owners.begin(), owners.end()), owners.end());
+
+	for (unsigned int i = 0; i < owners.size(); i++)
+	{
+		statistics.elementsTested++;
+
+		if (!owners[i]->isVisible())
+		{
+			statistics.elementsCulled++;
+		}
+	}
+}
+
+// - Rayo (coordenadas de mundo): se visitan primero los hijos ms cercanos y se descartan los nodos
+//   ms lejanos que la interseccin encontrada. Los tringulos se comprueban en el espacio local de
+//   cada malla, lo que no cambia la distancia en unidades de la direccin del rayo
+int BVH::intersectRay(const glm::vec3 &origin, const glm::vec3 &direction, float &distance)
+{
+	int result = -1;
+	distance = std::numeric_limits<float>::max();
+
+	if (nodes.empty())
+	{
+		return result;
+	}
+
+	glm::vec3 inverseDirection = 1.f / direction;
+	std::vector<int> stack;
+	stack.reserve(64);
+	stack.push_back(0);
+
+	while (!stack.empty())
+	{
+		int index = stack.back();
+		stack.pop_back();
+
+		const BVHNode &node = nodes[index];
+		float nodeDistance;
+
+		if (!intersectBox(node.bounds, origin, inverseDirection, distance, nodeDistance))
+		{
+			continue;
+		}
+
+		if (!node.isLeaf())
+		{
+			int left = index + 1;
+			int right = node.rightChild;
+			float leftDistance, rightDistance;
+			bool leftHit = intersectBox(nodes[left].bounds, origin, inverseDirection, distance, leftDistance);
+			bool rightHit = intersectBox(nodes[right].bounds, origin, inverseDirection, distance, rightDistance);
+
+			// - El ms cercano se apila el ltimo
+			if (leftHit && rightHit && leftDistance < rightDistance)
+			{
+				stack.push_back(right);
+				stack.push_back(left);
+			}
+			else
+			{
+				if (leftHit)
+				{
+					stack.push_back(left);
+				}
+
+				if (rightHit)
+				{
+					stack.push_back(right);
+				}
+			}
+
+			continue;
+		}
+
+		for (int i = node.firstPrimitive; i < node.firstPrimitive + node.numPrimitives; i++)
+		{
+			BVHPrimitive &primitive = primitives[i];
+			float primitiveDistance;
+
+			if (!intersectBox(primitive.bounds, origin, inverseDirection, distance, primitiveDistance))
+			{
+				continue;
+			}
+
+			if (primitive.mesh != nullptr)
+			{
+				glm::mat4 inverseModel = glm::inverse(primitive.mModel);
+				glm::vec3 localOrigin = glm::vec3(inverseModel * glm::vec4(origin, 1.f));
+				glm::vec3 localDirection = glm::vec3(inverseModel * glm::vec4(direction, 0.f));
+
+				if (!primitive.mesh->intersectRay(localOrigin, localDirection, primitiveDistance))
+				{
+					continue;
+				}
+			}
+
+			if (primitiveDistance < distance)
+			{
+				distance = primitiveDistance;
+				result = primitive.sceneElement;
+			}
+		}
+	}
+
+	return result;
+}
+
+// - Primitivas ordenadas de delante hacia atrs desde un punto: se recorre primero el hijo cuyo
+//   centro est ms cerca del punto
+void BVH::frontToBackPrimitives(const glm::vec3 &eye, std::vector<unsigned int> &order)
+{
+	order.clear();
+
+	if (nodes.empty())
+	{
+		return;
+	}
+
+	std::vector<int> stack;
+	stack.reserve(64);
+	stack.push_back(0);
+
+	while (!stack.empty())
+	{
+		int index = stack.back();
+		stack.pop_back();
+
+		const BVHNode &node = nodes[index];
+
+		if (node.isLeaf())
+		{
+			for (int i = node.firstPrimitive; i < node.firstPrimitive + node.numPrimitives; i++)
+			{
+				order.push_back(i);
+			}
+
+			continue;
+		}
+
+		int left = index + 1;
+		int right = node.rightChild;
+		glm::vec3 toLeft = nodes[left].bounds.getCenter() - eye;
+		glm::vec3 toRight = nodes[right].bounds.getCenter() - eye;
+
+		if (glm::dot(toLeft, toLeft) < glm::dot(toRight, toRight))
+		{
+			stack.push_back(right);
+			stack.push_back(left);
+		}
+		else
+		{
+			stack.push_back(left);
+			stack.push_back(right);
+		}
+	}
+}
+
+// - Elementos de primer nivel de la escena ordenados de delante hacia atrs: cada elemento se aade
+//   la primera vez que aparece una de sus primitivas
+void BVH::frontToBack(const glm::vec3 &eye, std::vector<int> &sceneElements)
+{
+	sceneElements.clear();
+
+	if (nodes.empty())
+	{
+		return;
+	}
+
+	std::vector<unsigned int> order;
+	frontToBackPrimitives(eye, order);
+
+	std::vector<bool> added(scene->getNumElements(), false);
+
+	for (unsigned int i = 0; i < order.size(); i++)
+	{
+		int element = primitives[order[i]].sceneElement;
+
+		if (element >= 0 && element < (int) added.size() && !added[element])
+		{
+			added[element] = true;
+			sceneElements.push_back(element);
+		}
+	}
+}
+
+// - Primitivas (en el orden de las hojas)
+const std::vector<BVHPrimitive>& BVH::getPrimitives()
+{
+	return primitives;
+}
+
+// - Informacin
+unsigned int BVH::getNumNodes()
+{
+	return (unsigned int) nodes.size();
+}
+
+unsigned int BVH::getNumPrimitives()
+{
+	return (unsigned int) primitives.size();
+}
+
+unsigned int BVH::getDepth()
+{
+	if (nodes.empty())
+	{
+		return 0;
+	}
+
+	unsigned int depth = 0;
+	std::vector<std::pair<int, unsigned int>> stack;
+	stack.push_back(std::make_pair(0, 1u));
+
+	while (!stack.empty())
+	{
+		std::pair<int, unsigned int> current = stack.back();
+		stack.pop_back();
+
+		depth = std::max(depth, current.second);
+
+		if (!nodes[current.first].isLeaf())
+		{
+			stack.push_back(std::make_pair(current.first + 1, current.second + 1));
+			stack.push_back(std::make_pair(nodes[current.first].rightChild, current.second + 1));
+		}
+	}
+
+	return depth;
+}
+
+// - Medir en CPU la construccin, el reajuste y las consultas sobre una escena. El frustum se gira
+//   alrededor del eje Y en cada iteracin y los rayos parten del punto de vista hacia puntos
+//   pseudoaleatorios de la escena. El culling sin jerarqua (Element3D::updateVisibility) se mide
+//   como referencia
+void BVH::benchmark(Group3D *scene, glm::mat4 viewProjection, glm::vec3 eye, unsigned int iterations)
+{
+	typedef std::chrono::high_resolution_clock Clock;
+
+	iterations = std::max(iterations, 1u);
+
+	BVH bvh;
+	CullingStatistics statistics;
+	Frustum frustum;
+
+	// - Construccin
+	Clock::time_point start = Clock::now();
+	for (unsigned int i = 0; i < iterations; i++)
+	{
+		bvh.build(scene);
+	}
+	double buildTime = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / iterations;
+
+	// - Reajuste
+	start = Clock::now();
+	for (unsigned int i = 0; i < iterations; i++)
+	{
+		bvh.refit();
+	}
+	double refitTime = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / iterations;
+
+	// - Frustum culling con y sin jerarqua
+	double cullTime = 0.0, flatCullTime = 0.0;
+	unsigned int culledMeshes = 0, flatCulledMeshes = 0;
+
+	for (unsigned int i = 0; i < iterations; i++)
+	{
+		float angle = glm::two_pi<float>() * i / iterations;
+		frustum.extract(viewProjection * glm::rotate(glm::mat4(1.f), angle, glm::vec3(0.f, 1.f, 0.f)));
+
+		statistics.reset();
+		start = Clock::now();
+		bvh.cullFrustum(frustum, statistics);
+		cullTime += std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+		culledMeshes += statistics.meshesCulled;
+
+		statistics.reset();
+		start = Clock::now();
+		scene->updateVisibility(frustum, scene->getModelMatrix(), statistics);
+		flatCullTime += std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+		flatCulledMeshes += statistics.meshesCulled;
+	}
+
+	// - Rayos
+	AABB sceneBounds;
+	for (unsigned int i = 0; i < bvh.primitives.size(); i++)
+	{
+		sceneBounds.expand(bvh.primitives[i].bounds);
+	}
+
+	unsigned int seed = 1;
+	unsigned int hits = 0;
+	double rayTime = 0.0;
+
+	for (unsigned int i = 0; i < iterations; i++)
+	{
+		glm::vec3 target;
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+			seed = seed * 1664525u + 1013904223u;
+			target[axis] = glm::mix(sceneBounds.min[axis], sceneBounds.max[axis], (seed >> 8) / 16777216.f);
+		}
+
+		float distance;
+		start = Clock::now();
+		hits += bvh.intersectRay(eye, target - eye, distance) >= 0 ? 1 : 0;
+		rayTime += std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+	}
+
+	// - Orden de delante hacia atrs
+	std::vector<int> order;
+	start = Clock::now();
+	for (unsigned int i = 0; i < iterations; i++)
+	{
+		bvh.frontToBack(eye, order);
+	}
+	double orderTime = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / iterations;
+
+	std::cout << std::fixed << std::setprecision(2);
+	std::cout << "==== BVH benchmark (" << iterations << " iterations) ====" << std::endl;
+	std::cout << "Primitives: " << bvh.getNumPrimitives() << ", nodes: " << bvh.getNumNodes()
+			  << ", depth: " << bvh.getDepth() << std::endl;
+	std::cout << "Build:              " << buildTime << " us" << std::endl;
+	std::cout << "Refit:              " << refitTime << " us" << std::endl;
+	std::cout << "Frustum (BVH):      " << cullTime / iterations << " us (" << culledMeshes << " meshes culled)" << std::endl;
+	std::cout << "Frustum (flat):     " << flatCullTime / iterations << " us (" << flatCulledMeshes << " meshes culled)" << std::endl;
+	std::cout << "Ray pick:           " << rayTime / iterations << " us (" << hits << " hits)" << std::endl;
+	std::cout << "Front-to-back:      " << orderTime << " us" << std::endl;
+	std::cout.unsetf(std::ios::fixed);
+	std::cout << std::setprecision(6);
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <vector>
+
+#include "BoundingVolumes.h"
+#include "Group3D.h"
+
+// - Nodo de la BVH. Los nodos se guardan en un array en orden de recorrido en profundidad: el hijo
+//   izquierdo de un nodo interno es el nodo siguiente y el derecho se indica con rightChild. Las
+//   hojas indican el rango de primitivas que contienen
+struct BVHNode
+{
+	AABB bounds;
+	int rightChild;
+	int firstPrimitive;
+	int numPrimitives;
+
+	BVHNode()
+	{
+		this->rightChild = -1;
+		this->firstPrimitive = 0;
+		this->numPrimitives = 0;
+	}
+
+	// - Saber si es una hoja
+	bool isLeaf() const
+	{
+		return numPrimitives > 0;
+	}
+};
+
+// - La clase BVH construye una jerarqua de volmenes envolventes (SAH por intervalos) sobre las
+//   mallas de todos los elementos de una escena, en coordenadas de mundo. Cuando cambia alguna matriz
+//   de modelado no se reconstruye: se recalculan las cajas de las primitivas y se reajustan las de
+//   los nodos de abajo a arriba. Se utiliza para el frustum culling, para seleccionar elementos con
+//   el ratn (rayos) y para ordenar los elementos de delante hacia atrs
+class BVH
+{
+private:
+	// - Escena sobre la que se construye la jerarqua
+	Group3D *scene;
+
+	// - Primitivas (en el orden de las hojas) y posicin de cada una en el orden en el que las
+	//   aade la escena, para poder reajustarlas sin reconstruir
+	std::vector<BVHPrimitive> primitives;
+	std::vector<unsigned int> collectionOrder;
+
+	// - Nodos
+	std::vector<BVHNode> nodes;
+
+	// - Mayor margen que aaden los contornos a una primitiva
+	float maxOutlineMargin;
+
+	// - Valor del contador de cambios de matrices de modelado en la ltima construccin o reajuste
+	unsigned int transformVersion;
+
+	// - Mtodo privado: obtener las primitivas de la escena en coordenadas de mundo
+	void collectPrimitives(std::vector<BVHPrimitive> &result);
+
+	// - Mtodo privado: construir el subrbol de las primitivas [first, first + count)
+	int buildNode(int first, int count);
+
+	// - Mtodo privado: calcular la caja de un nodo a partir de sus primitivas o de sus hijos
+	void refitNode(int node);
+
+	// - Mtodo privado: calcular el mayor margen de los contornos
+	void updateOutlineMargin();
+
+public:
+	// - Nmero mximo de primitivas en una hoja
+	static const int MAX_LEAF_PRIMITIVES = 2;
+
+	// - Nmero de intervalos por eje para evaluar la SAH
+	static const int SAH_BINS = 12;
+
+	// - Constructor por defecto
+	BVH();
+
+	// - Construir la jerarqua sobre una escena
+	void build(Group3D *scene);
+
+	// - Saber si ha cambiado alguna matriz de modelado desde la ltima construccin o reajuste
+	bool needsRefit();
+
+	// - Recalcular las cajas de las primitivas y reajustar los nodos (se reconstruye si la escena
+	//   tiene un nmero distinto de primitivas)
+	void refit();
+
+	// - Frustum culling: asignar la visibilidad de las mallas y de los elementos de la escena
+	void cullFrustum(const Frustum &frustum, CullingStatistics &statistics);
+
+	// - Rayo (coordenadas de mundo): ndice del elemento de primer nivel de la escena ms cercano
+	//   que corta el rayo (-1 si no corta ninguno) y distancia en unidades de la direccin
+	int intersectRay(const glm::vec3 &origin, const glm::vec3 &direction, float &distance);
+
+	// - Elementos de primer nivel de la escena ordenados de delante hacia atrs desde un punto
+	void frontToBack(const glm::vec3 &eye, std::vector<int> &sceneElements);
+
+	// - ndices de las primitivas ordenadas de delante hacia atrs desde un punto
+	void frontToBackPrimitives(const glm::vec3 &eye, std::vector<unsigned int> &order);
+
+	// - Primitivas (en el orden de las hojas)
+	const std::vector<BVHPrimitive>& getPrimitives();
+
+	// - Informacin
+	unsigned int getNumNodes();
+	unsigned int getNumPrimitives();
+	unsigned int getDepth();
+
+	// - Medir en CPU la construccin, el reajuste y las consultas sobre una escena
+	static void benchmark(Group3D *scene, glm::mat4 viewProjection, glm::vec3 eye, unsigned int iterations);
+};
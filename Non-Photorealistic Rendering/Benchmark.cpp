@@ -0,0 +1,442 @@
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#endif
+
+// - Constantes de las extensiones de consulta de memoria de vdeo (NVIDIA y AMD)
+#ifndef GL_GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX
+#define GL_GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX 0x9048
+#define GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX 0x9049
+#endif
+
+#ifndef GL_TEXTURE_FREE_MEMORY_ATI
+#define GL_TEXTURE_FREE_MEMORY_ATI 0x87FC
+#endif
+
+// - Tcnicas y modos de contorno medidos
+static const char *BENCHMARK_TECHNIQUES[] =
+{
+	"realistic", "monochrome", "celShading", "hatching", "goochShading",
+	"halftone", "dithering", "pixelArt", "painterly", "charcoal"
+};
+
+static const char *BENCHMARK_OUTLINES[] = { "none", "basic", "advanced", "advancedCompute" };
+
+// - Nmero de escenas disponibles en Renderer::setupScene
+static const unsigned int BENCHMARK_SCENES = 3;
+
+// - Constructor
+Benchmark::Benchmark(GLFWwindow *window, Renderer *renderer, BenchmarkSettings settings)
+{
+	this->window = window;
+	this->renderer = renderer;
+	this->settings = settings;
+
+	timerQuery = 0;
+	glGenQueries(1, &timerQuery);
+}
+
+// - Destructor
+Benchmark::~Benchmark()
+{
+	glDeleteQueries(1, &timerQuery);
+}
+
+// - Ejecutar el benchmark completo
+int Benchmark::run()
+{
+	results.clear();
+
+	// - Sin sincronizacin vertical, para no medir el tiempo de espera del monitor
+	glfwSwapInterval(0);
+
+	for (unsigned int scene = 0; scene < BENCHMARK_SCENES && !glfwWindowShouldClose(window); scene++)
+	{
+		// - La carga de la escena no se incluye en las medidas
+		renderer->setupScene(scene);
+
+		// - ndice del resultado de referencia de la escena (realista sin contornos)
+		unsigned int referenceIndex = results.size();
+
+		for (const char *technique : BENCHMARK_TECHNIQUES)
+		{
+			for (const char *outline : BENCHMARK_OUTLINES)
+			{
+				// - El contorno avanzado con compute shader slo se mide si el driver lo admite
+				if (std::string(outline) == "advancedCompute" && !renderer->isComputeSilhouetteSupported())
+				{
+					continue;
+				}
+
+				BenchmarkResult result = measure(scene, technique, outline);
+				result.relativeP50 = (results.size() > referenceIndex && results[referenceIndex].cpuP50 > 0.0) ?
+									 result.cpuP50 / results[referenceIndex].cpuP50 : 1.0;
+				results.push_back(result);
+
+				std::cout << "[Benchmark] Scene " << scene + 1 << " | " << technique << " | " << outline
+						  << " | CPU p50/p95/p99: " << result.cpuP50 << " / " << result.cpuP95 << " / " << result.cpuP99
+						  << " ms | GPU p50: " << result.gpuP50 << " ms" << std::endl;
+			}
+		}
+	}
+
+	// - Dejar la aplicacin en su estado inicial
+	renderer->setOutlines(false, false);
+	renderer->setComputeSilhouettes(false);
+	renderer->resetAllRenderingModes();
+	renderer->setRenderingMode("realistic");
+
+	// - Exportar resultados
+	writeJSON(settings.output + ".json");
+	writeCSV(settings.output + ".csv");
+
+	// - Comparar con los resultados de referencia
+	if (!settings.baseline.empty())
+	{
+		unsigned int regressions = 0;
+
+		// - Sin referencia no se puede comprobar nada: el benchmark falla
+		if (!compareWithBaseline(regressions))
+		{
+			std::cout << "[Benchmark] Cannot compare against baseline " << settings.baseline << std::endl;
+			return 2;
+		}
+
+		if (regressions > 0)
+		{
+			std::cout << "[Benchmark] " << regressions << " regression(s) above "
+					  << settings.threshold * 100.f << "%" << std::endl;
+			return 1;
+		}
+
+		std::cout << "[Benchmark] No regressions against " << settings.baseline << std::endl;
+	}
+
+	return 0;
+}
+
+// - Medir una combinacin escena/tcnica/contorno
+BenchmarkResult Benchmark::measure(unsigned int scene, const std::string &technique, const std::string &outline)
+{
+	BenchmarkResult result;
+	result.scene = scene;
+	result.technique = technique;
+	result.outline = outline;
+	result.frames = settings.frames;
+
+	// - Activar tcnica y contornos
+	renderer->resetAllRenderingModes();
+	renderer->setRenderingMode(technique, true);
+	renderer->setOutlines(outline == "basic", outline == "advanced" || outline == "advancedCompute");
+	renderer->setComputeSilhouettes(outline == "advancedCompute");
+
+	// - Recorrido de cmara determinista: la cmara vuelve a su estado inicial y oscila
+	//   alrededor del punto de inters mientras se acerca y aleja de l
+	renderer->cameraReset();
+
+	const float PI = 3.14159265f;
+	const float orbitAmplitude = 45.f;
+	const float dollyAmplitude = 2.f;
+
+	std::vector<double> cpuSamples;
+	std::vector<double> gpuSamples;
+
+	unsigned int totalFrames = settings.warmupFrames + settings.frames;
+
+	for (unsigned int frame = 0; frame < totalFrames; frame++)
+	{
+		glfwPollEvents();
+
+		// - Posicin de la cmara en el recorrido (se aplican incrementos para usar la API de la cmara)
+		float t0 = 2.f * PI * frame / totalFrames;
+		float t1 = 2.f * PI * (frame + 1) / totalFrames;
+		renderer->cameraOrbitMovement(orbitAmplitude * (std::sin(t1) - std::sin(t0)));
+		renderer->cameraDollyMovement(dollyAmplitude * (std::sin(2.f * t1) - std::sin(2.f * t0)));
+
+		std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+		glBeginQuery(GL_TIME_ELAPSED, timerQuery);
+
+		// - Dibujar frame
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		renderer->render();
+
+		glEndQuery(GL_TIME_ELAPSED);
+		glfwSwapBuffers(window);
+
+		// - Esperar a que la GPU termine para que el tiempo medido incluya todo el trabajo del frame
+		glFinish();
+		std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+
+		GLuint64 gpuTime = 0;
+		glGetQueryObjectui64v(timerQuery, GL_QUERY_RESULT, &gpuTime);
+
+		// - Los frames de calentamiento se descartan
+		if (frame >= settings.warmupFrames)
+		{
+			cpuSamples.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+			gpuSamples.push_back(gpuTime / 1000000.0);
+		}
+	}
+
+	result.cpuP50 = percentile(cpuSamples, 50.0);
+	result.cpuP95 = percentile(cpuSamples, 95.0);
+	result.cpuP99 = percentile(cpuSamples, 99.0);
+
+	result.gpuP50 = percentile(gpuSamples, 50.0);
+	result.gpuP95 = percentile(gpuSamples, 95.0);
+	result.gpuP99 = percentile(gpuSamples, 99.0);
+
+	result.relativeP50 = 1.0;
+
+	result.gpuMemoryKB = queryGPUMemoryKB();
+	result.processMemoryKB = queryProcessMemoryKB();
+
+	return result;
+}
+
+// - Percentil (nearest-rank) de un conjunto de muestras
+double Benchmark::percentile(std::vector<double> samples, double p)
+{
+	if (samples.empty())
+	{
+		return 0.0;
+	}
+
+	std::sort(samples.begin(), samples.end());
+
+	size_t rank = (size_t) std::ceil(p / 100.0 * samples.size());
+	rank = std::max<size_t>(rank, 1);
+
+	return samples[std::min(rank, samples.size()) - 1];
+}
+
+// - Memoria de vdeo en uso (slo disponible con GL_NVX_gpu_memory_info o GL_ATI_meminfo)
+long long Benchmark::queryGPUMemoryKB()
+{
+	if (GLEW_NVX_gpu_memory_info)
+	{
+		GLint total = 0;
+		GLint available = 0;
+		glGetIntegerv(GL_GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX, &total);
+		glGetIntegerv(GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX, &available);
+		return (long long) total - available;
+	}
+
+	// - En AMD slo se conoce la memoria libre: se devuelve en negativo para distinguirla
+	if (GLEW_ATI_meminfo)
+	{
+		GLint freeMemory[4] = { 0, 0, 0, 0 };
+		glGetIntegerv(GL_TEXTURE_FREE_MEMORY_ATI, freeMemory);
+		return -(long long) freeMemory[0];
+	}
+
+	return -1;
+}
+
+// - Memoria en uso por el proceso
+long long Benchmark::queryProcessMemoryKB()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+	{
+		return (long long) counters.WorkingSetSize / 1024;
+	}
+
+	return -1;
+#else
+	std::ifstream statm("/proc/self/statm");
+	long long pages = 0;
+	long long residentPages = 0;
+
+	if (statm >> pages >> residentPages)
+	{
+		return residentPages * 4;
+	}
+
+	return -1;
+#endif
+}
+
+// - Exportar resultados a JSON
+bool Benchmark::writeJSON(const std::string &filename)
+{
+	std::ofstream file(filename);
+
+	if (!file)
+	{
+		std::cout << "Cannot write benchmark results: " << filename << std::endl;
+		return false;
+	}
+
+	file << "{" << std::endl;
+	file << "  \"renderer\": \"" << glGetString(GL_RENDERER) << "\"," << std::endl;
+	file << "  \"version\": \"" << glGetString(GL_VERSION) << "\"," << std::endl;
+	file << "  \"frames\": " << settings.frames << "," << std::endl;
+	file << "  \"results\": [" << std::endl;
+
+	for (unsigned int i = 0; i < results.size(); i++)
+	{
+		const BenchmarkResult &r = results[i];
+
+		file << "    { \"scene\": " << r.scene + 1
+			 << ", \"technique\": \"" << r.technique << "\""
+			 << ", \"outline\": \"" << r.outline << "\""
+			 << ", \"frames\": " << r.frames
+			 << ", \"cpu_ms\": { \"p50\": " << r.cpuP50 << ", \"p95\": " << r.cpuP95 << ", \"p99\": " << r.cpuP99 << " }"
+			 << ", \"gpu_ms\": { \"p50\": " << r.gpuP50 << ", \"p95\": " << r.gpuP95 << ", \"p99\": " << r.gpuP99 << " }"
+			 << ", \"relative_p50\": " << r.relativeP50
+			 << ", \"gpu_memory_kb\": " << r.gpuMemoryKB
+			 << ", \"process_memory_kb\": " << r.processMemoryKB << " }"
+			 << (i + 1 < results.size() ? "," : "") << std::endl;
+	}
+
+	file << "  ]" << std::endl;
+	file << "}" << std::endl;
+
+	return true;
+}
+
+// - Exportar resultados a CSV
+bool Benchmark::writeCSV(const std::string &filename)
+{
+	std::ofstream file(filename);
+
+	if (!file)
+	{
+		std::cout << "Cannot write benchmark results: " << filename << std::endl;
+		return false;
+	}
+
+	file << "scene,technique,outline,frames,cpu_p50,cpu_p95,cpu_p99,gpu_p50,gpu_p95,gpu_p99,"
+		 << "relative_p50,gpu_memory_kb,process_memory_kb" << std::endl;
+
+	for (const BenchmarkResult &r : results)
+	{
+		file << r.scene + 1 << "," << r.technique << "," << r.outline << "," << r.frames << ","
+			 << r.cpuP50 << "," << r.cpuP95 << "," << r.cpuP99 << ","
+			 << r.gpuP50 << "," << r.gpuP95 << "," << r.gpuP99 << ","
+			 << r.relativeP50 << "," << r.gpuMemoryKB << "," << r.processMemoryKB << std::endl;
+	}
+
+	return true;
+}
+
+// - Leer resultados de referencia (CSV generado por writeCSV)
+bool Benchmark::readCSV(const std::string &filename, std::vector<BenchmarkResult> &baselineResults)
+{
+	std::ifstream file(filename);
+
+	if (!file)
+	{
+		std::cout << "Cannot read benchmark baseline: " << filename << std::endl;
+		return false;
+	}
+
+	std::string line;
+
+	// - Saltar cabecera
+	std::getline(file, line);
+
+	while (std::getline(file, line))
+	{
+		std::vector<std::string> fields;
+		std::stringstream lineStream(line);
+		std::string field;
+
+		while (std::getline(lineStream, field, ','))
+		{
+			fields.push_back(field);
+		}
+
+		if (fields.size() < 13)
+		{
+			continue;
+		}
+
+		BenchmarkResult r;
+
+		try
+		{
+			r.scene = std::stoi(fields[0]) - 1;
+			r.technique = fields[1];
+			r.outline = fields[2];
+			r.frames = std::stoi(fields[3]);
+			r.cpuP50 = std::stod(fields[4]);
+			r.cpuP95 = std::stod(fields[5]);
+			r.cpuP99 = std::stod(fields[6]);
+			r.gpuP50 = std::stod(fields[7]);
+			r.gpuP95 = std::stod(fields[8]);
+			r.gpuP99 = std::stod(fields[9]);
+			r.relativeP50 = std::stod(fields[10]);
+			r.gpuMemoryKB = std::stoll(fields[11]);
+			r.processMemoryKB = std::stoll(fields[12]);
+		}
+		catch (const std::exception &)
+		{
+			std::cout << "Malformed benchmark baseline: " << filename << std::endl;
+			return false;
+		}
+
+		baselineResults.push_back(r);
+	}
+
+	// - Una referencia vaca tampoco permite comparar
+	if (baselineResults.empty())
+	{
+		std::cout << "Empty benchmark baseline: " << filename << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+// - Comparar con los resultados de referencia. Se compara el p95 del tiempo de CPU (o el p50
+//   relativo si se pidi comparacin relativa) y se considera regresin todo aumento por
+//   encima del umbral
+bool Benchmark::compareWithBaseline(unsigned int &regressions)
+{
+	std::vector<BenchmarkResult> baselineResults;
+	regressions = 0;
+
+	if (!readCSV(settings.baseline, baselineResults))
+	{
+		return false;
+	}
+
+	for (const BenchmarkResult &current : results)
+	{
+		for (const BenchmarkResult &reference : baselineResults)
+		{
+			if (reference.scene != current.scene || reference.technique != current.technique ||
+				reference.outline != current.outline)
+			{
+				continue;
+			}
+
+			double currentValue = settings.relative ? current.relativeP50 : current.cpuP95;
+			double referenceValue = settings.relative ? reference.relativeP50 : reference.cpuP95;
+
+			if (referenceValue > 0.0 && currentValue > referenceValue * (1.0 + settings.threshold))
+			{
+				regressions++;
+				std::cout << "[Benchmark] REGRESSION Scene " << current.scene + 1 << " | " << current.technique
+						  << " | " << current.outline << ": " << referenceValue << " -> " << currentValue
+						  << (settings.relative ? " (relative)" : " ms (p95)") << std::endl;
+			}
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <string>
+#include <vector>
+
+#include "Renderer.h"
+
+// - Parmetros de ejecucin del benchmark
+struct BenchmarkSettings
+{
+	// - Frames medidos por combinacin (y frames de calentamiento descartados)
+	unsigned int frames;
+	unsigned int warmupFrames;
+
+	// - Ruta base de los resultados (se generan [output].json y [output].csv)
+	std::string output;
+
+	// - Resultados de referencia (CSV generado por una ejecucin anterior) y umbral de regresin
+	std::string baseline;
+	float threshold;
+
+	// - Comparar tiempos relativos (respecto a la tcnica realista sin contornos de cada escena)
+	//   en lugar de absolutos. til en mquinas sin GPU (llvmpipe), donde slo tienen sentido
+	//   las proporciones entre tcnicas
+	bool relative;
+
+	// - Constructor por defecto
+	BenchmarkSettings()
+	{
+		this->frames = 240;
+		this->warmupFrames = 30;
+		this->output = "Benchmark";
+		this->baseline = "";
+		this->threshold = 0.1f;
+		this->relative = false;
+	}
+};
+
+// - Resultado de una combinacin escena/tcnica/contorno
+struct BenchmarkResult
+{
+	unsigned int scene;
+	std::string technique;
+	std::string outline;
+	unsigned int frames;
+
+	// - Percentiles del tiempo de frame en CPU (ms)
+	double cpuP50;
+	double cpuP95;
+	double cpuP99;
+
+	// - Percentiles del tiempo de GPU (ms), medido con consultas GL_TIME_ELAPSED
+	double gpuP50;
+	double gpuP95;
+	double gpuP99;
+
+	// - Tiempo p50 relativo al de la tcnica realista sin contornos de la misma escena
+	double relativeP50;
+
+	// - Memoria en uso al terminar la combinacin (KB, -1 si no est disponible)
+	long long gpuMemoryKB;
+	long long processMemoryKB;
+};
+
+// - La clase Benchmark recorre todas las escenas de Renderer::setupScene y, para cada
+//   combinacin de tcnica y contorno, reproduce un recorrido de cmara determinista
+//   midiendo el tiempo de cada frame. Los resultados se exportan a JSON y CSV y, opcionalmente,
+//   se comparan con unos resultados de referencia
+class Benchmark
+{
+private:
+	// - Ventana (para el intercambio de buffers) y renderer a medir
+	GLFWwindow *window;
+	Renderer *renderer;
+
+	// - Parmetros
+	BenchmarkSettings settings;
+
+	// - Resultados
+	std::vector<BenchmarkResult> results;
+
+	// - Consulta de tiempo de GPU
+	GLuint timerQuery;
+
+	// - Medir una combinacin
+	BenchmarkResult measure(unsigned int scene, const std::string &technique, const std::string &outline);
+
+	// - Percentil (nearest-rank) de un conjunto de muestras
+	double percentile(std::vector<double> samples, double p);
+
+	// - Memoria en uso (GPU y proceso)
+	long long queryGPUMemoryKB();
+	long long queryProcessMemoryKB();
+
+	// - Exportar resultados
+	bool writeJSON(const std::string &filename);
+	bool writeCSV(const std::string &filename);
+
+	// - Leer resultados de referencia (CSV)
+	bool readCSV(const std::string &filename, std::vector<BenchmarkResult> &baselineResults);
+
+	// - Comparar con los resultados de referencia (nmero de regresiones). Devuelve false si no se
+	//   pueden leer
+	bool compareWithBaseline(unsigned int &regressions);
+
+public:
+	// - Constructor
+	Benchmark(GLFWwindow *window, Renderer *renderer, BenchmarkSettings settings);
+
+	// - Destructor
+	~Benchmark();
+
+	// - Ejecutar el benchmark completo. Devuelve 0 si no hay regresiones
+	int run();
+};
@@ -0,0 +1,214 @@
+#include "BoundingVolumes.h"
+
+#include <algorithm>
+#include <cmath>
+#include <xmmintrin.h>
+
+// - Caja que contiene a esta caja transformada por una matriz afn: el nuevo centro es el centro
+//   transformado y cada semieje es la suma de los semiejes ponderados por el valor absoluto de la
+//   matriz (Arvo)
+AABB AABB::transform(const glm::mat4 &matrix) const
+{
+	if (!isValid())
+	{
+		return AABB();
+	}
+
+	glm::vec3 center = glm::vec3(matrix * glm::vec4(getCenter(), 1.f));
+	glm::vec3 extents = getExtents();
+	glm::vec3 newExtents;
+
+	for (int i = 0; i < 3; i++)
+	{
+		newExtents[i] = std::abs(matrix[0][i]) * extents.x +
+						std::abs(matrix[1][i]) * extents.y +
+						std::abs(matrix[2][i]) * extents.z;
+	}
+
+	return AABB(center - newExtents, center + newExtents);
+}
+
+// - Caja que contiene un conjunto de vrtices
+AABB AABB::fromVertices(const std::vector<PosNorm> &vertices)
+{
+	AABB box;
+
+	for (unsigned int i = 0; i < vertices.size(); i++)
+	{
+		box.expand(vertices[i].position);
+	}
+
+	return box;
+}
+
+// - Esfera que contiene a esta esfera transformada por una matriz afn
+BoundingSphere BoundingSphere::transform(const glm::mat4 &matrix) const
+{
+	if (radius < 0.f)
+	{
+		return BoundingSphere();
+	}
+
+	float scaleX = glm::length(glm::vec3(matrix[0]));
+	float scaleY = glm::length(glm::vec3(matrix[1]));
+	float scaleZ = glm::length(glm::vec3(matrix[2]));
+	float maxScale = std::max(scaleX, std::max(scaleY, scaleZ));
+
+	return BoundingSphere(glm::vec3(matrix * glm::vec4(center, 1.f)), radius * maxScale);
+}
+
+// - Esfera centrada en la caja de los vrtices que contiene todos los vrtices
+BoundingSphere BoundingSphere::fromVertices(const std::vector<PosNorm> &vertices, const AABB &box)
+{
+	if (!box.isValid())
+	{
+		return BoundingSphere();
+	}
+
+	glm::vec3 center = box.getCenter();
+	float maxDistanceSquare = 0.f;
+
+	for (unsigned int i = 0; i < vertices.size(); i++)
+	{
+		glm::vec3 d = vertices[i].position - center;
+		maxDistanceSquare = std::max(maxDistanceSquare, glm::dot(d, d));
+	}
+
+	return BoundingSphere(center, std::sqrt(maxDistanceSquare));
+}
+
+// - Constructor por defecto: todos los planos aceptan cualquier volumen
+Frustum::Frustum()
+{
+	for (int i = 0; i < 8; i++)
+	{
+		normalX[i] = 0.f;
+		normalY[i] = 0.f;
+		normalZ[i] = 0.f;
+		distance[i] = std::numeric_limits<float>::max();
+	}
+}
+
+// - Extraer los planos de la matriz de visin-proyeccin (Gribb-Hartmann). Las filas de la matriz
+//   se combinan para obtener los planos izquierdo, derecho, inferior, superior, cercano y lejano
+void Frustum::extract(const glm::mat4 &viewProjection)
+{
+	glm::vec4 row[4];
+
+	for (int i = 0; i < 4; i++)
+	{
+		row[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+	}
+
+	glm::vec4 planes[6] =
+	{
+		row[3] + row[0],
+		row[3] - row[0],
+		row[3] + row[1],
+		row[3] - row[1],
+		row[3] + row[2],
+		row[3] - row[2]
+	};
+
+	for (int i = 0; i < 6; i++)
+	{
+		float length = glm::length(glm::vec3(planes[i]));
+
+		if (length > 0.f)
+		{
+			planes[i] /= length;
+		}
+
+		normalX[i] = planes[i].x;
+		normalY[i] = planes[i].y;
+		normalZ[i] = planes[i].z;
+		distance[i] = planes[i].w;
+	}
+
+	// - Planos de relleno (no descartan nada)
+	for (int i = 6; i < 8; i++)
+	{
+		normalX[i] = 0.f;
+		normalY[i] = 0.f;
+		normalZ[i] = 0.f;
+		distance[i] = std::numeric_limits<float>::max();
+	}
+}
+
+// - Comparar una esfera con el frustum: distancia con signo del centro a 4 planos a la vez
+FrustumTestResult Frustum::testSphere(const BoundingSphere &sphere) const
+{
+	if (sphere.radius < 0.f)
+	{
+		return FRUSTUM_OUTSIDE;
+	}
+
+	__m128 cx = _mm_set1_ps(sphere.center.x);
+	__m128 cy = _mm_set1_ps(sphere.center.y);
+	__m128 cz = _mm_set1_ps(sphere.center.z);
+	__m128 radius = _mm_set1_ps(sphere.radius);
+	__m128 negativeRadius = _mm_set1_ps(-sphere.radius);
+
+	int intersecting = 0;
+
+	for (int group = 0; group < 8; group += 4)
+	{
+		__m128 dist = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&normalX[group]), cx),
+								 _mm_mul_ps(_mm_loadu_ps(&normalY[group]), cy));
+		dist = _mm_add_ps(dist, _mm_mul_ps(_mm_loadu_ps(&normalZ[group]), cz));
+		dist = _mm_add_ps(dist, _mm_loadu_ps(&distance[group]));
+
+		// - Fuera de algn plano: descartada
+		if (_mm_movemask_ps(_mm_cmplt_ps(dist, negativeRadius)) != 0)
+		{
+			return FRUSTUM_OUTSIDE;
+		}
+
+		intersecting |= _mm_movemask_ps(_mm_cmplt_ps(dist, radius));
+	}
+
+	return intersecting != 0 ? FRUSTUM_INTERSECT : FRUSTUM_INSIDE;
+}
+
+// - Comparar una caja con el frustum: para cada plano se compara la distancia del centro con la
+//   proyeccin de los semiejes sobre la normal
+bool Frustum::testAABB(const AABB &box) const
+{
+	if (!box.isValid())
+	{
+		return false;
+	}
+
+	glm::vec3 center = box.getCenter();
+	glm::vec3 extents = box.getExtents();
+
+	__m128 cx = _mm_set1_ps(center.x);
+	__m128 cy = _mm_set1_ps(center.y);
+	__m128 cz = _mm_set1_ps(center.z);
+	__m128 ex = _mm_set1_ps(extents.x);
+	__m128 ey = _mm_set1_ps(extents.y);
+	__m128 ez = _mm_set1_ps(extents.z);
+	__m128 signMask = _mm_set1_ps(-0.f);
+
+	for (int group = 0; group < 8; group += 4)
+	{
+		__m128 nx = _mm_loadu_ps(&normalX[group]);
+		__m128 ny = _mm_loadu_ps(&normalY[group]);
+		__m128 nz = _mm_loadu_ps(&normalZ[group]);
+
+		__m128 dist = _mm_add_ps(_mm_mul_ps(nx, cx), _mm_mul_ps(ny, cy));
+		dist = _mm_add_ps(dist, _mm_mul_ps(nz, cz));
+		dist = _mm_add_ps(dist, _mm_loadu_ps(&distance[group]));
+
+		__m128 projectedRadius = _mm_add_ps(_mm_mul_ps(_mm_andnot_ps(signMask, nx), ex),
+											_mm_mul_ps(_mm_andnot_ps(signMask, ny), ey));
+		projectedRadius = _mm_add_ps(projectedRadius, _mm_mul_ps(_mm_andnot_ps(signMask, nz), ez));
+
+		if (_mm_movemask_ps(_mm_cmplt_ps(_mm_add_ps(dist, projectedRadius), _mm_setzero_ps())) != 0)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
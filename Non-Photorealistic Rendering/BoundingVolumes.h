@@ -0,0 +1,191 @@
+#pragma once
+
+#include <glm.hpp>
+#include <limits>
+#include <vector>
+
+#include "Structures.h"
+
+// - Forward declarations
+class Element3D;
+class Mesh;
+
+// - Caja alineada con los ejes (AABB)
+struct AABB
+{
+	glm::vec3 min;
+	glm::vec3 max;
+
+	// - Constructor por defecto (caja vaca)
+	AABB()
+	{
+		this->min = glm::vec3(std::numeric_limits<float>::max());
+		this->max = glm::vec3(-std::numeric_limits<float>::max());
+	}
+
+	AABB(glm::vec3 min, glm::vec3 max)
+	{
+		this->min = min;
+		this->max = max;
+	}
+
+	// - Saber si la caja contiene algn punto
+	bool isValid() const
+	{
+		return min.x <= max.x && min.y <= max.y && min.z <= max.z;
+	}
+
+	// - Ampliar la caja con un punto o con otra caja
+	void expand(const glm::vec3 &point)
+	{
+		min = glm::min(min, point);
+		max = glm::max(max, point);
+	}
+
+	void expand(const AABB &box)
+	{
+		if (box.isValid())
+		{
+			min = glm::min(min, box.min);
+			max = glm::max(max, box.max);
+		}
+	}
+
+	// - Ampliar la caja en todas las direcciones
+	AABB inflate(float margin) const
+	{
+		return AABB(min - glm::vec3(margin), max + glm::vec3(margin));
+	}
+
+	// - Centro y semiejes
+	glm::vec3 getCenter() const
+	{
+		return (min + max) * 0.5f;
+	}
+
+	glm::vec3 getExtents() const
+	{
+		return (max - min) * 0.5f;
+	}
+
+	// - Caja que contiene a esta caja transformada por una matriz afn
+	AABB transform(const glm::mat4 &matrix) const;
+
+	// - Caja que contiene un conjunto de vrtices
+	static AABB fromVertices(const std::vector<PosNorm> &vertices);
+};
+
+// - Esfera envolvente
+struct BoundingSphere
+{
+	glm::vec3 center;
+	float radius;
+
+	// - Constructor por defecto (esfera vaca)
+	BoundingSphere()
+	{
+		this->center = glm::vec3(0.f);
+		this->radius = -1.f;
+	}
+
+	BoundingSphere(glm::vec3 center, float radius)
+	{
+		this->center = center;
+		this->radius = radius;
+	}
+
+	// - Esfera que contiene a esta esfera transformada por una matriz afn (se usa el mayor escalado)
+	BoundingSphere transform(const glm::mat4 &matrix) const;
+
+	// - Esfera centrada en la caja de los vrtices que contiene todos los vrtices
+	static BoundingSphere fromVertices(const std::vector<PosNorm> &vertices, const AABB &box);
+};
+
+// - Primitiva de la jerarqua de volmenes envolventes (BVH): una malla de un modelo, un elemento
+//   completo (plano) o una instancia de un modelo instanciado, con su caja en coordenadas de mundo
+struct BVHPrimitive
+{
+	// - Caja envolvente (mundo)
+	AABB bounds;
+
+	// - Elemento que dibuja la primitiva (Model o Plane) y su matriz de modelado (mundo)
+	Element3D *owner;
+	glm::mat4 mModel;
+
+	// - Malla (nullptr si la primitiva es el elemento completo)
+	Mesh *mesh;
+
+	// - ndice del elemento de primer nivel de la escena al que pertenece (seleccin)
+	int sceneElement;
+
+	// - ndice de la instancia (-1 si la primitiva no es una instancia)
+	int instance;
+
+	BVHPrimitive()
+	{
+		this->owner = nullptr;
+		this->mModel = glm::mat4(1.0f);
+		this->mesh = nullptr;
+		this->sceneElement = -1;
+		this->instance = -1;
+	}
+};
+
+// - Resultado de comparar un volumen con el frustum
+enum FrustumTestResult : int
+{
+	FRUSTUM_OUTSIDE = 0,
+	FRUSTUM_INTERSECT = 1,
+	FRUSTUM_INSIDE = 2
+};
+
+// - Contadores de frustum culling de un frame
+struct CullingStatistics
+{
+	unsigned int elementsTested;
+	unsigned int elementsCulled;
+	unsigned int meshesTested;
+	unsigned int meshesCulled;
+
+	CullingStatistics()
+	{
+		reset();
+	}
+
+	void reset()
+	{
+		this->elementsTested = 0;
+		this->elementsCulled = 0;
+		this->meshesTested = 0;
+		this->meshesCulled = 0;
+	}
+};
+
+// - La clase Frustum almacena los 6 planos del volumen de visin, extrados de la matriz de
+//   visin-proyeccin. Los planos se guardan por componentes (estructura de arrays), en dos grupos
+//   de 4, para comparar un volumen con 4 planos a la vez usando SSE. Un frustum sin extraer (por
+//   defecto) acepta cualquier volumen, lo que permite desactivar el culling sin ms comprobaciones
+class Frustum
+{
+private:
+	// - Componentes de los planos (normal y distancia), rellenados hasta 8 con planos que no
+	//   descartan nada
+	float normalX[8];
+	float normalY[8];
+	float normalZ[8];
+	float distance[8];
+
+public:
+	// - Constructor por defecto (acepta cualquier volumen)
+	Frustum();
+
+	// - Extraer los planos de la matriz de visin-proyeccin (los planos quedan en el espacio en
+	//   el que est definida la matriz, normalmente coordenadas de mundo)
+	void extract(const glm::mat4 &viewProjection);
+
+	// - Comparar una esfera con el frustum
+	FrustumTestResult testSphere(const BoundingSphere &sphere) const;
+
+	// - Comparar una caja con el frustum (slo se descarta si queda por completo fuera de algn plano)
+	bool testAABB(const AABB &box) const;
+};
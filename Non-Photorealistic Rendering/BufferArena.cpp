@@ -0,0 +1,379 @@
+#include "BufferArena.h"
+#include "RenderStatistics.h"
+
+#include <algorithm>
+#include <iostream>
+
+// - Las subidas a la arena se registran en las estadsticas por reserva y no por buffer (muchas
+//   reservas comparten buffer). Los handles se desplazan para no coincidir con nombres de buffers
+static const GLuint ARENA_STATISTICS_KEY = 0x80000000;
+
+// - Singleton (inicializacin perezosa)
+BufferArena* BufferArena::instance = nullptr;
+
+// - Constructor
+BufferArena::BufferArena()
+{
+	generation = 0;
+
+	// - El almacenamiento inmutable necesita OpenGL 4.4 o la extensin (el contexto es 4.1)
+	immutable = GLEW_ARB_buffer_storage ? true : false;
+}
+
+// - Destructor
+BufferArena::~BufferArena()
+{
+	for (unsigned int i = 0; i < blocks.size(); i++)
+	{
+		glDeleteBuffers(1, &blocks[i].buffer);
+	}
+}
+
+// - Acceder al singleton
+BufferArena* BufferArena::getInstance()
+{
+	if (instance == nullptr)
+	{
+		instance = new BufferArena();
+	}
+
+	return instance;
+}
+
+// - Mtodo privado: crear un bloque. Con almacenamiento inmutable el tamao no puede cambiar, pero
+//   el contenido s (GL_DYNAMIC_STORAGE_BIT, para glBufferSubData)
+unsigned int BufferArena::createBlock(size_t size)
+{
+	ArenaBlock block;
+	block.buffer = 0;
+	block.size = size;
+	block.usedBytes = 0;
+	block.numAllocations = 0;
+	block.freeRanges.push_back(ArenaRange(0, size));
+
+	glGenBuffers(1, &block.buffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, block.buffer);
+
+	if (immutable)
+	{
+		glBufferStorage(GL_COPY_WRITE_BUFFER, size, nullptr, GL_DYNAMIC_STORAGE_BIT);
+	}
+	else
+	{
+		glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_STATIC_DRAW);
+	}
+
+	blocks.push_back(block);
+
+	return (unsigned int) blocks.size() - 1;
+}
+
+// - Mtodo privado: devolver un hueco a la lista libre de un bloque, fusionndolo con los huecos
+//   contiguos anterior y posterior
+void BufferArena::releaseRange(ArenaBlock &block, size_t offset, size_t size)
+{
+	std::vector<ArenaRange>::iterator next = block.freeRanges.begin();
+
+	while (next != block.freeRanges.end() && next->offset < offset)
+	{
+		next++;
+	}
+
+	std::vector<ArenaRange>::iterator range = block.freeRanges.insert(next, ArenaRange(offset, size));
+
+	// - Fusionar con el hueco siguiente
+	std::vector<ArenaRange>::iterator following = range + 1;
+
+	if (following != block.freeRanges.end() && range->offset + range->size == following->offset)
+	{
+		range->size += following->size;
+		range = block.freeRanges.erase(following) - 1;
+	}
+
+	// - Fusionar con el hueco anterior
+	if (range != block.freeRanges.begin())
+	{
+		std::vector<ArenaRange>::iterator previous = range - 1;
+
+		if (previous->offset + previous->size == range->offset)
+		{
+			previous->size += range->size;
+			block.freeRanges.erase(range);
+		}
+	}
+}
+
+// - Reservar y rellenar: primer hueco suficiente de los bloques existentes o un bloque nuevo
+unsigned int BufferArena::allocate(size_t bytes, const void *data)
+{
+	if (bytes == 0)
+	{
+		return NO_ALLOCATION;
+	}
+
+	size_t alignedBytes = (bytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+	unsigned int blockIndex = (unsigned int) blocks.size();
+	size_t offset = 0;
+
+	for (unsigned int i = 0; i < blocks.size() && blockIndex == blocks.size(); i++)
+	{
+		for (unsigned int j = 0; j < blocks[i].freeRanges.size(); j++)
+		{
+			ArenaRange &range = blocks[i].freeRanges[j];
+
+			if (range.size >= alignedBytes)
+			{
+				blockIndex = i;
+				offset = range.offset;
+
+				range.offset += alignedBytes;
+				range.size -= alignedBytes;
+
+				if (range.size == 0)
+				{
+					blocks[i].freeRanges.erase(blocks[i].freeRanges.begin() + j);
+				}
+
+				break;
+			}
+		}
+	}
+
+	// - Ningn hueco es suficiente: bloque nuevo (propio si la reserva es mayor que un bloque)
+	if (blockIndex == blocks.size())
+	{
+		blockIndex = createBlock(alignedBytes > BLOCK_SIZE ? alignedBytes : BLOCK_SIZE);
+		offset = 0;
+
+		ArenaRange &range = blocks[blockIndex].freeRanges[0];
+		range.offset += alignedBytes;
+		range.size -= alignedBytes;
+
+		if (range.size == 0)
+		{
+			blocks[blockIndex].freeRanges.clear();
+		}
+	}
+
+	blocks[blockIndex].usedBytes += alignedBytes;
+	blocks[blockIndex].numAllocations++;
+
+	// - Reutilizar un handle libre o aadir uno nuevo
+	ArenaAllocation allocation;
+	allocation.block = blockIndex;
+	allocation.offset = offset;
+	allocation.size = alignedBytes;
+	allocation.alive = true;
+
+	unsigned int handle;
+
+	if (!freeHandles.empty())
+	{
+		handle = freeHandles.back();
+		freeHandles.pop_back();
+		allocations[handle] = allocation;
+	}
+	else
+	{
+		allocations.push_back(allocation);
+		handle = (unsigned int) allocations.size() - 1;
+	}
+
+	if (data != nullptr)
+	{
+		update(handle, data, bytes);
+	}
+
+	return handle;
+}
+
+// - Volver a rellenar una reserva. Se usa GL_COPY_WRITE_BUFFER para no cambiar el IBO del VAO activo.
+//   Los datos que no caben en la reserva se descartan (con un aviso)
+void BufferArena::update(unsigned int handle, const void *data, size_t bytes)
+{
+	const ArenaAllocation &allocation = allocations[handle];
+	size_t written = std::min(bytes, allocation.size);
+
+	if (written < bytes)
+	{
+		std::cout << "Buffer arena: update of " << bytes << " bytes truncated to the " << allocation.size
+				  << " bytes of allocation " << handle << std::endl;
+	}
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, blocks[allocation.block].buffer);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, allocation.offset, written, data);
+	RENDER_STATS_UPLOAD(ARENA_STATISTICS_KEY + handle, data, written);
+}
+
+// - Liberar una reserva
+void BufferArena::release(unsigned int handle)
+{
+	if (handle == NO_ALLOCATION || !allocations[handle].alive)
+	{
+		return;
+	}
+
+	ArenaAllocation &allocation = allocations[handle];
+	ArenaBlock &block = blocks[allocation.block];
+
+	releaseRange(block, allocation.offset, allocation.size);
+	block.usedBytes -= allocation.size;
+	block.numAllocations--;
+
+	allocation.alive = false;
+	freeHandles.push_back(handle);
+}
+
+// - Obtener buffer de una reserva
+GLuint BufferArena::getBuffer(unsigned int handle)
+{
+	return blocks[allocations[handle].block].buffer;
+}
+
+// - Obtener desplazamiento de una reserva dentro de su buffer
+size_t BufferArena::getOffset(unsigned int handle)
+{
+	return allocations[handle].offset;
+}
+
+// - Obtener tamao (alineado) de una reserva
+size_t BufferArena::getSize(unsigned int handle)
+{
+	return allocations[handle].size;
+}
+
+// - Obtener generacin
+unsigned int BufferArena::getGeneration()
+{
+	return generation;
+}
+
+// - Desfragmentar: las reservas de cada bloque se copian seguidas a un buffer nuevo del mismo tamao,
+//   y los bloques sin reservas se eliminan (los handles no cambian)
+void BufferArena::defragment()
+{
+	std::vector<unsigned int> blockRemap(blocks.size(), 0);
+	std::vector<ArenaBlock> compacted;
+
+	for (unsigned int i = 0; i < blocks.size(); i++)
+	{
+		ArenaBlock &block = blocks[i];
+
+		if (block.numAllocations == 0)
+		{
+			glDeleteBuffers(1, &block.buffer);
+			continue;
+		}
+
+		blockRemap[i] = (unsigned int) compacted.size();
+
+		// - Reservas del bloque en orden de desplazamiento
+		std::vector<unsigned int> handles;
+
+		for (unsigned int j = 0; j < allocations.size(); j++)
+		{
+			if (allocations[j].alive && allocations[j].block == i)
+			{
+				handles.push_back(j);
+			}
+		}
+
+		std::sort(handles.begin(), handles.end(), [this](unsigned int a, unsigned int b)
+		{
+			return allocations[a].offset < allocations[b].offset;
+		});
+
+		// - Buffer nuevo y copia en la GPU
+		GLuint buffer = 0;
+		glGenBuffers(1, &buffer);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+
+		if (immutable)
+		{
+			glBufferStorage(GL_COPY_WRITE_BUFFER, block.size, nullptr, GL_DYNAMIC_STORAGE_BIT);
+		}
+		else
+		{
+			glBufferData(GL_COPY_WRITE_BUFFER, block.size, nullptr, GL_STATIC_DRAW);
+		}
+
+		glBindBuffer(GL_COPY_READ_BUFFER, block.buffer);
+
+		size_t offset = 0;
+
+		for (unsigned int j = 0; j < handles.size(); j++)
+		{
+			ArenaAllocation &allocation = allocations[handles[j]];
+
+			glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, allocation.offset, offset, allocation.size);
+			allocation.offset = offset;
+			offset += allocation.size;
+		}
+
+		glDeleteBuffers(1, &block.buffer);
+
+		block.buffer = buffer;
+		block.freeRanges.clear();
+
+		if (offset < block.size)
+		{
+			block.freeRanges.push_back(ArenaRange(offset, block.size - offset));
+		}
+
+		compacted.push_back(block);
+	}
+
+	for (unsigned int i = 0; i < allocations.size(); i++)
+	{
+		if (allocations[i].alive)
+		{
+			allocations[i].block = blockRemap[allocations[i].block];
+		}
+	}
+
+	blocks = compacted;
+	generation++;
+}
+
+// - Informe de utilizacin y fragmentacin
+ArenaStatistics BufferArena::getStatistics()
+{
+	ArenaStatistics statistics;
+	statistics.blocks = (unsigned int) blocks.size();
+	statistics.allocations = 0;
+	statistics.freeRanges = 0;
+	statistics.reservedBytes = 0;
+	statistics.usedBytes = 0;
+	statistics.largestFreeRange = 0;
+
+	for (unsigned int i = 0; i < blocks.size(); i++)
+	{
+		statistics.allocations += blocks[i].numAllocations;
+		statistics.freeRanges += (unsigned int) blocks[i].freeRanges.size();
+		statistics.reservedBytes += blocks[i].size;
+		statistics.usedBytes += blocks[i].usedBytes;
+
+		for (unsigned int j = 0; j < blocks[i].freeRanges.size(); j++)
+		{
+			statistics.largestFreeRange = std::max(statistics.largestFreeRange, blocks[i].freeRanges[j].size);
+		}
+	}
+
+	size_t freeBytes = statistics.reservedBytes - statistics.usedBytes;
+
+	statistics.utilisation = statistics.reservedBytes > 0 ? (float) statistics.usedBytes / statistics.reservedBytes : 0.f;
+	statistics.fragmentation = freeBytes > 0 ? 1.f - (float) statistics.largestFreeRange / freeBytes : 0.f;
+
+	return statistics;
+}
+
+// - Mostrar informe por consola
+void BufferArena::printReport()
+{
+	ArenaStatistics statistics = getStatistics();
+
+	std::cout << "Buffer arena: " << statistics.allocations << " allocations in " << statistics.blocks << " blocks, "
+			  << statistics.usedBytes / 1024 << " / " << statistics.reservedBytes / 1024 << " KB used ("
+			  << (int) (statistics.utilisation * 100.f) << "% utilisation, " << statistics.freeRanges << " free ranges, "
+			  << (int) (statistics.fragmentation * 100.f) << "% fragmentation)" << std::endl;
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <vector>
+
+// - Hueco libre dentro de un bloque de la arena
+struct ArenaRange
+{
+	size_t offset;
+	size_t size;
+
+	ArenaRange(size_t offset, size_t size)
+	{
+		this->offset = offset;
+		this->size = size;
+	}
+};
+
+// - Bloque de la arena: buffer de respaldo y huecos libres ordenados por desplazamiento
+struct ArenaBlock
+{
+	GLuint buffer;
+	size_t size;
+	size_t usedBytes;
+	unsigned int numAllocations;
+	std::vector<ArenaRange> freeRanges;
+};
+
+// - Reserva dentro de la arena. Los propietarios guardan el ndice de la reserva (handle), ya que la
+//   desfragmentacin puede cambiar su bloque y su desplazamiento
+struct ArenaAllocation
+{
+	unsigned int block;
+	size_t offset;
+	size_t size;
+	bool alive;
+};
+
+// - Estado de la arena para los informes
+struct ArenaStatistics
+{
+	unsigned int blocks;
+	unsigned int allocations;
+	unsigned int freeRanges;
+	size_t reservedBytes;
+	size_t usedBytes;
+	size_t largestFreeRange;
+
+	// - Utilizacin (bytes usados / reservados) y fragmentacin (1 - mayor hueco / bytes libres)
+	float utilisation;
+	float fragmentation;
+};
+
+// - La clase BufferArena sub-reserva los vrtices e ndices de todos los VAOs en unos pocos buffers
+//   grandes de tamao fijo (almacenamiento inmutable si el driver ofrece ARB_buffer_storage), en lugar
+//   de crear un buffer por atributo. Cada bloque gestiona sus huecos con una lista libre (primer
+//   hueco suficiente, fusionando huecos vecinos al liberar). La desfragmentacin compacta las reservas
+//   de cada bloque en la GPU (glCopyBufferSubData) y cambia la generacin de la arena, para que los
+//   VAOs vuelvan a enlazar sus atributos. Se implementa como un singleton para que la usen todos los VAOs
+class BufferArena
+{
+private:
+	// - Singleton
+	static BufferArena* instance;
+
+	// - Constructor privado (singleton)
+	BufferArena();
+
+	// - Bloques, reservas (huecos reutilizables de la tabla de handles) y generacin
+	std::vector<ArenaBlock> blocks;
+	std::vector<ArenaAllocation> allocations;
+	std::vector<unsigned int> freeHandles;
+	unsigned int generation;
+
+	// - Almacenamiento inmutable disponible
+	bool immutable;
+
+	// - Crear un bloque (buffer de respaldo) con un tamao
+	unsigned int createBlock(size_t size);
+
+	// - Liberar un hueco de un bloque, fusionndolo con sus vecinos
+	void releaseRange(ArenaBlock &block, size_t offset, size_t size);
+
+public:
+	// - Tamao de los bloques (las reservas mayores tienen un bloque propio) y alineamiento
+	static const size_t BLOCK_SIZE = 32 * 1024 * 1024;
+	static const size_t ALIGNMENT = 16;
+
+	// - Handle nulo (sin reserva)
+	static const unsigned int NO_ALLOCATION = 0xFFFFFFFF;
+
+	// - Acceder al singleton
+	static BufferArena* getInstance();
+
+	// - Destructor
+	~BufferArena();
+
+	// - Reservar y rellenar (data puede ser nullptr). Devuelve el handle de la reserva
+	unsigned int allocate(size_t bytes, const void *data);
+
+	// - Volver a rellenar una reserva (bytes no puede superar su tamao)
+	void update(unsigned int handle, const void *data, size_t bytes);
+
+	// - Liberar una reserva
+	void release(unsigned int handle);
+
+	// - Buffer y desplazamiento de una reserva
+	GLuint getBuffer(unsigned int handle);
+	size_t getOffset(unsigned int handle);
+	size_t getSize(unsigned int handle);
+
+	// - Generacin: cambia cada vez que la desfragmentacin mueve reservas
+	unsigned int getGeneration();
+
+	// - Compactar las reservas de cada bloque y liberar los bloques vacos
+	void defragment();
+
+	// - Informe de utilizacin y fragmentacin
+	ArenaStatistics getStatistics();
+	void printReport();
+};
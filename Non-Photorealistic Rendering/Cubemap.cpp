@@ -1,4 +1,5 @@
 #include "Cubemap.h"
+#include "GLStateCache.h"
 
 // - Constructor
 Cubemap::Cubemap()
@@ -6,6 +7,10 @@ Cubemap::Cubemap()
 	texture = 0;
 	glGenTextures(1, &texture);
 
+	gpuBytes = 0;
+	hatchDark = nullptr;
+	hatchBright = nullptr;
+
 	// - Geometra del cubo
 
 	// - Cara 1
@@ -63,7 +68,12 @@ Cubemap::Cubemap()
 // - Destructor
 Cubemap::~Cubemap()
 {
+	GLStateCache::getInstance()->forgetTexture(texture);
 	glDeleteTextures(1, &texture);
+
+	delete vao;
+	delete hatchDark;
+	delete hatchBright;
 }
 
 // - Cargar imgenes de disco
@@ -73,28 +83,40 @@ void Cubemap::loadTextures(std::vector<std::string> filenames)
 	widthImages.resize(filenames.size());
 	heightImages.resize(filenames.size());
 
+	// - Las caras se definen sobre la textura cubemap del skybox. Las imgenes decodificadas de cada
+	//   cara solo se necesitan para subirlas, as que se liberan en cada iteracin
+	bindCubemap();
+	gpuBytes = 0;
+
 	for (unsigned int i = 0; i < filenames.size(); i++)
 	{
-		Texture *texture = new Texture();
-		texture->loadImage(filenames[i].c_str(), true);
-		texture->bindTexture(GL_TEXTURE_2D, i);
-		texture->defineTexture(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,
-							   GL_TEXTURE_MIN_FILTER, GL_TEXTURE_MAG_FILTER, GL_LINEAR,
-							   GL_TEXTURE_WRAP_S, GL_TEXTURE_WRAP_T,
-							   GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE,
-							   0, GL_RGBA, texture->getWidth(),
-							   texture->getHeight(), 0,
-							   GL_RGBA, GL_UNSIGNED_BYTE, texture->getImage());
-
+		Texture face;
+		face.loadImage(filenames[i].c_str(), true);
+		face.defineTexture(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,
+						   GL_TEXTURE_MIN_FILTER, GL_TEXTURE_MAG_FILTER, GL_LINEAR,
+						   GL_TEXTURE_WRAP_S, GL_TEXTURE_WRAP_T,
+						   GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE,
+						   0, GL_RGBA, face.getWidth(),
+						   face.getHeight(), 0,
+						   GL_RGBA, GL_UNSIGNED_BYTE, face.getImage());
+
+		gpuBytes += face.getGPUMemory();
 	}
 }
 
+// - Mtodo privado: enlazar la textura cubemap en la unidad 0 (SamplerSkybox)
+void Cubemap::bindCubemap()
+{
+	GLStateCache::getInstance()->bindTexture(GL_TEXTURE_CUBE_MAP, 0, texture);
+}
+
 // - Dibujar cubemap de forma realista
 void Cubemap::drawRealistic(ShaderProgram &shader, glm::mat4 vp)
 {
 	// - Asignar uniforms correspondientes a la matriz de visin y proyeccin, y al sampleador de textura
 	shader.setUniform("mViewProj", vp);
 	shader.setUniform("SamplerSkybox", 0);
+	bindCubemap();
 
 	vao->draw(vertices.size());
 }
@@ -105,6 +127,7 @@ void Cubemap::drawCelShading(ShaderProgram &shader, glm::mat4 vp, glm::vec3 Ia)
 	// - Asignar uniforms correspondientes a la matriz de visin y proyeccin, y al sampleador de textura
 	shader.setUniform("mViewProj", vp);
 	shader.setUniform("SamplerSkybox", 0);
+	bindCubemap();
 	shader.setUniform("Ia", Ia);
 	shader.setUniform("tones", celShading.tones);
 
@@ -117,6 +140,7 @@ void Cubemap::drawHatching(ShaderProgram &shader, glm::mat4 vp)
 	// - Asignar uniforms correspondientes a la matriz de visin y proyeccin, y al sampleador de textura
 	shader.setUniform("mViewProj", vp);
 	shader.setUniform("SamplerSkybox", 0);
+	bindCubemap();
 	shader.setUniform("density", hatching.density);
 
 	// - ngulos de rotacin
@@ -195,6 +219,10 @@ void Cubemap::resetHatchingTechnique()
 // - Asignar texturas de Hatching
 void Cubemap::setHatchingTextures(std::string dark, std::string bright)
 {
+	// - Las texturas anteriores (escena anterior) se liberan
+	delete hatchDark;
+	delete hatchBright;
+
 	hatchDark = new Texture();
 	hatchDark->loadImage(dark.c_str());
 	hatchDark->bindTexture(GL_TEXTURE_2D, images.size());
@@ -212,4 +240,20 @@ void Cubemap::setHatchingTextures(std::string dark, std::string bright)
 							   GL_TEXTURE_WRAP_S, GL_TEXTURE_WRAP_T, GL_LINEAR_MIPMAP_LINEAR,
 							   0, GL_RGBA, hatchBright->getWidth(), hatchBright->getHeight(),
 							   0, GL_RGBA, GL_UNSIGNED_BYTE, hatchBright->getImage());
+
+	hatchDark->releaseImage();
+	hatchBright->releaseImage();
+}
+
+// - Obtener memoria ocupada en la GPU
+size_t Cubemap::getGPUMemory()
+{
+	size_t bytes = gpuBytes;
+
+	if (hatchDark != nullptr)
+	{
+		bytes += hatchDark->getGPUMemory() + hatchBright->getGPUMemory();
+	}
+
+	return bytes;
 }
\ No newline at end of file
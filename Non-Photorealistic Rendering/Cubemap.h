@@ -22,6 +22,9 @@ private:
 	std::vector<unsigned> widthImages;
 	std::vector<unsigned> heightImages;
 
+	// - Memoria ocupada en la GPU por las caras
+	size_t gpuBytes;
+
 	// - VAO
 	VAO *vao;
 
@@ -36,6 +39,9 @@ private:
 	Texture *hatchBright;
 	Texture *hatchDark;
 
+	// - Enlazar la textura cubemap en la unidad 0
+	void bindCubemap();
+
 public:
 	// - Constructor
 	Cubemap();
@@ -62,4 +68,7 @@ public:
 	void resetHatchingTechnique();
 
 	void setHatchingTextures(std::string dark, std::string bright);
+
+	// - Memoria ocupada en la GPU (caras y texturas de Hatching)
+	size_t getGPUMemory();
 };
\ No newline at end of file
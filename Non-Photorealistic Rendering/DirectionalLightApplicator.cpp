@@ -19,7 +19,10 @@ void DirectionalLightApplicator::apply(ShaderProgram &shader, LightSource *light
 	shader.setUniform("Id", light->getId());
 	shader.setUniform("Is", light->getIs());
 	shader.setUniform("lightDirection", glm::normalize(light->getDirection()));
+}
 
-	// - Utilizar subrutina
-	shader.setSubroutine("LightUniform", "DirectionalLight", GL_FRAGMENT_SHADER, 1);
+// - Obtener variante de los shader programs para la luz direccional
+ShaderProgramVariant DirectionalLightApplicator::getVariant()
+{
+	return DIRECTIONAL_LIGHT_VARIANT;
 }
\ No newline at end of file
@@ -13,4 +13,7 @@ public:
 
 	// - Aplicar luz direccional
 	void apply(ShaderProgram &shader, LightSource *light) override;
+
+	// - Variante de los shader programs para este tipo de luz
+	ShaderProgramVariant getVariant() override;
 };
\ No newline at end of file
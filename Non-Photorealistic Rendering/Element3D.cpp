@@ -1,13 +1,83 @@
 #include "Element3D.h"
 
+#include <algorithm>
+#include <cmath>
+
+// - Contador de cambios de matrices de modelado
+unsigned int Element3D::transformVersion = 0;
+
 // - Constructor por defecto
 Element3D::Element3D()
 {
 	modelMatrix = glm::mat4(1.0f);
+	material = nullptr;
+
+	frameModelView = nullptr;
+	frameMVP = nullptr;
+	viewSpaceVertices = false;
+
+	visible = true;
+	outlineVisible = true;
 }
 
 // - Destructor
 Element3D::~Element3D()
+{
+	delete material;
+}
+
+// - Asignar las matrices del frame calculadas en el almacn de la escena (nullptr para quitarlas)
+void Element3D::setFrameMatrices(const glm::mat4 *modelView, const glm::mat4 *mvp)
+{
+	frameModelView = modelView;
+	frameMVP = mvp;
+
+	// - Cada dibujado decide si usa la cach de transformaciones
+	viewSpaceVertices = false;
+}
+
+// - Textura con la que se ordena el elemento en el almacn de la escena (por defecto, ninguna)
+GLuint Element3D::getSortTexture()
+{
+	return 0;
+}
+
+// - VAO con el que se ordena el elemento en el almacn de la escena (por defecto, ninguno)
+GLuint Element3D::getSortVertexArray()
+{
+	return 0;
+}
+
+// - Mtodo protegido: matriz de modelado-visin con la que se dibuja el elemento
+glm::mat4 Element3D::getModelViewMatrix(const glm::mat4 &mModel, const glm::mat4 &mView)
+{
+	if (viewSpaceVertices)
+	{
+		return glm::mat4(1.f);
+	}
+
+	return frameModelView != nullptr ? *frameModelView : mView * mModel;
+}
+
+// - Mtodo protegido: matriz MVP con la que se dibuja el elemento
+glm::mat4 Element3D::getMVPMatrix(const glm::mat4 &mModel, const glm::mat4 &mView, const glm::mat4 &mProjection)
+{
+	if (viewSpaceVertices)
+	{
+		return mProjection;
+	}
+
+	return frameMVP != nullptr ? *frameMVP : mProjection * mView * mModel;
+}
+
+// - Sumar la memoria ocupada por el elemento (por defecto, ninguna)
+void Element3D::addMemoryUsage(MemoryUsage & /*usage*/)
+{
+
+}
+
+// - Liberar las imgenes decodificadas de las texturas (por defecto, ninguna)
+void Element3D::releaseTextureImages()
 {
 
 }
@@ -22,24 +92,190 @@ glm::mat4 Element3D::getModelMatrix()
 void Element3D::setModelMatrix(glm::mat4 modelMatrix)
 {
 	this->modelMatrix = modelMatrix;
+	transformVersion++;
 }
 
 // - Transformacin geomtrica: traslacin
 void Element3D::translate(glm::vec3 translation)
 {
 	this->modelMatrix = glm::translate(this->modelMatrix, translation);
+	transformVersion++;
 }
 
 // - Transformacin geomtrica: escalado
 void Element3D::scale(glm::vec3 scale)
 {
 	this->modelMatrix = glm::scale(this->modelMatrix, scale);
+	transformVersion++;
 }
 
 // - Transformacin geomtrica: rotacin
 void Element3D::rotate(glm::vec3 rotation, float angle)
 {
 	this->modelMatrix = glm::rotate(this->modelMatrix, angle, rotation);
+	transformVersion++;
+}
+
+// - Obtener la caja envolvente del elemento (espacio local)
+AABB Element3D::getBounds()
+{
+	return bounds;
+}
+
+// - Obtener la esfera envolvente del elemento (espacio local)
+BoundingSphere Element3D::getBoundingSphere()
+{
+	return boundingSphere;
+}
+
+// - Saber si el elemento es visible en el frame actual
+bool Element3D::isVisible()
+{
+	return visible;
+}
+
+// - Saber si el contorno del elemento es visible en el frame actual
+bool Element3D::isOutlineVisible()
+{
+	return outlineVisible;
+}
+
+// - Margen que aaden los contornos activados: el contorno bsico desplaza los vrtices dos veces
+//   su grosor (en espacio de visin) y el avanzado extiende cada eje en proporcin a su longitud
+float Element3D::getOutlineMargin(float size)
+{
+	float margin = 0.f;
+
+	if (basicOutline.enabled)
+	{
+		margin = std::max(margin, 2.f * std::abs(basicOutline.thickness));
+	}
+
+	if (advancedOutline.enabled)
+	{
+		margin = std::max(margin, std::abs(advancedOutline.thickness) + std::abs(advancedOutline.extension) * size);
+	}
+
+	return margin;
+}
+
+// - Comparar unos volmenes envolventes con el frustum: primero la esfera (ms barata) y, slo si
+//   corta algn plano, la caja. Los volmenes vacos se consideran siempre visibles
+void Element3D::testBounds(const Frustum &frustum, const glm::mat4 &mModel, const AABB &box, const BoundingSphere &sphere,
+						   bool &visible, bool &outlineVisible)
+{
+	if (!box.isValid())
+	{
+		visible = true;
+		outlineVisible = true;
+		return;
+	}
+
+	BoundingSphere worldSphere = sphere.transform(mModel);
+	AABB worldBox = box.transform(mModel);
+
+	FrustumTestResult result = frustum.testSphere(worldSphere);
+	visible = (result == FRUSTUM_INSIDE) || (result == FRUSTUM_INTERSECT && frustum.testAABB(worldBox));
+
+	float margin = getOutlineMargin(2.f * worldSphere.radius);
+
+	if (visible || margin <= 0.f)
+	{
+		outlineVisible = visible;
+		return;
+	}
+
+	worldSphere.radius += margin;
+	result = frustum.testSphere(worldSphere);
+	outlineVisible = (result == FRUSTUM_INSIDE) || (result == FRUSTUM_INTERSECT && frustum.testAABB(worldBox.inflate(margin)));
+}
+
+// - Frustum culling: calcular la visibilidad del elemento para el frame actual
+void Element3D::updateVisibility(const Frustum &frustum, glm::mat4 mModel, CullingStatistics &statistics)
+{
+	statistics.elementsTested++;
+
+	testBounds(frustum, mModel, bounds, boundingSphere, visible, outlineVisible);
+
+	if (!visible)
+	{
+		statistics.elementsCulled++;
+	}
+}
+
+// - Asignar visibilidad para el frame actual
+void Element3D::setVisibility(bool visible, bool outlineVisible)
+{
+	this->visible = visible;
+	this->outlineVisible = outlineVisible;
+}
+
+// - Recalcular la visibilidad a partir de la de sus elementos (slo los grupos la recalculan)
+void Element3D::aggregateVisibility()
+{
+
+}
+
+// - Visibilidad de una instancia (slo modelos instanciados)
+void Element3D::setInstanceVisibility(int /*instance*/, bool /*visible*/, bool /*outlineVisible*/)
+{
+
+}
+
+// - Nivel de detalle de una instancia (slo modelos instanciados)
+void Element3D::selectInstanceLOD(int /*instance*/, float /*screenSize*/)
+{
+
+}
+
+// - Saber si el elemento se dibuja con un shader: por defecto, con la variante no instanciada
+bool Element3D::acceptsShader(ShaderProgram &shader)
+{
+	return !shader.isInstanced();
+}
+
+// - Dibujar las aristas caractersticas (los elementos sin ellas, como el plano, no dibujan nada)
+void Element3D::drawFeatureEdges(ShaderProgram & /*shader*/, glm::mat4 /*mModel*/,
+								 glm::mat4 /*mView*/, glm::mat4 /*mProjection*/)
+{
+
+}
+
+// - Transformar los vrtices para la cach de transformaciones (los elementos que no la usan, como
+//   el plano, se dibujan transformando sus vrtices en cada pasada)
+void Element3D::captureTransform(ShaderProgram & /*shader*/, glm::mat4 /*mModel*/, glm::mat4 /*mView*/)
+{
+
+}
+
+// - Saber si el elemento se dibuja desde la cach de transformaciones (por defecto, no)
+bool Element3D::isTransformCached(const glm::mat4 & /*mView*/)
+{
+	return false;
+}
+
+// - BVH: aadir el elemento completo como primitiva
+void Element3D::collectPrimitives(glm::mat4 mModel, int sceneElement, std::vector<BVHPrimitive> &primitives)
+{
+	if (!bounds.isValid())
+	{
+		return;
+	}
+
+	BVHPrimitive primitive;
+	primitive.bounds = bounds.transform(mModel);
+	primitive.owner = this;
+	primitive.mModel = mModel;
+	primitive.mesh = nullptr;
+	primitive.sceneElement = sceneElement;
+
+	primitives.push_back(primitive);
+}
+
+// - Contador de cambios de matrices de modelado
+unsigned int Element3D::getTransformVersion()
+{
+	return transformVersion;
 }
 
 // - Saber si es o no un plano
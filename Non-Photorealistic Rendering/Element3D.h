@@ -3,6 +3,7 @@
 #include "Material.h"
 #include "ShaderProgram.h"
 #include "Structures.h"
+#include "BoundingVolumes.h"
 
 #include "Texture.h"
 
@@ -14,6 +15,9 @@ protected:
 	// - Matriz de modelado
 	glm::mat4 modelMatrix;
 
+	// - Contador de cambios de matrices de modelado (para saber cundo reajustar la BVH)
+	static unsigned int transformVersion;
+
 	// - Material
 	Material *material;
 
@@ -44,6 +48,34 @@ protected:
 	GoochShadingTechnique goochShading;
 	GoochShadingTechnique initialGoochShading;
 
+	// - Volmenes envolventes (en el espacio local del elemento), calculados al cargarlo
+	AABB bounds;
+	BoundingSphere boundingSphere;
+
+	// - Visibilidad en el frame actual, para las tcnicas y para los contornos (los contornos
+	//   desplazan los vrtices, as que sus volmenes se amplan)
+	bool visible;
+	bool outlineVisible;
+
+	// - Matrices de modelado-visin y MVP calculadas por lotes en el almacn de la escena (nullptr si el
+	//   elemento no se est dibujando desde l)
+	const glm::mat4 *frameModelView;
+	const glm::mat4 *frameMVP;
+
+	// - Cach de transformaciones: el dibujado actual lee los vrtices ya transformados al espacio de
+	//   visin (la matriz de modelado-visin es la identidad y la MVP es la de proyeccin)
+	bool viewSpaceVertices;
+
+	// - Matrices de modelado-visin y MVP con las que se dibuja el elemento (las del almacn o,
+	//   si no las hay, calculadas a partir de las recibidas; con los vrtices de la cach de
+	//   transformaciones, la identidad y la de proyeccin)
+	glm::mat4 getModelViewMatrix(const glm::mat4 &mModel, const glm::mat4 &mView);
+	glm::mat4 getMVPMatrix(const glm::mat4 &mModel, const glm::mat4 &mView, const glm::mat4 &mProjection);
+
+	// - Comparar unos volmenes envolventes, transformados por mModel, con el frustum
+	void testBounds(const Frustum &frustum, const glm::mat4 &mModel, const AABB &box, const BoundingSphere &sphere,
+					bool &visible, bool &outlineVisible);
+
 public:
 	// - Constructor por defecto
 	Element3D();
@@ -58,6 +90,47 @@ public:
 	// - Setters
 	void setModelMatrix(glm::mat4 modelMatrix);
 
+	// - Volmenes envolventes y visibilidad
+	AABB getBounds();
+	BoundingSphere getBoundingSphere();
+	bool isVisible();
+	bool isOutlineVisible();
+
+	// - Frustum culling: calcular la visibilidad del elemento (y de sus partes) para el frame actual
+	virtual void updateVisibility(const Frustum &frustum, glm::mat4 mModel, CullingStatistics &statistics);
+
+	// - Asignar visibilidad (culling con la BVH) y recalcular la de los grupos a partir de sus elementos
+	void setVisibility(bool visible, bool outlineVisible);
+	virtual void aggregateVisibility();
+
+	// - Modelos instanciados: visibilidad y nivel de detalle de una instancia (culling con la BVH)
+	virtual void setInstanceVisibility(int instance, bool visible, bool outlineVisible);
+	virtual void selectInstanceLOD(int instance, float screenSize);
+
+	// - Saber si el elemento se dibuja con un shader (los modelos instanciados slo se dibujan con la
+	//   variante instanciada y el resto de elementos slo con la variante por defecto)
+	virtual bool acceptsShader(ShaderProgram &shader);
+
+	// - Margen que aaden los contornos activados a un volumen de tamao dado
+	float getOutlineMargin(float size);
+
+	// - BVH: aadir las primitivas del elemento (en coordenadas de mundo)
+	virtual void collectPrimitives(glm::mat4 mModel, int sceneElement, std::vector<BVHPrimitive> &primitives);
+
+	// - Contador de cambios de matrices de modelado
+	static unsigned int getTransformVersion();
+
+	// - Almacn de la escena: matrices del frame para el siguiente dibujado, y textura y VAO con los
+	//   que se ordenan los elementos (0 si no tiene)
+	void setFrameMatrices(const glm::mat4 *modelView, const glm::mat4 *mvp);
+	virtual GLuint getSortTexture();
+	virtual GLuint getSortVertexArray();
+
+	// - Residencia: sumar la memoria ocupada por el elemento y liberar las imgenes decodificadas de
+	//   sus texturas (las texturas de la GPU no cambian)
+	virtual void addMemoryUsage(MemoryUsage &usage);
+	virtual void releaseTextureImages();
+
 	// - Transformaciones geomtricas
 	void translate(glm::vec3 translation);
 	void scale(glm::vec3 scale);
@@ -79,6 +152,14 @@ public:
 	virtual void drawGoochShading(ShaderProgram &shader, glm::mat4 mModel,
 								  glm::mat4 mView, glm::mat4 mProjection) = 0;
 
+	// - Dibujar slo la profundidad (pre-pasada de profundidad)
+	virtual void drawDepth(ShaderProgram &shader, glm::mat4 mModel,
+						   glm::mat4 mView, glm::mat4 mProjection) = 0;
+
+	// - Dibujar la normal y la profundidad (pre-pasada del contorno en espacio de pantalla)
+	virtual void drawNormals(ShaderProgram &shader, glm::mat4 mModel,
+							 glm::mat4 mView, glm::mat4 mProjection) = 0;
+
 	// - Dibujar contornos
 	virtual void drawBasicOutline(ShaderProgram &shader, glm::mat4 mModel,
 							      glm::mat4 mView, glm::mat4 mProjection) = 0;
@@ -86,6 +167,15 @@ public:
 	virtual void drawAdvancedOutline(ShaderProgram &shader, glm::mat4 mModel,
 									 glm::mat4 mView, glm::mat4 mProjection) = 0;
 
+	// - Dibujar las aristas caractersticas (por defecto el elemento no tiene)
+	virtual void drawFeatureEdges(ShaderProgram &shader, glm::mat4 mModel,
+								  glm::mat4 mView, glm::mat4 mProjection);
+
+	// - Transformar los vrtices al espacio de visin para la cach de transformaciones y saber si se
+	//   dibuja desde ella con una matriz de visin (por defecto el elemento no la usa)
+	virtual void captureTransform(ShaderProgram &shader, glm::mat4 mModel, glm::mat4 mView);
+	virtual bool isTransformCached(const glm::mat4 &mView);
+
 	// - Configuracin de contorno bsico
 	void setBasicOutline(BasicOutline basic);
 	BasicOutline& getBasicOutline();
@@ -3,5 +3,85 @@
 enum ShaderProgramFlags : int
 {
 	NO_GEOMETRY_SHADER = 0,
-	GEOMETRY_SHADER = 1
+	GEOMETRY_SHADER = 1,
+	COMPUTE_SHADER = 2,
+	TRANSFORM_FEEDBACK = 3
+};
+
+// - Variante (permutacin) de un shader program: mscara de bits con las definiciones que se aaden
+//   al cdigo fuente. La variante instanciada se compila con "#define INSTANCED" y lee la matriz de
+//   modelado y los parmetros de cada instancia de atributos de vrtice; las de fuente luminosa
+//   ("#define AMBIENT_LIGHT", etc.) compilan slo la funcin de iluminacin de ese tipo de fuente, y
+//   las de tcnica ("#define CEL_SHADING", etc.) eligen el modelo de los shaders del sombreado diferido
+enum ShaderProgramVariant : int
+{
+	DEFAULT_VARIANT = 0,
+	INSTANCED_VARIANT = 1,
+	AMBIENT_LIGHT_VARIANT = 2,
+	POINT_LIGHT_VARIANT = 4,
+	DIRECTIONAL_LIGHT_VARIANT = 8,
+	SPOT_LIGHT_VARIANT = 16,
+	MONOCHROME_VARIANT = 32,
+	CEL_SHADING_VARIANT = 64,
+	HATCHING_VARIANT = 128,
+	GOOCH_SHADING_VARIANT = 256
+};
+
+// - Forma de dibujar las mallas de un modelo: slo la geometra, con sus texturas o con adyacencias
+//   (contorno avanzado). Los contornos usan la visibilidad del contorno de cada malla
+enum MeshDrawMode : int
+{
+	DRAW_GEOMETRY = 0,
+	DRAW_TEXTURES = 1,
+	DRAW_OUTLINE = 2,
+	DRAW_ADJACENCIES = 3
+};
+
+// - Estado de residencia de un recurso (escena): cargado, descargado para respetar el presupuesto de
+//   memoria o leyndose en segundo plano antes de volver a cargarlo
+enum ResidencyState : int
+{
+	ASSET_RESIDENT = 0,
+	ASSET_EVICTED = 1,
+	ASSET_LOADING = 2
+};
+
+// - Pasada con la que el almacn de la escena dibuja sus elementos (funcin de dibujado de Element3D)
+enum ElementDrawPass : int
+{
+	PASS_REALISTIC = 0,
+	PASS_MONOCHROME = 1,
+	PASS_CEL_SHADING = 2,
+	PASS_HATCHING = 3,
+	PASS_GOOCH_SHADING = 4,
+	PASS_DEPTH = 5,
+	PASS_BASIC_OUTLINE = 6,
+	PASS_ADVANCED_OUTLINE = 7,
+	PASS_NORMALS = 8,
+	PASS_FEATURE_EDGES = 9,
+	PASS_TRANSFORM_CACHE = 10
+};
+
+// - Estado de la compilacin de un shader program: definido sin compilar (bajo demanda),
+//   compilndose en segundo plano, enlazado o con errores
+enum ShaderProgramStatus : int
+{
+	PROGRAM_DEFERRED = 0,
+	PROGRAM_COMPILING = 1,
+	PROGRAM_LINKED = 2,
+	PROGRAM_FAILED = 3
+};
+
+// - Destinos de color del G-buffer (sombreado diferido): color difuso (el alfa marca los pxeles con
+//   geometra), color ambiente, color especular, normal en espacio de visin y brillo, parmetros de
+//   la tcnica y tonos claros de hatching
+enum GBufferTarget : int
+{
+	GBUFFER_ALBEDO = 0,
+	GBUFFER_AMBIENT = 1,
+	GBUFFER_SPECULAR = 2,
+	GBUFFER_NORMAL = 3,
+	GBUFFER_PARAMS = 4,
+	GBUFFER_HATCHING = 5,
+	GBUFFER_NUM_TARGETS = 6
 };
\ No newline at end of file
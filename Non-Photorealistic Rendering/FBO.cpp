@@ -1,4 +1,6 @@
 #include "FBO.h"
+#include "RenderStatistics.h"
+#include "GLStateCache.h"
 #include <IL/ilu.h>
 #include <IL/ilut.h>
 
@@ -10,39 +12,47 @@ FBO::FBO()
 	fboHandle = 0;
 	renderTex = 0;
 	depthTex = 0;
+	normalTex = 0;
+	depthTexture = 0;
 
 	glGenFramebuffers(1, &fboHandle);
 	glGenTextures(1, &renderTex);
 	glGenRenderbuffers(1, &depthTex);
+	glGenTextures(1, &normalTex);
+	glGenTextures(1, &depthTexture);
 }
 
 // - Destructor
 FBO::~FBO()
 {
 	glDeleteFramebuffers(1, &fboHandle);
+	GLStateCache::getInstance()->forgetTexture(renderTex);
 	glDeleteTextures(1, &renderTex);
 	glDeleteRenderbuffers(1, &depthTex);
+	GLStateCache::getInstance()->forgetTexture(normalTex);
+	glDeleteTextures(1, &normalTex);
+	GLStateCache::getInstance()->forgetTexture(depthTexture);
+	glDeleteTextures(1, &depthTexture);
 }
 
 // - Enlazar el Frame Buffer
 void FBO::bindFrameBuffer()
 {
 	glBindFramebuffer(GL_FRAMEBUFFER, fboHandle);
+	RENDER_STATS_FRAMEBUFFER(fboHandle);
 }
 
 // - Desenlazar el Frame Buffer (enlazar con el Window-System-Provided Frame Buffer)
 void FBO::unbindFrameBuffer()
 {
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	RENDER_STATS_FRAMEBUFFER(0);
 }
 
 // - Activar textura de unidad
 void FBO::activeTextureUnit(unsigned int unit)
 {
-	if (unit >= 0 && unit <= 47)
-	{
-		glActiveTexture(GL_TEXTURE0 + unit);
-	}
+	GLStateCache::getInstance()->activeTexture(unit);
 }
 
 // - Crear textura de color
@@ -58,17 +68,19 @@ void FBO::createRenderTexture(unsigned int width, unsigned int height)
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
 }
 
-// - Enlazar textura de color
+// - Enlazar textura de color (en la unidad activa)
 void FBO::bindRenderTexture()
 {
 	// - Enlazar textura
-	glBindTexture(GL_TEXTURE_2D, renderTex);
+	GLStateCache *stateCache = GLStateCache::getInstance();
+	stateCache->bindTexture(GL_TEXTURE_2D, stateCache->getActiveUnit(), renderTex);
 }
 
 // - Desenlazar unidad de textura de color
 void FBO::unbindRenderTexture()
 {
-	glBindTexture(GL_TEXTURE_2D, 0);
+	GLStateCache *stateCache = GLStateCache::getInstance();
+	stateCache->bindTexture(GL_TEXTURE_2D, stateCache->getActiveUnit(), 0);
 }
 
 // - Asociar buffer de color al FBO
@@ -101,6 +113,76 @@ void FBO::attachDepthBuffer()
 	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthTex);
 }
 
+// - Crear textura de normales. Se leen pxel a pxel (sin filtrado) y en coma flotante, para que
+//   las normales conserven el signo y la precisin
+void FBO::createNormalTexture(unsigned int width, unsigned int height)
+{
+	// - Asignar parmetros a la textura
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	// - Crear textura 2D
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, width, height, 0, GL_RGBA, GL_FLOAT, NULL);
+}
+
+// - Enlazar textura de normales (en la unidad activa)
+void FBO::bindNormalTexture()
+{
+	GLStateCache *stateCache = GLStateCache::getInstance();
+	stateCache->bindTexture(GL_TEXTURE_2D, stateCache->getActiveUnit(), normalTex);
+}
+
+// - Desenlazar unidad de textura de normales
+void FBO::unbindNormalTexture()
+{
+	GLStateCache *stateCache = GLStateCache::getInstance();
+	stateCache->bindTexture(GL_TEXTURE_2D, stateCache->getActiveUnit(), 0);
+}
+
+// - Asociar textura de normales al FBO (segundo destino de color) y activar los dos destinos
+void FBO::attachNormalTexture()
+{
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, normalTex, 0);
+
+	const GLenum drawBuffers[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+	glDrawBuffers(2, drawBuffers);
+}
+
+// - Crear textura de profundidad
+void FBO::createDepthTexture(unsigned int width, unsigned int height)
+{
+	// - Asignar parmetros a la textura
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	// - Crear textura 2D
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT32F, width, height, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+}
+
+// - Enlazar textura de profundidad (en la unidad activa)
+void FBO::bindDepthTexture()
+{
+	GLStateCache *stateCache = GLStateCache::getInstance();
+	stateCache->bindTexture(GL_TEXTURE_2D, stateCache->getActiveUnit(), depthTexture);
+}
+
+// - Desenlazar unidad de textura de profundidad
+void FBO::unbindDepthTexture()
+{
+	GLStateCache *stateCache = GLStateCache::getInstance();
+	stateCache->bindTexture(GL_TEXTURE_2D, stateCache->getActiveUnit(), 0);
+}
+
+// - Asociar textura de profundidad al FBO
+void FBO::attachDepthTexture()
+{
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
+}
+
 // - Comprobar estado del FBO
 void FBO::checkStatus()
 {
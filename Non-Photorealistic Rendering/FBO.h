@@ -4,6 +4,9 @@
 #include <iostream>
 #include <string>
 
+// - La clase FBO encapsula un Frame Buffer con una textura de color y un buffer de profundidad. Para
+//   que las pasadas siguientes puedan leerlas, la profundidad puede ser tambin una textura y se
+//   puede aadir una textura de normales como segundo destino de color (MRT)
 class FBO
 {
 private:
@@ -12,6 +15,10 @@ private:
 	GLuint renderTex;
 	GLuint depthTex;
 
+	// - Texturas de normales (segundo destino de color) y de profundidad
+	GLuint normalTex;
+	GLuint depthTexture;
+
 public:
 	// - Constructor
 	FBO();
@@ -52,6 +59,31 @@ public:
 	// - Asociar buffer de profundidad al FBO
 	void attachDepthBuffer();
 
+	// - Crear textura de normales (normal en espacio de visin en coma flotante)
+	void createNormalTexture(unsigned int width, unsigned int height);
+
+	// - Enlazar textura de normales del FBO
+	void bindNormalTexture();
+
+	// - Desenlazar unidad de textura de normales
+	void unbindNormalTexture();
+
+	// - Asociar textura de normales al FBO como segundo destino de color (los shaders escriben en las
+	//   salidas 0 y 1)
+	void attachNormalTexture();
+
+	// - Crear textura de profundidad (alternativa al buffer de profundidad que se puede leer)
+	void createDepthTexture(unsigned int width, unsigned int height);
+
+	// - Enlazar textura de profundidad del FBO
+	void bindDepthTexture();
+
+	// - Desenlazar unidad de textura de profundidad
+	void unbindDepthTexture();
+
+	// - Asociar textura de profundidad al FBO
+	void attachDepthTexture();
+
 	// - Comprobar estado del FBO
 	void checkStatus();
 
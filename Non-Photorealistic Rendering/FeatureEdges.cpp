@@ -0,0 +1,234 @@
+#include "FeatureEdges.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+// - Diferencia mxima entre coordenadas de textura que se consideran iguales (costuras)
+static const float UV_SEAM_EPSILON = 1e-5f;
+
+// - Parmetros, versin y extracciones pendientes (todos los modelos)
+FeatureEdgeSettings FeatureEdges::settings;
+unsigned int FeatureEdges::version = 0;
+unsigned int FeatureEdges::pendingJobs = 0;
+
+// - Hash de una posicin (FNV-1a de los bits de sus coordenadas). Los bits se copian con memcpy y
+//   el cero negativo se sustituye por cero, que son iguales para == pero no en sus bits
+size_t WeldHash::operator()(const glm::vec3 &position) const
+{
+	uint64_t hash = 14695981039346656037ULL;
+
+	for (int i = 0; i < 3; i++)
+	{
+		float coordinate = position[i] == 0.f ? 0.f : position[i];
+		uint32_t bits;
+		std::memcpy(&bits, &coordinate, sizeof(bits));
+
+		hash ^= bits;
+		hash *= 1099511628211ULL;
+	}
+
+	return (size_t) hash;
+}
+
+// - Extraer las aristas caractersticas. Se suelda cada vrtice con el primero que tenga su posicin
+//   (en cualquier malla del modelo), se genera un half-edge por lado de cada tringulo con la clave
+//   de su arista y se ordenan por clave: las caras que comparten una arista quedan seguidas y se
+//   comparan en un solo recorrido
+std::vector<std::vector<unsigned int>> FeatureEdges::extract(const std::vector<FeatureEdgeMesh> &meshes,
+															 const FeatureEdgeSettings &settings)
+{
+	std::vector<std::vector<unsigned int>> lines(meshes.size());
+	std::vector<std::vector<unsigned int>> welded(meshes.size());
+	std::unordered_map<glm::vec3, unsigned int, WeldHash> positions;
+	size_t numHalfEdges = 0;
+
+	for (unsigned int m = 0; m < meshes.size(); m++)
+	{
+		const std::vector<PosNorm> &vertices = *meshes[m].vertices;
+		welded[m].resize(vertices.size());
+
+		for (unsigned int i = 0; i < vertices.size(); i++)
+		{
+			welded[m][i] = positions.insert(std::make_pair(vertices[i].position, (unsigned int) positions.size())).first->second;
+		}
+
+		numHalfEdges += meshes[m].topology.size();
+	}
+
+	// - Half-edges de todas las mallas (las aristas degeneradas, con los dos vrtices soldados, se ignoran)
+	std::vector<FeatureHalfEdge> halfEdges;
+	halfEdges.reserve(numHalfEdges);
+
+	for (unsigned int m = 0; m < meshes.size(); m++)
+	{
+		const std::vector<PosNorm> &vertices = *meshes[m].vertices;
+		const std::vector<unsigned int> &topology = meshes[m].topology;
+
+		for (unsigned int i = 0; i + 2 < topology.size(); i += 3)
+		{
+			const unsigned int *triangle = &topology[i];
+			const glm::vec3 &p0 = vertices[triangle[0]].position;
+			glm::vec3 normal = glm::cross(vertices[triangle[1]].position - p0, vertices[triangle[2]].position - p0);
+
+			for (unsigned int k = 0; k < 3; k++)
+			{
+				unsigned int a = triangle[k];
+				unsigned int b = triangle[(k + 1) % 3];
+				unsigned int weldedA = welded[m][a];
+				unsigned int weldedB = welded[m][b];
+
+				if (weldedA == weldedB)
+				{
+					continue;
+				}
+
+				FeatureHalfEdge halfEdge;
+				halfEdge.key = ((uint64_t) std::min(weldedA, weldedB) << 32) | std::max(weldedA, weldedB);
+				halfEdge.mesh = m;
+				halfEdge.a = a;
+				halfEdge.b = b;
+				halfEdge.normal = normal;
+
+				halfEdges.push_back(halfEdge);
+			}
+		}
+	}
+
+	std::sort(halfEdges.begin(), halfEdges.end(), [](const FeatureHalfEdge &left, const FeatureHalfEdge &right)
+	{
+		return left.key < right.key;
+	});
+
+	// - Recorrer las aristas (grupos de half-edges con la misma clave)
+	for (size_t first = 0; first < halfEdges.size();)
+	{
+		size_t last = first + 1;
+
+		while (last < halfEdges.size() && halfEdges[last].key == halfEdges[first].key)
+		{
+			last++;
+		}
+
+		if (isFeature(meshes, welded, &halfEdges[first], (unsigned int) (last - first), settings))
+		{
+			lines[halfEdges[first].mesh].push_back(halfEdges[first].a);
+			lines[halfEdges[first].mesh].push_back(halfEdges[first].b);
+		}
+
+		first = last;
+	}
+
+	return lines;
+}
+
+// - Mtodo privado: saber si una arista es caracterstica. Con una sola cara es una frontera y con
+//   ms de dos no es una variedad (tambin se trata como frontera); con dos caras es un cambio de
+//   material si las mallas tienen materiales distintos, una costura si las coordenadas de textura de
+//   algn extremo no coinciden y un pliegue si sus normales se separan ms que el umbral
+bool FeatureEdges::isFeature(const std::vector<FeatureEdgeMesh> &meshes, const std::vector<std::vector<unsigned int>> &welded,
+							 const FeatureHalfEdge *halfEdges, unsigned int count, const FeatureEdgeSettings &settings)
+{
+	if (count != 2)
+	{
+		return settings.boundaries;
+	}
+
+	const FeatureHalfEdge &first = halfEdges[0];
+	const FeatureHalfEdge &second = halfEdges[1];
+
+	if (settings.materialBoundaries && meshes[first.mesh].material != meshes[second.mesh].material)
+	{
+		return true;
+	}
+
+	if (settings.uvSeams)
+	{
+		// - Extremos de la segunda cara que corresponden a los de la primera (con orientacin
+		//   coherente, la arista est en sentido contrario)
+		bool reversed = welded[first.mesh][first.a] == welded[second.mesh][second.b];
+		unsigned int secondA = reversed ? second.b : second.a;
+		unsigned int secondB = reversed ? second.a : second.b;
+
+		const std::vector<glm::vec2> &firstTexCoords = *meshes[first.mesh].texCoords;
+		const std::vector<glm::vec2> &secondTexCoords = *meshes[second.mesh].texCoords;
+
+		if (first.a < firstTexCoords.size() && first.b < firstTexCoords.size() &&
+			secondA < secondTexCoords.size() && secondB < secondTexCoords.size())
+		{
+			glm::vec2 differenceA = glm::abs(firstTexCoords[first.a] - secondTexCoords[secondA]);
+			glm::vec2 differenceB = glm::abs(firstTexCoords[first.b] - secondTexCoords[secondB]);
+
+			if (std::max(differenceA.x, differenceA.y) > UV_SEAM_EPSILON ||
+				std::max(differenceB.x, differenceB.y) > UV_SEAM_EPSILON)
+			{
+				return true;
+			}
+		}
+	}
+
+	return isCrease(first.normal, second.normal, std::cos(glm::radians(settings.creaseAngle)));
+}
+
+// - Saber si dos caras forman un pliegue: sus normales se separan ms que el ngulo umbral
+bool FeatureEdges::isCrease(const glm::vec3 &normal0, const glm::vec3 &normal1, float cosCrease)
+{
+	float length0 = glm::length(normal0);
+	float length1 = glm::length(normal1);
+
+	if (length0 <= 0.f || length1 <= 0.f)
+	{
+		return false;
+	}
+
+	return glm::dot(normal0, normal1) / (length0 * length1) < cosCrease;
+}
+
+// - Asignar parmetros. El color, el grosor y la activacin slo afectan al dibujado; los tipos de
+//   arista y el ngulo cambian la versin para que los modelos vuelvan a extraer sus aristas
+void FeatureEdges::setSettings(const FeatureEdgeSettings &settings)
+{
+	if (settings.creaseAngle != FeatureEdges::settings.creaseAngle ||
+		settings.uvSeams != FeatureEdges::settings.uvSeams ||
+		settings.materialBoundaries != FeatureEdges::settings.materialBoundaries ||
+		settings.boundaries != FeatureEdges::settings.boundaries)
+	{
+		version++;
+	}
+
+	FeatureEdges::settings = settings;
+}
+
+// - Obtener parmetros
+const FeatureEdgeSettings& FeatureEdges::getSettings()
+{
+	return settings;
+}
+
+// - Obtener versin de los parmetros de la extraccin
+unsigned int FeatureEdges::getVersion()
+{
+	return version;
+}
+
+// - Registrar el inicio de una extraccin en segundo plano
+void FeatureEdges::beginJob()
+{
+	pendingJobs++;
+}
+
+// - Registrar el fin de una extraccin en segundo plano
+void FeatureEdges::endJob()
+{
+	if (pendingJobs > 0)
+	{
+		pendingJobs--;
+	}
+}
+
+// - Obtener nmero de extracciones en segundo plano pendientes
+unsigned int FeatureEdges::getPendingJobs()
+{
+	return pendingJobs;
+}
\ No newline at end of file
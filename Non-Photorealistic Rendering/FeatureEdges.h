@@ -0,0 +1,76 @@
+#pragma once
+
+#include <glm.hpp>
+#include <cstdint>
+#include <vector>
+
+#include "Structures.h"
+
+// - Malla de la que se extraen las aristas caractersticas: vrtices, coordenadas de textura,
+//   topologa y material (los vectores son los de la malla, que no cambian tras cargarla)
+struct FeatureEdgeMesh
+{
+	const std::vector<PosNorm> *vertices;
+	const std::vector<glm::vec2> *texCoords;
+	std::vector<unsigned int> topology;
+	unsigned int material;
+};
+
+// - Half-edge de un tringulo: clave de la arista (vrtices soldados, el menor primero), malla,
+//   vrtices en el sentido del tringulo y normal de su cara (sin normalizar)
+struct FeatureHalfEdge
+{
+	uint64_t key;
+	unsigned int mesh;
+	unsigned int a;
+	unsigned int b;
+	glm::vec3 normal;
+};
+
+// - Hash de una posicin (bits de sus coordenadas), para soldar los vrtices que comparten posicin.
+//   El cero negativo se cuenta como cero, ya que las posiciones se comparan con ==
+struct WeldHash
+{
+	size_t operator()(const glm::vec3 &position) const;
+};
+
+// - La clase FeatureEdges extrae las aristas caractersticas de un modelo, que no dependen de la
+//   vista: pliegues (caras con un ngulo diedro mayor que un umbral), costuras de coordenadas de
+//   textura, cambios de material entre mallas y fronteras. Los vrtices de todas las mallas del
+//   modelo se sueldan por su posicin y las caras que comparten cada arista se comparan una sola
+//   vez, al cargar el modelo o al cambiar los parmetros (en segundo plano); el resultado es un
+//   vector de ndices de GL_LINES por malla, que se dibuja sin geometry shader de siluetas. Los
+//   parmetros de la extraccin son los mismos para todos los modelos, con una versin que cambia
+//   cada vez que se modifican
+class FeatureEdges
+{
+private:
+	// - Parmetros, versin y extracciones en segundo plano pendientes (todos los modelos)
+	static FeatureEdgeSettings settings;
+	static unsigned int version;
+	static unsigned int pendingJobs;
+
+	// - Saber si las caras de una arista forman una arista caracterstica
+	static bool isFeature(const std::vector<FeatureEdgeMesh> &meshes, const std::vector<std::vector<unsigned int>> &welded,
+						  const FeatureHalfEdge *halfEdges, unsigned int count, const FeatureEdgeSettings &settings);
+
+public:
+	// - Extraer las aristas caractersticas de las mallas de un modelo: ndices (pares de vrtices)
+	//   de GL_LINES de cada malla. Cada arista se aade a una sola de las mallas que la comparten
+	static std::vector<std::vector<unsigned int>> extract(const std::vector<FeatureEdgeMesh> &meshes,
+														  const FeatureEdgeSettings &settings);
+
+	// - Saber si dos caras (normales sin normalizar) forman un pliegue, con el coseno del ngulo
+	//   umbral. Las caras degeneradas no tienen normal y no forman pliegues
+	static bool isCrease(const glm::vec3 &normal0, const glm::vec3 &normal1, float cosCrease);
+
+	// - Asignar parmetros (la versin slo cambia si cambian los tipos de arista o el ngulo)
+	static void setSettings(const FeatureEdgeSettings &settings);
+	static const FeatureEdgeSettings& getSettings();
+	static unsigned int getVersion();
+
+	// - Extracciones en segundo plano: registrar su inicio y fin, y nmero de pendientes
+	static void beginJob();
+	static void endJob();
+	static unsigned int getPendingJobs();
+};
\ No newline at end of file
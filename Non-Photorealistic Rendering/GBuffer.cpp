@@ -0,0 +1,173 @@
+#include "GBuffer.h"
+#include "RenderStatistics.h"
+#include "GLStateCache.h"
+
+// - Nombres de los samplers de los destinos y de la profundidad
+const char* GBuffer::TARGET_SAMPLERS[GBUFFER_NUM_TARGETS] =
+{
+	"GBufferAlbedo", "GBufferAmbient", "GBufferSpecular", "GBufferNormal", "GBufferParams", "GBufferHatching"
+};
+
+const char* GBuffer::DEPTH_SAMPLER = "GBufferDepth";
+
+// - Formato de cada destino: los colores en 8 bits y la normal y los parmetros de la tcnica en
+//   coma flotante de 16 bits
+static const GLint TARGET_FORMATS[GBUFFER_NUM_TARGETS] =
+{
+	GL_RGBA8, GL_RGBA8, GL_RGBA8, GL_RGBA16F, GL_RGBA16F, GL_RGBA8
+};
+
+// - Constructor
+GBuffer::GBuffer()
+{
+	fboHandle = 0;
+	depthTex = 0;
+	width = 0;
+	height = 0;
+	previousFrameBuffer = 0;
+
+	glGenFramebuffers(1, &fboHandle);
+	glGenTextures(GBUFFER_NUM_TARGETS, targets);
+	glGenTextures(1, &depthTex);
+}
+
+// - Destructor
+GBuffer::~GBuffer()
+{
+	GLStateCache *stateCache = GLStateCache::getInstance();
+
+	for (unsigned int i = 0; i < GBUFFER_NUM_TARGETS; i++)
+	{
+		stateCache->forgetTexture(targets[i]);
+	}
+
+	stateCache->forgetTexture(depthTex);
+
+	glDeleteFramebuffers(1, &fboHandle);
+	glDeleteTextures(GBUFFER_NUM_TARGETS, targets);
+	glDeleteTextures(1, &depthTex);
+}
+
+// - Crear las texturas y asociarlas al FBO. Se leen pxel a pxel (GL_NEAREST)
+void GBuffer::resize(unsigned int width, unsigned int height)
+{
+	this->width = width;
+	this->height = height;
+
+	GLStateCache *stateCache = GLStateCache::getInstance();
+	unsigned int unit = stateCache->getActiveUnit();
+
+	for (unsigned int i = 0; i <= GBUFFER_NUM_TARGETS; i++)
+	{
+		bool depth = (i == GBUFFER_NUM_TARGETS);
+		stateCache->bindTexture(GL_TEXTURE_2D, unit, depth ? depthTex : targets[i]);
+
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+		if (depth)
+		{
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT32F, width, height, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+		}
+		else
+		{
+			glTexImage2D(GL_TEXTURE_2D, 0, TARGET_FORMATS[i], width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+		}
+	}
+
+	stateCache->bindTexture(GL_TEXTURE_2D, unit, 0);
+
+	// - Asociar las texturas al FBO (un destino de dibujo por textura de color)
+	GLint frameBuffer = 0;
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &frameBuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, fboHandle);
+
+	GLenum drawBuffers[GBUFFER_NUM_TARGETS];
+
+	for (unsigned int i = 0; i < GBUFFER_NUM_TARGETS; i++)
+	{
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, GL_TEXTURE_2D, targets[i], 0);
+		drawBuffers[i] = GL_COLOR_ATTACHMENT0 + i;
+	}
+
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTex, 0);
+	glDrawBuffers(GBUFFER_NUM_TARGETS, drawBuffers);
+
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cout << "ERROR al crear G-buffer" << std::endl;
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, frameBuffer);
+}
+
+// - Enlazar el G-buffer y limpiarlo. Se limpia cada destino a cero (el alfa del albedo a cero
+//   indica que el pxel no tiene geometra) sin depender del color de fondo
+void GBuffer::bindFrameBuffer()
+{
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFrameBuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, fboHandle);
+	RENDER_STATS_FRAMEBUFFER(fboHandle);
+
+	const GLfloat zero[4] = { 0.f, 0.f, 0.f, 0.f };
+	const GLfloat one = 1.f;
+
+	for (unsigned int i = 0; i < GBUFFER_NUM_TARGETS; i++)
+	{
+		glClearBufferfv(GL_COLOR, i, zero);
+	}
+
+	glClearBufferfv(GL_DEPTH, 0, &one);
+}
+
+// - Volver al frame buffer enlazado antes
+void GBuffer::unbindFrameBuffer()
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, previousFrameBuffer);
+	RENDER_STATS_FRAMEBUFFER(previousFrameBuffer);
+}
+
+// - Enlazar las texturas (destinos y profundidad, en unidades consecutivas). Cada permutacin del
+//   shader de iluminacin usa slo algunas, as que slo se asignan los samplers que existen
+void GBuffer::bindTextures(ShaderProgram &shader, unsigned int firstUnit)
+{
+	GLStateCache *stateCache = GLStateCache::getInstance();
+
+	for (unsigned int i = 0; i <= GBUFFER_NUM_TARGETS; i++)
+	{
+		bool depth = (i == GBUFFER_NUM_TARGETS);
+		const char *sampler = depth ? DEPTH_SAMPLER : TARGET_SAMPLERS[i];
+
+		if (shader.hasUniform(sampler))
+		{
+			stateCache->bindTexture(GL_TEXTURE_2D, firstUnit + i, depth ? depthTex : targets[i]);
+			shader.setUniform(sampler, (GLint) (firstUnit + i));
+		}
+	}
+}
+
+// - Obtener textura de un destino
+GLuint GBuffer::getTexture(GBufferTarget target)
+{
+	return targets[target];
+}
+
+// - Obtener textura de profundidad
+GLuint GBuffer::getDepthTexture()
+{
+	return depthTex;
+}
+
+// - Obtener ancho
+unsigned int GBuffer::getWidth()
+{
+	return width;
+}
+
+// - Obtener alto
+unsigned int GBuffer::getHeight()
+{
+	return height;
+}
\ No newline at end of file
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <iostream>
+
+#include "Enumerations.h"
+#include "ShaderProgram.h"
+
+// - La clase GBuffer es el FBO del sombreado diferido: la pasada de geometra escribe en varios
+//   destinos a la vez (MRT, ver GBufferTarget) los datos de cada pxel visible, y la profundidad en
+//   una textura. Las pasadas de iluminacin leen esas texturas con un quad a pantalla completa, as
+//   que la escena se rasteriza una vez por frame sea cual sea el nmero de fuentes luminosas
+class GBuffer
+{
+private:
+	GLuint fboHandle;
+
+	// - Texturas de los destinos de color y de profundidad
+	GLuint targets[GBUFFER_NUM_TARGETS];
+	GLuint depthTex;
+
+	// - Dimensiones
+	unsigned int width;
+	unsigned int height;
+
+	// - Frame buffer enlazado antes del G-buffer (la pantalla o el FBO del post-procesamiento), al que
+	//   se vuelve al desenlazarlo
+	GLint previousFrameBuffer;
+
+public:
+	// - Nombres de los samplers de los destinos y de la profundidad en los shaders
+	static const char* TARGET_SAMPLERS[GBUFFER_NUM_TARGETS];
+	static const char* DEPTH_SAMPLER;
+
+	// - Constructor
+	GBuffer();
+
+	// - Destructor
+	~GBuffer();
+
+	// - Crear (o redimensionar) las texturas y asociarlas al FBO
+	void resize(unsigned int width, unsigned int height);
+
+	// - Enlazar el G-buffer y limpiarlo (color a cero y profundidad a uno)
+	void bindFrameBuffer();
+
+	// - Volver al frame buffer enlazado antes
+	void unbindFrameBuffer();
+
+	// - Enlazar las texturas a partir de una unidad de textura y asignar los samplers que use el shader
+	void bindTextures(ShaderProgram &shader, unsigned int firstUnit);
+
+	// - Texturas de un destino y de la profundidad (otras pasadas que las leen, como el contorno en
+	//   espacio de pantalla)
+	GLuint getTexture(GBufferTarget target);
+	GLuint getDepthTexture();
+
+	// - Dimensiones
+	unsigned int getWidth();
+	unsigned int getHeight();
+};
\ No newline at end of file
@@ -0,0 +1,200 @@
+#include "GLStateCache.h"
+#include "RenderStatistics.h"
+
+// - Singleton (inicializacin perezosa)
+GLStateCache* GLStateCache::instance = nullptr;
+
+// - Constructor
+GLStateCache::GLStateCache()
+{
+	textures2D.resize(NUM_TEXTURE_UNITS);
+	texturesCubemap.resize(NUM_TEXTURE_UNITS);
+
+	invalidate();
+}
+
+// - Acceder al singleton
+GLStateCache* GLStateCache::getInstance()
+{
+	if (instance == nullptr)
+	{
+		instance = new GLStateCache();
+	}
+
+	return instance;
+}
+
+// - Inicio de frame: los contadores del frame en curso pasan a ser los del ltimo frame
+void GLStateCache::beginFrame()
+{
+	lastFrame = currentFrame;
+	currentFrame.reset();
+
+	invalidate();
+}
+
+// - Olvidar el estado guardado
+void GLStateCache::invalidate()
+{
+	program = UNKNOWN;
+	vertexArray = UNKNOWN;
+	activeUnit = UNKNOWN;
+	blendSource = UNKNOWN;
+	blendDestination = UNKNOWN;
+
+	for (unsigned int i = 0; i < NUM_TEXTURE_UNITS; i++)
+	{
+		textures2D[i] = UNKNOWN;
+		texturesCubemap[i] = UNKNOWN;
+	}
+}
+
+// - Activar una unidad de textura (no se cuenta como cambio de estado: slo acompaa al enlace de
+//   las texturas)
+void GLStateCache::activeTexture(unsigned int unit)
+{
+	if (unit < NUM_TEXTURE_UNITS && unit != activeUnit)
+	{
+		glActiveTexture(GL_TEXTURE0 + unit);
+		activeUnit = unit;
+	}
+}
+
+// - Activar un shader program
+bool GLStateCache::useProgram(GLuint program)
+{
+	if (program == this->program)
+	{
+		currentFrame.skippedPrograms++;
+		return false;
+	}
+
+	glUseProgram(program);
+	RENDER_STATS_PROGRAM(program);
+
+	this->program = program;
+	currentFrame.programs++;
+
+	return true;
+}
+
+// - Enlazar una textura en una unidad
+bool GLStateCache::bindTexture(GLenum target, unsigned int unit, GLuint texture)
+{
+	if (unit >= NUM_TEXTURE_UNITS)
+	{
+		return false;
+	}
+
+	GLuint *bound = nullptr;
+
+	if (target == GL_TEXTURE_2D)
+	{
+		bound = &textures2D[unit];
+	}
+	else if (target == GL_TEXTURE_CUBE_MAP)
+	{
+		bound = &texturesCubemap[unit];
+	}
+
+	if (bound != nullptr && *bound == texture)
+	{
+		currentFrame.skippedTextures++;
+		return false;
+	}
+
+	activeTexture(unit);
+	glBindTexture(target, texture);
+	RENDER_STATS_TEXTURE(target, unit, texture);
+
+	if (bound != nullptr)
+	{
+		*bound = texture;
+	}
+
+	currentFrame.textures++;
+
+	return true;
+}
+
+// - Activar un VAO
+bool GLStateCache::bindVertexArray(GLuint vertexArray)
+{
+	if (vertexArray == this->vertexArray)
+	{
+		currentFrame.skippedVertexArrays++;
+		return false;
+	}
+
+	glBindVertexArray(vertexArray);
+
+	this->vertexArray = vertexArray;
+	currentFrame.vertexArrays++;
+
+	return true;
+}
+
+// - Asignar la funcin de blending
+bool GLStateCache::blendFunc(GLenum source, GLenum destination)
+{
+	if (source == blendSource && destination == blendDestination)
+	{
+		currentFrame.skippedBlendFuncs++;
+		return false;
+	}
+
+	glBlendFunc(source, destination);
+
+	blendSource = source;
+	blendDestination = destination;
+	currentFrame.blendFuncs++;
+
+	return true;
+}
+
+// - Obtener unidad de textura activa (0 si no se conoce: la unidad se vuelve a activar al enlazar)
+unsigned int GLStateCache::getActiveUnit()
+{
+	return activeUnit == UNKNOWN ? 0 : activeUnit;
+}
+
+// - Olvidar un shader program borrado
+void GLStateCache::forgetProgram(GLuint program)
+{
+	if (program == this->program)
+	{
+		this->program = UNKNOWN;
+	}
+}
+
+// - Olvidar una textura borrada en todas las unidades
+void GLStateCache::forgetTexture(GLuint texture)
+{
+	for (unsigned int i = 0; i < NUM_TEXTURE_UNITS; i++)
+	{
+		if (textures2D[i] == texture)
+		{
+			textures2D[i] = UNKNOWN;
+		}
+
+		if (texturesCubemap[i] == texture)
+		{
+			texturesCubemap[i] = UNKNOWN;
+		}
+	}
+}
+
+// - Olvidar un VAO borrado
+void GLStateCache::forgetVertexArray(GLuint vertexArray)
+{
+	if (vertexArray == this->vertexArray)
+	{
+		this->vertexArray = UNKNOWN;
+	}
+}
+
+// - Obtener contadores del ltimo frame completado
+const StateCacheCounters& GLStateCache::getLastFrame()
+{
+	return lastFrame;
+}
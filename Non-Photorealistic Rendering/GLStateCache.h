@@ -0,0 +1,111 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <vector>
+
+// - Cambios de estado de OpenGL de un frame: enviados al driver y evitados por ser redundantes
+struct StateCacheCounters
+{
+	unsigned int programs;
+	unsigned int skippedPrograms;
+	unsigned int textures;
+	unsigned int skippedTextures;
+	unsigned int vertexArrays;
+	unsigned int skippedVertexArrays;
+	unsigned int blendFuncs;
+	unsigned int skippedBlendFuncs;
+
+	// - Constructor por defecto
+	StateCacheCounters()
+	{
+		reset();
+	}
+
+	// - Poner a cero los contadores
+	void reset()
+	{
+		this->programs = 0;
+		this->skippedPrograms = 0;
+		this->textures = 0;
+		this->skippedTextures = 0;
+		this->vertexArrays = 0;
+		this->skippedVertexArrays = 0;
+		this->blendFuncs = 0;
+		this->skippedBlendFuncs = 0;
+	}
+
+	// - Total de cambios enviados
+	unsigned int getIssued() const
+	{
+		return programs + textures + vertexArrays + blendFuncs;
+	}
+
+	// - Total de cambios evitados
+	unsigned int getSkipped() const
+	{
+		return skippedPrograms + skippedTextures + skippedVertexArrays + skippedBlendFuncs;
+	}
+};
+
+// - La clase GLStateCache guarda el estado de OpenGL que se enlaza al dibujar (shader program, texturas
+//   por unidad, VAO y funcin de blending) y slo llama a OpenGL si el valor cambia. Todas las clases
+//   que enlazan ese estado (ShaderProgram, Texture, Cubemap, FBO, VAO, GeometryStore, Renderer) pasan
+//   por ella; el cdigo que lo cambia por su cuenta (ImGui restaura el suyo) debe invalidarla. Se
+//   implementa como un singleton para que pueda usarse desde las clases de bajo nivel
+class GLStateCache
+{
+private:
+	// - Singleton
+	static GLStateCache* instance;
+
+	// - Constructor privado (singleton)
+	GLStateCache();
+
+	// - Estado enlazado (UNKNOWN si no se conoce). Las texturas se guardan por unidad y destino (2D y
+	//   cubemap); los dems destinos se enlazan siempre
+	GLuint program;
+	GLuint vertexArray;
+	unsigned int activeUnit;
+	std::vector<GLuint> textures2D;
+	std::vector<GLuint> texturesCubemap;
+	GLenum blendSource;
+	GLenum blendDestination;
+
+	// - Contadores del frame en curso y del ltimo frame completado
+	StateCacheCounters currentFrame;
+	StateCacheCounters lastFrame;
+
+public:
+	// - Nmero de unidades de textura que se guardan
+	static const unsigned int NUM_TEXTURE_UNITS = 48;
+
+	// - Valor de estado desconocido
+	static const GLuint UNKNOWN = 0xFFFFFFFF;
+
+	// - Acceder al singleton
+	static GLStateCache* getInstance();
+
+	// - Inicio de frame (invalida el estado, que puede haber cambiado fuera de la cach)
+	void beginFrame();
+
+	// - Olvidar el estado guardado (la siguiente orden de cada tipo se enva siempre)
+	void invalidate();
+
+	// - Cambios de estado. Devuelven true si se ha llamado a OpenGL
+	bool useProgram(GLuint program);
+	bool bindTexture(GLenum target, unsigned int unit, GLuint texture);
+	bool bindVertexArray(GLuint vertexArray);
+	bool blendFunc(GLenum source, GLenum destination);
+
+	// - Unidad de textura activa
+	void activeTexture(unsigned int unit);
+	unsigned int getActiveUnit();
+
+	// - Objetos borrados: si estn enlazados, OpenGL los desenlaza y su nombre puede reutilizarse
+	void forgetProgram(GLuint program);
+	void forgetTexture(GLuint texture);
+	void forgetVertexArray(GLuint vertexArray);
+
+	// - Contadores del ltimo frame completado
+	const StateCacheCounters& getLastFrame();
+};
@@ -0,0 +1,327 @@
+#include "GeometryStore.h"
+#include "RenderStatistics.h"
+#include "GLStateCache.h"
+
+// - Singleton (inicializacin perezosa)
+GeometryStore* GeometryStore::instance = nullptr;
+
+// - Constructor
+GeometryStore::GeometryStore()
+{
+	vao = 0;
+	glGenVertexArrays(1, &vao);
+	glGenBuffers(2, vbo);
+	glGenBuffers(1, &ibo);
+	glGenBuffers(1, &indirectBuffer);
+
+	dirty = false;
+	removed = false;
+	enabled = true;
+
+	// - El dibujado indirecto necesita OpenGL 4.3 o la extensin (el contexto es 4.1)
+	indirect = GLEW_ARB_multi_draw_indirect && GLEW_ARB_draw_indirect;
+}
+
+// - Destructor
+GeometryStore::~GeometryStore()
+{
+	GLStateCache::getInstance()->forgetVertexArray(vao);
+	glDeleteVertexArrays(1, &vao);
+	glDeleteBuffers(2, vbo);
+	glDeleteBuffers(1, &ibo);
+	glDeleteBuffers(1, &indirectBuffer);
+}
+
+// - Acceder al singleton
+GeometryStore* GeometryStore::getInstance()
+{
+	if (instance == nullptr)
+	{
+		instance = new GeometryStore();
+	}
+
+	return instance;
+}
+
+// - Aadir los vrtices de una malla
+int GeometryStore::addVertices(const std::vector<PosNorm> &vertices, const std::vector<glm::vec2> &texCoords)
+{
+	int baseVertex = (int) this->vertices.size();
+
+	this->vertices.insert(this->vertices.end(), vertices.begin(), vertices.end());
+	this->texCoords.insert(this->texCoords.end(), texCoords.begin(), texCoords.end());
+	this->texCoords.resize(this->vertices.size(), glm::vec2(0.f));
+
+	dirty = true;
+
+	return baseVertex;
+}
+
+// - Aadir ndices
+IndexRange GeometryStore::addIndices(const std::vector<GLuint> &indices)
+{
+	IndexRange range((unsigned int) this->indices.size(), (unsigned int) indices.size());
+
+	this->indices.insert(this->indices.end(), indices.begin(), indices.end());
+
+	dirty = true;
+
+	return range;
+}
+
+// - Registrar la geometra de una malla
+unsigned int GeometryStore::addGeometry(const GeometryRange &range, unsigned int numVertices)
+{
+	GeometryEntry entry;
+	entry.range = range;
+	entry.numVertices = numVertices;
+	entry.alive = true;
+
+	if (!freeHandles.empty())
+	{
+		unsigned int handle = freeHandles.back();
+		freeHandles.pop_back();
+		entries[handle] = entry;
+
+		return handle;
+	}
+
+	entries.push_back(entry);
+
+	return (unsigned int) entries.size() - 1;
+}
+
+// - Obtener la geometra actual de una malla
+const GeometryRange& GeometryStore::getGeometry(unsigned int handle)
+{
+	return entries[handle].range;
+}
+
+// - Eliminar la geometra de una malla. Sus datos se descartan al compactar, al empezar el siguiente lote
+void GeometryStore::remove(unsigned int handle)
+{
+	if (handle == NO_GEOMETRY || !entries[handle].alive)
+	{
+		return;
+	}
+
+	entries[handle].alive = false;
+	entries[handle].range = GeometryRange();
+	freeHandles.push_back(handle);
+
+	removed = true;
+	dirty = true;
+}
+
+// - Activar el dibujado por lotes
+void GeometryStore::setEnabled(bool enabled)
+{
+	this->enabled = enabled;
+}
+
+// - Saber si el dibujado por lotes est activado
+bool GeometryStore::isEnabled()
+{
+	return enabled;
+}
+
+// - Saber si los lotes se dibujan con comandos indirectos
+bool GeometryStore::isIndirect()
+{
+	return indirect;
+}
+
+// - Obtener VAO del almacn
+GLuint GeometryStore::getVertexArray()
+{
+	return vao;
+}
+
+// - Memoria ocupada por los datos del almacn
+size_t GeometryStore::getMemory()
+{
+	return sizeof(PosNorm) * vertices.size() + sizeof(glm::vec2) * texCoords.size() + sizeof(GLuint) * indices.size();
+}
+
+// - Memoria ocupada por los datos de una malla (vrtices y rangos de ndices de todos sus niveles de
+//   detalle)
+size_t GeometryStore::getGeometryMemory(unsigned int handle)
+{
+	if (handle == NO_GEOMETRY || !entries[handle].alive)
+	{
+		return 0;
+	}
+
+	const GeometryEntry &entry = entries[handle];
+	size_t bytes = (sizeof(PosNorm) + sizeof(glm::vec2)) * entry.numVertices;
+
+	for (unsigned int i = 0; i < entry.range.topology.size(); i++)
+	{
+		bytes += sizeof(GLuint) * (entry.range.topology[i].count + entry.range.adjacencyIndices[i].count);
+	}
+
+	return bytes;
+}
+
+// - Mtodo privado: compactar las copias en CPU. Los ndices son relativos al vrtice base de cada
+//   malla, as que se copian sin cambios y solo se actualizan los rangos de las entradas
+void GeometryStore::compact()
+{
+	std::vector<PosNorm> compactedVertices;
+	std::vector<glm::vec2> compactedTexCoords;
+	std::vector<GLuint> compactedIndices;
+
+	for (unsigned int i = 0; i < entries.size(); i++)
+	{
+		if (!entries[i].alive)
+		{
+			continue;
+		}
+
+		GeometryRange &range = entries[i].range;
+		int baseVertex = (int) compactedVertices.size();
+
+		compactedVertices.insert(compactedVertices.end(), vertices.begin() + range.baseVertex,
+								 vertices.begin() + range.baseVertex + entries[i].numVertices);
+		compactedTexCoords.insert(compactedTexCoords.end(), texCoords.begin() + range.baseVertex,
+								  texCoords.begin() + range.baseVertex + entries[i].numVertices);
+		range.baseVertex = baseVertex;
+
+		std::vector<IndexRange>* lists[2] = { &range.topology, &range.adjacencyIndices };
+
+		for (unsigned int j = 0; j < 2; j++)
+		{
+			for (unsigned int k = 0; k < lists[j]->size(); k++)
+			{
+				IndexRange &indexRange = (*lists[j])[k];
+				unsigned int firstIndex = (unsigned int) compactedIndices.size();
+
+				compactedIndices.insert(compactedIndices.end(), indices.begin() + indexRange.firstIndex,
+										indices.begin() + indexRange.firstIndex + indexRange.count);
+				indexRange.firstIndex = firstIndex;
+			}
+		}
+	}
+
+	vertices.swap(compactedVertices);
+	texCoords.swap(compactedTexCoords);
+	indices.swap(compactedIndices);
+
+	removed = false;
+}
+
+// - Mtodo privado: subir los datos a la GPU. Los atributos siguen el formato de VAO::fillVBO
+//   (posicin y normal entrelazadas en las posiciones 0 y 1, coordenadas de textura en la 2)
+void GeometryStore::upload()
+{
+	if (!dirty)
+	{
+		return;
+	}
+
+	GLStateCache::getInstance()->bindVertexArray(vao);
+
+	glBindBuffer(GL_ARRAY_BUFFER, vbo[0]);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(PosNorm), ((GLubyte *) NULL + (0)));
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(PosNorm), ((GLubyte *) NULL + sizeof(glm::vec3)));
+	glBufferData(GL_ARRAY_BUFFER, sizeof(PosNorm) * vertices.size(), vertices.data(), GL_STATIC_DRAW);
+	RENDER_STATS_UPLOAD(vbo[0], vertices.data(), sizeof(PosNorm) * vertices.size());
+
+	glBindBuffer(GL_ARRAY_BUFFER, vbo[1]);
+	glEnableVertexAttribArray(2);
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), ((GLubyte *) NULL + (0)));
+	glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec2) * texCoords.size(), texCoords.data(), GL_STATIC_DRAW);
+	RENDER_STATS_UPLOAD(vbo[1], texCoords.data(), sizeof(glm::vec2) * texCoords.size());
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * indices.size(), indices.data(), GL_STATIC_DRAW);
+	RENDER_STATS_UPLOAD(ibo, indices.data(), sizeof(GLuint) * indices.size());
+
+	dirty = false;
+}
+
+// - Empezar un lote. La compactacin se hace aqu, antes de leer los rangos de las mallas del lote
+void GeometryStore::beginBatch()
+{
+	if (removed)
+	{
+		compact();
+	}
+
+	commands.clear();
+	counts.clear();
+	offsets.clear();
+	baseVertices.clear();
+}
+
+// - Aadir el rango de ndices de una malla al lote
+void GeometryStore::addDraw(const IndexRange &range, int baseVertex)
+{
+	if (range.count == 0)
+	{
+		return;
+	}
+
+	if (indirect)
+	{
+		DrawElementsIndirectCommand command;
+		command.count = range.count;
+		command.instanceCount = 1;
+		command.firstIndex = range.firstIndex;
+		command.baseVertex = baseVertex;
+		command.baseInstance = 0;
+
+		commands.push_back(command);
+	}
+	else
+	{
+		counts.push_back((GLsizei) range.count);
+		offsets.push_back((GLubyte *) NULL + sizeof(GLuint) * range.firstIndex);
+		baseVertices.push_back(baseVertex);
+	}
+}
+
+// - Dibujar el lote con una sola llamada
+void GeometryStore::drawBatch(GLenum mode)
+{
+	GLsizei numDraws = (GLsizei) (indirect ? commands.size() : counts.size());
+
+	if (numDraws == 0)
+	{
+		return;
+	}
+
+	upload();
+	GLStateCache::getInstance()->bindVertexArray(vao);
+
+	GLsizei numIndices = 0;
+
+	if (indirect)
+	{
+		for (unsigned int i = 0; i < commands.size(); i++)
+		{
+			numIndices += commands[i].count;
+		}
+
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(DrawElementsIndirectCommand) * commands.size(),
+					 commands.data(), GL_STREAM_DRAW);
+		RENDER_STATS_UPLOAD(indirectBuffer, commands.data(), sizeof(DrawElementsIndirectCommand) * commands.size());
+
+		glMultiDrawElementsIndirect(mode, GL_UNSIGNED_INT, NULL, numDraws, 0);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	}
+	else
+	{
+		for (unsigned int i = 0; i < counts.size(); i++)
+		{
+			numIndices += counts[i];
+		}
+
+		glMultiDrawElementsBaseVertex(mode, counts.data(), GL_UNSIGNED_INT, offsets.data(), numDraws, baseVertices.data());
+	}
+
+	RENDER_STATS_DRAW(mode, numIndices);
+}
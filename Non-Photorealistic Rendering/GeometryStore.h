@@ -0,0 +1,156 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm.hpp>
+#include <vector>
+
+#include "Structures.h"
+
+// - Rango de ndices dentro del IBO compartido
+struct IndexRange
+{
+	unsigned int firstIndex;
+	unsigned int count;
+
+	IndexRange()
+	{
+		this->firstIndex = 0;
+		this->count = 0;
+	}
+
+	IndexRange(unsigned int firstIndex, unsigned int count)
+	{
+		this->firstIndex = firstIndex;
+		this->count = count;
+	}
+};
+
+// - Geometra de una malla dentro del almacn: vrtice base y rangos de ndices de cada nivel de
+//   detalle (topologa y adyacencias)
+struct GeometryRange
+{
+	int baseVertex;
+	std::vector<IndexRange> topology;
+	std::vector<IndexRange> adjacencyIndices;
+
+	GeometryRange()
+	{
+		this->baseVertex = -1;
+	}
+
+	bool isValid() const
+	{
+		return baseVertex >= 0;
+	}
+};
+
+// - Entrada del almacn: geometra de una malla, nmero de vrtices y si sigue en uso (las mallas
+//   guardan el ndice de su entrada, ya que la compactacin mueve sus rangos)
+struct GeometryEntry
+{
+	GeometryRange range;
+	unsigned int numVertices;
+	bool alive;
+};
+
+// - Comando de dibujado indirecto (formato de GL_DRAW_INDIRECT_BUFFER)
+struct DrawElementsIndirectCommand
+{
+	GLuint count;
+	GLuint instanceCount;
+	GLuint firstIndex;
+	GLint baseVertex;
+	GLuint baseInstance;
+};
+
+// - La clase GeometryStore guarda los vrtices e ndices de todas las mallas de la escena en un nico
+//   VAO (VBOs e IBO compartidos), de forma que las mallas de un modelo que comparten texturas se
+//   dibujan con una sola llamada multi-draw en lugar de enlazar un VAO y subir un IBO por malla.
+//   Si el driver ofrece ARB_multi_draw_indirect, los comandos de cada lote se escriben en un buffer
+//   de dibujado indirecto (glMultiDrawElementsIndirect); si no, se usa glMultiDrawElementsBaseVertex
+//   (OpenGL 3.2), que acepta los mismos rangos. Se implementa como un singleton para que lo usen
+//   Mesh, Model y Renderer
+class GeometryStore
+{
+private:
+	// - Singleton
+	static GeometryStore* instance;
+
+	// - Constructor privado (singleton)
+	GeometryStore();
+
+	// - VAO, VBOs (posiciones y normales, coordenadas de textura), IBO y buffer de comandos indirectos
+	GLuint vao;
+	GLuint vbo[2];
+	GLuint ibo;
+	GLuint indirectBuffer;
+
+	// - Copia en CPU de los datos, que se suben a la GPU al dibujar el primer lote tras aadir mallas
+	std::vector<PosNorm> vertices;
+	std::vector<glm::vec2> texCoords;
+	std::vector<GLuint> indices;
+	bool dirty;
+
+	// - Entradas de las mallas (huecos reutilizables de la tabla de handles) y si hay entradas
+	//   eliminadas cuyos datos siguen en las copias
+	std::vector<GeometryEntry> entries;
+	std::vector<unsigned int> freeHandles;
+	bool removed;
+
+	// - Dibujado por lotes activado y disponibilidad del dibujado indirecto
+	bool enabled;
+	bool indirect;
+
+	// - Lote en construccin
+	std::vector<DrawElementsIndirectCommand> commands;
+	std::vector<GLsizei> counts;
+	std::vector<void*> offsets;
+	std::vector<GLint> baseVertices;
+
+	// - Copiar seguidos los datos de las entradas vivas, descartando los de las eliminadas
+	void compact();
+
+	// - Subir los datos a la GPU si han cambiado
+	void upload();
+
+public:
+	// - Acceder al singleton
+	static GeometryStore* getInstance();
+
+	// - Destructor
+	~GeometryStore();
+
+	// - Aadir los vrtices de una malla (las coordenadas de textura que falten se rellenan con 0).
+	//   Devuelve el vrtice base
+	int addVertices(const std::vector<PosNorm> &vertices, const std::vector<glm::vec2> &texCoords);
+
+	// - Aadir ndices (relativos al vrtice base de la malla). Devuelve su rango
+	IndexRange addIndices(const std::vector<GLuint> &indices);
+
+	// - Registrar la geometra de una malla (vrtices e ndices ya aadidos). Devuelve su handle
+	unsigned int addGeometry(const GeometryRange &range, unsigned int numVertices);
+
+	// - Geometra actual de una malla y eliminacin de sus datos (al descargar su escena)
+	const GeometryRange& getGeometry(unsigned int handle);
+	void remove(unsigned int handle);
+
+	// - Handle nulo (malla fuera del almacn)
+	static const unsigned int NO_GEOMETRY = 0xFFFFFFFF;
+
+	// - Activar el dibujado por lotes
+	void setEnabled(bool enabled);
+	bool isEnabled();
+	bool isIndirect();
+
+	// - VAO del almacn (compartido por todas las mallas)
+	GLuint getVertexArray();
+
+	// - Memoria ocupada por los datos del almacn y por los de una malla
+	size_t getMemory();
+	size_t getGeometryMemory(unsigned int handle);
+
+	// - Construccin y dibujado de un lote: rangos de ndices de varias mallas con el mismo modo
+	void beginBatch();
+	void addDraw(const IndexRange &range, int baseVertex);
+	void drawBatch(GLenum mode);
+};
@@ -42,12 +42,88 @@ int Group3D::getNumElements()
 	return elements.size();
 }
 
+// - Frustum culling: visibilidad de los elementos del grupo. El grupo es visible si lo es alguno de ellos
+void Group3D::updateVisibility(const Frustum &frustum, glm::mat4 mModel, CullingStatistics &statistics)
+{
+	visible = false;
+	outlineVisible = false;
+
+	for (unsigned int i = 0; i < elements.size(); i++)
+	{
+		elements[i]->updateVisibility(frustum, mModel * elements[i]->getModelMatrix(), statistics);
+
+		visible = visible || elements[i]->isVisible();
+		outlineVisible = outlineVisible || elements[i]->isOutlineVisible();
+	}
+}
+
+// - Recalcular la visibilidad del grupo a partir de la de sus elementos
+void Group3D::aggregateVisibility()
+{
+	visible = false;
+	outlineVisible = false;
+
+	for (unsigned int i = 0; i < elements.size(); i++)
+	{
+		elements[i]->aggregateVisibility();
+
+		visible = visible || elements[i]->isVisible();
+		outlineVisible = outlineVisible || elements[i]->isOutlineVisible();
+	}
+}
+
+// - Un grupo se dibuja con cualquier variante del shader (cada elemento filtra la suya)
+bool Group3D::acceptsShader(ShaderProgram & /*shader*/)
+{
+	return true;
+}
+
+// - BVH: primitivas de todos los elementos del grupo. Los elementos de primer nivel de la escena
+//   (sceneElement < 0) se identifican por su posicin en el grupo
+void Group3D::collectPrimitives(glm::mat4 mModel, int sceneElement, std::vector<BVHPrimitive> &primitives)
+{
+	for (unsigned int i = 0; i < elements.size(); i++)
+	{
+		elements[i]->collectPrimitives(mModel * elements[i]->getModelMatrix(), sceneElement < 0 ? (int) i : sceneElement, primitives);
+	}
+}
+
+// - Sumar la memoria de los elementos del grupo
+void Group3D::addMemoryUsage(MemoryUsage &usage)
+{
+	for (unsigned int i = 0; i < elements.size(); i++)
+	{
+		elements[i]->addMemoryUsage(usage);
+	}
+}
+
+// - Liberar las imgenes decodificadas de las texturas de los elementos del grupo
+void Group3D::releaseTextureImages()
+{
+	for (unsigned int i = 0; i < elements.size(); i++)
+	{
+		elements[i]->releaseTextureImages();
+	}
+}
+
 // - Dibujado del grupo 3D de forma realista
 void Group3D::drawRealistic(ShaderProgram &shader, glm::mat4 mModel,
 							glm::mat4 mView, glm::mat4 mProjection)
 {
 	for (int i = 0; i < elements.size(); i++)
 	{
+		// - Frustum culling
+		if (!elements[i]->isVisible())
+		{
+			continue;
+		}
+
+		// - Variante del shader (instanciada o no) con la que se dibuja el elemento
+		if (!elements[i]->acceptsShader(shader))
+		{
+			continue;
+		}
+
 		// - Dibujar elemento
 		elements[i]->drawRealistic(shader, mModel * elements[i]->getModelMatrix(), mView, mProjection);
 	}
@@ -59,6 +135,18 @@ void Group3D::drawMonochrome(ShaderProgram &shader, glm::mat4 mModel,
 {
 	for (int i = 0; i < elements.size(); i++)
 	{
+		// - Frustum culling
+		if (!elements[i]->isVisible())
+		{
+			continue;
+		}
+
+		// - Variante del shader (instanciada o no) con la que se dibuja el elemento
+		if (!elements[i]->acceptsShader(shader))
+		{
+			continue;
+		}
+
 		// - Dibujar elemento
 		elements[i]->drawMonochrome(shader, mModel * elements[i]->getModelMatrix(), mView, mProjection);
 	}
@@ -70,6 +158,18 @@ void Group3D::drawCelShading(ShaderProgram &shader, glm::mat4 mModel,
 {
 	for (int i = 0; i < elements.size(); i++)
 	{
+		// - Frustum culling
+		if (!elements[i]->isVisible())
+		{
+			continue;
+		}
+
+		// - Variante del shader (instanciada o no) con la que se dibuja el elemento
+		if (!elements[i]->acceptsShader(shader))
+		{
+			continue;
+		}
+
 		// - Dibujar elemento
 		elements[i]->drawCelShading(shader, mModel * elements[i]->getModelMatrix(), mView, mProjection);
 	}
@@ -81,6 +181,18 @@ void Group3D::drawHatching(ShaderProgram &shader, glm::mat4 mModel,
 {
 	for (int i = 0; i < elements.size(); i++)
 	{
+		// - Frustum culling
+		if (!elements[i]->isVisible())
+		{
+			continue;
+		}
+
+		// - Variante del shader (instanciada o no) con la que se dibuja el elemento
+		if (!elements[i]->acceptsShader(shader))
+		{
+			continue;
+		}
+
 		// - Dibujar elemento
 		elements[i]->drawHatching(shader, mModel * elements[i]->getModelMatrix(), mView, mProjection);
 	}
@@ -92,17 +204,87 @@ void Group3D::drawGoochShading(ShaderProgram &shader, glm::mat4 mModel,
 {
 	for (int i = 0; i < elements.size(); i++)
 	{
+		// - Frustum culling
+		if (!elements[i]->isVisible())
+		{
+			continue;
+		}
+
+		// - Variante del shader (instanciada o no) con la que se dibuja el elemento
+		if (!elements[i]->acceptsShader(shader))
+		{
+			continue;
+		}
+
 		// - Dibujar elemento
 		elements[i]->drawGoochShading(shader, mModel * elements[i]->getModelMatrix(), mView, mProjection);
 	}
 }
 
+// - Dibujado de la profundidad del grupo 3D (pre-pasada de profundidad)
+void Group3D::drawDepth(ShaderProgram &shader, glm::mat4 mModel,
+						glm::mat4 mView, glm::mat4 mProjection)
+{
+	for (unsigned int i = 0; i < elements.size(); i++)
+	{
+		// - Frustum culling
+		if (!elements[i]->isVisible())
+		{
+			continue;
+		}
+
+		// - Variante del shader (instanciada o no) con la que se dibuja el elemento
+		if (!elements[i]->acceptsShader(shader))
+		{
+			continue;
+		}
+
+		// - Dibujar elemento
+		elements[i]->drawDepth(shader, mModel * elements[i]->getModelMatrix(), mView, mProjection);
+	}
+}
+
+// - Dibujado de la normal y la profundidad del grupo 3D (pre-pasada del contorno en espacio de pantalla)
+void Group3D::drawNormals(ShaderProgram &shader, glm::mat4 mModel,
+						  glm::mat4 mView, glm::mat4 mProjection)
+{
+	for (unsigned int i = 0; i < elements.size(); i++)
+	{
+		// - Frustum culling
+		if (!elements[i]->isVisible())
+		{
+			continue;
+		}
+
+		// - Variante del shader (instanciada o no) con la que se dibuja el elemento
+		if (!elements[i]->acceptsShader(shader))
+		{
+			continue;
+		}
+
+		// - Dibujar elemento
+		elements[i]->drawNormals(shader, mModel * elements[i]->getModelMatrix(), mView, mProjection);
+	}
+}
+
 // - Dibujado del contorno del grupo 3D
 void Group3D::drawBasicOutline(ShaderProgram &shader, glm::mat4 mModel,
 						  glm::mat4 mView, glm::mat4 mProjection)
 {
 	for (int i = 0; i < elements.size(); i++)
 	{
+		// - Frustum culling
+		if (!elements[i]->isOutlineVisible())
+		{
+			continue;
+		}
+
+		// - Variante del shader (instanciada o no) con la que se dibuja el elemento
+		if (!elements[i]->acceptsShader(shader))
+		{
+			continue;
+		}
+
 		// - Dibujar elemento
 		elements[i]->drawBasicOutline(shader, mModel * elements[i]->getModelMatrix(), mView, mProjection);
 	}
@@ -114,6 +296,18 @@ void Group3D::drawAdvancedOutline(ShaderProgram &shader, glm::mat4 mModel,
 {
 	for (int i = 0; i < elements.size(); i++)
 	{
+		// - Frustum culling
+		if (!elements[i]->isOutlineVisible())
+		{
+			continue;
+		}
+
+		// - Variante del shader (instanciada o no) con la que se dibuja el elemento
+		if (!elements[i]->acceptsShader(shader))
+		{
+			continue;
+		}
+
 		// - Dibujar elemento
 		elements[i]->drawAdvancedOutline(shader, mModel * elements[i]->getModelMatrix(),
 										 mView, mProjection);
@@ -27,6 +27,20 @@ public:
 
 	// - Obtener nmero de elementos del grupo
 	int getNumElements();
+
+	// - Frustum culling: visibilidad de los elementos del grupo
+	void updateVisibility(const Frustum &frustum, glm::mat4 mModel, CullingStatistics &statistics) override;
+	void aggregateVisibility() override;
+
+	// - Variantes del shader con las que se dibujan los elementos del grupo
+	bool acceptsShader(ShaderProgram &shader) override;
+
+	// - BVH: primitivas de todos los elementos del grupo
+	void collectPrimitives(glm::mat4 mModel, int sceneElement, std::vector<BVHPrimitive> &primitives) override;
+
+	// - Residencia: memoria e imgenes de todos los elementos del grupo
+	void addMemoryUsage(MemoryUsage &usage) override;
+	void releaseTextureImages() override;
 	
 	// - Mtodos de dibujado
 	void drawRealistic(ShaderProgram &shader, glm::mat4 mModel,
@@ -44,6 +58,14 @@ public:
 	void drawGoochShading(ShaderProgram &shader, glm::mat4 mModel,
 						  glm::mat4 mView, glm::mat4 mProjection) override;
 
+	// - Dibujar slo la profundidad (pre-pasada de profundidad)
+	void drawDepth(ShaderProgram &shader, glm::mat4 mModel,
+				   glm::mat4 mView, glm::mat4 mProjection) override;
+
+	// - Dibujar la normal y la profundidad (pre-pasada del contorno en espacio de pantalla)
+	void drawNormals(ShaderProgram &shader, glm::mat4 mModel,
+					 glm::mat4 mView, glm::mat4 mProjection) override;
+
 	// - Dibujar contornos
 	void drawBasicOutline(ShaderProgram &shader, glm::mat4 mModel,
 						  glm::mat4 mView, glm::mat4 mProjection) override;
@@ -0,0 +1,614 @@
+#include "ImageFilters.h"
+#include "lodepng.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iostream>
+#include <thread>
+#include <emmintrin.h>
+
+#define PI 3.1415926535897932384626433832795f
+
+// - Nmero de hilos (0: uno por ncleo)
+unsigned int ImageFilters::threadCount = 0;
+
+/* *** FUNCIONES AUXILIARES *** */
+
+namespace
+{
+	// - Leer un pixel (4 canales) con coordenadas ya dentro de la imagen
+	inline __m128 loadPixel(const FloatImage &image, int x, int y)
+	{
+		return _mm_loadu_ps(&image.pixels[4 * ((size_t) y * image.width + x)]);
+	}
+
+	// - Leer un pixel ajustando las coordenadas al borde (GL_CLAMP_TO_EDGE). Al muestrear en el
+	//   centro de un texel, el filtrado GL_LINEAR devuelve exactamente ese texel
+	inline __m128 fetchClamped(const FloatImage &image, int x, int y)
+	{
+		x = std::min(std::max(x, 0), (int) image.width - 1);
+		y = std::min(std::max(y, 0), (int) image.height - 1);
+
+		return loadPixel(image, x, y);
+	}
+
+	// - Escribir un pixel
+	inline void storePixel(FloatImage &image, unsigned int x, unsigned int y, __m128 color)
+	{
+		_mm_storeu_ps(&image.pixels[4 * ((size_t) y * image.width + x)], color);
+	}
+
+	// - Muestreo bilineal (GL_LINEAR, GL_CLAMP_TO_EDGE) en coordenadas de textura normalizadas
+	inline __m128 sampleBilinear(const FloatImage &image, float u, float v)
+	{
+		float tx = u * image.width - 0.5f;
+		float ty = v * image.height - 0.5f;
+		float fx = std::floor(tx);
+		float fy = std::floor(ty);
+
+		int x0 = (int) fx;
+		int y0 = (int) fy;
+
+		__m128 wx = _mm_set1_ps(tx - fx);
+		__m128 wy = _mm_set1_ps(ty - fy);
+
+		__m128 c00 = fetchClamped(image, x0, y0);
+		__m128 c10 = fetchClamped(image, x0 + 1, y0);
+		__m128 c01 = fetchClamped(image, x0, y0 + 1);
+		__m128 c11 = fetchClamped(image, x0 + 1, y0 + 1);
+
+		__m128 bottom = _mm_add_ps(c00, _mm_mul_ps(_mm_sub_ps(c10, c00), wx));
+		__m128 top = _mm_add_ps(c01, _mm_mul_ps(_mm_sub_ps(c11, c01), wx));
+
+		return _mm_add_ps(bottom, _mm_mul_ps(_mm_sub_ps(top, bottom), wy));
+	}
+
+	// - Suma de los tres primeros canales (r + g + b)
+	inline float sum3(__m128 a)
+	{
+		float values[4];
+		_mm_storeu_ps(values, a);
+
+		return values[0] + values[1] + values[2];
+	}
+
+	// - Producto escalar de los tres primeros canales
+	inline float dot3(__m128 a, __m128 b)
+	{
+		return sum3(_mm_mul_ps(a, b));
+	}
+
+	// - Canal de un pixel
+	inline float channel(__m128 a, int index)
+	{
+		float values[4];
+		_mm_storeu_ps(values, a);
+
+		return values[index];
+	}
+
+	// - Sustituir el canal alfa
+	inline __m128 withAlpha(__m128 a, float alpha)
+	{
+		float values[4];
+		_mm_storeu_ps(values, a);
+		values[3] = alpha;
+
+		return _mm_loadu_ps(values);
+	}
+
+	// - mod() de GLSL: x - y * floor(x / y)
+	inline float glslMod(float x, float y)
+	{
+		return x - y * std::floor(x / y);
+	}
+
+	// - fract() de GLSL
+	inline float glslFract(float x)
+	{
+		return x - std::floor(x);
+	}
+}
+
+/* *** CONFIGURACIN Y CONVERSIONES *** */
+
+// - Nmero de hilos utilizados (0: uno por ncleo)
+void ImageFilters::setThreadCount(unsigned int threads)
+{
+	threadCount = threads;
+}
+
+// - Repartir las filas [0, height) en bloques entre los hilos. Cada hilo toma el siguiente
+//   bloque libre, de forma que las filas ms costosas no dejan hilos parados
+void ImageFilters::parallelRows(unsigned int height, const std::function<void(unsigned int, unsigned int)> &task)
+{
+	unsigned int threads = threadCount;
+
+	if (threads == 0)
+	{
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	threads = std::min(threads, std::max(1u, height));
+
+	unsigned int rowsPerBlock = std::max(16u, height / (threads * 4));
+	std::atomic<unsigned int> nextRow(0);
+
+	auto worker = [&]()
+	{
+		while (true)
+		{
+			unsigned int firstRow = nextRow.fetch_add(rowsPerBlock);
+
+			if (firstRow >= height)
+			{
+				break;
+			}
+
+			task(firstRow, std::min(height, firstRow + rowsPerBlock));
+		}
+	};
+
+	std::vector<std::thread> pool;
+
+	for (unsigned int i = 1; i < threads; i++)
+	{
+		pool.push_back(std::thread(worker));
+	}
+
+	worker();
+
+	for (unsigned int i = 0; i < pool.size(); i++)
+	{
+		pool[i].join();
+	}
+}
+
+// - Conversin desde RGBA8
+void ImageFilters::fromRGBA8(const std::vector<unsigned char> &image, unsigned int width, unsigned int height, FloatImage &result)
+{
+	result = FloatImage(width, height);
+
+	for (size_t i = 0; i < result.pixels.size() && i < image.size(); i++)
+	{
+		result.pixels[i] = image[i] / 255.f;
+	}
+}
+
+// - Conversin a RGBA8 (ajuste a [0, 1] y redondeo al ms cercano, como al escribir en un FBO RGBA8)
+void ImageFilters::toRGBA8(const FloatImage &image, std::vector<unsigned char> &result)
+{
+	result.resize(image.pixels.size());
+
+	for (size_t i = 0; i < image.pixels.size(); i++)
+	{
+		float value = std::min(std::max(image.pixels[i], 0.f), 1.f);
+		result[i] = (unsigned char) (value * 255.f + 0.5f);
+	}
+}
+
+// - Cargar PNG
+bool ImageFilters::loadPNG(const std::string &filename, FloatImage &image)
+{
+	std::vector<unsigned char> data;
+	unsigned int width, height;
+
+	unsigned error = lodepng::decode(data, width, height, filename);
+
+	if (error)
+	{
+		std::cout << filename << " cannot be loaded" << std::endl;
+		return false;
+	}
+
+	// - lodepng devuelve la fila superior primero
+	std::vector<unsigned char> flipped(data.size());
+	size_t rowBytes = (size_t) width * 4;
+
+	for (unsigned int y = 0; y < height; y++)
+	{
+		std::copy(data.begin() + y * rowBytes, data.begin() + (y + 1) * rowBytes,
+				  flipped.begin() + (height - 1 - y) * rowBytes);
+	}
+
+	fromRGBA8(flipped, width, height, image);
+
+	return true;
+}
+
+// - Guardar PNG
+bool ImageFilters::savePNG(const std::string &filename, const FloatImage &image)
+{
+	std::vector<unsigned char> data;
+	toRGBA8(image, data);
+
+	std::vector<unsigned char> flipped(data.size());
+	size_t rowBytes = (size_t) image.width * 4;
+
+	for (unsigned int y = 0; y < image.height; y++)
+	{
+		std::copy(data.begin() + y * rowBytes, data.begin() + (y + 1) * rowBytes,
+				  flipped.begin() + (image.height - 1 - y) * rowBytes);
+	}
+
+	unsigned error = lodepng::encode(filename, flipped, image.width, image.height);
+
+	if (error)
+	{
+		std::cout << filename << " cannot be saved" << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+/* *** FILTROS *** */
+
+// - Halftone (Shaders/halftone-frag.glsl)
+void ImageFilters::halftone(const FloatImage &source, FloatImage &result, const HalftoneTechnique &halftone)
+{
+	result = FloatImage(source.width, source.height);
+
+	const float texSizeX = source.width / halftone.size;
+	const float texSizeY = source.height / halftone.size;
+	const __m128 halftoneColor = _mm_setr_ps(halftone.color.r, halftone.color.g, halftone.color.b, 1.f);
+	const __m128 brightnessWeights = _mm_setr_ps(0.241f, 0.691f, 0.068f, 0.f);
+
+	parallelRows(source.height, [&](unsigned int firstRow, unsigned int lastRow)
+	{
+		for (unsigned int y = firstRow; y < lastRow; y++)
+		{
+			float v = (y + 0.5f) / source.height;
+
+			for (unsigned int x = 0; x < source.width; x++)
+			{
+				float u = (x + 0.5f) / source.width;
+
+				__m128 color = loadPixel(source, x, y);
+
+				float sinMinus = std::sin(u * texSizeX - v * texSizeY);
+				float sinPlus = std::sin(u * texSizeX + v * texSizeY);
+
+				if (sinMinus < halftone.threshold && sinPlus < halftone.threshold)
+				{
+					// - Brillo percibido del color
+					float brightness = std::sqrt(dot3(_mm_mul_ps(color, color), brightnessWeights));
+					float factor = std::sin(2.f * PI * brightness) * halftone.intensity;
+
+					color = _mm_add_ps(color, _mm_mul_ps(halftoneColor, _mm_set1_ps(factor)));
+				}
+
+				storePixel(result, x, y, color);
+			}
+		}
+	});
+}
+
+// - Dithering (Shaders/dithering-frag.glsl)
+void ImageFilters::dithering(const FloatImage &source, FloatImage &result, const DitheringTechnique &dithering)
+{
+	result = FloatImage(source.width, source.height);
+
+	const __m128 luminance = _mm_setr_ps(0.2326f, 0.7152f, 0.0722f, 0.f);
+	const __m128 white = _mm_set1_ps(1.f);
+	const float deltaFactor = 0.1f;
+	const float density = dithering.density;
+	const float width = dithering.width;
+
+	parallelRows(source.height, [&](unsigned int firstRow, unsigned int lastRow)
+	{
+		for (unsigned int y = firstRow; y < lastRow; y++)
+		{
+			// - gl_FragCoord apunta al centro del pixel
+			float pixelY = y + 0.5f;
+
+			for (unsigned int x = 0; x < source.width; x++)
+			{
+				float pixelX = x + 0.5f;
+
+				__m128 color = loadPixel(source, x, y);
+
+				float brightness = std::sqrt(dot3(_mm_mul_ps(color, color), luminance));
+
+				float minChannelColor = std::min(std::min(channel(color, 0), channel(color, 1)), channel(color, 2));
+				float maxChannelColor = std::max(std::max(channel(color, 0), channel(color, 1)), channel(color, 2));
+				float deltaChannelColor = maxChannelColor - minChannelColor;
+
+				// - Color base
+				if (deltaChannelColor > deltaFactor)
+				{
+					color = dithering.useSceneColor ? _mm_div_ps(color, _mm_set1_ps(maxChannelColor)) : _mm_set1_ps(maxChannelColor);
+				}
+				else
+				{
+					color = white;
+				}
+
+				__m128 finalColor = white;
+
+				// - Lneas que representan el color de relleno
+				if (brightness < dithering.threshold1 && glslMod(pixelX + pixelY, density) >= width)
+				{
+					finalColor = _mm_mul_ps(color, _mm_set1_ps(dithering.intensityThreshold1));
+				}
+
+				if (brightness < dithering.threshold2 && glslMod(pixelX - pixelY, density) >= width)
+				{
+					finalColor = _mm_mul_ps(color, _mm_set1_ps(dithering.intensityThreshold2));
+				}
+
+				// - Lneas que representan las zonas con sombra
+				if (brightness < dithering.threshold3 && glslMod(pixelX + pixelY - (density * 0.5f), density) >= width)
+				{
+					finalColor = _mm_mul_ps(color, _mm_set1_ps(dithering.intensityThreshold3));
+				}
+
+				if (brightness < dithering.threshold4 && glslMod(pixelX - pixelY - (density * 0.5f), density) >= width)
+				{
+					finalColor = _mm_mul_ps(color, _mm_set1_ps(dithering.intensityThreshold4));
+				}
+
+				storePixel(result, x, y, withAlpha(finalColor, 1.f));
+			}
+		}
+	});
+}
+
+// - Pixel Art (Shaders/pixelArt-frag.glsl). Las coordenadas cuantizadas caen entre texels, por lo
+//   que se usa el muestreo bilineal
+void ImageFilters::pixelArt(const FloatImage &source, FloatImage &result, const PixelArtTechnique &pixelArt)
+{
+	result = FloatImage(source.width, source.height);
+
+	const float xPixelSize = 1.f / pixelArt.numHorizontalPixels;
+	const float yPixelSize = 1.f / pixelArt.numVerticalPixels;
+
+	parallelRows(source.height, [&](unsigned int firstRow, unsigned int lastRow)
+	{
+		for (unsigned int y = firstRow; y < lastRow; y++)
+		{
+			float v = (y + 0.5f) / source.height;
+			float newV = std::floor(v / yPixelSize) * yPixelSize;
+
+			for (unsigned int x = 0; x < source.width; x++)
+			{
+				float u = (x + 0.5f) / source.width;
+				float newU = std::floor(u / xPixelSize) * xPixelSize;
+
+				storePixel(result, x, y, withAlpha(sampleBilinear(source, newU, newV), 1.f));
+			}
+		}
+	});
+}
+
+// - Painterly (Shaders/painterly-frag.glsl). El shader suma (brushSize + 1)^2 muestras en cada uno
+//   de los cuatro cuadrantes; aqu las sumas se calculan de forma separable (primero por filas y
+//   luego por columnas), con lo que el coste por pixel pasa a ser lineal con el tamao del pincel
+void ImageFilters::painterly(const FloatImage &source, FloatImage &result, const PainterlyTechnique &painterly)
+{
+	result = FloatImage(source.width, source.height);
+
+	const int brushSize = std::max(0, painterly.brushSize);
+	const int windowSize = brushSize + 1;
+	const int width = source.width;
+	const __m128 brushSizeSquare = _mm_set1_ps((float) (windowSize * windowSize));
+
+	// - Columnas de las ventanas: la ventana que empieza en x0 cubre [x0, x0 + brushSize], con
+	//   x0 en [-brushSize, width - 1]
+	const int windowColumns = width + brushSize;
+
+	parallelRows(source.height, [&](unsigned int firstRow, unsigned int lastRow)
+	{
+		// - Filas de ventanas necesarias: de firstRow - brushSize a lastRow - 1
+		const int firstWindowRow = (int) firstRow - brushSize;
+		const int windowRows = (int) (lastRow - firstRow) + brushSize;
+
+		// - Sumas por filas (color y color al cuadrado) de las filas [firstWindowRow, lastRow + brushSize)
+		const int sourceRows = windowRows + brushSize;
+		std::vector<float> rowSum(8 * (size_t) sourceRows * windowColumns);
+
+		for (int r = 0; r < sourceRows; r++)
+		{
+			int y = firstWindowRow + r;
+
+			for (int x0 = -brushSize; x0 < width; x0++)
+			{
+				__m128 sum = _mm_setzero_ps();
+				__m128 sumSquare = _mm_setzero_ps();
+
+				for (int i = 0; i <= brushSize; i++)
+				{
+					__m128 color = fetchClamped(source, x0 + i, y);
+					sum = _mm_add_ps(sum, color);
+					sumSquare = _mm_add_ps(sumSquare, _mm_mul_ps(color, color));
+				}
+
+				float *dst = &rowSum[8 * ((size_t) r * windowColumns + (x0 + brushSize))];
+				_mm_storeu_ps(dst, sum);
+				_mm_storeu_ps(dst + 4, sumSquare);
+			}
+		}
+
+		// - Sumas de las ventanas completas (suma de brushSize + 1 filas)
+		std::vector<float> windowSum(8 * (size_t) windowRows * windowColumns);
+
+		for (int r = 0; r < windowRows; r++)
+		{
+			for (int c = 0; c < windowColumns; c++)
+			{
+				__m128 sum = _mm_setzero_ps();
+				__m128 sumSquare = _mm_setzero_ps();
+
+				for (int j = 0; j <= brushSize; j++)
+				{
+					const float *src = &rowSum[8 * ((size_t) (r + j) * windowColumns + c)];
+					sum = _mm_add_ps(sum, _mm_loadu_ps(src));
+					sumSquare = _mm_add_ps(sumSquare, _mm_loadu_ps(src + 4));
+				}
+
+				float *dst = &windowSum[8 * ((size_t) r * windowColumns + c)];
+				_mm_storeu_ps(dst, sum);
+				_mm_storeu_ps(dst + 4, sumSquare);
+			}
+		}
+
+		// - Elegir, para cada pixel, el cuadrante con menor varianza
+		for (unsigned int y = firstRow; y < lastRow; y++)
+		{
+			const int r = (int) y - firstWindowRow;
+
+			for (int x = 0; x < width; x++)
+			{
+				const int c = x + brushSize;
+
+				// - Cuadrantes en el orden del shader: (-,-), (-,+), (+,-), (+,+) en (x, y)
+				const float *quadrants[4] =
+				{
+					&windowSum[8 * ((size_t) (r - brushSize) * windowColumns + (c - brushSize))],
+					&windowSum[8 * ((size_t) r * windowColumns + (c - brushSize))],
+					&windowSum[8 * ((size_t) (r - brushSize) * windowColumns + c)],
+					&windowSum[8 * ((size_t) r * windowColumns + c)]
+				};
+
+				float minValue = 1.f;
+				__m128 finalColor = _mm_setr_ps(0.f, 0.f, 0.f, 1.f);
+
+				for (int q = 0; q < 4; q++)
+				{
+					__m128 mean = _mm_div_ps(_mm_loadu_ps(quadrants[q]), brushSizeSquare);
+					__m128 variance = _mm_sub_ps(_mm_div_ps(_mm_loadu_ps(quadrants[q] + 4), brushSizeSquare), _mm_mul_ps(mean, mean));
+
+					// - abs(): se borra el bit de signo
+					variance = _mm_andnot_ps(_mm_set1_ps(-0.f), variance);
+
+					float sumColorSquare = sum3(variance);
+
+					if (sumColorSquare < minValue)
+					{
+						minValue = sumColorSquare;
+						finalColor = withAlpha(mean, 1.f);
+					}
+				}
+
+				storePixel(result, x, y, finalColor);
+			}
+		}
+	});
+}
+
+// - Charcoal (Shaders/charcoal-frag.glsl). El ruido se calcula con la misma funcin hash que el
+//   shader, pero depende de la precisin de sin() en cada GPU, por lo que slo coincide de forma
+//   aproximada
+void ImageFilters::charcoal(const FloatImage &source, FloatImage &result, const CharcoalTechnique &charcoal)
+{
+	result = FloatImage(source.width, source.height);
+
+	const __m128 luma = _mm_setr_ps(0.2326f, 0.7152f, 0.0722f, 0.f);
+	const __m128 two = _mm_set1_ps(2.f);
+	const glm::vec3 charcoalColor = glm::vec3(0.1f) * charcoal.colorMultiplier;
+	const __m128 edgeColor = _mm_setr_ps(charcoal.edgeColor.r, charcoal.edgeColor.g, charcoal.edgeColor.b, 0.f);
+	const __m128 fillColor = _mm_setr_ps(charcoalColor.r, charcoalColor.g, charcoalColor.b, 0.f);
+
+	parallelRows(source.height, [&](unsigned int firstRow, unsigned int lastRow)
+	{
+		for (unsigned int y = firstRow; y < lastRow; y++)
+		{
+			int iy = (int) y;
+			float v = (y + 0.5f) / source.height;
+
+			for (unsigned int x = 0; x < source.width; x++)
+			{
+				int ix = (int) x;
+				float u = (x + 0.5f) / source.width;
+
+				__m128 texColor = loadPixel(source, ix, iy);
+				__m128 color = fillColor;
+
+				if (charcoal.sobelFilter)
+				{
+					// - Sobel edge detection
+					__m128 left = fetchClamped(source, ix - 1, iy);
+					__m128 right = fetchClamped(source, ix + 1, iy);
+					__m128 bottom = fetchClamped(source, ix, iy - 1);
+					__m128 top = fetchClamped(source, ix, iy + 1);
+					__m128 bottomLeft = fetchClamped(source, ix - 1, iy - 1);
+					__m128 topLeft = fetchClamped(source, ix - 1, iy + 1);
+					__m128 bottomRight = fetchClamped(source, ix + 1, iy - 1);
+					__m128 topRight = fetchClamped(source, ix + 1, iy + 1);
+
+					__m128 horizontal = _mm_mul_ps(_mm_sub_ps(top, bottom), two);
+					horizontal = _mm_add_ps(horizontal, _mm_sub_ps(topLeft, bottomLeft));
+					horizontal = _mm_add_ps(horizontal, _mm_sub_ps(topRight, bottomRight));
+
+					__m128 vertical = _mm_mul_ps(_mm_sub_ps(left, right), two);
+					vertical = _mm_add_ps(vertical, _mm_sub_ps(bottomLeft, topLeft));
+					vertical = _mm_add_ps(vertical, _mm_sub_ps(bottomRight, topRight));
+
+					__m128 magnitude = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(horizontal, horizontal), _mm_mul_ps(vertical, vertical)));
+					float edge = std::sqrt(dot3(magnitude, magnitude));
+
+					if (edge > (charcoal.threshold * 8.f))
+					{
+						color = edgeColor;
+					}
+				}
+
+				// - Aplicar luminancia
+				color = _mm_add_ps(color, _mm_set1_ps(dot3(texColor, luma)));
+
+				// - Ruido aleatorio
+				float noise = (glslFract(std::sin(u * 12.9898f + v * 78.233f) * 43758.5453f) - 0.5f) * charcoal.noise;
+				color = _mm_add_ps(color, _mm_set1_ps(noise));
+
+				storePixel(result, x, y, withAlpha(color, 1.f));
+			}
+		}
+	});
+}
+
+/* *** COMPARACIN *** */
+
+// - Comparar dos imgenes RGBA8 del mismo tamao con una tolerancia por canal
+ImageComparison ImageFilters::compareImages(const std::vector<unsigned char> &imageA, const std::vector<unsigned char> &imageB,
+											unsigned int width, unsigned int height, unsigned int tolerance)
+{
+	ImageComparison comparison;
+	size_t numPixels = (size_t) width * height;
+
+	if (imageA.size() < numPixels * 4 || imageB.size() < numPixels * 4)
+	{
+		comparison.differentPixels = (unsigned int) numPixels;
+		comparison.maxDifference = 255;
+		comparison.meanDifference = 255.0;
+		return comparison;
+	}
+
+	unsigned long long totalDifference = 0;
+
+	for (size_t i = 0; i < numPixels; i++)
+	{
+		bool different = false;
+
+		for (size_t c = 0; c < 4; c++)
+		{
+			unsigned int difference = (unsigned int) std::abs((int) imageA[4 * i + c] - (int) imageB[4 * i + c]);
+			totalDifference += difference;
+			comparison.maxDifference = std::max(comparison.maxDifference, difference);
+
+			if (difference > tolerance)
+			{
+				different = true;
+			}
+		}
+
+		if (different)
+		{
+			comparison.differentPixels++;
+		}
+	}
+
+	comparison.meanDifference = numPixels > 0 ? (double) totalDifference / (numPixels * 4) : 0.0;
+
+	return comparison;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "Structures.h"
+
+// - Imagen RGBA en coma flotante (4 canales por pixel, valores en [0, 1]). La fila 0 es la fila
+//   inferior, igual que en las texturas de OpenGL, para que los patrones que dependen de la
+//   posicin (gl_FragCoord, texCoord) coincidan con los de los shaders
+struct FloatImage
+{
+	unsigned int width;
+	unsigned int height;
+	std::vector<float> pixels;
+
+	FloatImage()
+	{
+		this->width = 0;
+		this->height = 0;
+	}
+
+	FloatImage(unsigned int width, unsigned int height)
+	{
+		this->width = width;
+		this->height = height;
+		this->pixels.resize(4 * width * height, 0.f);
+	}
+};
+
+// - Resultado de comparar dos imgenes
+struct ImageComparison
+{
+	// - Pixels en los que algn canal difiere ms que la tolerancia
+	unsigned int differentPixels;
+
+	// - Mayor diferencia encontrada en un canal (0-255)
+	unsigned int maxDifference;
+
+	// - Diferencia media por canal (0-255)
+	double meanDifference;
+
+	ImageComparison()
+	{
+		this->differentPixels = 0;
+		this->maxDifference = 0;
+		this->meanDifference = 0.0;
+	}
+};
+
+// - La clase ImageFilters contiene implementaciones en CPU de los filtros de post-procesamiento
+//   (Shaders/halftone, dithering, pixelArt, painterly y charcoal), configuradas con las mismas
+//   estructuras de tcnica que Quad. Reproducen el muestreo de la textura de la escena del FBO
+//   (GL_LINEAR, GL_CLAMP_TO_EDGE, RGBA8), usan SSE para operar con los 4 canales de un pixel a la
+//   vez y reparten las filas de la imagen entre varios hilos. Se utilizan para estilizar imgenes
+//   sin GPU y como referencia para comparar con las imgenes generadas por los shaders
+class ImageFilters
+{
+private:
+	// - Nmero de hilos (0: uno por ncleo)
+	static unsigned int threadCount;
+
+	// - Repartir las filas [0, height) en bloques entre los hilos
+	static void parallelRows(unsigned int height, const std::function<void(unsigned int, unsigned int)> &task);
+
+public:
+	// - Nmero de hilos utilizados (0: uno por ncleo)
+	static void setThreadCount(unsigned int threads);
+
+	// - Conversin desde/hacia RGBA8 (fila 0 = fila inferior)
+	static void fromRGBA8(const std::vector<unsigned char> &image, unsigned int width, unsigned int height, FloatImage &result);
+	static void toRGBA8(const FloatImage &image, std::vector<unsigned char> &result);
+
+	// - Cargar y guardar PNG (se da la vuelta a la imagen, ya que lodepng guarda la fila superior primero)
+	static bool loadPNG(const std::string &filename, FloatImage &image);
+	static bool savePNG(const std::string &filename, const FloatImage &image);
+
+	// - Filtros de post-procesamiento
+	static void halftone(const FloatImage &source, FloatImage &result, const HalftoneTechnique &halftone);
+	static void dithering(const FloatImage &source, FloatImage &result, const DitheringTechnique &dithering);
+	static void pixelArt(const FloatImage &source, FloatImage &result, const PixelArtTechnique &pixelArt);
+	static void painterly(const FloatImage &source, FloatImage &result, const PainterlyTechnique &painterly);
+	static void charcoal(const FloatImage &source, FloatImage &result, const CharcoalTechnique &charcoal);
+
+	// - Comparar dos imgenes RGBA8 del mismo tamao con una tolerancia por canal (0-255)
+	static ImageComparison compareImages(const std::vector<unsigned char> &imageA, const std::vector<unsigned char> &imageB,
+										 unsigned int width, unsigned int height, unsigned int tolerance);
+};
@@ -0,0 +1,441 @@
+#include "ImageStylizer.h"
+#include "lodepng.h"
+#include "GLStateCache.h"
+
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <iostream>
+
+// - Constructor
+ImageStylizer::ImageStylizer(StylizerSettings settings, bool glContext)
+{
+	this->settings = settings;
+
+	quad = nullptr;
+	fbo = nullptr;
+	inputTexture = 0;
+	targetWidth = 0;
+	targetHeight = 0;
+	uploadPBO[0] = uploadPBO[1] = 0;
+	readbackPBO[0] = readbackPBO[1] = 0;
+
+	useGPU = glContext && !settings.forceCPU;
+
+	// - Si no se pueden preparar los recursos de GPU, se usan los filtros de CPU
+	if (useGPU && !prepareGPU())
+	{
+		std::cout << "Cannot prepare GPU stylization, using CPU filters" << std::endl;
+		releaseGPU();
+		useGPU = false;
+	}
+}
+
+// - Destructor
+ImageStylizer::~ImageStylizer()
+{
+	releaseGPU();
+}
+
+// - Saber si un efecto existe
+bool ImageStylizer::isValidEffect(const std::string &effect)
+{
+	return effect == "halftone" || effect == "dithering" || effect == "pixelArt" ||
+		   effect == "painterly" || effect == "charcoal";
+}
+
+// - Mtodo privado: Preparar los recursos de GPU
+bool ImageStylizer::prepareGPU()
+{
+	std::string shaderPath = "Shaders/" + settings.effect;
+
+	if (shader.createShaderProgram(shaderPath.c_str()) == 0)
+	{
+		return false;
+	}
+
+	quad = new Quad();
+
+	// - Las imgenes no tienen profundidad: la tcnica Charcoal slo detecta contornos en el color
+	CharcoalTechnique charcoal = quad->getCharcoalTechnique();
+	charcoal.depthEdges = false;
+	quad->setCharcoalTechnique(charcoal);
+
+	glGenTextures(1, &inputTexture);
+	glGenBuffers(2, uploadPBO);
+	glGenBuffers(2, readbackPBO);
+
+	// - Estado de OpenGL: slo se dibuja un quad a pantalla completa
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_BLEND);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+	return true;
+}
+
+// - Mtodo privado: Liberar los recursos de GPU
+void ImageStylizer::releaseGPU()
+{
+	if (quad != nullptr)
+	{
+		delete quad;
+		quad = nullptr;
+	}
+
+	if (fbo != nullptr)
+	{
+		delete fbo;
+		fbo = nullptr;
+	}
+
+	if (inputTexture != 0)
+	{
+		GLStateCache::getInstance()->forgetTexture(inputTexture);
+		glDeleteTextures(1, &inputTexture);
+		glDeleteBuffers(2, uploadPBO);
+		glDeleteBuffers(2, readbackPBO);
+		inputTexture = 0;
+	}
+}
+
+// - Mtodo privado: Ajustar la textura de entrada y el FBO al tamao de la imagen
+void ImageStylizer::resizeTargets(unsigned int width, unsigned int height)
+{
+	if (width == targetWidth && height == targetHeight)
+	{
+		return;
+	}
+
+	targetWidth = width;
+	targetHeight = height;
+
+	// - Textura de entrada, con los mismos parmetros que la textura de la escena del renderer
+	GLStateCache *stateCache = GLStateCache::getInstance();
+	stateCache->bindTexture(GL_TEXTURE_2D, 0, inputTexture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	stateCache->bindTexture(GL_TEXTURE_2D, 0, 0);
+
+	// - FBO de salida (slo color)
+	if (fbo != nullptr)
+	{
+		delete fbo;
+	}
+
+	fbo = new FBO();
+
+	fbo->activeTextureUnit(0);
+	fbo->bindRenderTexture();
+	fbo->createRenderTexture(width, height);
+	fbo->unbindRenderTexture();
+
+	fbo->bindFrameBuffer();
+	fbo->attachRenderTexture();
+	fbo->checkStatus();
+	fbo->unbindFrameBuffer();
+}
+
+// - Mtodo privado: Dibujar el quad con el efecto seleccionado
+void ImageStylizer::drawEffect()
+{
+	shader.use();
+
+	if (settings.effect == "halftone")
+	{
+		quad->drawHalftone(shader, 0);
+	}
+	else if (settings.effect == "dithering")
+	{
+		quad->drawDithering(shader, 0);
+	}
+	else if (settings.effect == "pixelArt")
+	{
+		quad->drawPixelArt(shader, 0);
+	}
+	else if (settings.effect == "painterly")
+	{
+		quad->drawPainterly(shader, 0);
+	}
+	else if (settings.effect == "charcoal")
+	{
+		// - Sin contornos de profundidad no se lee TexDepth (comparte la unidad de la imagen)
+		quad->drawCharcoal(shader, 0, 0, glm::mat4(1.f));
+	}
+}
+
+// - Mtodo privado: Procesar todas las imgenes en GPU. Mientras la GPU procesa la imagen i, se
+//   decodifica la imagen i + 1 en otro hilo, se leen los pixels de la imagen i - 1 (su lectura
+//   se lanz de forma asncrona a un PBO en la iteracin anterior) y se codifica en otro hilo
+unsigned int ImageStylizer::stylizeGPU()
+{
+	unsigned int failed = 0;
+	unsigned int processed = 0;
+
+	// - Lectura pendiente (imagen anterior)
+	bool pendingReadback = false;
+	std::string pendingOutput;
+	unsigned int pendingWidth = 0;
+	unsigned int pendingHeight = 0;
+	unsigned int pendingSlot = 0;
+
+	// - Decodificacin de la siguiente imagen y codificacin de la anterior
+	std::future<StylizerImage> nextImage = std::async(std::launch::async, &ImageStylizer::loadImage, settings.inputs[0]);
+	std::future<bool> pendingSave;
+
+	// - Recoger los pixels de la lectura pendiente y guardarlos en otro hilo
+	auto finishReadback = [&]()
+	{
+		size_t bytes = (size_t) pendingWidth * pendingHeight * 4;
+		std::vector<unsigned char> pixels(bytes);
+
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, readbackPBO[pendingSlot]);
+		void *data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, bytes, GL_MAP_READ_BIT);
+
+		if (data != nullptr)
+		{
+			memcpy(pixels.data(), data, bytes);
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+		}
+
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+		if (pendingSave.valid() && !pendingSave.get())
+		{
+			failed++;
+		}
+
+		if (data == nullptr)
+		{
+			std::cout << pendingOutput << " cannot be read back" << std::endl;
+			failed++;
+		}
+		else
+		{
+			pendingSave = std::async(std::launch::async, &ImageStylizer::saveImage, pendingOutput, std::move(pixels), pendingWidth, pendingHeight);
+		}
+
+		pendingReadback = false;
+	};
+
+	for (unsigned int i = 0; i < settings.inputs.size(); i++)
+	{
+		StylizerImage image = nextImage.get();
+
+		if (i + 1 < settings.inputs.size())
+		{
+			nextImage = std::async(std::launch::async, &ImageStylizer::loadImage, settings.inputs[i + 1]);
+		}
+
+		if (!image.valid)
+		{
+			failed++;
+			continue;
+		}
+
+		size_t bytes = (size_t) image.width * image.height * 4;
+		unsigned int slot = processed % 2;
+		processed++;
+
+		resizeTargets(image.width, image.height);
+
+		// - Subida a travs de un PBO: la copia a la textura se realiza de forma asncrona
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, uploadPBO[slot]);
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+		void *data = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+
+		if (data != nullptr)
+		{
+			memcpy(data, image.pixels.data(), bytes);
+			glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+		}
+
+		GLStateCache::getInstance()->bindTexture(GL_TEXTURE_2D, 0, inputTexture);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, image.width, image.height, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+		// - Dibujar el efecto en el FBO
+		fbo->bindFrameBuffer();
+		glViewport(0, 0, image.width, image.height);
+		glClear(GL_COLOR_BUFFER_BIT);
+
+		drawEffect();
+
+		// - Lectura asncrona al PBO
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, readbackPBO[slot]);
+		glBufferData(GL_PIXEL_PACK_BUFFER, bytes, nullptr, GL_STREAM_READ);
+		glReadPixels(0, 0, image.width, image.height, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+		fbo->unbindFrameBuffer();
+		GLStateCache::getInstance()->bindTexture(GL_TEXTURE_2D, 0, 0);
+
+		// - Recoger la imagen anterior, que ya habr terminado mientras se preparaba esta
+		if (pendingReadback)
+		{
+			finishReadback();
+		}
+
+		pendingReadback = true;
+		pendingOutput = outputPath(image.path);
+		pendingWidth = image.width;
+		pendingHeight = image.height;
+		pendingSlot = slot;
+	}
+
+	if (pendingReadback)
+	{
+		finishReadback();
+	}
+
+	if (pendingSave.valid() && !pendingSave.get())
+	{
+		failed++;
+	}
+
+	return failed;
+}
+
+// - Mtodo privado: Procesar todas las imgenes en CPU (los filtros ya reparten las filas entre hilos)
+unsigned int ImageStylizer::stylizeCPU()
+{
+	unsigned int failed = 0;
+
+	for (unsigned int i = 0; i < settings.inputs.size(); i++)
+	{
+		FloatImage source, result;
+
+		if (!ImageFilters::loadPNG(settings.inputs[i], source))
+		{
+			failed++;
+			continue;
+		}
+
+		if (settings.effect == "halftone")
+		{
+			ImageFilters::halftone(source, result, HalftoneTechnique());
+		}
+		else if (settings.effect == "dithering")
+		{
+			ImageFilters::dithering(source, result, DitheringTechnique());
+		}
+		else if (settings.effect == "pixelArt")
+		{
+			ImageFilters::pixelArt(source, result, PixelArtTechnique());
+		}
+		else if (settings.effect == "painterly")
+		{
+			ImageFilters::painterly(source, result, PainterlyTechnique());
+		}
+		else if (settings.effect == "charcoal")
+		{
+			ImageFilters::charcoal(source, result, CharcoalTechnique());
+		}
+
+		if (!ImageFilters::savePNG(outputPath(settings.inputs[i]), result))
+		{
+			failed++;
+		}
+	}
+
+	return failed;
+}
+
+// - Mtodo privado: Cargar una imagen PNG (se le da la vuelta para que la fila 0 sea la inferior)
+StylizerImage ImageStylizer::loadImage(const std::string &path)
+{
+	StylizerImage image;
+	image.path = path;
+
+	std::vector<unsigned char> data;
+	unsigned error = lodepng::decode(data, image.width, image.height, path);
+
+	if (error)
+	{
+		std::cout << path << " cannot be loaded" << std::endl;
+		return image;
+	}
+
+	size_t rowBytes = (size_t) image.width * 4;
+	image.pixels.resize(data.size());
+
+	for (unsigned int y = 0; y < image.height; y++)
+	{
+		memcpy(&image.pixels[(image.height - 1 - y) * rowBytes], &data[y * rowBytes], rowBytes);
+	}
+
+	image.valid = true;
+
+	return image;
+}
+
+// - Mtodo privado: Guardar una imagen PNG
+bool ImageStylizer::saveImage(const std::string &path, const std::vector<unsigned char> &pixels, unsigned int width, unsigned int height)
+{
+	size_t rowBytes = (size_t) width * 4;
+	std::vector<unsigned char> data(pixels.size());
+
+	for (unsigned int y = 0; y < height; y++)
+	{
+		memcpy(&data[(height - 1 - y) * rowBytes], &pixels[y * rowBytes], rowBytes);
+	}
+
+	unsigned error = lodepng::encode(path, data, width, height);
+
+	if (error)
+	{
+		std::cout << path << " cannot be saved" << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+// - Mtodo privado: Ruta de salida de una imagen de entrada ([directorio]/[nombre]_[efecto].png)
+std::string ImageStylizer::outputPath(const std::string &input)
+{
+	std::string name = input.substr(input.find_last_of("/\\") + 1);
+	name = name.substr(0, name.find_last_of('.'));
+
+	return settings.outputDirectory + '/' + name + '_' + settings.effect + ".png";
+}
+
+// - Procesar todas las imgenes
+int ImageStylizer::run()
+{
+	if (!isValidEffect(settings.effect))
+	{
+		std::cout << "Unknown effect: " << settings.effect << std::endl;
+		return 1;
+	}
+
+	if (settings.inputs.empty())
+	{
+		std::cout << "No input images" << std::endl;
+		return 1;
+	}
+
+	std::cout << "Stylizing " << settings.inputs.size() << " image(s) with " << settings.effect
+			  << (useGPU ? " (GPU)" : " (CPU)") << std::endl;
+
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+	unsigned int failed = useGPU ? stylizeGPU() : stylizeCPU();
+
+	std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+	double seconds = std::chrono::duration<double>(end - start).count();
+
+	std::cout << settings.inputs.size() - failed << " image(s) stylized in " << seconds << " s";
+
+	if (failed > 0)
+	{
+		std::cout << ", " << failed << " failed";
+	}
+
+	std::cout << std::endl;
+
+	return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <string>
+#include <vector>
+
+#include "FBO.h"
+#include "ImageFilters.h"
+#include "Quad.h"
+#include "ShaderProgram.h"
+
+// - Parmetros de la estilizacin de imgenes
+struct StylizerSettings
+{
+	// - Efecto de post-procesamiento (halftone, dithering, pixelArt, painterly o charcoal)
+	std::string effect;
+
+	// - Imgenes de entrada (PNG) y directorio de salida
+	std::vector<std::string> inputs;
+	std::string outputDirectory;
+
+	// - Forzar los filtros de CPU aunque haya contexto OpenGL
+	bool forceCPU;
+
+	// - Constructor por defecto
+	StylizerSettings()
+	{
+		this->effect = "halftone";
+		this->outputDirectory = ".";
+		this->forceCPU = false;
+	}
+};
+
+// - Imagen RGBA8 (fila 0 = fila inferior, como en OpenGL)
+struct StylizerImage
+{
+	std::string path;
+	std::vector<unsigned char> pixels;
+	unsigned int width;
+	unsigned int height;
+	bool valid;
+
+	StylizerImage()
+	{
+		this->width = 0;
+		this->height = 0;
+		this->valid = false;
+	}
+};
+
+// - La clase ImageStylizer aplica un efecto de post-procesamiento a una lista de imgenes de
+//   disco sin cargar ninguna escena. Con contexto OpenGL se usan el Quad y los shaders del
+//   renderer: la decodificacin de la siguiente imagen y la codificacin de la anterior se hacen
+//   en otros hilos, y las subidas y lecturas de pixels pasan por dos pares de PBOs, de forma que la
+//   GPU procesa una imagen mientras se sube la siguiente y se lee la anterior. Sin contexto OpenGL
+//   se utilizan las implementaciones de CPU de ImageFilters
+class ImageStylizer
+{
+private:
+	// - Parmetros
+	StylizerSettings settings;
+
+	// - Usar la GPU (hay contexto OpenGL y no se han forzado los filtros de CPU)
+	bool useGPU;
+
+	// - Recursos de GPU: shader del efecto, quad, textura de entrada y FBO de salida
+	ShaderProgram shader;
+	Quad *quad;
+	FBO *fbo;
+	GLuint inputTexture;
+	unsigned int targetWidth;
+	unsigned int targetHeight;
+
+	// - PBOs de subida y de lectura (doble buffer)
+	GLuint uploadPBO[2];
+	GLuint readbackPBO[2];
+
+	// - Preparar y liberar los recursos de GPU
+	bool prepareGPU();
+	void releaseGPU();
+
+	// - Ajustar la textura de entrada y el FBO al tamao de la imagen
+	void resizeTargets(unsigned int width, unsigned int height);
+
+	// - Dibujar el quad con el efecto seleccionado
+	void drawEffect();
+
+	// - Procesar todas las imgenes en GPU o en CPU. Devuelven el nmero de imgenes con error
+	unsigned int stylizeGPU();
+	unsigned int stylizeCPU();
+
+	// - Cargar y guardar imgenes PNG
+	static StylizerImage loadImage(const std::string &path);
+	static bool saveImage(const std::string &path, const std::vector<unsigned char> &pixels, unsigned int width, unsigned int height);
+
+	// - Ruta de salida de una imagen de entrada
+	std::string outputPath(const std::string &input);
+
+public:
+	// - Constructor. glContext indica si hay un contexto OpenGL activo
+	ImageStylizer(StylizerSettings settings, bool glContext);
+
+	// - Destructor
+	~ImageStylizer();
+
+	// - Saber si un efecto existe
+	static bool isValidEffect(const std::string &effect);
+
+	// - Procesar todas las imgenes. Devuelve 0 si todas se procesaron correctamente
+	int run();
+};
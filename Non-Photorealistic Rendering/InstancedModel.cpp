@@ -0,0 +1,434 @@
+#include "InstancedModel.h"
+#include "RenderStatistics.h"
+
+// - Constructor
+InstancedModel::InstancedModel(Model *model)
+{
+	this->model = model;
+
+	// - VBO de atributos de instancia
+	instanceBuffer = 0;
+	glGenBuffers(1, &instanceBuffer);
+	instancesChanged = true;
+
+	for (unsigned int i = 0; i < Mesh::MAX_LODS; i++)
+	{
+		firstInstance[0][i] = firstInstance[1][i] = 0;
+		numInstances[0][i] = numInstances[1][i] = 0;
+	}
+
+	// - Volmenes envolventes (sin instancias)
+	computeBounds();
+
+	// - No es un plano
+	isPlane = false;
+}
+
+// - Destructor
+InstancedModel::~InstancedModel()
+{
+	glDeleteBuffers(1, &instanceBuffer);
+	delete model;
+}
+
+// - Aadir una instancia
+unsigned int InstancedModel::addInstance(glm::mat4 modelMatrix)
+{
+	instances.push_back(ModelInstance(modelMatrix));
+
+	computeBounds();
+	instancesChanged = true;
+	transformVersion++;
+
+	return (unsigned int) instances.size() - 1;
+}
+
+// - Cambiar la matriz de modelado de una instancia
+void InstancedModel::setInstanceMatrix(unsigned int instance, glm::mat4 modelMatrix)
+{
+	instances[instance].modelMatrix = modelMatrix;
+
+	computeBounds();
+	instancesChanged = true;
+	transformVersion++;
+}
+
+// - Contorno de una instancia (valores negativos: se usa el del modelo)
+void InstancedModel::setInstanceOutline(unsigned int instance, glm::vec3 color, float thickness)
+{
+	instances[instance].outlineColor = color;
+	instances[instance].outlineThickness = thickness;
+	instancesChanged = true;
+}
+
+// - Parmetros de Cel-Shading de una instancia (valores negativos: se usan los del modelo)
+void InstancedModel::setInstanceCelShading(unsigned int instance, float tones, float silhouettingFactor)
+{
+	instances[instance].celTones = tones;
+	instances[instance].celSilhouettingFactor = silhouettingFactor;
+	instancesChanged = true;
+}
+
+// - Obtener nmero de instancias
+unsigned int InstancedModel::getNumInstances()
+{
+	return (unsigned int) instances.size();
+}
+
+// - Obtener nmero de instancias visibles en el frame actual
+unsigned int InstancedModel::getNumVisibleInstances()
+{
+	unsigned int visibleInstances = 0;
+
+	for (unsigned int i = 0; i < instances.size(); i++)
+	{
+		if (instances[i].visible)
+		{
+			visibleInstances++;
+		}
+	}
+
+	return visibleInstances;
+}
+
+// - Cargar texturas de hatching (del modelo)
+void InstancedModel::setHatchingTextures(std::string dark, std::string bright)
+{
+	model->setHatchingTextures(dark, bright);
+}
+
+// - Mtodo privado: volmenes envolventes del elemento, que contienen a todas las instancias
+void InstancedModel::computeBounds()
+{
+	bounds = AABB();
+
+	for (unsigned int i = 0; i < instances.size(); i++)
+	{
+		bounds.expand(model->getBounds().transform(instances[i].modelMatrix));
+	}
+
+	boundingSphere = bounds.isValid() ? BoundingSphere(bounds.getCenter(), glm::length(bounds.getExtents())) : BoundingSphere();
+}
+
+// - Frustum culling: visibilidad de cada instancia. El elemento es visible si lo es alguna de ellas
+void InstancedModel::updateVisibility(const Frustum &frustum, glm::mat4 mModel, CullingStatistics &statistics)
+{
+	statistics.elementsTested++;
+
+	visible = false;
+	outlineVisible = false;
+
+	for (unsigned int i = 0; i < instances.size(); i++)
+	{
+		testBounds(frustum, mModel * instances[i].modelMatrix, model->getBounds(), model->getBoundingSphere(),
+				   instances[i].visible, instances[i].outlineVisible);
+
+		visible = visible || instances[i].visible;
+		outlineVisible = outlineVisible || instances[i].outlineVisible;
+	}
+
+	if (!visible)
+	{
+		statistics.elementsCulled++;
+	}
+
+	instancesChanged = true;
+}
+
+// - Visibilidad de una instancia (culling con la BVH)
+void InstancedModel::setInstanceVisibility(int instance, bool visible, bool outlineVisible)
+{
+	instances[instance].visible = visible;
+	instances[instance].outlineVisible = outlineVisible;
+	instancesChanged = true;
+}
+
+// - Nivel de detalle de una instancia, con la misma histresis que las mallas
+void InstancedModel::selectInstanceLOD(int instance, float screenSize)
+{
+	unsigned int lod = Mesh::chooseLOD(screenSize, instances[instance].lod, Mesh::MAX_LODS);
+
+	if (lod != instances[instance].lod)
+	{
+		instances[instance].lod = lod;
+		instancesChanged = true;
+	}
+}
+
+// - BVH: una primitiva por instancia, con la caja del modelo transformada por su matriz
+void InstancedModel::collectPrimitives(glm::mat4 mModel, int sceneElement, std::vector<BVHPrimitive> &primitives)
+{
+	if (!model->getBounds().isValid())
+	{
+		return;
+	}
+
+	for (unsigned int i = 0; i < instances.size(); i++)
+	{
+		BVHPrimitive primitive;
+		primitive.bounds = model->getBounds().transform(mModel * instances[i].modelMatrix);
+		primitive.owner = this;
+		primitive.mModel = mModel * instances[i].modelMatrix;
+		primitive.mesh = nullptr;
+		primitive.sceneElement = sceneElement;
+		primitive.instance = (int) i;
+
+		primitives.push_back(primitive);
+	}
+}
+
+// - Sumar la memoria del modelo compartido y de los atributos de instancia
+void InstancedModel::addMemoryUsage(MemoryUsage &usage)
+{
+	model->addMemoryUsage(usage);
+
+	usage.gpuBytes += sizeof(InstanceData) * instanceData.size();
+	usage.hostBytes += sizeof(ModelInstance) * instances.size() + sizeof(InstanceData) * instanceData.capacity();
+}
+
+// - Liberar las imgenes decodificadas de las texturas del modelo compartido
+void InstancedModel::releaseTextureImages()
+{
+	model->releaseTextureImages();
+}
+
+// - Slo se dibuja con la variante instanciada de los shaders
+bool InstancedModel::acceptsShader(ShaderProgram &shader)
+{
+	return shader.isInstanced();
+}
+
+// - Mtodo privado: rellenar el VBO de atributos de instancia. Se hace como mucho una vez por frame,
+//   en el primer dibujado tras calcular la visibilidad
+void InstancedModel::updateInstanceBuffer()
+{
+	if (!instancesChanged)
+	{
+		return;
+	}
+
+	instanceData.clear();
+
+	for (unsigned int pass = 0; pass < 2; pass++)
+	{
+		for (unsigned int lod = 0; lod < Mesh::MAX_LODS; lod++)
+		{
+			firstInstance[pass][lod] = (unsigned int) instanceData.size();
+
+			for (unsigned int i = 0; i < instances.size(); i++)
+			{
+				const ModelInstance &instance = instances[i];
+
+				if (instance.lod != lod || !(pass == 0 ? instance.visible : instance.outlineVisible))
+				{
+					continue;
+				}
+
+				InstanceData data;
+				data.modelMatrix = instance.modelMatrix;
+				data.outline = glm::vec4(instance.outlineColor, instance.outlineThickness);
+				data.celShading = glm::vec4(instance.celTones, instance.celSilhouettingFactor, 0.f, 0.f);
+
+				instanceData.push_back(data);
+			}
+
+			numInstances[pass][lod] = (unsigned int) instanceData.size() - firstInstance[pass][lod];
+		}
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(InstanceData) * instanceData.size(), instanceData.data(), GL_STREAM_DRAW);
+	RENDER_STATS_UPLOAD(instanceBuffer, instanceData.data(), sizeof(InstanceData) * instanceData.size());
+
+	instancesChanged = false;
+}
+
+// - Mtodo privado: preparar las mallas del modelo para dibujar las instancias de un nivel de detalle.
+//   El nivel de las mallas slo se cambia cuando es distinto del seleccionado, porque cada cambio
+//   vuelve a subir los ndices al IBO
+bool InstancedModel::bindInstances(unsigned int lod, bool outline)
+{
+	updateInstanceBuffer();
+
+	unsigned int pass = outline ? 1 : 0;
+
+	if (numInstances[pass][lod] == 0)
+	{
+		return false;
+	}
+
+	for (unsigned int i = 0; i < model->getNumMeshes(); i++)
+	{
+		Mesh *mesh = model->getMesh(i);
+
+		mesh->setVisibility(true, true);
+
+		if (mesh->getCurrentLOD() != lod)
+		{
+			mesh->setLOD(lod);
+		}
+
+		mesh->setInstances(instanceBuffer, firstInstance[pass][lod], numInstances[pass][lod]);
+	}
+
+	return true;
+}
+
+// - Mtodo privado: volver al dibujado normal de las mallas del modelo. Las mallas conservan el
+//   ltimo nivel de detalle (slo las dibuja el elemento), para no subir otra vez sus ndices en la
+//   siguiente pasada
+void InstancedModel::unbindInstances()
+{
+	for (unsigned int i = 0; i < model->getNumMeshes(); i++)
+	{
+		model->getMesh(i)->setInstances(0, 0, 0);
+	}
+}
+
+// - Dibujado realista de las instancias
+void InstancedModel::drawRealistic(ShaderProgram &shader, glm::mat4 mModel,
+								   glm::mat4 mView, glm::mat4 mProjection)
+{
+	for (unsigned int lod = 0; lod < Mesh::MAX_LODS; lod++)
+	{
+		if (bindInstances(lod, false))
+		{
+			model->drawRealistic(shader, mModel, mView, mProjection);
+		}
+	}
+
+	unbindInstances();
+}
+
+// - Dibujado monocromtico (material) de las instancias
+void InstancedModel::drawMonochrome(ShaderProgram &shader, glm::mat4 mModel,
+									glm::mat4 mView, glm::mat4 mProjection)
+{
+	model->getMonochromeTechnique() = monochrome;
+
+	for (unsigned int lod = 0; lod < Mesh::MAX_LODS; lod++)
+	{
+		if (bindInstances(lod, false))
+		{
+			model->drawMonochrome(shader, mModel, mView, mProjection);
+		}
+	}
+
+	unbindInstances();
+}
+
+// - Dibujado de las instancias utilizando la tcnica Cel-Shading
+void InstancedModel::drawCelShading(ShaderProgram &shader, glm::mat4 mModel,
+									glm::mat4 mView, glm::mat4 mProjection)
+{
+	model->getCelShadingTechnique() = celShading;
+
+	for (unsigned int lod = 0; lod < Mesh::MAX_LODS; lod++)
+	{
+		if (bindInstances(lod, false))
+		{
+			model->drawCelShading(shader, mModel, mView, mProjection);
+		}
+	}
+
+	unbindInstances();
+}
+
+// - Dibujado de las instancias utilizando la tcnica Hatching
+void InstancedModel::drawHatching(ShaderProgram &shader, glm::mat4 mModel,
+								  glm::mat4 mView, glm::mat4 mProjection)
+{
+	model->getHatchingTechnique() = hatching;
+
+	for (unsigned int lod = 0; lod < Mesh::MAX_LODS; lod++)
+	{
+		if (bindInstances(lod, false))
+		{
+			model->drawHatching(shader, mModel, mView, mProjection);
+		}
+	}
+
+	unbindInstances();
+}
+
+// - Dibujado de las instancias utilizando la tcnica Gooch Shading
+void InstancedModel::drawGoochShading(ShaderProgram &shader, glm::mat4 mModel,
+									  glm::mat4 mView, glm::mat4 mProjection)
+{
+	model->getGoochShadingTechnique() = goochShading;
+
+	for (unsigned int lod = 0; lod < Mesh::MAX_LODS; lod++)
+	{
+		if (bindInstances(lod, false))
+		{
+			model->drawGoochShading(shader, mModel, mView, mProjection);
+		}
+	}
+
+	unbindInstances();
+}
+
+// - Dibujado de la profundidad de las instancias (pre-pasada de profundidad)
+void InstancedModel::drawDepth(ShaderProgram &shader, glm::mat4 mModel,
+							   glm::mat4 mView, glm::mat4 mProjection)
+{
+	for (unsigned int lod = 0; lod < Mesh::MAX_LODS; lod++)
+	{
+		if (bindInstances(lod, false))
+		{
+			model->drawDepth(shader, mModel, mView, mProjection);
+		}
+	}
+
+	unbindInstances();
+}
+
+// - Dibujado de la normal y la profundidad de las instancias (pre-pasada del contorno en espacio de
+//   pantalla)
+void InstancedModel::drawNormals(ShaderProgram &shader, glm::mat4 mModel,
+								 glm::mat4 mView, glm::mat4 mProjection)
+{
+	for (unsigned int lod = 0; lod < Mesh::MAX_LODS; lod++)
+	{
+		if (bindInstances(lod, false))
+		{
+			model->drawNormals(shader, mModel, mView, mProjection);
+		}
+	}
+
+	unbindInstances();
+}
+
+// - Dibujado del contorno bsico de las instancias
+void InstancedModel::drawBasicOutline(ShaderProgram &shader, glm::mat4 mModel,
+									  glm::mat4 mView, glm::mat4 mProjection)
+{
+	model->getBasicOutline() = basicOutline;
+
+	for (unsigned int lod = 0; lod < Mesh::MAX_LODS; lod++)
+	{
+		if (bindInstances(lod, true))
+		{
+			model->drawBasicOutline(shader, mModel, mView, mProjection);
+		}
+	}
+
+	unbindInstances();
+}
+
+// - Dibujado del contorno avanzado de las instancias (adyacencias de cada nivel de detalle)
+void InstancedModel::drawAdvancedOutline(ShaderProgram &shader, glm::mat4 mModel,
+										 glm::mat4 mView, glm::mat4 mProjection)
+{
+	model->getAdvancedOutline() = advancedOutline;
+
+	for (unsigned int lod = 0; lod < Mesh::MAX_LODS; lod++)
+	{
+		if (bindInstances(lod, true))
+		{
+			model->drawAdvancedOutline(shader, mModel, mView, mProjection);
+		}
+	}
+
+	unbindInstances();
+}
\ No newline at end of file
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <vector>
+
+#include "Element3D.h"
+#include "Model.h"
+
+// - Instancia de un modelo instanciado: matriz de modelado y parmetros propios de las tcnicas
+//   (si son negativos, se usan los del modelo)
+struct ModelInstance
+{
+	glm::mat4 modelMatrix;
+
+	// - Contorno (bsico y avanzado)
+	glm::vec3 outlineColor;
+	float outlineThickness;
+
+	// - Cel-Shading
+	float celTones;
+	float celSilhouettingFactor;
+
+	// - Visibilidad y nivel de detalle en el frame actual
+	bool visible;
+	bool outlineVisible;
+	unsigned int lod;
+
+	ModelInstance(glm::mat4 modelMatrix)
+	{
+		this->modelMatrix = modelMatrix;
+		this->outlineColor = glm::vec3(-1.f);
+		this->outlineThickness = -1.f;
+		this->celTones = -1.f;
+		this->celSilhouettingFactor = -1.f;
+		this->visible = true;
+		this->outlineVisible = true;
+		this->lod = 0;
+	}
+};
+
+// - La clase InstancedModel dibuja muchas copias de un mismo modelo (mallas, texturas y texturas de
+//   hatching compartidas) con una llamada de dibujado instanciado por malla y nivel de detalle. Cada
+//   instancia tiene su matriz de modelado y sus parmetros de contorno y Cel-Shading, que se pasan
+//   a la variante instanciada de los shaders como atributos de vrtice. Las tcnicas usan el resto
+//   de parmetros del elemento, que se copian al modelo antes de dibujarlo
+class InstancedModel: public Element3D
+{
+private:
+	// - Modelo compartido por todas las instancias
+	Model *model;
+
+	// - Instancias
+	std::vector<ModelInstance> instances;
+
+	// - VBO de atributos de instancia: primero las instancias visibles y despus las que tienen el
+	//   contorno visible, agrupadas por nivel de detalle
+	GLuint instanceBuffer;
+	std::vector<InstanceData> instanceData;
+	unsigned int firstInstance[2][Mesh::MAX_LODS];
+	unsigned int numInstances[2][Mesh::MAX_LODS];
+
+	// - Flag para saber si hay que volver a rellenar el VBO (cambios de visibilidad o de parmetros)
+	bool instancesChanged;
+
+	// - Recalcular los volmenes envolventes del elemento (todas las instancias)
+	void computeBounds();
+
+	// - Rellenar el VBO de atributos de instancia
+	void updateInstanceBuffer();
+
+	// - Preparar las mallas del modelo para dibujar las instancias (visibles o con el contorno
+	//   visible) de un nivel de detalle. Devuelve false si no hay ninguna
+	bool bindInstances(unsigned int lod, bool outline);
+
+	// - Volver al dibujado normal de las mallas del modelo
+	void unbindInstances();
+
+public:
+	// - Constructor (el modelo pasa a ser del elemento)
+	InstancedModel(Model *model);
+
+	// - Destructor
+	~InstancedModel();
+
+	// - Aadir una instancia. Devuelve su posicin
+	unsigned int addInstance(glm::mat4 modelMatrix);
+
+	// - Configuracin de las instancias
+	void setInstanceMatrix(unsigned int instance, glm::mat4 modelMatrix);
+	void setInstanceOutline(unsigned int instance, glm::vec3 color, float thickness);
+	void setInstanceCelShading(unsigned int instance, float tones, float silhouettingFactor);
+	unsigned int getNumInstances();
+	unsigned int getNumVisibleInstances();
+
+	// - Cargar texturas de hatching (del modelo)
+	void setHatchingTextures(std::string dark, std::string bright);
+
+	// - Frustum culling: visibilidad de cada instancia
+	void updateVisibility(const Frustum &frustum, glm::mat4 mModel, CullingStatistics &statistics) override;
+	void setInstanceVisibility(int instance, bool visible, bool outlineVisible) override;
+
+	// - Nivel de detalle de cada instancia
+	void selectInstanceLOD(int instance, float screenSize) override;
+
+	// - BVH: una primitiva por instancia
+	void collectPrimitives(glm::mat4 mModel, int sceneElement, std::vector<BVHPrimitive> &primitives) override;
+
+	// - Residencia: memoria del modelo compartido y del VBO de instancias
+	void addMemoryUsage(MemoryUsage &usage) override;
+	void releaseTextureImages() override;
+
+	// - Slo se dibuja con la variante instanciada de los shaders
+	bool acceptsShader(ShaderProgram &shader) override;
+
+	// - Dibujar las instancias de distintas formas
+	void drawRealistic(ShaderProgram &shader, glm::mat4 mModel,
+					   glm::mat4 mView, glm::mat4 mProjection) override;
+
+	void drawMonochrome(ShaderProgram &shader, glm::mat4 mModel,
+						glm::mat4 mView, glm::mat4 mProjection) override;
+
+	void drawCelShading(ShaderProgram &shader, glm::mat4 mModel,
+						glm::mat4 mView, glm::mat4 mProjection) override;
+
+	void drawHatching(ShaderProgram &shader, glm::mat4 mModel,
+					  glm::mat4 mView, glm::mat4 mProjection) override;
+
+	void drawGoochShading(ShaderProgram &shader, glm::mat4 mModel,
+						  glm::mat4 mView, glm::mat4 mProjection) override;
+
+	// - Dibujar slo la profundidad (pre-pasada de profundidad)
+	void drawDepth(ShaderProgram &shader, glm::mat4 mModel,
+				   glm::mat4 mView, glm::mat4 mProjection) override;
+
+	// - Dibujar la normal y la profundidad (pre-pasada del contorno en espacio de pantalla)
+	void drawNormals(ShaderProgram &shader, glm::mat4 mModel,
+					 glm::mat4 mView, glm::mat4 mProjection) override;
+
+	// - Dibujar contornos
+	void drawBasicOutline(ShaderProgram &shader, glm::mat4 mModel,
+						  glm::mat4 mView, glm::mat4 mProjection) override;
+
+	void drawAdvancedOutline(ShaderProgram &shader, glm::mat4 mModel,
+							 glm::mat4 mView, glm::mat4 mProjection) override;
+};
\ No newline at end of file
@@ -9,4 +9,7 @@ class LightApplicator
 public:
 	// - Aplicar tipo de luz
 	virtual void apply(ShaderProgram &shader, LightSource *light) = 0;
+
+	// - Variante (permutacin) de los shader programs que iluminan con este tipo de luz
+	virtual ShaderProgramVariant getVariant() = 0;
 };
\ No newline at end of file
@@ -21,6 +21,13 @@ void LightSource::apply(ShaderProgram &shader)
 	}
 }
 
+// - Obtener variante de los shader programs para el tipo de la fuente luminosa (ambiente si no tiene
+//   aplicador)
+ShaderProgramVariant LightSource::getVariant()
+{
+	return applicator != nullptr ? applicator->getVariant() : AMBIENT_LIGHT_VARIANT;
+}
+
 // - Obtener tipo de aplicador
 LightApplicator* LightSource::getApplicator()
 {
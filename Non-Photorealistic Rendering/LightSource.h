@@ -50,6 +50,9 @@ public:
 	// - Aplicar el shader de la fuente luminosa
 	void apply(ShaderProgram &shader);
 
+	// - Variante de los shader programs para el tipo de la fuente luminosa
+	ShaderProgramVariant getVariant();
+
 	// - Getters
 	LightApplicator* getApplicator();
 	std::string getType();
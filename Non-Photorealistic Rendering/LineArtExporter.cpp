@@ -0,0 +1,627 @@
+#include "LineArtExporter.h"
+#include "FeatureEdges.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <xmmintrin.h>
+
+namespace
+{
+	// - Arista sin tringulo vecino pendiente de emparejar: vrtices y normal de su cara
+	struct PendingEdge
+	{
+		unsigned int a;
+		unsigned int b;
+		glm::vec3 normal;
+	};
+
+	// - Clave de un extremo de tramo (cuantizado a 1/16 de pxel), para encadenar los tramos
+	inline uint64_t endpointKey(const glm::vec2 &point)
+	{
+		int64_t x = (int64_t) std::floor(point.x * 16.f + 0.5f);
+		int64_t y = (int64_t) std::floor(point.y * 16.f + 0.5f);
+
+		return ((uint64_t) x << 32) ^ (uint64_t) (uint32_t) y;
+	}
+
+	// - Nmero con dos decimales (SVG y PDF)
+	inline std::string formatNumber(float value)
+	{
+		std::ostringstream stream;
+		stream << std::fixed << std::setprecision(2) << value;
+
+		return stream.str();
+	}
+}
+
+// - Constructor
+LineArtExporter::LineArtExporter(const LineArtSettings &settings)
+{
+	this->settings = settings;
+
+	width = 0;
+	height = 0;
+	depth = nullptr;
+}
+
+// - Aadir una malla (slo las que tienen adyacencias, como el contorno avanzado)
+void LineArtExporter::addMesh(Mesh *mesh, const glm::mat4 &mModel, const glm::vec3 &color, float thickness)
+{
+	LineArtMesh lineArtMesh;
+	lineArtMesh.mesh = mesh;
+	lineArtMesh.mModel = mModel;
+	lineArtMesh.color = color;
+	lineArtMesh.thickness = thickness;
+
+	meshes.push_back(lineArtMesh);
+}
+
+// - Mtodo privado: construir las aristas de una malla a partir de sus adyacencias. Cada arista
+//   interior aparece en los dos tringulos que la comparten y se guarda una vez; las aristas sin
+//   tringulo vecino se emparejan por la posicin de sus vrtices (costuras) y las que siguen solas
+//   son fronteras
+void LineArtExporter::buildEdges(Mesh *mesh, LineArtEdges &edges)
+{
+	const std::vector<PosNorm> &vertices = mesh->getVertices();
+	std::vector<unsigned int> adjacencyIndices = mesh->getAdjacencyIndices();
+
+	for (int side = 0; side < 2; side++)
+	{
+		edges.normalX[side].clear();
+		edges.normalY[side].clear();
+		edges.normalZ[side].clear();
+		edges.distance[side].clear();
+		edges.vertices[side].clear();
+	}
+
+	edges.crease.clear();
+	edges.boundary.clear();
+	edges.numEdges = 0;
+
+	// - Vrtices soldados: primer vrtice con cada posicin
+	std::unordered_map<glm::vec3, unsigned int, WeldHash> positions;
+	std::vector<unsigned int> welded(vertices.size());
+
+	for (unsigned int i = 0; i < vertices.size(); i++)
+	{
+		welded[i] = positions.insert(std::make_pair(vertices[i].position, i)).first->second;
+	}
+
+	float cosCrease = std::cos(glm::radians(settings.creaseAngle));
+
+	auto addEdge = [&](unsigned int a, unsigned int b, const glm::vec3 &normal0, const glm::vec3 &normal1, bool boundary)
+	{
+		const glm::vec3 normals[2] = { normal0, normal1 };
+
+		for (int side = 0; side < 2; side++)
+		{
+			edges.normalX[side].push_back(normals[side].x);
+			edges.normalY[side].push_back(normals[side].y);
+			edges.normalZ[side].push_back(normals[side].z);
+			edges.distance[side].push_back(glm::dot(normals[side], vertices[a].position));
+		}
+
+		bool crease = !boundary && FeatureEdges::isCrease(normal0, normal1, cosCrease);
+
+		edges.vertices[0].push_back(a);
+		edges.vertices[1].push_back(b);
+		edges.crease.push_back(crease ? 1 : 0);
+		edges.boundary.push_back(boundary ? 1 : 0);
+		edges.numEdges++;
+	};
+
+	// - Aristas sin vecino pendientes de emparejar (vrtices soldados en el sentido de la arista)
+	std::map<std::pair<unsigned int, unsigned int>, PendingEdge> pending;
+
+	for (unsigned int i = 0; i + 5 < adjacencyIndices.size(); i += 6)
+	{
+		const unsigned int *index = &adjacencyIndices[i];
+
+		for (unsigned int k = 0; k < 3; k++)
+		{
+			unsigned int a = index[2 * k];
+			unsigned int neighbour = index[2 * k + 1];
+			unsigned int b = index[(2 * k + 2) % 6];
+			unsigned int c = index[(2 * k + 4) % 6];
+
+			if (welded[a] == welded[b])
+			{
+				continue;
+			}
+
+			const glm::vec3 &pa = vertices[a].position;
+			glm::vec3 normal = glm::cross(vertices[b].position - pa, vertices[c].position - pa);
+
+			// - Arista interior (el vecino es el tringulo (a, vecino, b))
+			if (neighbour != c)
+			{
+				if (a < b)
+				{
+					addEdge(a, b, normal, glm::cross(vertices[neighbour].position - pa, vertices[b].position - pa), false);
+				}
+
+				continue;
+			}
+
+			// - Sin vecino: emparejar con la arista opuesta de otra cara en la misma posicin
+			auto opposite = pending.find(std::make_pair(welded[b], welded[a]));
+
+			if (opposite != pending.end())
+			{
+				addEdge(a, b, normal, opposite->second.normal, false);
+				pending.erase(opposite);
+			}
+			else
+			{
+				PendingEdge edge = { a, b, normal };
+				pending[std::make_pair(welded[a], welded[b])] = edge;
+			}
+		}
+	}
+
+	// - Fronteras: la cara opuesta es la misma (nunca son siluetas)
+	for (auto &edge : pending)
+	{
+		addEdge(edge.second.a, edge.second.b, edge.second.normal, edge.second.normal, true);
+	}
+
+	// - Completar el ltimo grupo de cuatro aristas (planos nulos, sin tipo)
+	while (edges.normalX[0].size() % 4 != 0)
+	{
+		for (int side = 0; side < 2; side++)
+		{
+			edges.normalX[side].push_back(0.f);
+			edges.normalY[side].push_back(0.f);
+			edges.normalZ[side].push_back(0.f);
+			edges.distance[side].push_back(0.f);
+		}
+	}
+}
+
+// - Mtodo privado: recortar un segmento con los seis planos del frustum en coordenadas de recorte
+//   (Liang-Barsky)
+bool LineArtExporter::clipSegment(glm::vec4 &a, glm::vec4 &b)
+{
+	float t0 = 0.f;
+	float t1 = 1.f;
+
+	for (int plane = 0; plane < 6; plane++)
+	{
+		float sign = (plane % 2 == 0) ? 1.f : -1.f;
+		int axis = plane / 2;
+		float distanceA = a.w + sign * a[axis];
+		float distanceB = b.w + sign * b[axis];
+
+		if (distanceA < 0.f && distanceB < 0.f)
+		{
+			return false;
+		}
+
+		if (distanceA < 0.f)
+		{
+			t0 = std::max(t0, distanceA / (distanceA - distanceB));
+		}
+		else if (distanceB < 0.f)
+		{
+			t1 = std::min(t1, distanceA / (distanceA - distanceB));
+		}
+	}
+
+	if (t0 > t1)
+	{
+		return false;
+	}
+
+	glm::vec4 clippedA = a + (b - a) * t0;
+	glm::vec4 clippedB = a + (b - a) * t1;
+	a = clippedA;
+	b = clippedB;
+
+	return true;
+}
+
+// - Mtodo privado: distancia a la cmara (en el eje de visin) de una profundidad normalizada
+float LineArtExporter::linearDepth(float ndcDepth) const
+{
+	float denominator = ndcDepth + mProjection[2][2];
+
+	if (std::abs(denominator) < 1e-7f)
+	{
+		return std::numeric_limits<float>::max();
+	}
+
+	return mProjection[3][2] / denominator;
+}
+
+// - Mtodo privado: un punto es visible si no est detrs de la profundidad ms lejana de los
+//   pxeles de alrededor (las siluetas estn en el borde de su superficie, junto al fondo), con una
+//   tolerancia relativa para las aristas que estn sobre la propia superficie
+bool LineArtExporter::isVisible(const glm::vec4 &clip) const
+{
+	glm::vec3 ndc = glm::vec3(clip) / clip.w;
+
+	int x = (int) std::floor((ndc.x * 0.5f + 0.5f) * width);
+	int y = (int) std::floor((ndc.y * 0.5f + 0.5f) * height);
+	float distance = linearDepth(ndc.z);
+	float maxDistance = 0.f;
+
+	for (int dy = -1; dy <= 1; dy++)
+	{
+		for (int dx = -1; dx <= 1; dx++)
+		{
+			int px = std::min(std::max(x + dx, 0), (int) width - 1);
+			int py = std::min(std::max(y + dy, 0), (int) height - 1);
+
+			maxDistance = std::max(maxDistance, linearDepth((*depth)[(size_t) py * width + px] * 2.f - 1.f));
+		}
+	}
+
+	return distance <= maxDistance * (1.f + settings.depthTolerance);
+}
+
+// - Mtodo privado: punto en pantalla de unas coordenadas de recorte
+glm::vec2 LineArtExporter::toScreen(const glm::vec4 &clip) const
+{
+	return glm::vec2((clip.x / clip.w * 0.5f + 0.5f) * width, (0.5f - clip.y / clip.w * 0.5f) * height);
+}
+
+// - Mtodo privado: extraer las lneas de una malla. Las caras de cada arista se comparan con la
+//   posicin del observador (en el espacio del modelo) de cuatro en cuatro: la arista es de la
+//   silueta si una cara es frontal y la otra no. Cada arista seleccionada se recorta con el frustum
+//   y se muestrea una vez por pxel contra el buffer de profundidad
+void LineArtExporter::extractMesh(const LineArtMesh &mesh, std::vector<LineArtPolyline> &result)
+{
+	LineArtEdges edges;
+	buildEdges(mesh.mesh, edges);
+
+	if (edges.numEdges == 0)
+	{
+		return;
+	}
+
+	const std::vector<PosNorm> &vertices = mesh.mesh->getVertices();
+	glm::mat4 mModelView = mView * mesh.mModel;
+	glm::mat4 mvp = mProjection * mModelView;
+	glm::vec3 eye = glm::vec3(glm::inverse(mModelView) * glm::vec4(0.f, 0.f, 0.f, 1.f));
+
+	__m128 eyeX = _mm_set1_ps(eye.x);
+	__m128 eyeY = _mm_set1_ps(eye.y);
+	__m128 eyeZ = _mm_set1_ps(eye.z);
+	__m128 zero = _mm_setzero_ps();
+
+	std::vector<LineArtSegment> segments;
+
+	for (unsigned int group = 0; group < edges.numEdges; group += 4)
+	{
+		int front[2];
+
+		for (int side = 0; side < 2; side++)
+		{
+			__m128 facing = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&edges.normalX[side][group]), eyeX),
+									   _mm_mul_ps(_mm_loadu_ps(&edges.normalY[side][group]), eyeY));
+			facing = _mm_add_ps(facing, _mm_mul_ps(_mm_loadu_ps(&edges.normalZ[side][group]), eyeZ));
+			facing = _mm_sub_ps(facing, _mm_loadu_ps(&edges.distance[side][group]));
+
+			front[side] = _mm_movemask_ps(_mm_cmpgt_ps(facing, zero));
+		}
+
+		int silhouette = front[0] ^ front[1];
+
+		for (unsigned int lane = 0; lane < 4 && group + lane < edges.numEdges; lane++)
+		{
+			unsigned int edge = group + lane;
+
+			if (!((settings.silhouettes && (silhouette & (1 << lane)) != 0) ||
+				  (settings.creases && edges.crease[edge] != 0) ||
+				  (settings.boundaries && edges.boundary[edge] != 0)))
+			{
+				continue;
+			}
+
+			glm::vec4 a = mvp * glm::vec4(vertices[edges.vertices[0][edge]].position, 1.f);
+			glm::vec4 b = mvp * glm::vec4(vertices[edges.vertices[1][edge]].position, 1.f);
+
+			if (!clipSegment(a, b))
+			{
+				continue;
+			}
+
+			// - Muestras (una por pxel) y tramos visibles seguidos
+			unsigned int numSamples = std::max(1u, (unsigned int) std::ceil(glm::length(toScreen(b) - toScreen(a))));
+			int runStart = -1;
+
+			for (unsigned int sample = 0; sample <= numSamples; sample++)
+			{
+				bool visible = isVisible(a + (b - a) * ((float) sample / numSamples));
+
+				if (visible && runStart < 0)
+				{
+					runStart = (int) sample;
+				}
+
+				if ((!visible || sample == numSamples) && runStart >= 0)
+				{
+					int runEnd = visible ? (int) sample : (int) sample - 1;
+
+					if (runEnd > runStart)
+					{
+						glm::vec4 start = a + (b - a) * ((float) runStart / numSamples);
+						glm::vec4 end = a + (b - a) * ((float) runEnd / numSamples);
+
+						// - Grosor: el quad del contorno avanzado mide dos veces el grosor en coordenadas
+						//   de visin
+						LineArtSegment segment;
+						segment.start = toScreen(start);
+						segment.end = toScreen(end);
+						segment.width = mesh.thickness * mProjection[1][1] * height / (0.5f * (start.w + end.w));
+
+						segments.push_back(segment);
+					}
+
+					runStart = -1;
+				}
+			}
+		}
+	}
+
+	chainSegments(segments, mesh.color, result);
+}
+
+// - Mtodo privado: encadenar los tramos que comparten extremos. Cada polilnea empieza en un tramo
+//   libre y se alarga por sus dos extremos mientras haya tramos libres que empiecen o acaben en l.
+//   El grosor es la media de sus tramos (al menos un pxel, para las mallas sin contorno avanzado)
+void LineArtExporter::chainSegments(const std::vector<LineArtSegment> &segments, const glm::vec3 &color,
+									std::vector<LineArtPolyline> &result)
+{
+	std::unordered_map<uint64_t, std::vector<unsigned int>> endpoints;
+
+	for (unsigned int i = 0; i < segments.size(); i++)
+	{
+		endpoints[endpointKey(segments[i].start)].push_back(2 * i);
+		endpoints[endpointKey(segments[i].end)].push_back(2 * i + 1);
+	}
+
+	std::vector<bool> used(segments.size(), false);
+
+	// - Siguiente punto desde un extremo (y marcar su tramo como usado). Devuelve false si no hay
+	auto nextPoint = [&](const glm::vec2 &point, glm::vec2 &next, float &width) -> bool
+	{
+		auto it = endpoints.find(endpointKey(point));
+
+		if (it == endpoints.end())
+		{
+			return false;
+		}
+
+		for (unsigned int endpoint : it->second)
+		{
+			unsigned int segment = endpoint / 2;
+
+			if (!used[segment])
+			{
+				used[segment] = true;
+				next = (endpoint % 2 == 0) ? segments[segment].end : segments[segment].start;
+				width = segments[segment].width;
+
+				return true;
+			}
+		}
+
+		return false;
+	};
+
+	for (unsigned int i = 0; i < segments.size(); i++)
+	{
+		if (used[i])
+		{
+			continue;
+		}
+
+		used[i] = true;
+
+		std::deque<glm::vec2> points = { segments[i].start, segments[i].end };
+		float widthSum = segments[i].width;
+		unsigned int numSegments = 1;
+		glm::vec2 next;
+		float width;
+
+		while (nextPoint(points.back(), next, width))
+		{
+			points.push_back(next);
+			widthSum += width;
+			numSegments++;
+		}
+
+		while (nextPoint(points.front(), next, width))
+		{
+			points.push_front(next);
+			widthSum += width;
+			numSegments++;
+		}
+
+		LineArtPolyline polyline;
+		polyline.points.assign(points.begin(), points.end());
+		polyline.color = color;
+		polyline.width = std::max(1.f, widthSum / numSegments);
+
+		result.push_back(polyline);
+	}
+}
+
+// - Extraer las lneas visibles. Las mallas se reparten entre los hilos: cada hilo toma la
+//   siguiente malla libre y guarda sus polilneas aparte, que se juntan en el orden de las mallas
+void LineArtExporter::extract(const glm::mat4 &mView, const glm::mat4 &mProjection, unsigned int width,
+							  unsigned int height, const std::vector<float> &depth)
+{
+	this->mView = mView;
+	this->mProjection = mProjection;
+	this->width = width;
+	this->height = height;
+	this->depth = &depth;
+
+	polylines.clear();
+
+	if (width == 0 || height == 0 || depth.size() < (size_t) width * height || meshes.empty())
+	{
+		return;
+	}
+
+	std::vector<std::vector<LineArtPolyline>> results(meshes.size());
+	std::atomic<unsigned int> nextMesh(0);
+
+	auto worker = [&]()
+	{
+		while (true)
+		{
+			unsigned int mesh = nextMesh.fetch_add(1);
+
+			if (mesh >= meshes.size())
+			{
+				break;
+			}
+
+			extractMesh(meshes[mesh], results[mesh]);
+		}
+	};
+
+	unsigned int threads = std::min(std::max(1u, std::thread::hardware_concurrency()), (unsigned int) meshes.size());
+	std::vector<std::thread> pool;
+
+	for (unsigned int i = 1; i < threads; i++)
+	{
+		pool.push_back(std::thread(worker));
+	}
+
+	worker();
+
+	for (unsigned int i = 0; i < pool.size(); i++)
+	{
+		pool[i].join();
+	}
+
+	for (unsigned int i = 0; i < results.size(); i++)
+	{
+		polylines.insert(polylines.end(), results[i].begin(), results[i].end());
+	}
+}
+
+// - Obtener nmero de polilneas extradas
+unsigned int LineArtExporter::getNumPolylines()
+{
+	return (unsigned int) polylines.size();
+}
+
+// - Guardar las lneas como SVG: un path por polilnea, sin relleno y con extremos redondeados
+bool LineArtExporter::writeSVG(const std::string &path)
+{
+	std::ofstream file(path);
+
+	if (!file)
+	{
+		std::cout << "Cannot write line art: " << path << std::endl;
+		return false;
+	}
+
+	file << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+	file << "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"" << width << "\" height=\"" << height
+		 << "\" viewBox=\"0 0 " << width << " " << height << "\">\n";
+	file << "<g fill=\"none\" stroke-linecap=\"round\" stroke-linejoin=\"round\">\n";
+
+	for (const LineArtPolyline &polyline : polylines)
+	{
+		glm::ivec3 color = glm::ivec3(glm::clamp(polyline.color, 0.f, 1.f) * 255.f + 0.5f);
+		char hexColor[8];
+		snprintf(hexColor, sizeof(hexColor), "#%02x%02x%02x", color.r, color.g, color.b);
+
+		file << "<path stroke=\"" << hexColor << "\" stroke-width=\"" << formatNumber(polyline.width) << "\" d=\"";
+
+		for (unsigned int i = 0; i < polyline.points.size(); i++)
+		{
+			file << (i == 0 ? "M" : " L") << formatNumber(polyline.points[i].x) << " " << formatNumber(polyline.points[i].y);
+		}
+
+		file << "\"/>\n";
+	}
+
+	file << "</g>\n</svg>\n";
+
+	return (bool) file;
+}
+
+// - Guardar las lneas como PDF: una pgina con un nico content stream sin comprimir (el origen
+//   del PDF est abajo, as que se da la vuelta al eje y)
+bool LineArtExporter::writePDF(const std::string &path)
+{
+	std::ostringstream content;
+	content << "1 J 1 j\n";
+
+	for (const LineArtPolyline &polyline : polylines)
+	{
+		glm::vec3 color = glm::clamp(polyline.color, 0.f, 1.f);
+
+		content << formatNumber(color.r) << " " << formatNumber(color.g) << " " << formatNumber(color.b) << " RG "
+				<< formatNumber(polyline.width) << " w\n";
+
+		for (unsigned int i = 0; i < polyline.points.size(); i++)
+		{
+			content << formatNumber(polyline.points[i].x) << " " << formatNumber(height - polyline.points[i].y)
+					<< (i == 0 ? " m\n" : " l\n");
+		}
+
+		content << "S\n";
+	}
+
+	std::string stream = content.str();
+	std::ostringstream document;
+	std::vector<size_t> offsets;
+
+	document << "%PDF-1.4\n";
+
+	offsets.push_back((size_t) document.tellp());
+	document << "1 0 obj\n<< /Type /Catalog /Pages 2 0 R >>\nendobj\n";
+
+	offsets.push_back((size_t) document.tellp());
+	document << "2 0 obj\n<< /Type /Pages /Kids [3 0 R] /Count 1 >>\nendobj\n";
+
+	offsets.push_back((size_t) document.tellp());
+	document << "3 0 obj\n<< /Type /Page /Parent 2 0 R /MediaBox [0 0 " << width << " " << height
+			 << "] /Resources << >> /Contents 4 0 R >>\nendobj\n";
+
+	offsets.push_back((size_t) document.tellp());
+	document << "4 0 obj\n<< /Length " << stream.size() << " >>\nstream\n" << stream << "endstream\nendobj\n";
+
+	size_t xref = (size_t) document.tellp();
+	document << "xref\n0 " << offsets.size() + 1 << "\n0000000000 65535 f \n";
+
+	for (size_t offset : offsets)
+	{
+		document << std::setw(10) << std::setfill('0') << offset << " 00000 n \n";
+	}
+
+	document << "trailer\n<< /Size " << offsets.size() + 1 << " /Root 1 0 R >>\nstartxref\n" << xref << "\n%%EOF\n";
+
+	std::ofstream file(path, std::ios::binary);
+
+	if (!file)
+	{
+		std::cout << "Cannot write line art: " << path << std::endl;
+		return false;
+	}
+
+	std::string data = document.str();
+	file.write(data.data(), data.size());
+
+	return (bool) file;
+}
\ No newline at end of file
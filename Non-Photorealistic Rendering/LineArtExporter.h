@@ -0,0 +1,116 @@
+#pragma once
+
+#include <glm.hpp>
+#include <string>
+#include <vector>
+
+#include "Structures.h"
+#include "Mesh.h"
+
+// - Malla de la que se extraen las lneas: matriz de modelado y contorno avanzado de su elemento
+//   (color y grosor)
+struct LineArtMesh
+{
+	Mesh *mesh;
+	glm::mat4 mModel;
+	glm::vec3 color;
+	float thickness;
+};
+
+// - Aristas de una malla en estructura de arrays (para compararlas de cuatro en cuatro con SSE):
+//   planos de las dos caras (normal y distancia), vrtices y tipo. Las aristas frontera repiten el
+//   plano de su nica cara
+struct LineArtEdges
+{
+	std::vector<float> normalX[2];
+	std::vector<float> normalY[2];
+	std::vector<float> normalZ[2];
+	std::vector<float> distance[2];
+	std::vector<unsigned int> vertices[2];
+	std::vector<unsigned char> crease;
+	std::vector<unsigned char> boundary;
+	unsigned int numEdges;
+};
+
+// - Tramo visible de una arista en pantalla (pxeles, y hacia abajo) y su grosor en pxeles
+struct LineArtSegment
+{
+	glm::vec2 start;
+	glm::vec2 end;
+	float width;
+};
+
+// - Polilnea del dibujo: puntos en pantalla, color y grosor (pxeles)
+struct LineArtPolyline
+{
+	std::vector<glm::vec2> points;
+	glm::vec3 color;
+	float width;
+};
+
+// - La clase LineArtExporter extrae en la CPU las aristas de la silueta, los pliegues (ngulo
+//   diedro mayor que un umbral) y las fronteras de las mallas de la escena para la cmara actual, y
+//   las exporta como trazos vectoriales (SVG o PDF) que no dependen de la resolucin. Las aristas
+//   se obtienen de las adyacencias de cada malla (construidas con los half-edges del modelo); las
+//   fronteras con vrtices en la misma posicin (costuras de coordenadas de textura) se unen. La
+//   visibilidad se resuelve muestreando cada arista contra un buffer de profundidad de la escena,
+//   y los tramos visibles se encadenan en polilneas. Las mallas se procesan en paralelo y, en
+//   cada malla, las caras de cuatro aristas se comparan con el observador a la vez
+class LineArtExporter
+{
+private:
+	// - Parmetros y mallas
+	LineArtSettings settings;
+	std::vector<LineArtMesh> meshes;
+
+	// - Cmara, tamao del viewport y profundidad de la escena (fila 0 = fila inferior)
+	glm::mat4 mView;
+	glm::mat4 mProjection;
+	unsigned int width;
+	unsigned int height;
+	const std::vector<float> *depth;
+
+	// - Polilneas extradas
+	std::vector<LineArtPolyline> polylines;
+
+	// - Construir las aristas de una malla
+	void buildEdges(Mesh *mesh, LineArtEdges &edges);
+
+	// - Extraer los tramos visibles de las aristas seleccionadas de una malla
+	void extractMesh(const LineArtMesh &mesh, std::vector<LineArtPolyline> &result);
+
+	// - Recortar un segmento (coordenadas de recorte) con el frustum. Devuelve false si queda fuera
+	static bool clipSegment(glm::vec4 &a, glm::vec4 &b);
+
+	// - Distancia a la cmara de una profundidad en coordenadas normalizadas
+	float linearDepth(float ndcDepth) const;
+
+	// - Saber si un punto (coordenadas de recorte) es visible segn el buffer de profundidad
+	bool isVisible(const glm::vec4 &clip) const;
+
+	// - Punto en pantalla (pxeles, y hacia abajo) de unas coordenadas de recorte
+	glm::vec2 toScreen(const glm::vec4 &clip) const;
+
+	// - Encadenar los tramos de una malla en polilneas
+	static void chainSegments(const std::vector<LineArtSegment> &segments, const glm::vec3 &color,
+							  std::vector<LineArtPolyline> &result);
+
+public:
+	// - Constructor
+	LineArtExporter(const LineArtSettings &settings);
+
+	// - Aadir una malla
+	void addMesh(Mesh *mesh, const glm::mat4 &mModel, const glm::vec3 &color, float thickness);
+
+	// - Extraer las lneas visibles para una cmara y un buffer de profundidad (profundidad de la
+	//   ventana, de 0 a 1, de tamao width x height)
+	void extract(const glm::mat4 &mView, const glm::mat4 &mProjection, unsigned int width, unsigned int height,
+				 const std::vector<float> &depth);
+
+	// - Polilneas extradas
+	unsigned int getNumPolylines();
+
+	// - Guardar las lneas como SVG o PDF (una pgina del tamao del viewport, un punto por pxel)
+	bool writeSVG(const std::string &path);
+	bool writePDF(const std::string &path);
+};
\ No newline at end of file
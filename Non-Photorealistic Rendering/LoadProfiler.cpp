@@ -0,0 +1,272 @@
+#include "LoadProfiler.h"
+
+#include <fstream>
+#include <iomanip>
+
+// - Singleton (inicializacin perezosa)
+LoadProfiler* LoadProfiler::instance = nullptr;
+
+// - Constructor
+LoadProfiler::LoadProfiler()
+{
+	enabled = false;
+	output = "";
+	sceneActive = false;
+	assetIndex = -1;
+}
+
+// - Acceder al singleton
+LoadProfiler* LoadProfiler::getInstance()
+{
+	if (instance == nullptr)
+	{
+		instance = new LoadProfiler();
+	}
+
+	return instance;
+}
+
+// - Activar el perfilado detallado
+void LoadProfiler::setEnabled(bool enabled, const std::string &output)
+{
+	this->enabled = enabled;
+	this->output = output;
+}
+
+// - Saber si el perfilado detallado est activado
+bool LoadProfiler::isEnabled()
+{
+	return enabled;
+}
+
+// - Inicio de escena. Sin perfilado no se guarda nada: las escenas se cargan y descargan durante la
+//   sesin y los informes creceran sin lmite
+void LoadProfiler::beginScene(const std::string &name)
+{
+	if (!enabled)
+	{
+		return;
+	}
+
+	LoadSceneReport scene;
+	scene.name = name;
+	scenes.push_back(scene);
+
+	sceneActive = true;
+	assetIndex = -1;
+}
+
+// - Fin de escena: se muestra el informe y se vuelca a fichero
+void LoadProfiler::endScene()
+{
+	if (!sceneActive)
+	{
+		return;
+	}
+
+	sceneActive = false;
+	assetIndex = -1;
+
+	if (enabled)
+	{
+		printScene(scenes.back());
+
+		if (!output.empty())
+		{
+			writeJSON(output);
+		}
+	}
+}
+
+// - Inicio de recurso
+void LoadProfiler::beginAsset(const std::string &name)
+{
+	if (!enabled)
+	{
+		return;
+	}
+
+	if (!sceneActive)
+	{
+		beginScene("(no scene)");
+	}
+
+	LoadAssetReport asset;
+	asset.name = name;
+	scenes.back().assets.push_back(asset);
+	assetIndex = scenes.back().assets.size() - 1;
+}
+
+// - Fin de recurso. Las medidas siguientes van al recurso "otros" de la escena
+void LoadProfiler::endAsset()
+{
+	assetIndex = -1;
+}
+
+// - Recurso al que se asignan las medidas fuera de un modelo
+void LoadProfiler::ensureAsset()
+{
+	if (!sceneActive)
+	{
+		beginScene("(no scene)");
+	}
+
+	if (assetIndex < 0)
+	{
+		std::vector<LoadAssetReport> &assets = scenes.back().assets;
+
+		for (unsigned int i = 0; i < assets.size(); i++)
+		{
+			if (assets[i].name == "(other assets)")
+			{
+				assetIndex = i;
+				return;
+			}
+		}
+
+		LoadAssetReport asset;
+		asset.name = "(other assets)";
+		assets.push_back(asset);
+		assetIndex = assets.size() - 1;
+	}
+}
+
+// - Registrar una fase. Las fases repetidas (una por malla o por textura) se acumulan
+void LoadProfiler::record(const std::string &phase, double milliseconds, size_t bytes)
+{
+	if (!enabled)
+	{
+		return;
+	}
+
+	int previousAsset = assetIndex;
+	ensureAsset();
+
+	std::vector<LoadPhaseRecord> &phases = scenes.back().assets[assetIndex].phases;
+
+	// - Las medidas sueltas no fijan el recurso "otros" como recurso activo
+	if (previousAsset < 0)
+	{
+		assetIndex = -1;
+	}
+
+	for (unsigned int i = 0; i < phases.size(); i++)
+	{
+		if (phases[i].phase == phase)
+		{
+			phases[i].milliseconds += milliseconds;
+			phases[i].bytes += bytes;
+			phases[i].count++;
+			return;
+		}
+	}
+
+	LoadPhaseRecord record;
+	record.phase = phase;
+	record.milliseconds = milliseconds;
+	record.bytes = bytes;
+	record.count = 1;
+	phases.push_back(record);
+}
+
+// - Sumar las fases de un recurso
+LoadPhaseRecord LoadProfiler::totalOf(const LoadAssetReport &asset)
+{
+	LoadPhaseRecord total;
+	total.phase = "Total";
+	total.milliseconds = 0.0;
+	total.bytes = 0;
+	total.count = 0;
+
+	for (const LoadPhaseRecord &phase : asset.phases)
+	{
+		total.milliseconds += phase.milliseconds;
+		total.bytes += phase.bytes;
+		total.count += phase.count;
+	}
+
+	return total;
+}
+
+// - Mostrar informe de una escena por consola
+void LoadProfiler::printScene(const LoadSceneReport &scene)
+{
+	double sceneMilliseconds = 0.0;
+	size_t sceneBytes = 0;
+
+	std::cout << std::fixed << std::setprecision(2);
+	std::cout << "==== Load profile: " << scene.name << " ====" << std::endl;
+
+	for (const LoadAssetReport &asset : scene.assets)
+	{
+		LoadPhaseRecord total = totalOf(asset);
+		sceneMilliseconds += total.milliseconds;
+		sceneBytes += total.bytes;
+
+		std::cout << asset.name << " (" << total.milliseconds << " ms, "
+				  << total.bytes / (1024.0 * 1024.0) << " MB)" << std::endl;
+
+		for (const LoadPhaseRecord &phase : asset.phases)
+		{
+			std::cout << "    " << std::left << std::setw(40) << phase.phase << std::right
+					  << std::setw(10) << phase.milliseconds << " ms "
+					  << std::setw(10) << phase.bytes / (1024.0 * 1024.0) << " MB "
+					  << " x" << phase.count << std::endl;
+		}
+	}
+
+	std::cout << "Scene total: " << sceneMilliseconds << " ms, "
+			  << sceneBytes / (1024.0 * 1024.0) << " MB" << std::endl;
+	std::cout.unsetf(std::ios::fixed);
+	std::cout << std::setprecision(6);
+}
+
+// - Volcar todas las escenas cargadas a JSON
+bool LoadProfiler::writeJSON(const std::string &filename)
+{
+	std::ofstream file(filename);
+
+	if (!file)
+	{
+		std::cout << "Cannot write load profile: " << filename << std::endl;
+		return false;
+	}
+
+	file << "{" << std::endl << "  \"scenes\": [" << std::endl;
+
+	for (unsigned int s = 0; s < scenes.size(); s++)
+	{
+		double sceneMilliseconds = 0.0;
+		size_t sceneBytes = 0;
+
+		file << "    { \"name\": \"" << scenes[s].name << "\", \"assets\": [" << std::endl;
+
+		for (unsigned int a = 0; a < scenes[s].assets.size(); a++)
+		{
+			const LoadAssetReport &asset = scenes[s].assets[a];
+			LoadPhaseRecord total = totalOf(asset);
+			sceneMilliseconds += total.milliseconds;
+			sceneBytes += total.bytes;
+
+			file << "      { \"name\": \"" << asset.name << "\", \"ms\": " << total.milliseconds
+				 << ", \"bytes\": " << total.bytes << ", \"phases\": [" << std::endl;
+
+			for (unsigned int p = 0; p < asset.phases.size(); p++)
+			{
+				const LoadPhaseRecord &phase = asset.phases[p];
+				file << "        { \"phase\": \"" << phase.phase << "\", \"ms\": " << phase.milliseconds
+					 << ", \"bytes\": " << phase.bytes << ", \"count\": " << phase.count << " }"
+					 << (p + 1 < asset.phases.size() ? "," : "") << std::endl;
+			}
+
+			file << "      ] }" << (a + 1 < scenes[s].assets.size() ? "," : "") << std::endl;
+		}
+
+		file << "    ], \"ms\": " << sceneMilliseconds << ", \"bytes\": " << sceneBytes << " }"
+			 << (s + 1 < scenes.size() ? "," : "") << std::endl;
+	}
+
+	file << "  ]" << std::endl << "}" << std::endl;
+
+	return true;
+}
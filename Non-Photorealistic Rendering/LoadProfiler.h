@@ -0,0 +1,103 @@
+#pragma once
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// - Tiempo y memoria registrados para una fase de carga
+struct LoadPhaseRecord
+{
+	std::string phase;
+	double milliseconds;
+	size_t bytes;
+	unsigned int count;
+};
+
+// - Desglose de carga de un recurso (modelo o recursos sueltos de la escena)
+struct LoadAssetReport
+{
+	std::string name;
+	std::vector<LoadPhaseRecord> phases;
+};
+
+// - Desglose de carga de una escena
+struct LoadSceneReport
+{
+	std::string name;
+	std::vector<LoadAssetReport> assets;
+};
+
+// - La clase LoadProfiler registra el tiempo y los bytes reservados en cada fase de la carga
+//   de modelos (importacin de Assimp por paso de post-procesamiento, copia de vrtices,
+//   construccin de half-edges y adyacencias, decodificacin y subida de texturas, subida de
+//   VBOs). Se implementa como un singleton para que puedan usarla Model, Texture y Renderer
+class LoadProfiler
+{
+private:
+	// - Singleton
+	static LoadProfiler* instance;
+
+	// - Constructor privado (singleton)
+	LoadProfiler();
+
+	// - Informe activo y escenas completadas
+	bool enabled;
+	std::string output;
+	std::vector<LoadSceneReport> scenes;
+	bool sceneActive;
+	int assetIndex;
+
+	// - Recurso al que se asignan las medidas fuera de un modelo (hatching, skybox, plano...)
+	void ensureAsset();
+
+	// - Sumar las fases de un recurso
+	static LoadPhaseRecord totalOf(const LoadAssetReport &asset);
+
+public:
+	// - Acceder al singleton
+	static LoadProfiler* getInstance();
+
+	// - Activar el perfilado detallado (post-procesamiento de Assimp paso a paso, informe por
+	//   consola y volcado a fichero)
+	void setEnabled(bool enabled, const std::string &output);
+	bool isEnabled();
+
+	// - Inicio y fin de escena
+	void beginScene(const std::string &name);
+	void endScene();
+
+	// - Inicio y fin de recurso (modelo)
+	void beginAsset(const std::string &name);
+	void endAsset();
+
+	// - Registrar una fase
+	void record(const std::string &phase, double milliseconds, size_t bytes);
+
+	// - Mostrar informe de una escena por consola
+	void printScene(const LoadSceneReport &scene);
+
+	// - Volcar todas las escenas cargadas a JSON
+	bool writeJSON(const std::string &filename);
+};
+
+// - Medidor de una fase: se crea al empezar y se detiene indicando los bytes reservados
+class LoadPhaseTimer
+{
+private:
+	std::string phase;
+	std::chrono::high_resolution_clock::time_point start;
+
+public:
+	LoadPhaseTimer(const std::string &phase)
+	{
+		this->phase = phase;
+		this->start = std::chrono::high_resolution_clock::now();
+	}
+
+	void stop(size_t bytes)
+	{
+		std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+		LoadProfiler::getInstance()->record(phase, std::chrono::duration<double, std::milli>(end - start).count(), bytes);
+	}
+};
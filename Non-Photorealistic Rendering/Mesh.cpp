@@ -1,5 +1,17 @@
 #include "Mesh.h"
 
+#include <algorithm>
+#include <cmath>
+
+#include "MeshSimplifier.h"
+#include "SilhouetteExtractor.h"
+#include "TransformCache.h"
+
+// - Tamao proyectado (radio en coordenadas normalizadas) por debajo del cual se pasa a cada nivel
+//   de detalle, e histresis relativa de los umbrales
+static const float LOD_SCREEN_SIZE[Mesh::MAX_LODS - 1] = { 0.5f, 0.25f, 0.1f };
+static const float LOD_HYSTERESIS = 0.1f;
+
 // - Constructor
 Mesh::Mesh(std::vector<PosNorm> vertices, std::vector<glm::vec2> texCoords,
 		   std::vector<unsigned int> topology, std::vector<Texture*> textures)
@@ -9,6 +21,22 @@ Mesh::Mesh(std::vector<PosNorm> vertices, std::vector<glm::vec2> texCoords,
 	this->topology = topology;
 	this->textures = textures;
 
+	// - Volmenes envolventes
+	computeBounds();
+
+	// - Nivel de detalle (slo la malla original), todava sin ndices subidos
+	currentLOD = 0;
+	uploadedLOD[0] = uploadedLOD[1] = -1;
+	geometry = GeometryStore::NO_GEOMETRY;
+
+	// - Dibujado normal (sin instancias), con todas las adyacencias
+	numInstances = 0;
+	silhouetteSelected = false;
+
+	// - Vrtices sin transformar en la cach de transformaciones
+	transformFrame = 0;
+	transformOffset = 0;
+
 	// - Creacin de VAO y VBOs
 	vao = new VAO();
 	vao->fillVBO(this->vertices, this->texCoords);
@@ -25,6 +53,22 @@ Mesh::Mesh(std::vector<PosNorm> vertices, std::vector<glm::vec2> texCoords,
 	this->topology = topology;
 	this->textures = textures;
 
+	// - Volmenes envolventes
+	computeBounds();
+
+	// - Nivel de detalle (slo la malla original), todava sin ndices subidos
+	currentLOD = 0;
+	uploadedLOD[0] = uploadedLOD[1] = -1;
+	geometry = GeometryStore::NO_GEOMETRY;
+
+	// - Dibujado normal (sin instancias), con todas las adyacencias
+	numInstances = 0;
+	silhouetteSelected = false;
+
+	// - Vrtices sin transformar en la cach de transformaciones
+	transformFrame = 0;
+	transformOffset = 0;
+
 	// - Creacin de VAO y VBOs
 	vao = new VAO();
 	vao->fillVBO(this->vertices, this->texCoords, this->tangents);
@@ -42,6 +86,22 @@ Mesh::Mesh(std::vector<PosNorm> vertices, std::vector<glm::vec2> texCoords,
 	this->topology = topology;
 	this->textures = textures;
 
+	// - Volmenes envolventes
+	computeBounds();
+
+	// - Nivel de detalle (slo la malla original), todava sin ndices subidos
+	currentLOD = 0;
+	uploadedLOD[0] = uploadedLOD[1] = -1;
+	geometry = GeometryStore::NO_GEOMETRY;
+
+	// - Dibujado normal (sin instancias), con todas las adyacencias
+	numInstances = 0;
+	silhouetteSelected = false;
+
+	// - Vrtices sin transformar en la cach de transformaciones
+	transformFrame = 0;
+	transformOffset = 0;
+
 	// - Creacin de VAO y VBOs
 	vao = new VAO();
 	vao->fillVBO(this->vertices, this->texCoords, this->tangents, this->bitangents);
@@ -61,6 +121,22 @@ Mesh::Mesh(std::vector<PosNorm> vertices, std::vector<glm::vec2> texCoords,
 	this->adjacencyIndices = adjacencyIndices;
 	this->textures = textures;
 
+	// - Volmenes envolventes
+	computeBounds();
+
+	// - Nivel de detalle (slo la malla original), todava sin ndices subidos
+	currentLOD = 0;
+	uploadedLOD[0] = uploadedLOD[1] = -1;
+	geometry = GeometryStore::NO_GEOMETRY;
+
+	// - Dibujado normal (sin instancias), con todas las adyacencias
+	numInstances = 0;
+	silhouetteSelected = false;
+
+	// - Vrtices sin transformar en la cach de transformaciones
+	transformFrame = 0;
+	transformOffset = 0;
+
 	// - Creacin de VAO y VBOs
 	vao = new VAO();
 	vao->fillVBO(this->vertices, this->texCoords, this->tangents, this->bitangents);
@@ -75,6 +151,445 @@ Mesh::~Mesh()
 	bitangents.clear();
 	topology.clear();
 	textures.clear();
+
+	GeometryStore::getInstance()->remove(geometry);
+	delete vao;
+}
+
+// - Calcular caja y esfera envolventes de la malla
+void Mesh::computeBounds()
+{
+	bounds = AABB::fromVertices(vertices);
+	boundingSphere = BoundingSphere::fromVertices(vertices, bounds);
+
+	visible = true;
+	outlineVisible = true;
+}
+
+// - Obtener caja envolvente
+AABB Mesh::getBounds()
+{
+	return bounds;
+}
+
+// - Obtener esfera envolvente
+BoundingSphere Mesh::getBoundingSphere()
+{
+	return boundingSphere;
+}
+
+// - Saber si la malla es visible en el frame actual
+bool Mesh::isVisible()
+{
+	return visible;
+}
+
+// - Saber si el contorno de la malla es visible en el frame actual
+bool Mesh::isOutlineVisible()
+{
+	return outlineVisible;
+}
+
+// - Asignar visibilidad para el frame actual
+void Mesh::setVisibility(bool visible, bool outlineVisible)
+{
+	this->visible = visible;
+	this->outlineVisible = outlineVisible;
+}
+
+// - Interseccin de un rayo con los tringulos de la malla (Mller-Trumbore, por ambas caras)
+bool Mesh::intersectRay(const glm::vec3 &origin, const glm::vec3 &direction, float &distance)
+{
+	bool hit = false;
+	distance = std::numeric_limits<float>::max();
+
+	for (unsigned int i = 0; i + 2 < topology.size(); i += 3)
+	{
+		const glm::vec3 &v0 = vertices[topology[i]].position;
+		const glm::vec3 &v1 = vertices[topology[i + 1]].position;
+		const glm::vec3 &v2 = vertices[topology[i + 2]].position;
+
+		glm::vec3 edge1 = v1 - v0;
+		glm::vec3 edge2 = v2 - v0;
+		glm::vec3 p = glm::cross(direction, edge2);
+		float determinant = glm::dot(edge1, p);
+
+		if (std::abs(determinant) < 1e-12f)
+		{
+			continue;
+		}
+
+		float inverseDeterminant = 1.f / determinant;
+		glm::vec3 s = origin - v0;
+		float u = glm::dot(s, p) * inverseDeterminant;
+
+		if (u < 0.f || u > 1.f)
+		{
+			continue;
+		}
+
+		glm::vec3 q = glm::cross(s, edge1);
+		float v = glm::dot(direction, q) * inverseDeterminant;
+
+		if (v < 0.f || u + v > 1.f)
+		{
+			continue;
+		}
+
+		float t = glm::dot(edge2, q) * inverseDeterminant;
+
+		if (t > 0.f && t < distance)
+		{
+			distance = t;
+			hit = true;
+		}
+	}
+
+	return hit;
+}
+
+// - Generar los niveles de detalle: cada nivel se simplifica a partir del anterior. Se deja de
+//   generar niveles cuando la malla es pequea o la simplificacin apenas reduce tringulos
+size_t Mesh::generateLODs(unsigned int levels)
+{
+	size_t bytes = 0;
+	lods.clear();
+	currentLOD = 0;
+	uploadedLOD[0] = uploadedLOD[1] = -1;
+
+	const std::vector<unsigned int> *previous = &topology;
+
+	for (unsigned int level = 1; level < std::min(levels, MAX_LODS); level++)
+	{
+		unsigned int previousTriangles = (unsigned int) previous->size() / 3;
+
+		if (previousTriangles < 2 * MIN_LOD_TRIANGLES)
+		{
+			break;
+		}
+
+		MeshLOD lod;
+		lod.topology = MeshSimplifier::simplify(vertices, *previous, previousTriangles / 2);
+
+		if (lod.topology.size() / 3 > previousTriangles * 9 / 10)
+		{
+			break;
+		}
+
+		// - Adyacencias slo si la malla original las tiene (contorno avanzado)
+		if (!adjacencyIndices.empty())
+		{
+			lod.adjacencyIndices = MeshSimplifier::buildAdjacencyIndices(lod.topology);
+		}
+
+		bytes += sizeof(unsigned int) * (lod.topology.size() + lod.adjacencyIndices.size());
+
+		lods.push_back(lod);
+		previous = &lods.back().topology;
+	}
+
+	return bytes;
+}
+
+// - Seleccionar el nivel de detalle. Para pasar a un nivel ms simple hay que bajar de su umbral
+//   reducido en la histresis, y para volver a uno ms detallado hay que superar el umbral ampliado
+void Mesh::selectLOD(float screenSize)
+{
+	currentLOD = chooseLOD(screenSize, currentLOD, (unsigned int) lods.size() + 1);
+}
+
+// - Nivel de detalle para un tamao en pantalla, partiendo del nivel actual (tambin se usa para
+//   cada instancia de un modelo instanciado)
+unsigned int Mesh::chooseLOD(float screenSize, unsigned int currentLOD, unsigned int numLODs)
+{
+	unsigned int target = 0;
+
+	for (unsigned int level = 0; level + 1 < std::min(numLODs, MAX_LODS); level++)
+	{
+		float threshold = LOD_SCREEN_SIZE[level] * (currentLOD > level ? 1.f + LOD_HYSTERESIS : 1.f - LOD_HYSTERESIS);
+
+		if (screenSize >= threshold)
+		{
+			break;
+		}
+
+		target = level + 1;
+	}
+
+	return target;
+}
+
+// - Fijar el nivel de detalle
+void Mesh::setLOD(unsigned int lod)
+{
+	currentLOD = std::min(lod, (unsigned int) lods.size());
+}
+
+// - Nmero de niveles de detalle (incluida la malla original)
+unsigned int Mesh::getNumLODs()
+{
+	return (unsigned int) lods.size() + 1;
+}
+
+// - Nivel de detalle seleccionado
+unsigned int Mesh::getCurrentLOD()
+{
+	return currentLOD;
+}
+
+// - Nmero de tringulos de un nivel de detalle
+unsigned int Mesh::getNumTriangles(unsigned int lod)
+{
+	if (lod == 0 || lod > lods.size())
+	{
+		return (unsigned int) topology.size() / 3;
+	}
+
+	return (unsigned int) lods[lod - 1].topology.size() / 3;
+}
+
+// - Mtodo privado: topologa del nivel de detalle seleccionado
+const std::vector<unsigned int>& Mesh::getLODTopology()
+{
+	return currentLOD == 0 ? topology : lods[currentLOD - 1].topology;
+}
+
+// - Mtodo privado: ndices de adyacencia del nivel de detalle seleccionado
+const std::vector<unsigned int>& Mesh::getLODAdjacencyIndices()
+{
+	return currentLOD == 0 ? adjacencyIndices : lods[currentLOD - 1].adjacencyIndices;
+}
+
+// - Mtodo privado: jerarqua de siluetas del nivel de detalle seleccionado
+SilhouetteClusters& Mesh::getLODSilhouetteClusters()
+{
+	return currentLOD == 0 ? silhouetteClusters : lods[currentLOD - 1].silhouetteClusters;
+}
+
+// - Construir las jerarquas de siluetas de las adyacencias de cada nivel de detalle
+size_t Mesh::buildSilhouetteClusters()
+{
+	size_t bytes = silhouetteClusters.build(adjacencyIndices, vertices);
+
+	for (unsigned int i = 0; i < lods.size(); i++)
+	{
+		bytes += lods[i].silhouetteClusters.build(lods[i].adjacencyIndices, vertices);
+	}
+
+	uploadedLOD[1] = -1;
+
+	return bytes;
+}
+
+// - Seleccionar los rangos de las adyacencias del nivel de detalle actual que pueden tener aristas
+//   de la silueta. Sin direccin de visin (instancias con orientaciones distintas) o sin jerarqua,
+//   se dibujan todas
+void Mesh::selectSilhouetteClusters(const glm::vec3 *viewDirection)
+{
+	SilhouetteClusters &clusters = getLODSilhouetteClusters();
+	silhouetteSelected = viewDirection != nullptr && clusters.isBuilt();
+
+	if (silhouetteSelected)
+	{
+		clusters.select(*viewDirection, silhouetteRanges);
+	}
+}
+
+// - Asignar las aristas caractersticas y subirlas a su IBO (siempre son las de la malla original,
+//   tambin con niveles de detalle, porque los vrtices son los mismos)
+size_t Mesh::setFeatureEdges(const std::vector<unsigned int> &indices)
+{
+	featureEdges = indices;
+	vao->fillIBOLines(featureEdges);
+
+	return sizeof(unsigned int) * featureEdges.size();
+}
+
+// - Obtener nmero de aristas caractersticas
+unsigned int Mesh::getNumFeatureEdges()
+{
+	return (unsigned int) featureEdges.size() / 2;
+}
+
+// - Mtodo privado: subir al IBO la topologa (o las adyacencias) del nivel de detalle seleccionado.
+//   Los ndices slo se suben cuando cambia el nivel de detalle
+void Mesh::uploadLOD(bool adjacencies)
+{
+	if (uploadedLOD[adjacencies ? 1 : 0] != (int) currentLOD)
+	{
+		if (adjacencies)
+		{
+			vao->fillIBOAdjacencies(getLODAdjacencyIndices());
+		}
+		else
+		{
+			vao->fillIBO(getLODTopology());
+		}
+
+		uploadedLOD[adjacencies ? 1 : 0] = (int) currentLOD;
+	}
+}
+
+// - Mtodo privado: dibujar la topologa (o las adyacencias) del nivel de detalle seleccionado
+void Mesh::drawLOD(bool adjacencies)
+{
+	const std::vector<unsigned int> &indices = adjacencies ? getLODAdjacencyIndices() : getLODTopology();
+	GLenum mode = adjacencies ? GL_TRIANGLES_ADJACENCY : GL_TRIANGLES;
+
+	uploadLOD(adjacencies);
+
+	if (numInstances > 0)
+	{
+		vao->drawInstanced(mode, indices, numInstances);
+	}
+	else
+	{
+		vao->draw(mode, indices);
+	}
+}
+
+// - Dibujado instanciado: enlazar (o desenlazar) los atributos de instancia en el VAO de la malla
+void Mesh::setInstances(GLuint instanceBuffer, unsigned int firstInstance, unsigned int numInstances)
+{
+	this->numInstances = numInstances;
+
+	vao->setInstanceBuffer(numInstances > 0 ? instanceBuffer : 0, firstInstance);
+}
+
+// - Saber si la malla se est dibujando de forma instanciada
+bool Mesh::isInstanced()
+{
+	return numInstances > 0;
+}
+
+// - Obtener VAO con el que se dibuja la malla
+GLuint Mesh::getVertexArray()
+{
+	GeometryStore *store = GeometryStore::getInstance();
+
+	if (geometry != GeometryStore::NO_GEOMETRY && store->isEnabled() && !isInstanced())
+	{
+		return store->getVertexArray();
+	}
+
+	return vao->getId();
+}
+
+// - Transformar los vrtices de la malla (todos: los niveles de detalle los comparten) y guardarlos
+//   en la cach de transformaciones
+void Mesh::captureTransform(size_t offset)
+{
+	TransformCache *cache = TransformCache::getInstance();
+	cache->capture(vao, (unsigned int) vertices.size(), offset);
+
+	transformFrame = cache->getFrame();
+	transformOffset = offset;
+}
+
+// - Saber si los vrtices de la malla estn en la cach de transformaciones
+bool Mesh::isTransformCached()
+{
+	return transformFrame == TransformCache::getInstance()->getFrame();
+}
+
+// - Leer la posicin y la normal de la cach de transformaciones (o volver a leerlas del VAO)
+void Mesh::bindTransformCache(bool enabled)
+{
+	vao->setVertexBuffer(enabled ? TransformCache::getInstance()->getBuffer() : 0, transformOffset);
+}
+
+// - Obtener nmero de vrtices de la malla
+unsigned int Mesh::getNumVertices()
+{
+	return (unsigned int) vertices.size();
+}
+
+// - Copiar la malla al almacn de geometra: vrtices una sola vez e ndices de cada nivel de detalle
+size_t Mesh::addToGeometryStore()
+{
+	GeometryStore *store = GeometryStore::getInstance();
+	size_t bytes = store->getMemory();
+
+	GeometryRange range;
+	range.baseVertex = store->addVertices(vertices, texCoords);
+
+	for (unsigned int lod = 0; lod < getNumLODs(); lod++)
+	{
+		range.topology.push_back(store->addIndices(lod == 0 ? topology : lods[lod - 1].topology));
+		range.adjacencyIndices.push_back(store->addIndices(lod == 0 ? adjacencyIndices : lods[lod - 1].adjacencyIndices));
+	}
+
+	store->remove(geometry);
+	geometry = store->addGeometry(range, (unsigned int) vertices.size());
+
+	return store->getMemory() - bytes;
+}
+
+// - Aadir al lote actual la topologa (o las adyacencias) del nivel de detalle seleccionado
+void Mesh::addToBatch(bool adjacencies)
+{
+	if (geometry == GeometryStore::NO_GEOMETRY)
+	{
+		return;
+	}
+
+	GeometryStore *store = GeometryStore::getInstance();
+	const GeometryRange &range = store->getGeometry(geometry);
+	const std::vector<IndexRange> &ranges = adjacencies ? range.adjacencyIndices : range.topology;
+
+	// - Contorno avanzado: slo los rangos que pueden tener aristas de la silueta
+	if (adjacencies && silhouetteSelected)
+	{
+		for (const IndexRange &silhouetteRange : silhouetteRanges)
+		{
+			store->addDraw(IndexRange(ranges[currentLOD].firstIndex + silhouetteRange.firstIndex, silhouetteRange.count),
+						   range.baseVertex);
+		}
+
+		return;
+	}
+
+	store->addDraw(ranges[currentLOD], range.baseVertex);
+}
+
+// - Sumar la memoria de la malla: atributos de vrtice e ndices (en la GPU slo estn los del nivel
+//   de detalle subido; en CPU se guardan los de todos los niveles) y su copia en el almacn de
+//   geometra
+void Mesh::addMemoryUsage(MemoryUsage &usage)
+{
+	size_t vertexBytes = sizeof(PosNorm) * vertices.size() + sizeof(glm::vec2) * texCoords.size() +
+						 sizeof(glm::vec3) * (tangents.size() + bitangents.size());
+	size_t indexBytes = sizeof(unsigned int) * (topology.size() + adjacencyIndices.size() + featureEdges.size());
+
+	for (unsigned int i = 0; i < lods.size(); i++)
+	{
+		indexBytes += sizeof(unsigned int) * (lods[i].topology.size() + lods[i].adjacencyIndices.size());
+	}
+
+	// - Copia de la malla en el almacn de geometra (en la GPU y en la CPU)
+	size_t storeBytes = GeometryStore::getInstance()->getGeometryMemory(geometry);
+
+	usage.gpuBytes += vertexBytes + sizeof(unsigned int) * (getLODTopology().size() + getLODAdjacencyIndices().size() +
+														   featureEdges.size()) + storeBytes;
+	usage.hostBytes += vertexBytes + indexBytes + storeBytes;
+}
+
+// - Obtener texturas
+const std::vector<Texture*>& Mesh::getTextures()
+{
+	return textures;
+}
+
+// - Obtener vrtices (posicin y normal)
+const std::vector<PosNorm>& Mesh::getVertices()
+{
+	return vertices;
+}
+
+// - Obtener coordenadas de textura
+const std::vector<glm::vec2>& Mesh::getTexCoords()
+{
+	return texCoords;
 }
 
 // - Obtener ndices de topologa
@@ -93,6 +608,8 @@ std::vector<unsigned int> Mesh::getAdjacencyIndices()
 void Mesh::setAdjacencyIndices(std::vector<unsigned int> adjacencyIndices)
 {
 	this->adjacencyIndices = adjacencyIndices;
+	silhouetteClusters = SilhouetteClusters();
+	uploadedLOD[1] = -1;
 }
 
 // - Aplicar texturas a los shaders
@@ -148,8 +665,7 @@ void Mesh::applyDiffuseTexture(ShaderProgram &shader)
 void Mesh::draw(ShaderProgram &shader)
 {
 	// - Dibujar la malla de tringulos
-	vao->fillIBO(topology);
-	vao->draw(GL_TRIANGLES, topology);
+	drawLOD(false);
 }
 
 // - Dibujar la malla usando texturas
@@ -158,8 +674,7 @@ void Mesh::drawWithTextures(ShaderProgram &shader)
 	applyTextures(shader);
 
 	// - Dibujar la malla de tringulos
-	vao->fillIBO(topology);
-	vao->draw(GL_TRIANGLES, topology);
+	drawLOD(false);
 }
 
 // - Dibujar la malla usando slo textura difusa
@@ -168,14 +683,66 @@ void Mesh::drawWithDiffuseTexture(ShaderProgram &shader)
 	applyDiffuseTexture(shader);
 
 	// - Dibujar la malla de tringulos
-	vao->fillIBO(topology);
-	vao->draw(GL_TRIANGLES, topology);
+	drawLOD(false);
 }
 
 // - Dibujar contorno avanzado de la malla
 void Mesh::drawAdvancedOutline(ShaderProgram &shader)
 {
+	// - Con el compute shader de siluetas, se buscan las aristas de la silueta de las adyacencias del
+	//   nivel de detalle seleccionado (los quads se dibujan despus, todos a la vez)
+	if (shader.isCompute())
+	{
+		GLuint vertexBuffer = 0;
+		GLuint indexBuffer = 0;
+		size_t vertexOffset = 0;
+		size_t indexOffset = 0;
+
+		uploadLOD(true);
+
+		if (!vao->getAdjacencyStorage(vertexBuffer, vertexOffset, indexBuffer, indexOffset))
+		{
+			return;
+		}
+
+		// - Un lanzamiento por rango que puede tener aristas de la silueta
+		if (silhouetteSelected)
+		{
+			for (const IndexRange &range : silhouetteRanges)
+			{
+				SilhouetteExtractor::dispatch(shader, vertexBuffer, vertexOffset, indexBuffer,
+											  indexOffset + sizeof(GLuint) * range.firstIndex, range.count / 6);
+			}
+
+			return;
+		}
+
+		SilhouetteExtractor::dispatch(shader, vertexBuffer, vertexOffset, indexBuffer, indexOffset,
+									  (unsigned int) getLODAdjacencyIndices().size() / 6);
+
+		return;
+	}
+
+	// - Dibujar slo los rangos que pueden tener aristas de la silueta
+	if (silhouetteSelected && numInstances == 0)
+	{
+		uploadLOD(true);
+		vao->drawRanges(GL_TRIANGLES_ADJACENCY, silhouetteRanges);
+
+		return;
+	}
+
 	// - Dibujar la malla de tringulos
-	vao->fillIBOAdjacencies(adjacencyIndices);
-	vao->draw(GL_TRIANGLES_ADJACENCY, adjacencyIndices);
+	drawLOD(true);
+}
+
+// - Dibujar las aristas caractersticas de la malla (lneas que el geometry shader convierte en quads)
+void Mesh::drawFeatureEdges(ShaderProgram & /*shader*/)
+{
+	if (featureEdges.empty() || numInstances > 0)
+	{
+		return;
+	}
+
+	vao->draw(GL_LINES, featureEdges);
 }
\ No newline at end of file
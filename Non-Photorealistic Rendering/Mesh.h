@@ -6,6 +6,18 @@
 #include "VAO.h"
 #include "ShaderProgram.h"
 #include "Texture.h"
+#include "BoundingVolumes.h"
+#include "GeometryStore.h"
+#include "SilhouetteClusters.h"
+
+// - Nivel de detalle de una malla: topologa simplificada, ndices de adyacencia y su jerarqua de
+//   siluetas (los vrtices son los de la malla original)
+struct MeshLOD
+{
+	std::vector<unsigned int> topology;
+	std::vector<unsigned int> adjacencyIndices;
+	SilhouetteClusters silhouetteClusters;
+};
 
 class Mesh
 {
@@ -22,10 +34,53 @@ private:
 	std::vector<Texture*> textures;
 
 	std::vector<unsigned int> adjacencyIndices;
+	SilhouetteClusters silhouetteClusters;
 
-	// - Aplicar texturas a shaders
-	void applyTextures(ShaderProgram &shader);
-	void applyDiffuseTexture(ShaderProgram &shader);
+	// - Aristas caractersticas (pares de vrtices de GL_LINES, de la malla original)
+	std::vector<unsigned int> featureEdges;
+
+	// - Rangos de las adyacencias que pueden tener aristas de la silueta en el dibujado actual del
+	//   contorno avanzado (si no se han seleccionado, se dibujan todas)
+	std::vector<IndexRange> silhouetteRanges;
+	bool silhouetteSelected;
+
+	// - Niveles de detalle (el nivel 0 es la malla original) y nivel seleccionado
+	std::vector<MeshLOD> lods;
+	unsigned int currentLOD;
+
+	// - Nivel de detalle cuyos ndices (topologa y adyacencias) estn en los IBOs del VAO (-1 si
+	//   ninguno), para no volver a subirlos en cada dibujado
+	int uploadedLOD[2];
+
+	// - Dibujado instanciado: nmero de instancias de cada llamada de dibujado (0 para el dibujado normal)
+	unsigned int numInstances;
+
+	// - Handle de la geometra de la malla en el almacn compartido (dibujado por lotes)
+	unsigned int geometry;
+
+	// - Cach de transformaciones: frame en el que se transformaron los vrtices y su desplazamiento
+	//   (en bytes) en el buffer de la cach
+	unsigned int transformFrame;
+	size_t transformOffset;
+
+	// - Volmenes envolventes y visibilidad en el frame actual
+	AABB bounds;
+	BoundingSphere boundingSphere;
+	bool visible;
+	bool outlineVisible;
+
+	// - Calcular volmenes envolventes
+	void computeBounds();
+
+	// - Topologa e ndices de adyacencia del nivel de detalle seleccionado
+	const std::vector<unsigned int>& getLODTopology();
+	const std::vector<unsigned int>& getLODAdjacencyIndices();
+	SilhouetteClusters& getLODSilhouetteClusters();
+
+	// - Subir y dibujar la topologa (o las adyacencias) del nivel de detalle seleccionado, una vez o
+	//   por cada instancia
+	void uploadLOD(bool adjacencies);
+	void drawLOD(bool adjacencies);
 
 public:
 	// - Constructor
@@ -52,13 +107,84 @@ public:
 	~Mesh();
 	
 	// - Getters y setters
+	const std::vector<PosNorm>& getVertices();
+	const std::vector<glm::vec2>& getTexCoords();
 	std::vector<unsigned int> getTopology();
 	std::vector<unsigned int> getAdjacencyIndices();
 	void setAdjacencyIndices(std::vector<unsigned int> adjacencyIndices);
 
+	// - Volmenes envolventes y visibilidad
+	AABB getBounds();
+	BoundingSphere getBoundingSphere();
+	bool isVisible();
+	bool isOutlineVisible();
+	void setVisibility(bool visible, bool outlineVisible);
+
+	// - Niveles de detalle
+	static const unsigned int MAX_LODS = 4;
+	static const unsigned int MIN_LOD_TRIANGLES = 256;
+
+	// - Generar los niveles de detalle 1..levels - 1 (cada uno con la mitad de tringulos que el
+	//   anterior). Devuelve la memoria reservada para sus ndices
+	size_t generateLODs(unsigned int levels);
+
+	// - Seleccionar el nivel de detalle segn el tamao proyectado en pantalla (radio de la esfera
+	//   envolvente en coordenadas normalizadas), con histresis para evitar cambios continuos
+	void selectLOD(float screenSize);
+	static unsigned int chooseLOD(float screenSize, unsigned int currentLOD, unsigned int numLODs);
+	void setLOD(unsigned int lod);
+	unsigned int getNumLODs();
+	unsigned int getCurrentLOD();
+	unsigned int getNumTriangles(unsigned int lod);
+
+	// - Jerarquas de siluetas: construirlas para las adyacencias de cada nivel de detalle (reordena
+	//   sus tringulos, as que se construyen antes de copiarlas al almacn de geometra; devuelve la
+	//   memoria reservada) y seleccionar los rangos del nivel actual que pueden tener aristas de la
+	//   silueta con una direccin de visin en el espacio del modelo (nullptr para dibujarlos todos)
+	size_t buildSilhouetteClusters();
+	void selectSilhouetteClusters(const glm::vec3 *viewDirection);
+
+	// - Aristas caractersticas: asignar sus ndices (se suben a su IBO; devuelve su memoria)
+	size_t setFeatureEdges(const std::vector<unsigned int> &indices);
+	unsigned int getNumFeatureEdges();
+
+	// - Interseccin de un rayo (en el espacio local de la malla) con sus tringulos. Devuelve la
+	//   distancia, en unidades de la direccin del rayo, al tringulo ms cercano
+	bool intersectRay(const glm::vec3 &origin, const glm::vec3 &direction, float &distance);
+
+	// - Dibujado instanciado: las siguientes llamadas de dibujado dibujan numInstances instancias con
+	//   los atributos de instanceBuffer a partir de firstInstance (numInstances = 0 lo desactiva)
+	void setInstances(GLuint instanceBuffer, unsigned int firstInstance, unsigned int numInstances);
+	bool isInstanced();
+
+	// - VAO con el que se dibuja la malla (el del almacn de geometra si se dibuja por lotes)
+	GLuint getVertexArray();
+
+	// - Cach de transformaciones: transformar los vrtices a partir de un desplazamiento reservado,
+	//   saber si estn transformados en el frame actual de la cach y leerlos de ella en los
+	//   siguientes dibujados (false para volver a leer los del VAO)
+	void captureTransform(size_t offset);
+	bool isTransformCached();
+	void bindTransformCache(bool enabled);
+	unsigned int getNumVertices();
+
+	// - Dibujado por lotes: copiar la malla y sus niveles de detalle al almacn de geometra (devuelve
+	//   la memoria reservada) y aadir al lote actual el nivel de detalle seleccionado
+	size_t addToGeometryStore();
+	void addToBatch(bool adjacencies);
+
+	// - Residencia: sumar la memoria de los atributos e ndices de la malla
+	void addMemoryUsage(MemoryUsage &usage);
+
+	// - Texturas de la malla y aplicacin de texturas a shaders
+	const std::vector<Texture*>& getTextures();
+	void applyTextures(ShaderProgram &shader);
+	void applyDiffuseTexture(ShaderProgram &shader);
+
 	// - Dibujar la malla de distintas formas
 	void draw(ShaderProgram &shader);
 	void drawWithTextures(ShaderProgram &shader);
 	void drawWithDiffuseTexture(ShaderProgram &shader);
 	void drawAdvancedOutline(ShaderProgram &shader);
+	void drawFeatureEdges(ShaderProgram &shader);
 };
\ No newline at end of file
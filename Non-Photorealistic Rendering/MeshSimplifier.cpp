@@ -0,0 +1,430 @@
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <unordered_map>
+
+// - Peso de los planos que protegen las aristas frontera
+static const double BOUNDARY_WEIGHT = 1000.0;
+
+// - Cudrica de error: matriz simtrica 4x4 (10 coeficientes) que suma los cuadrados de las
+//   distancias de un punto a un conjunto de planos
+struct Quadric
+{
+	double a[10];
+
+	Quadric()
+	{
+		for (int i = 0; i < 10; i++)
+		{
+			this->a[i] = 0.0;
+		}
+	}
+
+	// - Cudrica del plano np + d = 0, ponderada
+	Quadric(const glm::dvec3 &n, double d, double weight)
+	{
+		this->a[0] = weight * n.x * n.x;
+		this->a[1] = weight * n.x * n.y;
+		this->a[2] = weight * n.x * n.z;
+		this->a[3] = weight * n.x * d;
+		this->a[4] = weight * n.y * n.y;
+		this->a[5] = weight * n.y * n.z;
+		this->a[6] = weight * n.y * d;
+		this->a[7] = weight * n.z * n.z;
+		this->a[8] = weight * n.z * d;
+		this->a[9] = weight * d * d;
+	}
+
+	void add(const Quadric &q)
+	{
+		for (int i = 0; i < 10; i++)
+		{
+			a[i] += q.a[i];
+		}
+	}
+
+	// - Error de un punto
+	double evaluate(const glm::vec3 &p) const
+	{
+		double x = p.x, y = p.y, z = p.z;
+
+		return a[0] * x * x + 2.0 * a[1] * x * y + 2.0 * a[2] * x * z + 2.0 * a[3] * x +
+			   a[4] * y * y + 2.0 * a[5] * y * z + 2.0 * a[6] * y +
+			   a[7] * z * z + 2.0 * a[8] * z + a[9];
+	}
+};
+
+// - Colapso candidato (del vrtice from al vrtice to). version es la versin del vrtice to cuando
+//   se calcul el coste: si su cudrica cambia, el candidato queda obsoleto
+struct Collapse
+{
+	double cost;
+	unsigned int from;
+	unsigned int to;
+	unsigned int version;
+
+	bool operator>(const Collapse &other) const
+	{
+		return cost > other.cost;
+	}
+};
+
+// - Clave de una arista (dirigida o no)
+static unsigned long long edgeKey(unsigned int a, unsigned int b)
+{
+	return ((unsigned long long) a << 32) | b;
+}
+
+// - Simplificar una malla por colapso de aristas
+std::vector<unsigned int> MeshSimplifier::simplify(const std::vector<PosNorm> &vertices, const std::vector<unsigned int> &topology,
+												   unsigned int targetTriangles)
+{
+	unsigned int numVertices = (unsigned int) vertices.size();
+	unsigned int numTriangles = (unsigned int) topology.size() / 3;
+
+	std::vector<unsigned int> triangles(topology.begin(), topology.begin() + numTriangles * 3);
+	std::vector<bool> removedTriangle(numTriangles, false);
+	std::vector<bool> removedVertex(numVertices, false);
+	std::vector<unsigned int> version(numVertices, 0);
+	std::vector<Quadric> quadrics(numVertices);
+	std::vector<std::vector<unsigned int>> vertexTriangles(numVertices);
+
+	// - Cudricas de las caras (ponderadas por el rea) y tringulos de cada vrtice
+	std::unordered_map<unsigned long long, unsigned int> edgeCount;
+
+	for (unsigned int t = 0; t < numTriangles; t++)
+	{
+		const unsigned int *tri = &triangles[3 * t];
+		glm::dvec3 p0 = glm::dvec3(vertices[tri[0]].position);
+		glm::dvec3 p1 = glm::dvec3(vertices[tri[1]].position);
+		glm::dvec3 p2 = glm::dvec3(vertices[tri[2]].position);
+		glm::dvec3 normal = glm::cross(p1 - p0, p2 - p0);
+		double length = glm::length(normal);
+
+		for (int j = 0; j < 3; j++)
+		{
+			vertexTriangles[tri[j]].push_back(t);
+			edgeCount[edgeKey(std::min(tri[j], tri[(j + 1) % 3]), std::max(tri[j], tri[(j + 1) % 3]))]++;
+		}
+
+		if (length > 0.0)
+		{
+			normal /= length;
+			Quadric plane(normal, -glm::dot(normal, p0), 0.5 * length);
+
+			for (int j = 0; j < 3; j++)
+			{
+				quadrics[tri[j]].add(plane);
+			}
+		}
+	}
+
+	// - Aristas frontera: plano perpendicular a la cara que contiene la arista
+	for (unsigned int t = 0; t < numTriangles; t++)
+	{
+		const unsigned int *tri = &triangles[3 * t];
+		glm::dvec3 p0 = glm::dvec3(vertices[tri[0]].position);
+		glm::dvec3 p1 = glm::dvec3(vertices[tri[1]].position);
+		glm::dvec3 p2 = glm::dvec3(vertices[tri[2]].position);
+		glm::dvec3 faceNormal = glm::cross(p1 - p0, p2 - p0);
+
+		if (glm::length(faceNormal) <= 0.0)
+		{
+			continue;
+		}
+
+		for (int j = 0; j < 3; j++)
+		{
+			unsigned int a = tri[j], b = tri[(j + 1) % 3];
+
+			if (edgeCount[edgeKey(std::min(a, b), std::max(a, b))] != 1)
+			{
+				continue;
+			}
+
+			glm::dvec3 pa = glm::dvec3(vertices[a].position);
+			glm::dvec3 edge = glm::dvec3(vertices[b].position) - pa;
+			glm::dvec3 normal = glm::cross(edge, faceNormal);
+			double length = glm::length(normal);
+
+			if (length <= 0.0)
+			{
+				continue;
+			}
+
+			normal /= length;
+			Quadric plane(normal, -glm::dot(normal, pa), BOUNDARY_WEIGHT * glm::dot(edge, edge));
+
+			quadrics[a].add(plane);
+			quadrics[b].add(plane);
+		}
+	}
+
+	// - Cola de colapsos candidatos (menor coste primero)
+	std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> heap;
+
+	auto pushCollapse = [&](unsigned int from, unsigned int to)
+	{
+		Quadric q = quadrics[from];
+		q.add(quadrics[to]);
+
+		Collapse collapse;
+		collapse.cost = q.evaluate(vertices[to].position);
+		collapse.from = from;
+		collapse.to = to;
+		collapse.version = version[to];
+
+		heap.push(collapse);
+	};
+
+	for (unsigned int t = 0; t < numTriangles; t++)
+	{
+		for (int j = 0; j < 3; j++)
+		{
+			unsigned int a = triangles[3 * t + j], b = triangles[3 * t + (j + 1) % 3];
+
+			if (a != b)
+			{
+				pushCollapse(a, b);
+				pushCollapse(b, a);
+			}
+		}
+	}
+
+	// - Vecinos de un vrtice (vrtices de sus tringulos)
+	std::vector<unsigned int> neighboursFrom, neighboursTo;
+
+	auto collectNeighbours = [&](unsigned int vertex, std::vector<unsigned int> &neighbours)
+	{
+		neighbours.clear();
+
+		for (unsigned int i = 0; i < vertexTriangles[vertex].size(); i++)
+		{
+			unsigned int t = vertexTriangles[vertex][i];
+
+			if (removedTriangle[t])
+			{
+				continue;
+			}
+
+			for (int j = 0; j < 3; j++)
+			{
+				if (triangles[3 * t + j] != vertex)
+				{
+					neighbours.push_back(triangles[3 * t + j]);
+				}
+			}
+		}
+
+		std::sort(neighbours.begin(), neighbours.end());
+		neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+	};
+
+	unsigned int liveTriangles = numTriangles;
+
+	while (liveTriangles > targetTriangles && !heap.empty())
+	{
+		Collapse collapse = heap.top();
+		heap.pop();
+
+		unsigned int from = collapse.from;
+		unsigned int to = collapse.to;
+
+		if (removedVertex[from] || removedVertex[to] || collapse.version != version[to])
+		{
+			continue;
+		}
+
+		// - Tringulos que comparten la arista y comprobacin de que la arista sigue existiendo
+		unsigned int sharedTriangles = 0;
+
+		for (unsigned int i = 0; i < vertexTriangles[from].size(); i++)
+		{
+			unsigned int t = vertexTriangles[from][i];
+
+			if (!removedTriangle[t] &&
+				(triangles[3 * t] == to || triangles[3 * t + 1] == to || triangles[3 * t + 2] == to))
+			{
+				sharedTriangles++;
+			}
+		}
+
+		if (sharedTriangles == 0)
+		{
+			continue;
+		}
+
+		// - Condicin de enlace: los vecinos comunes deben ser slo los vrtices opuestos a la
+		//   arista (evita crear geometra no variedad)
+		collectNeighbours(from, neighboursFrom);
+		collectNeighbours(to, neighboursTo);
+
+		unsigned int commonNeighbours = 0;
+
+		for (unsigned int i = 0, j = 0; i < neighboursFrom.size() && j < neighboursTo.size();)
+		{
+			if (neighboursFrom[i] < neighboursTo[j])
+			{
+				i++;
+			}
+			else if (neighboursFrom[i] > neighboursTo[j])
+			{
+				j++;
+			}
+			else
+			{
+				commonNeighbours++;
+				i++;
+				j++;
+			}
+		}
+
+		if (commonNeighbours != sharedTriangles)
+		{
+			continue;
+		}
+
+		// - Los tringulos que se mueven no pueden invertirse ni degenerar
+		bool valid = true;
+
+		for (unsigned int i = 0; i < vertexTriangles[from].size() && valid; i++)
+		{
+			unsigned int t = vertexTriangles[from][i];
+			const unsigned int *tri = &triangles[3 * t];
+
+			if (removedTriangle[t] || tri[0] == to || tri[1] == to || tri[2] == to)
+			{
+				continue;
+			}
+
+			glm::vec3 p[3], q[3];
+
+			for (int j = 0; j < 3; j++)
+			{
+				p[j] = vertices[tri[j]].position;
+				q[j] = (tri[j] == from) ? vertices[to].position : p[j];
+			}
+
+			glm::vec3 oldNormal = glm::cross(p[1] - p[0], p[2] - p[0]);
+			glm::vec3 newNormal = glm::cross(q[1] - q[0], q[2] - q[0]);
+			float oldLength = glm::length(oldNormal);
+			float newLength = glm::length(newNormal);
+
+			if (newLength <= 1e-6f * oldLength || (oldLength > 0.f && glm::dot(oldNormal, newNormal) < 0.2f * oldLength * newLength))
+			{
+				valid = false;
+			}
+		}
+
+		if (!valid)
+		{
+			continue;
+		}
+
+		// - Colapsar: se eliminan los tringulos de la arista y el resto pasan al vrtice destino
+		for (unsigned int i = 0; i < vertexTriangles[from].size(); i++)
+		{
+			unsigned int t = vertexTriangles[from][i];
+			unsigned int *tri = &triangles[3 * t];
+
+			if (removedTriangle[t])
+			{
+				continue;
+			}
+
+			if (tri[0] == to || tri[1] == to || tri[2] == to)
+			{
+				removedTriangle[t] = true;
+				liveTriangles--;
+			}
+			else
+			{
+				for (int j = 0; j < 3; j++)
+				{
+					if (tri[j] == from)
+					{
+						tri[j] = to;
+					}
+				}
+
+				vertexTriangles[to].push_back(t);
+			}
+		}
+
+		vertexTriangles[from].clear();
+		removedVertex[from] = true;
+		quadrics[to].add(quadrics[from]);
+		version[to]++;
+
+		// - Eliminar de la lista del vrtice destino los tringulos eliminados
+		std::vector<unsigned int> &toTriangles = vertexTriangles[to];
+		toTriangles.erase(std::remove_if(toTriangles.begin(), toTriangles.end(),
+										 [&](unsigned int t) { return removedTriangle[t]; }), toTriangles.end());
+
+		// - Nuevos candidatos de las aristas del vrtice destino
+		collectNeighbours(to, neighboursTo);
+
+		for (unsigned int i = 0; i < neighboursTo.size(); i++)
+		{
+			pushCollapse(to, neighboursTo[i]);
+			pushCollapse(neighboursTo[i], to);
+		}
+	}
+
+	// - Topologa resultante (mismo orden que la original)
+	std::vector<unsigned int> result;
+	result.reserve(3 * liveTriangles);
+
+	for (unsigned int t = 0; t < numTriangles; t++)
+	{
+		if (!removedTriangle[t])
+		{
+			result.push_back(triangles[3 * t]);
+			result.push_back(triangles[3 * t + 1]);
+			result.push_back(triangles[3 * t + 2]);
+		}
+	}
+
+	return result;
+}
+
+// - Construir el vector de ndices con topologa y vrtices adyacentes. Cada arista dirigida se
+//   asocia al vrtice opuesto de su tringulo; el vrtice adyacente de una arista es el opuesto de
+//   la misma arista en sentido contrario (misma disposicin que Model::buildTopologyPlusAdjacencies)
+std::vector<unsigned int> MeshSimplifier::buildAdjacencyIndices(const std::vector<unsigned int> &topology)
+{
+	std::unordered_map<unsigned long long, unsigned int> opposite;
+	opposite.reserve(topology.size());
+
+	for (unsigned int i = 0; i + 2 < topology.size(); i += 3)
+	{
+		for (int j = 0; j < 3; j++)
+		{
+			opposite.insert(std::make_pair(edgeKey(topology[i + j], topology[i + (j + 1) % 3]), topology[i + (j + 2) % 3]));
+		}
+	}
+
+	std::vector<unsigned int> indices((topology.size() / 3) * 6);
+
+	for (unsigned int i = 0; i + 2 < topology.size(); i += 3)
+	{
+		unsigned int *adjacency = &indices[i * 2];
+
+		for (int j = 0; j < 3; j++)
+		{
+			unsigned int a = topology[i + j];
+			unsigned int b = topology[i + (j + 1) % 3];
+			std::unordered_map<unsigned long long, unsigned int>::iterator it = opposite.find(edgeKey(b, a));
+
+			adjacency[2 * j] = a;
+
+			// - Arista frontera: se usa el vrtice opuesto del propio tringulo
+			adjacency[2 * j + 1] = (it != opposite.end()) ? it->second : topology[i + (j + 2) % 3];
+		}
+	}
+
+	return indices;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <vector>
+
+#include "Structures.h"
+
+// - La clase MeshSimplifier simplifica mallas de tringulos colapsando aristas segn el error de
+//   las cudricas de los planos de sus caras (Garland-Heckbert). Los colapsos llevan un vrtice
+//   sobre otro ya existente, as que la malla simplificada usa los mismos vrtices que la original
+//   (slo cambia la topologa) y todos los niveles de detalle pueden compartir los VBOs. Las aristas
+//   frontera (bordes y costuras de coordenadas de textura) se penalizan para que no se deformen
+class MeshSimplifier
+{
+public:
+	// - Simplificar una malla hasta un nmero de tringulos (o hasta que no se pueda colapsar
+	//   ninguna arista sin invertir caras). Devuelve la nueva topologa
+	static std::vector<unsigned int> simplify(const std::vector<PosNorm> &vertices, const std::vector<unsigned int> &topology,
+											  unsigned int targetTriangles);
+
+	// - Construir el vector de ndices con topologa y vrtices adyacentes (GL_TRIANGLES_ADJACENCY)
+	//		.ndices pares: vrtice del tringulo
+	//		.ndices impares: vrtice no compartido del tringulo vecino (o un vrtice del propio
+	//		 tringulo si la arista es frontera)
+	static std::vector<unsigned int> buildAdjacencyIndices(const std::vector<unsigned int> &topology);
+};
@@ -1,12 +1,24 @@
 #include "Model.h"
+#include "LoadProfiler.h"
+#include "ResidencyManager.h"
+#include "TransformCache.h"
 #include "lodepng.h"
 
+#include <algorithm>
 #include <iostream>
 #include <cmath>
+#include <memory>
 
 // - Constructor
 Model::Model(std::string path)
 {
+	hatchDark = nullptr;
+	hatchBright = nullptr;
+
+	// - Las aristas caractersticas se extraen al cargar el modelo, con los parmetros actuales
+	featureEdgeVersion = FeatureEdges::getVersion();
+	featureEdgeJobVersion = featureEdgeVersion;
+
 	// - Cargar modelo
 	loadModel(path);
 
@@ -17,11 +29,40 @@ Model::Model(std::string path)
 // - Destructor
 Model::~Model()
 {
+	// - Esperar a la extraccin de aristas en segundo plano, que lee los vrtices de las mallas
+	if (featureEdgeJob.valid())
+	{
+		featureEdgeJob.wait();
+		FeatureEdges::endJob();
+	}
+
+	for (Mesh *mesh : meshes)
+	{
+		delete mesh;
+	}
 	meshes.clear();
+
+	// - Las texturas se comparten entre mallas, as que se liberan desde el vector de texturas cargadas
+	for (Texture *texture : loadedTextures)
+	{
+		delete texture;
+	}
+	loadedTextures.clear();
+
+	delete hatchDark;
+	delete hatchBright;
+
+	// - Cada eje del mapa es dueo del vrtice al que apunta
+	for (auto &edge : edges)
+	{
+		delete edge.second->vertex;
+		delete edge.second;
+	}
+	edges.clear();
 }
 
-// - Cargar el modelo
-void Model::loadModel(std::string path)
+// - Leer un fichero con Assimp (tambin desde los hilos de recarga en segundo plano)
+const aiScene* Model::importFile(Assimp::Importer &importer, const std::string &path)
 {
 	// - Leer el archivo y almacenarlo en un objeto escena. Opciones de postprocesamiento utilizadas:
 	//		.aiProcess_Triangulate: transforma todas las primitivas del modelo a tringulos
@@ -30,22 +71,86 @@ void Model::loadModel(std::string path)
 	//		.aiProcess_OptimizeMeshes: optimizar mallas
 	//		.aiProcess_GenUVCoords: generar coordenadas de textura
 	//		.aiProcess_JoinIdenticalVertices: reducir nmero de vrtices uniendo los que sean iguales
+	return importer.ReadFile(path, 
+							 aiProcess_Triangulate |
+							 aiProcess_CalcTangentSpace |
+							 aiProcess_GenSmoothNormals |
+							 aiProcess_OptimizeMeshes |
+							 aiProcess_GenUVCoords |
+							 aiProcess_JoinIdenticalVertices
+	);
+}
 
+// - Cargar el modelo
+void Model::loadModel(std::string path)
+{
 	Assimp::Importer importer;
-	
-	const aiScene *scene = importer.ReadFile(path, 
-											 aiProcess_Triangulate |
-											 aiProcess_CalcTangentSpace |
-											 aiProcess_GenSmoothNormals |
-											 aiProcess_OptimizeMeshes |
-											 aiProcess_GenUVCoords |
-											 aiProcess_JoinIdenticalVertices
-	);
+	const aiScene *scene = nullptr;
+
+	// - Residencia: el modelo pertenece a la escena que se est cargando. Si se ha vuelto a leer en
+	//   segundo plano (recarga de una escena descargada), se usa esa lectura
+	ResidencyManager::getInstance()->recordModel(path);
+	std::unique_ptr<Assimp::Importer> prefetched(ResidencyManager::getInstance()->takeImport(path));
+	Assimp::Importer &source = prefetched ? *prefetched : importer;
+
+	// - Perfilado de carga: los tiempos y bytes de cada fase se asignan a este modelo
+	LoadProfiler::getInstance()->beginAsset(path);
+
+	if (prefetched)
+	{
+		scene = prefetched->GetScene();
+	}
+	else if (LoadProfiler::getInstance()->isEnabled())
+	{
+		// - Perfilado detallado: se lee el fichero sin post-procesamiento y se aplica cada paso por
+		//   separado (en el orden en que Assimp los ejecuta) para medir el coste de cada uno
+		static const std::pair<unsigned int, const char*> postProcessSteps[] =
+		{
+			{ aiProcess_OptimizeMeshes, "Assimp OptimizeMeshes" },
+			{ aiProcess_GenUVCoords, "Assimp GenUVCoords" },
+			{ aiProcess_Triangulate, "Assimp Triangulate" },
+			{ aiProcess_GenSmoothNormals, "Assimp GenSmoothNormals" },
+			{ aiProcess_CalcTangentSpace, "Assimp CalcTangentSpace" },
+			{ aiProcess_JoinIdenticalVertices, "Assimp JoinIdenticalVertices" }
+		};
+
+		aiMemoryInfo memory;
+
+		LoadPhaseTimer readTimer("Assimp ReadFile");
+		scene = importer.ReadFile(path, 0);
+		importer.GetMemoryRequirements(memory);
+		readTimer.stop(memory.total);
+
+		for (const std::pair<unsigned int, const char*> &step : postProcessSteps)
+		{
+			if (!scene)
+			{
+				break;
+			}
+
+			unsigned int previousBytes = memory.total;
+
+			LoadPhaseTimer stepTimer(step.second);
+			scene = importer.ApplyPostProcessing(step.first);
+			importer.GetMemoryRequirements(memory);
+			stepTimer.stop(memory.total > previousBytes ? memory.total - previousBytes : 0);
+		}
+	}
+	else
+	{
+		aiMemoryInfo memory;
+
+		LoadPhaseTimer readTimer("Assimp ReadFile + post-processing");
+		scene = importFile(importer, path);
+		importer.GetMemoryRequirements(memory);
+		readTimer.stop(memory.total);
+	}
 
 	// - Comprobar si han ocurrido errores
 	if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
 	{
-		std::cout << "ERROR[ASSIMP]: " << importer.GetErrorString() << std::endl;
+		std::cout << "ERROR[ASSIMP]: " << source.GetErrorString() << std::endl;
+		LoadProfiler::getInstance()->endAsset();
 		return;
 	}
 	
@@ -54,6 +159,49 @@ void Model::loadModel(std::string path)
 
 	// - Procesamiento de la escena a nivel de nodo
 	processNode(scene->mRootNode, scene);
+
+	// - Perfilado de carga: aristas caractersticas de todas las mallas (los cambios de material
+	//   necesitan las caras de las mallas vecinas)
+	LoadPhaseTimer featureEdgeTimer("Feature edges");
+	featureEdgeTimer.stop(applyFeatureEdges(FeatureEdges::extract(getFeatureEdgeSources(), FeatureEdges::getSettings())));
+
+	// - Orden del dibujado por lotes: mallas agrupadas por conjunto de texturas
+	for (unsigned int i = 0; i < meshes.size(); i++)
+	{
+		batchOrder.push_back(i);
+	}
+
+	std::stable_sort(batchOrder.begin(), batchOrder.end(), [this](unsigned int a, unsigned int b)
+	{
+		return meshes[a]->getTextures() < meshes[b]->getTextures();
+	});
+
+	// - Volmenes envolventes del modelo, a partir de los de sus mallas
+	bounds = AABB();
+
+	for (unsigned int i = 0; i < meshes.size(); i++)
+	{
+		bounds.expand(meshes[i]->getBounds());
+	}
+
+	if (bounds.isValid())
+	{
+		float radius = 0.f;
+
+		for (unsigned int i = 0; i < meshes.size(); i++)
+		{
+			BoundingSphere meshSphere = meshes[i]->getBoundingSphere();
+
+			if (meshSphere.radius >= 0.f)
+			{
+				radius = std::max(radius, glm::length(meshSphere.center - bounds.getCenter()) + meshSphere.radius);
+			}
+		}
+
+		boundingSphere = BoundingSphere(bounds.getCenter(), radius);
+	}
+
+	LoadProfiler::getInstance()->endAsset();
 }
 
 // - Procesamiento de la escena a nivel de nodo
@@ -66,8 +214,9 @@ void Model::processNode(aiNode *node, const aiScene *scene)
 		aiMesh *aimesh = scene->mMeshes[node->mMeshes[i]];
 		Mesh *mesh = processMesh(aimesh, scene);
 
-		// - Aadir malla
+		// - Aadir malla (y su material)
 		meshes.push_back(mesh);
+		meshMaterials.push_back(aimesh->mMaterialIndex);
 	}
 
 	// - Procesamiento de los hijos del nodo (recursividad)
@@ -109,6 +258,9 @@ Mesh* Model::processMesh(aiMesh *mesh, const aiScene *scene)
 		hasTangentsAndBitangents = true;
 	}
 
+	// - Perfilado de carga: copia de vrtices y topologa
+	LoadPhaseTimer vertexCopyTimer("Vertex copy");
+
 	// - Procesamiento de vrtices
 	for (unsigned int i = 0; i < mesh->mNumVertices; i++)
 	{
@@ -168,6 +320,18 @@ Mesh* Model::processMesh(aiMesh *mesh, const aiScene *scene)
 		{
 			topology.push_back(face->mIndices[j]);
 		}
+	}
+
+	vertexCopyTimer.stop(sizeof(PosNorm) * vertices.size() + sizeof(glm::vec2) * texCoords.size() +
+						 sizeof(glm::vec3) * (tangents.size() + bitangents.size()) +
+						 sizeof(unsigned int) * topology.size());
+
+	// - Perfilado de carga: construccin del mapa de half-edges
+	LoadPhaseTimer halfEdgeTimer("Half-edge construction");
+
+	for (unsigned int i = 0; i < mesh->mNumFaces; i++)
+	{
+		aiFace *face = &mesh->mFaces[i];
 
 		// - Adyacencias: Construccin del mapa de ejes
 		for (unsigned int j = 0; j < face->mNumIndices; j++)
@@ -186,8 +350,12 @@ Mesh* Model::processMesh(aiMesh *mesh, const aiScene *scene)
 			v->position = vertices[v->index].position;
 			edge->vertex = v;
 
-			// - Aadir eje al mapa de ejes
-			edges.insert(std::pair<std::pair<unsigned int, unsigned int>, HalfEdge*>(p, edge));
+			// - Aadir eje al mapa de ejes (si ya existe, el nuevo se descarta)
+			if (!edges.insert(std::pair<std::pair<unsigned int, unsigned int>, HalfEdge*>(p, edge)).second)
+			{
+				delete v;
+				delete edge;
+			}
 		}
 
 		// - Adyacencias: Aadir informacin de adyacencia a los ejes del mapa
@@ -224,8 +392,15 @@ Mesh* Model::processMesh(aiMesh *mesh, const aiScene *scene)
 	//		.ndices pares: vrtice del tringulo
 	//		.ndices impares: vrtice no compartido del tringulo vecino
 
+	// - Cada eje reserva un HalfEdge, un Vertex y un nodo del mapa de ejes (estimado)
+	halfEdgeTimer.stop(topology.size() * (sizeof(HalfEdge) + sizeof(Vertex) +
+										  sizeof(std::pair<std::pair<unsigned int, unsigned int>, HalfEdge*>) +
+										  4 * sizeof(void*)));
+
+	LoadPhaseTimer adjacencyTimer("buildTopologyPlusAdjacencies");
 	std::vector<unsigned int> adjacencyIndices;
 	adjacencyIndices = buildTopologyPlusAdjacencies(topology);
+	adjacencyTimer.stop(sizeof(unsigned int) * adjacencyIndices.size());
 	
 	// - Procesamiento de materiales (texturas)
 	if (mesh->mMaterialIndex >= 0)
@@ -251,13 +426,36 @@ Mesh* Model::processMesh(aiMesh *mesh, const aiScene *scene)
 		loadMaterial(mat);
 	}
 
+	// - Perfilado de carga: creacin de la malla (copia de datos y subida de VBOs)
+	LoadPhaseTimer uploadTimer("VBO upload (Mesh creation)");
+	Mesh *result = nullptr;
+
 	// - Si no tiene tangentes ni bitangentes, se devuelve la malla sin utilizarlas
 	if (!hasTangentsAndBitangents)
 	{
-		return new Mesh(vertices, texCoords, topology, textures);
+		result = new Mesh(vertices, texCoords, topology, textures);
 	}
+	else
+	{
+		result = new Mesh(vertices, texCoords, tangents, bitangents, topology, adjacencyIndices, textures);
+	}
+
+	uploadTimer.stop(sizeof(PosNorm) * vertices.size() + sizeof(glm::vec2) * texCoords.size() +
+					 sizeof(glm::vec3) * (tangents.size() + bitangents.size()));
+
+	// - Perfilado de carga: generacin de niveles de detalle
+	LoadPhaseTimer lodTimer("LOD generation");
+	lodTimer.stop(result->generateLODs(Mesh::MAX_LODS));
+
+	// - Perfilado de carga: jerarquas de siluetas (antes de copiar las adyacencias, que se reordenan)
+	LoadPhaseTimer clusterTimer("Silhouette clusters");
+	clusterTimer.stop(result->buildSilhouetteClusters());
 
-	return new Mesh(vertices, texCoords, tangents, bitangents, topology, adjacencyIndices, textures);
+	// - Perfilado de carga: copia al almacn de geometra (dibujado por lotes)
+	LoadPhaseTimer storeTimer("Geometry store");
+	storeTimer.stop(result->addToGeometryStore());
+
+	return result;
 }
 
 // - Carga de texturas
@@ -315,6 +513,8 @@ std::vector<Texture*> Model::loadMaterialTextures(aiMaterial *material, aiTextur
 // - Carga de materiales
 void Model::loadMaterial(aiMaterial* mat) 
 {
+	// - El modelo usa el material de la ltima malla procesada
+	delete material;
 	material = new Material();
 
 	aiColor3D color(0.f, 0.f, 0.f);
@@ -411,6 +611,9 @@ std::vector<unsigned int> Model::buildTopologyPlusAdjacencies(std::vector<unsign
 // - Asignar texturas de Hatching
 void Model::setHatchingTextures(std::string dark, std::string bright)
 {
+	delete hatchDark;
+	delete hatchBright;
+
 	hatchDark = new Texture();
 	hatchDark->loadImage(dark.c_str());
 	hatchDark->bindTexture(GL_TEXTURE_2D, loadedTextures.size());
@@ -430,49 +633,299 @@ void Model::setHatchingTextures(std::string dark, std::string bright)
 							   0, GL_RGBA, GL_UNSIGNED_BYTE, hatchBright->getImage());
 }
 
+// - Sumar la memoria de las mallas y de las texturas (cargadas y de hatching)
+void Model::addMemoryUsage(MemoryUsage &usage)
+{
+	for (Mesh *mesh : meshes)
+	{
+		mesh->addMemoryUsage(usage);
+	}
+
+	for (Texture *texture : loadedTextures)
+	{
+		usage.gpuBytes += texture->getGPUMemory();
+		usage.hostBytes += texture->getHostMemory();
+	}
+
+	Texture* hatchTextures[2] = { hatchDark, hatchBright };
+
+	for (Texture *texture : hatchTextures)
+	{
+		if (texture != nullptr)
+		{
+			usage.gpuBytes += texture->getGPUMemory();
+			usage.hostBytes += texture->getHostMemory();
+		}
+	}
+}
+
+// - Liberar las imgenes decodificadas de las texturas
+void Model::releaseTextureImages()
+{
+	for (Texture *texture : loadedTextures)
+	{
+		texture->releaseImage();
+	}
+
+	if (hatchDark != nullptr)
+	{
+		hatchDark->releaseImage();
+		hatchBright->releaseImage();
+	}
+}
+
+// - Obtener la textura con la que se ordena el modelo (la primera cargada)
+GLuint Model::getSortTexture()
+{
+	return loadedTextures.empty() ? 0 : loadedTextures[0]->getId();
+}
+
+// - Obtener el VAO con el que se ordena el modelo (el de su primera malla)
+GLuint Model::getSortVertexArray()
+{
+	return meshes.empty() ? 0 : meshes[0]->getVertexArray();
+}
+
+// - Obtener malla dada su posicin
+Mesh* Model::getMesh(unsigned int pos)
+{
+	return meshes[pos];
+}
+
+// - Obtener nmero de mallas del modelo
+unsigned int Model::getNumMeshes()
+{
+	return (unsigned int) meshes.size();
+}
+
+// - Frustum culling: visibilidad del modelo y de cada una de sus mallas
+void Model::updateVisibility(const Frustum &frustum, glm::mat4 mModel, CullingStatistics &statistics)
+{
+	Element3D::updateVisibility(frustum, mModel, statistics);
+
+	for (unsigned int i = 0; i < meshes.size(); i++)
+	{
+		statistics.meshesTested++;
+
+		// - Si el modelo completo queda fuera, no hace falta comprobar sus mallas
+		if (!outlineVisible)
+		{
+			meshes[i]->setVisibility(false, false);
+			statistics.meshesCulled++;
+			continue;
+		}
+
+		bool meshVisible, meshOutlineVisible;
+		testBounds(frustum, mModel, meshes[i]->getBounds(), meshes[i]->getBoundingSphere(), meshVisible, meshOutlineVisible);
+		meshes[i]->setVisibility(meshVisible, meshOutlineVisible);
+
+		if (!meshVisible)
+		{
+			statistics.meshesCulled++;
+		}
+	}
+}
+
+// - BVH: una primitiva por malla
+void Model::collectPrimitives(glm::mat4 mModel, int sceneElement, std::vector<BVHPrimitive> &primitives)
+{
+	for (unsigned int i = 0; i < meshes.size(); i++)
+	{
+		if (!meshes[i]->getBounds().isValid())
+		{
+			continue;
+		}
+
+		BVHPrimitive primitive;
+		primitive.bounds = meshes[i]->getBounds().transform(mModel);
+		primitive.owner = this;
+		primitive.mModel = mModel;
+		primitive.mesh = meshes[i];
+		primitive.sceneElement = sceneElement;
+
+		primitives.push_back(primitive);
+	}
+}
+
+// - Mtodo privado: dibujar las mallas visibles (o con el contorno visible). Por lotes, las mallas
+//   seguidas con las mismas texturas se dibujan con una sola llamada desde el almacn de geometra;
+//   las mallas instanciadas, el dibujado sin lotes y el compute shader de siluetas usan el VAO de
+//   cada malla
+void Model::drawMeshes(ShaderProgram &shader, MeshDrawMode mode)
+{
+	bool outline = mode == DRAW_OUTLINE || mode == DRAW_ADJACENCIES;
+	GeometryStore *store = GeometryStore::getInstance();
+
+	// - Con la cach de transformaciones, cada malla lee sus vrtices transformados (no se dibuja por lotes)
+	if (!store->isEnabled() || meshes.empty() || meshes[0]->isInstanced() || shader.isCompute() || viewSpaceVertices)
+	{
+		for (unsigned int i = 0; i < meshes.size(); i++)
+		{
+			// - Frustum culling
+			if (!(outline ? meshes[i]->isOutlineVisible() : meshes[i]->isVisible()))
+			{
+				continue;
+			}
+
+			if (viewSpaceVertices)
+			{
+				meshes[i]->bindTransformCache(true);
+			}
+
+			if (mode == DRAW_TEXTURES)
+			{
+				meshes[i]->drawWithTextures(shader);
+			}
+			else if (mode == DRAW_ADJACENCIES)
+			{
+				meshes[i]->drawAdvancedOutline(shader);
+			}
+			else
+			{
+				meshes[i]->draw(shader);
+			}
+
+			if (viewSpaceVertices)
+			{
+				meshes[i]->bindTransformCache(false);
+			}
+		}
+
+		return;
+	}
+
+	GLenum primitive = mode == DRAW_ADJACENCIES ? GL_TRIANGLES_ADJACENCY : GL_TRIANGLES;
+	Mesh *batchMesh = nullptr;
+
+	store->beginBatch();
+
+	for (unsigned int i = 0; i < batchOrder.size(); i++)
+	{
+		Mesh *mesh = meshes[batchOrder[i]];
+
+		// - Frustum culling
+		if (!(outline ? mesh->isOutlineVisible() : mesh->isVisible()))
+		{
+			continue;
+		}
+
+		// - Cambio de texturas: dibujar el lote anterior y aplicar las texturas del nuevo
+		if (mode == DRAW_TEXTURES && (batchMesh == nullptr || mesh->getTextures() != batchMesh->getTextures()))
+		{
+			store->drawBatch(primitive);
+			store->beginBatch();
+
+			mesh->applyTextures(shader);
+			batchMesh = mesh;
+		}
+
+		mesh->addToBatch(mode == DRAW_ADJACENCIES);
+	}
+
+	store->drawBatch(primitive);
+}
+
+// - Mtodo privado: mallas de las que se extraen las aristas caractersticas (la topologa se copia;
+//   los vrtices y las coordenadas de textura no cambian tras cargar la malla)
+std::vector<FeatureEdgeMesh> Model::getFeatureEdgeSources()
+{
+	std::vector<FeatureEdgeMesh> sources(meshes.size());
+
+	for (unsigned int i = 0; i < meshes.size(); i++)
+	{
+		sources[i].vertices = &meshes[i]->getVertices();
+		sources[i].texCoords = &meshes[i]->getTexCoords();
+		sources[i].topology = meshes[i]->getTopology();
+		sources[i].material = meshMaterials[i];
+	}
+
+	return sources;
+}
+
+// - Mtodo privado: asignar a cada malla sus aristas caractersticas
+size_t Model::applyFeatureEdges(const std::vector<std::vector<unsigned int>> &lines)
+{
+	size_t bytes = 0;
+
+	for (unsigned int i = 0; i < meshes.size() && i < lines.size(); i++)
+	{
+		bytes += meshes[i]->setFeatureEdges(lines[i]);
+	}
+
+	return bytes;
+}
+
+// - Mtodo privado: si la extraccin en segundo plano ha terminado, subir sus aristas; si no hay
+//   ninguna en curso y los parmetros han cambiado desde la ltima, lanzar otra. Mientras tanto se
+//   dibujan las aristas anteriores. Al mover un control de la GUI, los cambios que llegan durante
+//   una extraccin se recogen en la siguiente
+void Model::updateFeatureEdges()
+{
+	if (featureEdgeJob.valid())
+	{
+		if (featureEdgeJob.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		{
+			return;
+		}
+
+		applyFeatureEdges(featureEdgeJob.get());
+		featureEdgeVersion = featureEdgeJobVersion;
+		FeatureEdges::endJob();
+	}
+
+	if (featureEdgeVersion == FeatureEdges::getVersion() || meshes.empty())
+	{
+		return;
+	}
+
+	featureEdgeJobVersion = FeatureEdges::getVersion();
+	featureEdgeJob = std::async(std::launch::async, &FeatureEdges::extract, getFeatureEdgeSources(), FeatureEdges::getSettings());
+	FeatureEdges::beginJob();
+}
+
 // - Dibujado del modelo de forma realista
 void Model::drawRealistic(ShaderProgram &shader, glm::mat4 mModel,
 						  glm::mat4 mView, glm::mat4 mProjection)
 {
-	// - Asignar matriz de modelado, visin y proyeccin
-	shader.setUniform("mvpMatrix", mProjection * mView * mModel);
-	shader.setUniform("mModelView", mView * mModel);
+	// - Asignar matriz de modelado, visin y proyeccin (identidad y proyeccin si los vrtices se
+	//   leen de la cach de transformaciones)
+	useTransformCache(shader, mView);
+	shader.setUniform("mvpMatrix", getMVPMatrix(mModel, mView, mProjection));
+	shader.setUniform("mModelView", getModelViewMatrix(mModel, mView));
 	shader.setUniform("KaMaterial", material->getKa());
 	shader.setUniform("KdMaterial", material->getKd());
 	shader.setUniform("KsMaterial", material->getKs());
 	shader.setUniform("shininess", material->getShininess());
 
-	for (unsigned int i = 0; i < meshes.size(); i++)
-	{
-		meshes[i]->drawWithTextures(shader);
-	}
+	drawMeshes(shader, DRAW_TEXTURES);
 }
 
 // - Dibujado del modelo de forma monocromtica (material)
 void Model::drawMonochrome(ShaderProgram &shader, glm::mat4 mModel,
 						   glm::mat4 mView, glm::mat4 mProjection)
 {
-	// - Asignar matriz de modelado, visin y proyeccin
-	shader.setUniform("mvpMatrix", mProjection * mView * mModel);
-	shader.setUniform("mModelView", mView * mModel);
+	// - Asignar matriz de modelado, visin y proyeccin (identidad y proyeccin si los vrtices se
+	//   leen de la cach de transformaciones)
+	useTransformCache(shader, mView);
+	shader.setUniform("mvpMatrix", getMVPMatrix(mModel, mView, mProjection));
+	shader.setUniform("mModelView", getModelViewMatrix(mModel, mView));
 	shader.setUniform("KaMaterial", monochrome.material.getKa());
 	shader.setUniform("KdMaterial", monochrome.material.getKd());
 	shader.setUniform("KsMaterial", monochrome.material.getKs());
 	shader.setUniform("shininess", monochrome.material.getShininess());
 
-	for (unsigned int i = 0; i < meshes.size(); i++)
-	{
-		meshes[i]->draw(shader);
-	}
+	drawMeshes(shader, DRAW_GEOMETRY);
 }
 
 // - Dibujado del modelo utilizando la tcnica Cel-Shading
 void Model::drawCelShading(ShaderProgram &shader, glm::mat4 mModel,
 						   glm::mat4 mView, glm::mat4 mProjection)
 {
-	// - Asignar matriz de modelado, visin y proyeccin
-	shader.setUniform("mvpMatrix", mProjection * mView * mModel);
-	shader.setUniform("mModelView", mView * mModel);
+	// - Asignar matriz de modelado, visin y proyeccin (identidad y proyeccin si los vrtices se
+	//   leen de la cach de transformaciones)
+	useTransformCache(shader, mView);
+	shader.setUniform("mvpMatrix", getMVPMatrix(mModel, mView, mProjection));
+	shader.setUniform("mModelView", getModelViewMatrix(mModel, mView));
 	shader.setUniform("KaMaterial", material->getKa());
 	shader.setUniform("KdMaterial", material->getKd());
 	shader.setUniform("KsMaterial", material->getKs());
@@ -480,19 +933,18 @@ void Model::drawCelShading(ShaderProgram &shader, glm::mat4 mModel,
 	shader.setUniform("tones", celShading.tones);
 	shader.setUniform("silhouettingFactor", celShading.silhouettingFactor);
 
-	for (unsigned int i = 0; i < meshes.size(); i++)
-	{
-		meshes[i]->drawWithTextures(shader);
-	}
+	drawMeshes(shader, DRAW_TEXTURES);
 }
 
 // - Dibujado del modelo utilizando la tcnica Hatching
 void Model::drawHatching(ShaderProgram &shader, glm::mat4 mModel,
 						 glm::mat4 mView, glm::mat4 mProjection)
 {
-	// - Asignar matriz de modelado, visin y proyeccin
-	shader.setUniform("mvpMatrix", mProjection * mView * mModel);
-	shader.setUniform("mModelView", mView * mModel);
+	// - Asignar matriz de modelado, visin y proyeccin (identidad y proyeccin si los vrtices se
+	//   leen de la cach de transformaciones)
+	useTransformCache(shader, mView);
+	shader.setUniform("mvpMatrix", getMVPMatrix(mModel, mView, mProjection));
+	shader.setUniform("mModelView", getModelViewMatrix(mModel, mView));
 	shader.setUniform("KaMaterial", glm::vec3(1.0));
 	shader.setUniform("KdMaterial", glm::vec3(1.0));
 	shader.setUniform("KsMaterial", glm::vec3(1.0));
@@ -520,19 +972,18 @@ void Model::drawHatching(ShaderProgram &shader, glm::mat4 mModel,
 	hatchBright->bindTexture(GL_TEXTURE_2D, (loadedTextures.size() + 1));
 	shader.setUniform("hatchBright", (int) (loadedTextures.size() + 1));
 
-	for (unsigned int i = 0; i < meshes.size(); i++)
-	{
-		meshes[i]->draw(shader);
-	}
+	drawMeshes(shader, DRAW_GEOMETRY);
 }
 
 // - Dibujado del modelo utilizando la tcnica Gooch Shading
 void Model::drawGoochShading(ShaderProgram &shader, glm::mat4 mModel,
 							 glm::mat4 mView, glm::mat4 mProjection)
 {
-	// - Asignar matriz de modelado, visin y proyeccin
-	shader.setUniform("mvpMatrix", mProjection * mView * mModel);
-	shader.setUniform("mModelView", mView * mModel);
+	// - Asignar matriz de modelado, visin y proyeccin (identidad y proyeccin si los vrtices se
+	//   leen de la cach de transformaciones)
+	useTransformCache(shader, mView);
+	shader.setUniform("mvpMatrix", getMVPMatrix(mModel, mView, mProjection));
+	shader.setUniform("mModelView", getModelViewMatrix(mModel, mView));
 	shader.setUniform("KaMaterial", material->getKa());
 	shader.setUniform("KdMaterial", material->getKd());
 	shader.setUniform("KsMaterial", material->getKs());
@@ -542,42 +993,170 @@ void Model::drawGoochShading(ShaderProgram &shader, glm::mat4 mModel,
 	shader.setUniform("alpha", goochShading.alpha);
 	shader.setUniform("beta", goochShading.beta);
 
-	for (unsigned int i = 0; i < meshes.size(); i++)
-	{
-		meshes[i]->drawWithTextures(shader);
-	}
+	drawMeshes(shader, DRAW_TEXTURES);
+}
+
+// - Dibujado de la profundidad del modelo (pre-pasada de profundidad)
+void Model::drawDepth(ShaderProgram &shader, glm::mat4 mModel,
+					  glm::mat4 mView, glm::mat4 mProjection)
+{
+	// - Asignar matriz de modelado, visin y proyeccin (identidad y proyeccin si los vrtices se
+	//   leen de la cach de transformaciones)
+	useTransformCache(shader, mView);
+	shader.setUniform("mvpMatrix", getMVPMatrix(mModel, mView, mProjection));
+
+	drawMeshes(shader, DRAW_GEOMETRY);
+}
+
+// - Dibujado de la normal y la profundidad del modelo (pre-pasada del contorno en espacio de pantalla)
+void Model::drawNormals(ShaderProgram &shader, glm::mat4 mModel,
+						glm::mat4 mView, glm::mat4 mProjection)
+{
+	// - Asignar matriz de modelado, visin y proyeccin (identidad y proyeccin si los vrtices se
+	//   leen de la cach de transformaciones)
+	useTransformCache(shader, mView);
+	shader.setUniform("mvpMatrix", getMVPMatrix(mModel, mView, mProjection));
+	shader.setUniform("mModelView", getModelViewMatrix(mModel, mView));
+
+	drawMeshes(shader, DRAW_GEOMETRY);
 }
 
 // - Dibujado del contorno del modelo
 void Model::drawBasicOutline(ShaderProgram &shader, glm::mat4 mModel,
 							 glm::mat4 mView, glm::mat4 mProjection)
 {
-	// - Asignar matriz de modelado, visin y proyeccin
-	shader.setUniform("mvpMatrix", mProjection * mView * mModel);
-	shader.setUniform("mModelView", mView * mModel);
+	// - Asignar matriz de modelado, visin y proyeccin (identidad y proyeccin si los vrtices se
+	//   leen de la cach de transformaciones)
+	useTransformCache(shader, mView);
+	shader.setUniform("mvpMatrix", getMVPMatrix(mModel, mView, mProjection));
+	shader.setUniform("mModelView", getModelViewMatrix(mModel, mView));
 	shader.setUniform("mProjection", mProjection);
 	shader.setUniform("outlineColor", basicOutline.color);
 	shader.setUniform("outlineThickness", basicOutline.thickness);
 
-	for (unsigned int i = 0; i < meshes.size(); i++)
-	{
-		meshes[i]->draw(shader);
-	}
+	drawMeshes(shader, DRAW_OUTLINE);
 }
 
 // - Dibujado del contorno avanzado del modelo
 void Model::drawAdvancedOutline(ShaderProgram &shader, glm::mat4 mModel,
 								glm::mat4 mView, glm::mat4 mProjection)
 {
-	// - Asignar matriz de modelado, visin y proyeccin
-	shader.setUniform("mModelView", mView * mModel);
+	// - Asignar matriz de modelado, visin y proyeccin (identidad y proyeccin si los vrtices se
+	//   leen de la cach de transformaciones)
+	useTransformCache(shader, mView);
+	shader.setUniform("mModelView", getModelViewMatrix(mModel, mView));
 	shader.setUniform("mProjection", mProjection);
 	shader.setUniform("outlineColor", advancedOutline.color);
 	shader.setUniform("outlineThickness", advancedOutline.thickness);
 	shader.setUniform("lineExtension", advancedOutline.extension);
 
+	// - Jerarquas de siluetas: cada malla slo dibuja los grupos de tringulos que pueden tener
+	//   aristas de la silueta con la orientacin del modelo. Las instancias tienen orientaciones
+	//   distintas, as que dibujan todos. Las jerarquas estn en el espacio del modelo, as que con
+	//   la cach de transformaciones se usa la matriz de modelado-visin del modelo
+	glm::vec3 viewDirection = SilhouetteClusters::getViewDirection(viewSpaceVertices ? mView * mModel : getModelViewMatrix(mModel, mView));
+	bool instanced = shader.isInstanced();
+
+	for (unsigned int i = 0; i < meshes.size(); i++)
+	{
+		if (meshes[i]->isOutlineVisible())
+		{
+			meshes[i]->selectSilhouetteClusters(instanced ? nullptr : &viewDirection);
+		}
+	}
+
+	drawMeshes(shader, DRAW_ADJACENCIES);
+}
+
+// - Dibujado de las aristas caractersticas del modelo (las de la ltima extraccin terminada)
+void Model::drawFeatureEdges(ShaderProgram &shader, glm::mat4 mModel,
+							 glm::mat4 mView, glm::mat4 mProjection)
+{
+	updateFeatureEdges();
+
+	// - Asignar matriz de modelado, visin y proyeccin (identidad y proyeccin si los vrtices se
+	//   leen de la cach de transformaciones)
+	useTransformCache(shader, mView);
+	shader.setUniform("mvpMatrix", getMVPMatrix(mModel, mView, mProjection));
+
+	for (unsigned int i = 0; i < meshes.size(); i++)
+	{
+		// - Frustum culling
+		if (meshes[i]->isVisible())
+		{
+			if (viewSpaceVertices)
+			{
+				meshes[i]->bindTransformCache(true);
+				meshes[i]->drawFeatureEdges(shader);
+				meshes[i]->bindTransformCache(false);
+			}
+			else
+			{
+				meshes[i]->drawFeatureEdges(shader);
+			}
+		}
+	}
+}
+
+// - Transformar los vrtices de las mallas visibles (para las tcnicas o para los contornos) al
+//   espacio de visin. Se reserva un solo rango para todas, as que el modelo se dibuja desde la
+//   cach con todas sus mallas o sin ella
+void Model::captureTransform(ShaderProgram &shader, glm::mat4 mModel, glm::mat4 mView)
+{
+	TransformCache *cache = TransformCache::getInstance();
+	unsigned int numVertices = 0;
+	size_t offset = 0;
+
+	for (unsigned int i = 0; i < meshes.size(); i++)
+	{
+		if (meshes[i]->isVisible() || meshes[i]->isOutlineVisible())
+		{
+			numVertices += meshes[i]->getNumVertices();
+		}
+	}
+
+	if (!cache->allocate(numVertices, offset))
+	{
+		return;
+	}
+
+	shader.setUniform("mModelView", getModelViewMatrix(mModel, mView));
+
+	for (unsigned int i = 0; i < meshes.size(); i++)
+	{
+		if (meshes[i]->isVisible() || meshes[i]->isOutlineVisible())
+		{
+			meshes[i]->captureTransform(offset);
+			offset += sizeof(PosNorm) * meshes[i]->getNumVertices();
+		}
+	}
+}
+
+// - Saber si el modelo se dibuja desde la cach de transformaciones: sus vrtices se transformaron
+//   en este frame con la misma matriz de visin y estn todas las mallas visibles. Todas las pasadas
+//   (tambin la pre-pasada de profundidad malla a malla) usan esta regla, para que la profundidad
+//   de cada malla se calcule siempre igual
+bool Model::isTransformCached(const glm::mat4 &mView)
+{
+	if (meshes.empty() || !TransformCache::getInstance()->isValid(mView))
+	{
+		return false;
+	}
+
 	for (unsigned int i = 0; i < meshes.size(); i++)
 	{
-		meshes[i]->drawAdvancedOutline(shader);
+		if ((meshes[i]->isVisible() || meshes[i]->isOutlineVisible()) && !meshes[i]->isTransformCached())
+		{
+			return false;
+		}
 	}
+
+	return true;
+}
+
+// - Mtodo privado: el dibujado lee los vrtices de la cach de transformaciones si el modelo est
+//   en ella. Las variantes instanciadas y el compute shader de siluetas leen los vrtices del modelo
+void Model::useTransformCache(ShaderProgram &shader, const glm::mat4 &mView)
+{
+	viewSpaceVertices = !shader.isInstanced() && !shader.isCompute() && isTransformCached(mView);
 }
\ No newline at end of file
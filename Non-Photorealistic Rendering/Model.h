@@ -1,5 +1,6 @@
 #pragma once
 
+#include <future>
 #include <map>
 
 #include <assimp/Importer.hpp>
@@ -9,6 +10,7 @@
 #include "Element3D.h"
 #include "Mesh.h"
 #include "Material.h"
+#include "FeatureEdges.h"
 
 class Model: public Element3D
 {
@@ -17,9 +19,21 @@ private:
 	std::vector<Mesh*> meshes;
 	std::string directory;
 
+	// - Orden de las mallas en el dibujado por lotes (las que comparten texturas quedan seguidas)
+	std::vector<unsigned int> batchOrder;
+
 	// - Mapa de ejes (adyacencias)
 	std::map<std::pair<unsigned int, unsigned int>, HalfEdge*> edges;
 
+	// - Material de cada malla (ndice del material de Assimp), para las aristas caractersticas
+	std::vector<unsigned int> meshMaterials;
+
+	// - Aristas caractersticas: versin de los parmetros con la que se extrajeron y extraccin en
+	//   segundo plano (con la versin que se est extrayendo)
+	unsigned int featureEdgeVersion;
+	unsigned int featureEdgeJobVersion;
+	std::future<std::vector<std::vector<unsigned int>>> featureEdgeJob;
+
 	// - Texturas cargadas
 	std::vector<Texture*> loadedTextures;
 
@@ -46,15 +60,48 @@ private:
 	// - Construir vector de ndices con topologa y los ndices de los vrtices adyacentes
 	std::vector<unsigned int> buildTopologyPlusAdjacencies(std::vector<unsigned int> topology);
 
+	// - Dibujar las mallas visibles, por lotes o malla a malla
+	void drawMeshes(ShaderProgram &shader, MeshDrawMode mode);
+
+	// - Cach de transformaciones: decidir si el dibujado actual lee los vrtices transformados
+	void useTransformCache(ShaderProgram &shader, const glm::mat4 &mView);
+
+	// - Aristas caractersticas: mallas de las que se extraen, asignarlas a las mallas (devuelve su
+	//   memoria) y recoger o lanzar la extraccin en segundo plano
+	std::vector<FeatureEdgeMesh> getFeatureEdgeSources();
+	size_t applyFeatureEdges(const std::vector<std::vector<unsigned int>> &lines);
+	void updateFeatureEdges();
+
 public:
 	// - Constructor
 	Model(std::string path);
 
+	// - Leer un fichero con Assimp y las opciones de post-procesamiento de los modelos
+	static const aiScene* importFile(Assimp::Importer &importer, const std::string &path);
+
 	// - Destructor
 	~Model();
 
 	// - Cargar texturas de hatching
 	void setHatchingTextures(std::string dark, std::string bright);
+
+	// - Residencia: memoria de mallas y texturas, y liberacin de las imgenes decodificadas
+	void addMemoryUsage(MemoryUsage &usage) override;
+	void releaseTextureImages() override;
+
+	// - Almacn de la escena: el modelo se ordena por su primera textura y el VAO de su primera malla
+	GLuint getSortTexture() override;
+	GLuint getSortVertexArray() override;
+
+	// - Obtener malla dada su posicin y nmero de mallas del modelo
+	Mesh* getMesh(unsigned int pos);
+	unsigned int getNumMeshes();
+
+	// - Frustum culling: visibilidad del modelo y de sus mallas
+	void updateVisibility(const Frustum &frustum, glm::mat4 mModel, CullingStatistics &statistics) override;
+
+	// - BVH: una primitiva por malla
+	void collectPrimitives(glm::mat4 mModel, int sceneElement, std::vector<BVHPrimitive> &primitives) override;
 	
 	// - Dibujar el modelo de distintas formas
 	void drawRealistic(ShaderProgram &shader, glm::mat4 mModel,
@@ -72,6 +119,14 @@ public:
 	void drawGoochShading(ShaderProgram &shader, glm::mat4 mModel,
 						  glm::mat4 mView, glm::mat4 mProjection) override;
 
+	// - Dibujar slo la profundidad (pre-pasada de profundidad)
+	void drawDepth(ShaderProgram &shader, glm::mat4 mModel,
+				   glm::mat4 mView, glm::mat4 mProjection) override;
+
+	// - Dibujar la normal y la profundidad (pre-pasada del contorno en espacio de pantalla)
+	void drawNormals(ShaderProgram &shader, glm::mat4 mModel,
+					 glm::mat4 mView, glm::mat4 mProjection) override;
+
 	// - Dibujar contornos
 	void drawBasicOutline(ShaderProgram &shader, glm::mat4 mModel,
 						  glm::mat4 mView, glm::mat4 mProjection) override;
@@ -79,4 +134,13 @@ public:
 	void drawAdvancedOutline(ShaderProgram &shader, glm::mat4 mModel,
 							 glm::mat4 mView, glm::mat4 mProjection) override;
 
+	// - Dibujar las aristas caractersticas
+	void drawFeatureEdges(ShaderProgram &shader, glm::mat4 mModel,
+						  glm::mat4 mView, glm::mat4 mProjection) override;
+
+	// - Transformar los vrtices de las mallas visibles para la cach de transformaciones y saber si
+	//   el modelo se dibuja desde ella (todas sus mallas visibles o ninguna)
+	void captureTransform(ShaderProgram &shader, glm::mat4 mModel, glm::mat4 mView) override;
+	bool isTransformCached(const glm::mat4 &mView) override;
+
 };
\ No newline at end of file
@@ -0,0 +1,160 @@
+#include "OcclusionCuller.h"
+
+#include <algorithm>
+#include <gtc/matrix_transform.hpp>
+
+// - Constructor: caja unitaria [0, 1]^3 como 12 tringulos
+OcclusionCuller::OcclusionCuller()
+{
+	const glm::vec3 corners[8] =
+	{
+		glm::vec3(0.f, 0.f, 0.f), glm::vec3(1.f, 0.f, 0.f), glm::vec3(1.f, 1.f, 0.f), glm::vec3(0.f, 1.f, 0.f),
+		glm::vec3(0.f, 0.f, 1.f), glm::vec3(1.f, 0.f, 1.f), glm::vec3(1.f, 1.f, 1.f), glm::vec3(0.f, 1.f, 1.f)
+	};
+
+	const unsigned int faces[36] =
+	{
+		0, 2, 1, 0, 3, 2,
+		4, 5, 6, 4, 6, 7,
+		0, 1, 5, 0, 5, 4,
+		3, 6, 2, 3, 7, 6,
+		0, 4, 7, 0, 7, 3,
+		1, 2, 6, 1, 6, 5
+	};
+
+	std::vector<glm::vec3> vertices;
+
+	for (unsigned int i = 0; i < 36; i++)
+	{
+		vertices.push_back(corners[faces[i]]);
+	}
+
+	box = new VAO();
+	box->fillVBO(vertices);
+
+	occludedMeshes = 0;
+}
+
+// - Destructor
+OcclusionCuller::~OcclusionCuller()
+{
+	clear();
+	delete box;
+}
+
+// - Mtodo privado: saber si un punto est dentro de una caja ampliada
+bool OcclusionCuller::isInside(const AABB &box, const glm::vec3 &point, float margin)
+{
+	AABB inflated = box.inflate(margin);
+
+	return point.x >= inflated.min.x && point.y >= inflated.min.y && point.z >= inflated.min.z &&
+		   point.x <= inflated.max.x && point.y <= inflated.max.y && point.z <= inflated.max.z;
+}
+
+// - Leer los resultados disponibles del frame anterior (sin bloquear: si la consulta no ha
+//   terminado se mantiene el ltimo resultado) y ocultar las mallas que estaban ocultas. Si la
+//   cmara est dentro de la caja (ampliada con el plano cercano), la caja no se puede dibujar de
+//   forma fiable y la malla se considera visible
+void OcclusionCuller::applyResults(const std::vector<BVHPrimitive> &primitives, const glm::vec3 &eye, float zNear)
+{
+	candidates.clear();
+	occludedMeshes = 0;
+
+	for (unsigned int i = 0; i < primitives.size(); i++)
+	{
+		const BVHPrimitive &primitive = primitives[i];
+
+		if (primitive.mesh == nullptr || !primitive.mesh->isVisible())
+		{
+			continue;
+		}
+
+		candidates.push_back(i);
+
+		OcclusionQuery &query = queries[primitive.mesh];
+
+		if (query.pending)
+		{
+			GLuint available = 0;
+			glGetQueryObjectuiv(query.query, GL_QUERY_RESULT_AVAILABLE, &available);
+
+			if (available)
+			{
+				GLuint anySamplesPassed = 0;
+				glGetQueryObjectuiv(query.query, GL_QUERY_RESULT, &anySamplesPassed);
+
+				query.occluded = (anySamplesPassed == 0);
+				query.pending = false;
+			}
+		}
+
+		if (query.occluded && !isInside(primitive.bounds, eye, 2.f * zNear))
+		{
+			primitive.mesh->setVisibility(false, primitive.mesh->isOutlineVisible());
+			occludedMeshes++;
+		}
+	}
+}
+
+// - Lanzar las consultas de las mallas visibles en el frustum: se dibujan sus cajas sin escribir
+//   color ni profundidad. Las mallas con una consulta sin terminar no lanzan otra
+void OcclusionCuller::issueQueries(ShaderProgram &shader, const std::vector<BVHPrimitive> &primitives, glm::mat4 mViewProjection)
+{
+	glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+	glDepthMask(GL_FALSE);
+
+	for (unsigned int i = 0; i < candidates.size(); i++)
+	{
+		const BVHPrimitive &primitive = primitives[candidates[i]];
+		OcclusionQuery &query = queries[primitive.mesh];
+
+		if (query.pending)
+		{
+			continue;
+		}
+
+		if (query.query == 0)
+		{
+			glGenQueries(1, &query.query);
+		}
+
+		// - La caja se ampla un poco para que las mallas planas no tengan una caja sin volumen
+		AABB bounds = primitive.bounds.inflate(std::max(0.01f * glm::length(primitive.bounds.getExtents()), 1e-3f));
+
+		glm::mat4 mBox = glm::translate(glm::mat4(1.f), bounds.min);
+		mBox = glm::scale(mBox, bounds.max - bounds.min);
+
+		shader.setUniform("mvpMatrix", mViewProjection * mBox);
+
+		glBeginQuery(GL_ANY_SAMPLES_PASSED, query.query);
+		box->draw(36);
+		glEndQuery(GL_ANY_SAMPLES_PASSED);
+
+		query.pending = true;
+	}
+
+	glDepthMask(GL_TRUE);
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+}
+
+// - Eliminar todas las consultas (cambio de escena)
+void OcclusionCuller::clear()
+{
+	for (std::unordered_map<Mesh*, OcclusionQuery>::iterator it = queries.begin(); it != queries.end(); it++)
+	{
+		if (it->second.query != 0)
+		{
+			glDeleteQueries(1, &it->second.query);
+		}
+	}
+
+	queries.clear();
+	candidates.clear();
+	occludedMeshes = 0;
+}
+
+// - Mallas descartadas en el frame actual
+unsigned int OcclusionCuller::getOccludedMeshes()
+{
+	return occludedMeshes;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <unordered_map>
+#include <vector>
+
+#include "BoundingVolumes.h"
+#include "Mesh.h"
+#include "ShaderProgram.h"
+#include "VAO.h"
+
+// - Consulta de oclusin de una malla
+struct OcclusionQuery
+{
+	GLuint query;
+	bool pending;
+	bool occluded;
+
+	OcclusionQuery()
+	{
+		this->query = 0;
+		this->pending = false;
+		this->occluded = false;
+	}
+};
+
+// - La clase OcclusionCuller descarta las mallas ocultas usando consultas de oclusin de OpenGL
+//   sobre sus cajas envolventes. Las cajas se dibujan (sin escribir color ni profundidad) contra
+//   la profundidad de la pre-pasada y el resultado se lee en el frame siguiente, sin esperar a la
+//   GPU: una malla oculta en el frame anterior no se dibuja, y su consulta se sigue lanzando para
+//   detectar cundo vuelve a verse. Si la cmara est dentro de una caja, la malla se dibuja siempre
+class OcclusionCuller
+{
+private:
+	// - Consultas de cada malla
+	std::unordered_map<Mesh*, OcclusionQuery> queries;
+
+	// - Primitivas visibles en el frustum en el frame actual (candidatas a consulta)
+	std::vector<unsigned int> candidates;
+
+	// - Caja unitaria (proxy de las mallas)
+	VAO *box;
+
+	// - Mallas descartadas en el frame actual
+	unsigned int occludedMeshes;
+
+	// - Mtodo privado: saber si un punto est dentro de una caja ampliada
+	static bool isInside(const AABB &box, const glm::vec3 &point, float margin);
+
+public:
+	// - Constructor
+	OcclusionCuller();
+
+	// - Destructor
+	~OcclusionCuller();
+
+	// - Leer los resultados disponibles del frame anterior y ocultar las mallas que estaban ocultas
+	void applyResults(const std::vector<BVHPrimitive> &primitives, const glm::vec3 &eye, float zNear);
+
+	// - Lanzar las consultas de las mallas visibles en el frustum (se debe llamar tras la pre-pasada
+	//   de profundidad, con el shader de profundidad activado)
+	void issueQueries(ShaderProgram &shader, const std::vector<BVHPrimitive> &primitives, glm::mat4 mViewProjection);
+
+	// - Eliminar todas las consultas (cambio de escena)
+	void clear();
+
+	// - Mallas descartadas en el frame actual
+	unsigned int getOccludedMeshes();
+};
@@ -0,0 +1,95 @@
+#include "OverdrawCounter.h"
+
+// - Constructor
+OverdrawCounter::OverdrawCounter()
+{
+	for (int i = 0; i < 2; i++)
+	{
+		usedQueries[i] = 0;
+		shadingPasses[i] = 0;
+		viewportSamples[i] = 0;
+	}
+
+	currentFrame = 0;
+	shadedFragments = 0;
+	overdrawRatio = 0.f;
+}
+
+// - Destructor
+OverdrawCounter::~OverdrawCounter()
+{
+	for (int i = 0; i < 2; i++)
+	{
+		if (!queries[i].empty())
+		{
+			glDeleteQueries((GLsizei) queries[i].size(), queries[i].data());
+		}
+	}
+}
+
+// - Inicio de frame: el buffer que se va a reutilizar contiene las consultas de hace dos frames,
+//   que normalmente ya estn disponibles
+void OverdrawCounter::beginFrame(unsigned int width, unsigned int height)
+{
+	currentFrame = 1 - currentFrame;
+
+	if (usedQueries[currentFrame] > 0)
+	{
+		GLuint64 fragments = 0;
+
+		for (unsigned int i = 0; i < usedQueries[currentFrame]; i++)
+		{
+			GLuint64 samples = 0;
+			glGetQueryObjectui64v(queries[currentFrame][i], GL_QUERY_RESULT, &samples);
+			fragments += samples;
+		}
+
+		shadedFragments = fragments;
+		overdrawRatio = (viewportSamples[currentFrame] > 0 && shadingPasses[currentFrame] > 0) ?
+						(float) ((double) fragments / (viewportSamples[currentFrame] * shadingPasses[currentFrame])) : 0.f;
+	}
+
+	// - Muestras por pixel del framebuffer actual (1 si no es multimuestreado)
+	GLint samples = 0;
+	glGetIntegerv(GL_SAMPLES, &samples);
+
+	usedQueries[currentFrame] = 0;
+	shadingPasses[currentFrame] = 0;
+	viewportSamples[currentFrame] = (GLuint64) width * height * (samples > 1 ? samples : 1);
+}
+
+// - Inicio de una pasada de sombreado
+void OverdrawCounter::beginShading()
+{
+	std::vector<GLuint> &frameQueries = queries[currentFrame];
+
+	if (usedQueries[currentFrame] == frameQueries.size())
+	{
+		GLuint query;
+		glGenQueries(1, &query);
+		frameQueries.push_back(query);
+	}
+
+	glBeginQuery(GL_SAMPLES_PASSED, frameQueries[usedQueries[currentFrame]]);
+}
+
+// - Fin de una pasada de sombreado
+void OverdrawCounter::endShading()
+{
+	glEndQuery(GL_SAMPLES_PASSED);
+
+	usedQueries[currentFrame]++;
+	shadingPasses[currentFrame]++;
+}
+
+// - Fragmentos sombreados en el ltimo frame ledo
+GLuint64 OverdrawCounter::getShadedFragments()
+{
+	return shadedFragments;
+}
+
+// - Fragmentos sombreados por muestra del viewport y pasada de iluminacin
+float OverdrawCounter::getOverdrawRatio()
+{
+	return overdrawRatio;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <vector>
+
+// - La clase OverdrawCounter cuenta los fragmentos sombreados en cada frame con consultas
+//   GL_SAMPLES_PASSED alrededor de las pasadas de sombreado. Las consultas de un frame se leen dos
+//   frames despus (doble buffer) para no esperar a la GPU. El sobredibujado es el nmero de
+//   fragmentos sombreados por cada pixel (muestra) del viewport y pasada de iluminacin
+class OverdrawCounter
+{
+private:
+	// - Consultas de los dos ltimos frames y nmero de consultas usadas en cada uno
+	std::vector<GLuint> queries[2];
+	unsigned int usedQueries[2];
+	unsigned int currentFrame;
+
+	// - Pasadas de sombreado y muestras del viewport de cada frame
+	unsigned int shadingPasses[2];
+	GLuint64 viewportSamples[2];
+
+	// - Resultados del ltimo frame ledo
+	GLuint64 shadedFragments;
+	float overdrawRatio;
+
+public:
+	// - Constructor
+	OverdrawCounter();
+
+	// - Destructor
+	~OverdrawCounter();
+
+	// - Inicio de frame: leer los resultados del frame que ocupaba el buffer
+	void beginFrame(unsigned int width, unsigned int height);
+
+	// - Inicio y fin de una pasada de sombreado
+	void beginShading();
+	void endShading();
+
+	// - Resultados
+	GLuint64 getShadedFragments();
+	float getOverdrawRatio();
+};
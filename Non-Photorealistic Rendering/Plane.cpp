@@ -45,6 +45,15 @@ Plane::Plane(int width, int height, int tilingHorizontal, int tilingVertical)
 		topology.push_back(0xFFFFFFFF);
 	}
 
+	// - Volmenes envolventes
+	bounds = AABB::fromVertices(vertices);
+	boundingSphere = BoundingSphere::fromVertices(vertices, bounds);
+
+	// - Texturas (se cargan despus)
+	texture = nullptr;
+	hatchDark = nullptr;
+	hatchBright = nullptr;
+
 	// - Crear VAO
 	vao = new VAO();
 
@@ -69,11 +78,17 @@ Plane::~Plane()
 	textureCoords.clear();
 	tangents.clear();
 	topology.clear();
+
+	delete vao;
+	delete texture;
+	delete hatchDark;
+	delete hatchBright;
 }
 
 // - Cargar textura
 void Plane::loadTexture(std::string filename)
 {
+	delete texture;
 	texture = new Texture();
 	texture->loadImage(filename.c_str());
 	texture->bindTexture(GL_TEXTURE_2D, 0);
@@ -87,6 +102,9 @@ void Plane::loadTexture(std::string filename)
 // - Asignar texturas de Hatching
 void Plane::setHatchingTextures(std::string dark, std::string bright)
 {
+	delete hatchDark;
+	delete hatchBright;
+
 	hatchDark = new Texture();
 	hatchDark->loadImage(dark.c_str());
 	hatchDark->bindTexture(GL_TEXTURE_2D, 1);
@@ -106,13 +124,60 @@ void Plane::setHatchingTextures(std::string dark, std::string bright)
 							   0, GL_RGBA, GL_UNSIGNED_BYTE, hatchBright->getImage());
 }
 
+// - Sumar la memoria de la geometra y de las texturas
+void Plane::addMemoryUsage(MemoryUsage &usage)
+{
+	size_t geometryBytes = sizeof(PosNorm) * vertices.size() + sizeof(glm::vec2) * textureCoords.size() +
+						   sizeof(glm::vec3) * tangents.size() + sizeof(GLuint) * topology.size();
+
+	usage.gpuBytes += geometryBytes;
+	usage.hostBytes += geometryBytes;
+
+	Texture* textures[3] = { texture, hatchDark, hatchBright };
+
+	for (Texture *current : textures)
+	{
+		if (current != nullptr)
+		{
+			usage.gpuBytes += current->getGPUMemory();
+			usage.hostBytes += current->getHostMemory();
+		}
+	}
+}
+
+// - Liberar las imgenes decodificadas de las texturas
+void Plane::releaseTextureImages()
+{
+	Texture* textures[3] = { texture, hatchDark, hatchBright };
+
+	for (Texture *current : textures)
+	{
+		if (current != nullptr)
+		{
+			current->releaseImage();
+		}
+	}
+}
+
+// - Obtener la textura con la que se ordena el plano
+GLuint Plane::getSortTexture()
+{
+	return texture != nullptr ? texture->getId() : 0;
+}
+
+// - Obtener el VAO con el que se ordena el plano
+GLuint Plane::getSortVertexArray()
+{
+	return vao->getId();
+}
+
 // - Dibujado del plano de forma realista
 void Plane::drawRealistic(ShaderProgram &shader, glm::mat4 mModel,
 						  glm::mat4 mView, glm::mat4 mProjection)
 {
 	// - Asignar matriz de modelado, visin y proyeccin
-	shader.setUniform("mvpMatrix", mProjection * mView * mModel);
-	shader.setUniform("mModelView", mView * mModel);
+	shader.setUniform("mvpMatrix", getMVPMatrix(mModel, mView, mProjection));
+	shader.setUniform("mModelView", getModelViewMatrix(mModel, mView));
 	shader.setUniform("KaMaterial", material->getKa());
 	shader.setUniform("KdMaterial", material->getKd());
 	shader.setUniform("KsMaterial", material->getKs());
@@ -134,8 +199,8 @@ void Plane::drawMonochrome(ShaderProgram &shader, glm::mat4 mModel,
 						   glm::mat4 mView, glm::mat4 mProjection)
 {
 	// - Asignar matriz de modelado, visin y proyeccin
-	shader.setUniform("mvpMatrix", mProjection * mView * mModel);
-	shader.setUniform("mModelView", mView * mModel);
+	shader.setUniform("mvpMatrix", getMVPMatrix(mModel, mView, mProjection));
+	shader.setUniform("mModelView", getModelViewMatrix(mModel, mView));
 	shader.setUniform("KaMaterial", monochrome.material.getKa());
 	shader.setUniform("KdMaterial", monochrome.material.getKd());
 	shader.setUniform("KsMaterial", monochrome.material.getKs());
@@ -151,8 +216,8 @@ void Plane::drawCelShading(ShaderProgram &shader, glm::mat4 mModel,
 						   glm::mat4 mView, glm::mat4 mProjection)
 {
 	// - Asignar matriz de modelado, visin y proyeccin
-	shader.setUniform("mvpMatrix", mProjection * mView * mModel);
-	shader.setUniform("mModelView", mView * mModel);
+	shader.setUniform("mvpMatrix", getMVPMatrix(mModel, mView, mProjection));
+	shader.setUniform("mModelView", getModelViewMatrix(mModel, mView));
 	shader.setUniform("KaMaterial", material->getKa());
 	shader.setUniform("KdMaterial", material->getKd());
 	shader.setUniform("KsMaterial", material->getKs());
@@ -176,8 +241,8 @@ void Plane::drawHatching(ShaderProgram &shader, glm::mat4 mModel,
 						 glm::mat4 mView, glm::mat4 mProjection)
 {
 	// - Asignar matriz de modelado, visin y proyeccin
-	shader.setUniform("mvpMatrix", mProjection * mView * mModel);
-	shader.setUniform("mModelView", mView * mModel);
+	shader.setUniform("mvpMatrix", getMVPMatrix(mModel, mView, mProjection));
+	shader.setUniform("mModelView", getModelViewMatrix(mModel, mView));
 	shader.setUniform("KaMaterial", glm::vec3(1.0));
 	shader.setUniform("KdMaterial", glm::vec3(1.0));
 	shader.setUniform("KsMaterial", glm::vec3(1.0));
@@ -215,8 +280,8 @@ void Plane::drawGoochShading(ShaderProgram &shader, glm::mat4 mModel,
 							 glm::mat4 mView, glm::mat4 mProjection)
 {
 	// - Asignar matriz de modelado, visin y proyeccin
-	shader.setUniform("mvpMatrix", mProjection * mView * mModel);
-	shader.setUniform("mModelView", mView * mModel);
+	shader.setUniform("mvpMatrix", getMVPMatrix(mModel, mView, mProjection));
+	shader.setUniform("mModelView", getModelViewMatrix(mModel, mView));
 	shader.setUniform("KaMaterial", material->getKa());
 	shader.setUniform("KdMaterial", material->getKd());
 	shader.setUniform("KsMaterial", material->getKs());
@@ -237,13 +302,38 @@ void Plane::drawGoochShading(ShaderProgram &shader, glm::mat4 mModel,
 	vao->draw(GL_TRIANGLE_STRIP, topology);
 }
 
+// - Dibujado de la profundidad del plano (pre-pasada de profundidad)
+void Plane::drawDepth(ShaderProgram &shader, glm::mat4 mModel,
+					  glm::mat4 mView, glm::mat4 mProjection)
+{
+	// - Asignar matriz de modelado, visin y proyeccin
+	shader.setUniform("mvpMatrix", getMVPMatrix(mModel, mView, mProjection));
+
+	// - Dibujar plano
+	vao->fillIBO(topology);
+	vao->draw(GL_TRIANGLE_STRIP, topology);
+}
+
+// - Dibujado de la normal y la profundidad del plano (pre-pasada del contorno en espacio de pantalla)
+void Plane::drawNormals(ShaderProgram &shader, glm::mat4 mModel,
+						glm::mat4 mView, glm::mat4 mProjection)
+{
+	// - Asignar matriz de modelado, visin y proyeccin
+	shader.setUniform("mvpMatrix", getMVPMatrix(mModel, mView, mProjection));
+	shader.setUniform("mModelView", getModelViewMatrix(mModel, mView));
+
+	// - Dibujar plano
+	vao->fillIBO(topology);
+	vao->draw(GL_TRIANGLE_STRIP, topology);
+}
+
 // - Dibujado del contorno del plano
 void Plane::drawBasicOutline(ShaderProgram &shader, glm::mat4 mModel, 
 						glm::mat4 mView, glm::mat4 mProjection)
 {
 	// - Asignar matriz de modelado, visin y proyeccin
-	shader.setUniform("mvpMatrix", mProjection * mView * mModel);
-	shader.setUniform("mModelView", mView * mModel);
+	shader.setUniform("mvpMatrix", getMVPMatrix(mModel, mView, mProjection));
+	shader.setUniform("mModelView", getModelViewMatrix(mModel, mView));
 	shader.setUniform("mProjection", mProjection);
 	shader.setUniform("outlineColor", basicOutline.color);
 	shader.setUniform("outlineThickness", basicOutline.thickness);
@@ -258,12 +348,18 @@ void Plane::drawAdvancedOutline(ShaderProgram &shader, glm::mat4 mModel,
 								glm::mat4 mView, glm::mat4 mProjection)
 {
 	// - Asignar matriz de modelado, visin y proyeccin
-	shader.setUniform("mModelView", mView * mModel);
+	shader.setUniform("mModelView", getModelViewMatrix(mModel, mView));
 	shader.setUniform("mProjection", mProjection);
 	shader.setUniform("outlineColor", glm::vec3(0.f));
 	shader.setUniform("outlineThickness", 0.f);
 	shader.setUniform("lineExtension", 0.f);
 
+	// - El plano no tiene contorno (grosor nulo): no se buscan sus siluetas con el compute shader
+	if (shader.isCompute())
+	{
+		return;
+	}
+
 	// - Dibujar plano
 	vao->fillIBOAdjacencies(topology);
 	vao->draw(GL_TRIANGLES_ADJACENCY, topology);
@@ -50,6 +50,14 @@ public:
 	// - Cargar texturas de hatching
 	void setHatchingTextures(std::string dark, std::string bright);
 
+	// - Residencia: memoria de la geometra y las texturas, y liberacin de las imgenes decodificadas
+	void addMemoryUsage(MemoryUsage &usage) override;
+	void releaseTextureImages() override;
+
+	// - Almacn de la escena: el plano se ordena por su textura y su VAO
+	GLuint getSortTexture() override;
+	GLuint getSortVertexArray() override;
+
 	// - Dibujar el plano de distintas formas
 	void drawRealistic(ShaderProgram &shader, glm::mat4 mModel,
 					   glm::mat4 mView, glm::mat4 mProjection) override;
@@ -66,6 +74,14 @@ public:
 	void drawGoochShading(ShaderProgram &shader, glm::mat4 mModel,
 						  glm::mat4 mView, glm::mat4 mProjection) override;
 
+	// - Dibujar slo la profundidad (pre-pasada de profundidad)
+	void drawDepth(ShaderProgram &shader, glm::mat4 mModel,
+				   glm::mat4 mView, glm::mat4 mProjection) override;
+
+	// - Dibujar la normal y la profundidad (pre-pasada del contorno en espacio de pantalla)
+	void drawNormals(ShaderProgram &shader, glm::mat4 mModel,
+					 glm::mat4 mView, glm::mat4 mProjection) override;
+
 	// - Dibujar contornos
 	void drawBasicOutline(ShaderProgram &shader, glm::mat4 mModel,
 					 glm::mat4 mView, glm::mat4 mProjection) override;
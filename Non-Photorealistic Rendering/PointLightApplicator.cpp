@@ -24,7 +24,10 @@ void PointLightApplicator::apply(ShaderProgram &shader, LightSource *light)
 	shader.setUniform("constant", 1.f);
 	shader.setUniform("linear", 0.f);
 	shader.setUniform("quadratic", 0.f);
+}
 
-	// - Utilizar subrutina
-	shader.setSubroutine("LightUniform", "PointLight", GL_FRAGMENT_SHADER, 1);
+// - Obtener variante de los shader programs para la luz puntual
+ShaderProgramVariant PointLightApplicator::getVariant()
+{
+	return POINT_LIGHT_VARIANT;
 }
\ No newline at end of file
@@ -0,0 +1,270 @@
+#include "ProgramBinaryCache.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#define PROGRAM_CACHE_MKDIR(path) _mkdir(path)
+#else
+#define PROGRAM_CACHE_MKDIR(path) mkdir(path, 0755)
+#endif
+
+// - Singleton (inicializacin perezosa)
+ProgramBinaryCache* ProgramBinaryCache::instance = nullptr;
+
+// - Directorio por defecto de los binarios
+const std::string ProgramBinaryCache::DEFAULT_DIRECTORY = "ShaderCache";
+
+// - Identificador de los archivos de la cach
+static const uint32_t PROGRAM_CACHE_MAGIC = 0x4252504E;
+
+// - Constructor
+ProgramBinaryCache::ProgramBinaryCache()
+{
+	enabled = true;
+	supported = false;
+	initialized = false;
+	directory = DEFAULT_DIRECTORY;
+	driverHash = 0;
+
+	hits = 0;
+	misses = 0;
+	milliseconds = 0.0;
+}
+
+// - Acceder al singleton
+ProgramBinaryCache* ProgramBinaryCache::getInstance()
+{
+	if (instance == nullptr)
+	{
+		instance = new ProgramBinaryCache();
+	}
+
+	return instance;
+}
+
+// - Mtodo privado: comprobar que el driver admite al menos un formato de binario y calcular la huella
+//   del driver (fabricante, versin y nombre)
+void ProgramBinaryCache::initialize()
+{
+	if (initialized)
+	{
+		return;
+	}
+
+	initialized = true;
+
+	GLint numFormats = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+	supported = numFormats > 0;
+
+	if (!supported)
+	{
+		std::cout << "Program binaries not supported by the driver: shader cache disabled" << std::endl;
+		return;
+	}
+
+	const GLubyte *strings[] = { glGetString(GL_VENDOR), glGetString(GL_VERSION), glGetString(GL_RENDERER) };
+	driverHash = 14695981039346656037ULL;
+
+	for (const GLubyte *string : strings)
+	{
+		driverHash = hashString(string != nullptr ? (const char *) string : "", driverHash);
+	}
+
+	PROGRAM_CACHE_MKDIR(directory.c_str());
+}
+
+// - Mtodo privado: ruta del binario de una huella
+std::string ProgramBinaryCache::getPath(uint64_t key)
+{
+	std::ostringstream path;
+	path << directory << "/" << std::hex << std::setw(16) << std::setfill('0') << key << ".bin";
+
+	return path.str();
+}
+
+// - Activar o desactivar la cach
+void ProgramBinaryCache::setEnabled(bool enabled)
+{
+	this->enabled = enabled;
+}
+
+// - Saber si la cach est activada
+bool ProgramBinaryCache::isEnabled()
+{
+	return enabled;
+}
+
+// - Huella FNV-1a de 64 bits de una cadena. Se aade tambin la longitud, para que la huella de
+//   varias cadenas seguidas dependa de dnde empieza cada una
+uint64_t ProgramBinaryCache::hashString(const std::string &text, uint64_t hash)
+{
+	for (size_t i = 0; i < text.size(); i++)
+	{
+		hash ^= (unsigned char) text[i];
+		hash *= 1099511628211ULL;
+	}
+
+	hash ^= text.size();
+	hash *= 1099511628211ULL;
+
+	return hash;
+}
+
+// - Huella de un programa
+uint64_t ProgramBinaryCache::computeKey(const std::vector<std::string> &sources)
+{
+	initialize();
+
+	uint64_t key = driverHash;
+
+	for (const std::string &source : sources)
+	{
+		key = hashString(source, key);
+	}
+
+	return key;
+}
+
+// - Cargar el binario de un programa. Si el driver no lo acepta (otro formato o driver actualizado
+//   con la misma versin), se borra el archivo para volver a guardarlo al compilar
+bool ProgramBinaryCache::load(uint64_t key, GLuint program)
+{
+	initialize();
+
+	if (!enabled || !supported)
+	{
+		return false;
+	}
+
+	std::string path = getPath(key);
+	std::ifstream file(path, std::ios::binary);
+
+	if (!file)
+	{
+		return false;
+	}
+
+	uint32_t magic = 0;
+	GLenum format = 0;
+	GLint length = 0;
+
+	file.read((char *) &magic, sizeof(magic));
+	file.read((char *) &format, sizeof(format));
+	file.read((char *) &length, sizeof(length));
+
+	if (!file || magic != PROGRAM_CACHE_MAGIC || length <= 0)
+	{
+		file.close();
+		std::remove(path.c_str());
+		return false;
+	}
+
+	std::vector<char> binary(length);
+	file.read(binary.data(), length);
+	bool complete = (bool) file;
+	file.close();
+
+	GLint linkSuccess = GL_FALSE;
+
+	if (complete)
+	{
+		glProgramBinary(program, format, binary.data(), length);
+		glGetProgramiv(program, GL_LINK_STATUS, &linkSuccess);
+	}
+
+	if (linkSuccess == GL_FALSE)
+	{
+		std::cout << "Discarding incompatible program binary: " << path << std::endl;
+		std::remove(path.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+// - Pedir al driver que conserve el binario del programa al enlazarlo
+void ProgramBinaryCache::prepare(GLuint program)
+{
+	initialize();
+
+	if (enabled && supported)
+	{
+		glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	}
+}
+
+// - Guardar el binario de un programa enlazado
+void ProgramBinaryCache::store(uint64_t key, GLuint program)
+{
+	if (!enabled || !supported)
+	{
+		return;
+	}
+
+	GLint length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+
+	if (length <= 0)
+	{
+		return;
+	}
+
+	std::vector<char> binary(length);
+	GLenum format = 0;
+	glGetProgramBinary(program, length, &length, &format, binary.data());
+
+	std::string path = getPath(key);
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+
+	if (!file)
+	{
+		std::cout << "Cannot write program binary: " << path << std::endl;
+		return;
+	}
+
+	file.write((const char *) &PROGRAM_CACHE_MAGIC, sizeof(PROGRAM_CACHE_MAGIC));
+	file.write((const char *) &format, sizeof(format));
+	file.write((const char *) &length, sizeof(length));
+	file.write(binary.data(), length);
+}
+
+// - Registrar el tiempo de creacin de un programa
+void ProgramBinaryCache::registerProgram(bool hit, double milliseconds)
+{
+	if (hit)
+	{
+		hits++;
+	}
+	else
+	{
+		misses++;
+	}
+
+	this->milliseconds += milliseconds;
+}
+
+// - Obtener nmero de programas cargados de la cach
+unsigned int ProgramBinaryCache::getHits()
+{
+	return hits;
+}
+
+// - Obtener nmero de programas compilados desde el cdigo fuente
+unsigned int ProgramBinaryCache::getMisses()
+{
+	return misses;
+}
+
+// - Obtener tiempo total de creacin de los programas (ms)
+double ProgramBinaryCache::getMilliseconds()
+{
+	return milliseconds;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// - La clase ProgramBinaryCache guarda en disco los binarios de los shader programs enlazados
+//   (glGetProgramBinary) y los carga en los siguientes arranques (glProgramBinary) en lugar de
+//   compilar y enlazar el cdigo fuente. Cada binario se identifica con una huella (FNV-1a de 64
+//   bits) del cdigo fuente de sus shader objects (con las definiciones de la variante) y del
+//   fabricante, versin y nombre del driver, as que cambiar un shader o el driver invalida el
+//   binario sin ms. Si el driver rechaza un binario (formato distinto), se borra y el programa se
+//   compila desde el cdigo fuente. Se implementa como un singleton para que lo use ShaderProgram
+class ProgramBinaryCache
+{
+private:
+	// - Singleton
+	static ProgramBinaryCache* instance;
+
+	// - Constructor privado (singleton)
+	ProgramBinaryCache();
+
+	// - Activacin, directorio de los binarios y huella del driver
+	bool enabled;
+	bool supported;
+	bool initialized;
+	std::string directory;
+	uint64_t driverHash;
+
+	// - Programas cargados de la cach y compilados desde el cdigo fuente, y tiempo total (ms)
+	unsigned int hits;
+	unsigned int misses;
+	double milliseconds;
+
+	// - Comprobar el soporte del driver y calcular su huella (necesita el contexto OpenGL)
+	void initialize();
+
+	// - Ruta del binario de una huella
+	std::string getPath(uint64_t key);
+
+public:
+	// - Directorio por defecto de los binarios
+	static const std::string DEFAULT_DIRECTORY;
+
+	// - Acceder al singleton
+	static ProgramBinaryCache* getInstance();
+
+	// - Activar o desactivar la cach (desactivada, todos los programas se compilan)
+	void setEnabled(bool enabled);
+	bool isEnabled();
+
+	// - Huella FNV-1a de 64 bits de una cadena, continuando la huella hash
+	static uint64_t hashString(const std::string &text, uint64_t hash = 14695981039346656037ULL);
+
+	// - Huella de un programa a partir del cdigo fuente de sus shader objects (incluye la del driver)
+	uint64_t computeKey(const std::vector<std::string> &sources);
+
+	// - Cargar el binario de un programa. Devuelve false si no est en la cach o el driver lo rechaza
+	bool load(uint64_t key, GLuint program);
+
+	// - Preparar un programa para poder leer su binario tras enlazarlo, y guardar el binario
+	void prepare(GLuint program);
+	void store(uint64_t key, GLuint program);
+
+	// - Registrar el tiempo de creacin de un programa (cargado de la cach o compilado)
+	void registerProgram(bool hit, double milliseconds);
+
+	// - Estadsticas de la cach
+	unsigned int getHits();
+	unsigned int getMisses();
+	double getMilliseconds();
+};
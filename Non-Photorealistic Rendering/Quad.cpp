@@ -34,6 +34,12 @@ Quad::~Quad()
 	texCoords.clear();
 }
 
+// - Dibujar el quad con el shader activo (sus uniforms ya estn asignados)
+void Quad::draw()
+{
+	vao->draw(vertices.size());
+}
+
 // - Dibujar la escena usando la tcnica Halftone
 void Quad::drawHalftone(ShaderProgram &shader, unsigned int textureUnit)
 {
@@ -65,12 +71,19 @@ void Quad::drawDithering(ShaderProgram &shader, unsigned int textureUnit)
 	vao->draw(vertices.size());
 }
 
-// - Dibujar la escena usando la tcnica Charcoal
-void Quad::drawCharcoal(ShaderProgram &shader, unsigned int textureUnit)
+// - Dibujar la escena usando la tcnica Charcoal. La profundidad de la escena (y la proyeccin
+//   inversa para hacerla lineal) permite detectar tambin los contornos entre superficies de colores
+//   parecidos
+void Quad::drawCharcoal(ShaderProgram &shader, unsigned int textureUnit, unsigned int depthUnit,
+						const glm::mat4 &mInverseProjection)
 {
 	shader.setUniform("TexScene", (int) textureUnit);
+	shader.setUniform("TexDepth", (int) depthUnit);
+	shader.setUniform("mInverseProjection", mInverseProjection);
 	shader.setUniform("enableSobel", charcoal.sobelFilter);
 	shader.setUniform("threshold", charcoal.threshold);
+	shader.setUniform("enableDepthEdges", charcoal.depthEdges);
+	shader.setUniform("depthThreshold", charcoal.depthThreshold);
 	shader.setUniform("edgeColor", charcoal.edgeColor);
 	shader.setUniform("charcoalColor", glm::vec3(0.1f) * charcoal.colorMultiplier);
 	shader.setUniform("noiseAmount", charcoal.noise);
@@ -47,10 +47,14 @@ public:
 	// - Destructor
 	~Quad();
 
+	// - Dibujar el quad con el shader activo (pasadas a pantalla completa del sombreado diferido)
+	void draw();
+
 	// - Modos de dibujado de post-procesamiento
 	void drawHalftone(ShaderProgram &shader, unsigned int textureUnit);
 	void drawDithering(ShaderProgram &shader, unsigned int textureUnit);
-	void drawCharcoal(ShaderProgram &shader, unsigned int textureUnit);
+	void drawCharcoal(ShaderProgram &shader, unsigned int textureUnit, unsigned int depthUnit,
+					  const glm::mat4 &mInverseProjection);
 	void drawPainterly(ShaderProgram &shader, unsigned int textureUnit);
 	void drawPixelArt(ShaderProgram &shader, unsigned int textureUnit);
 
@@ -0,0 +1,49 @@
+#include "RenderQueue.h"
+
+#include <algorithm>
+
+// - Construir una clave. La profundidad se cuantiza a 16 bits
+uint64_t RenderQueue::makeKey(unsigned int pass, GLuint program, GLuint textureSet, GLuint vertexArray, float depth)
+{
+	float clampedDepth = depth < 0.f ? 0.f : (depth > 1.f ? 1.f : depth);
+	uint64_t quantizedDepth = (uint64_t) (clampedDepth * 65535.f);
+
+	return ((uint64_t) (pass & 0xF) << 60) |
+		   ((uint64_t) (program & 0xFFF) << 48) |
+		   ((uint64_t) (textureSet & 0xFFFF) << 32) |
+		   ((uint64_t) (vertexArray & 0xFFFF) << 16) |
+		   quantizedDepth;
+}
+
+// - Vaciar la cola (se conserva la memoria reservada)
+void RenderQueue::clear()
+{
+	items.clear();
+}
+
+// - Aadir una orden de dibujo
+void RenderQueue::add(uint64_t key, unsigned int index)
+{
+	items.push_back(RenderItem(key, index));
+}
+
+// - Ordenar las rdenes por clave
+void RenderQueue::sort()
+{
+	std::stable_sort(items.begin(), items.end(), [](const RenderItem &a, const RenderItem &b)
+	{
+		return a.key < b.key;
+	});
+}
+
+// - Obtener orden de dibujo dada su posicin
+const RenderItem& RenderQueue::getItem(unsigned int pos)
+{
+	return items[pos];
+}
+
+// - Obtener nmero de rdenes de dibujo
+unsigned int RenderQueue::getNumItems()
+{
+	return (unsigned int) items.size();
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <cstdint>
+#include <vector>
+
+// - Elemento de la cola: clave de ordenacin y posicin del elemento que se dibuja
+struct RenderItem
+{
+	uint64_t key;
+	unsigned int index;
+
+	RenderItem(uint64_t key, unsigned int index)
+	{
+		this->key = key;
+		this->index = index;
+	}
+};
+
+// - La clase RenderQueue ordena las rdenes de dibujo de una pasada por una clave de 64 bits que
+//   agrupa el estado que comparten: pasada (bits 60-63), shader program (bits 48-59), texturas
+//   (bits 32-47), VAO (bits 16-31) y profundidad (bits 0-15, de delante hacia atrs). Al dibujarlas
+//   en ese orden, las rdenes seguidas con el mismo estado no lo cambian (la cach de estado evita
+//   las llamadas redundantes) y la prueba de profundidad descarta antes los fragmentos ocultos.
+//   Los identificadores que no caben en sus bits se truncan: slo empeora la agrupacin
+class RenderQueue
+{
+private:
+	std::vector<RenderItem> items;
+
+public:
+	// - Construir una clave (depth es la profundidad normalizada, de 0 a 1)
+	static uint64_t makeKey(unsigned int pass, GLuint program, GLuint textureSet, GLuint vertexArray, float depth);
+
+	// - Vaciar la cola
+	void clear();
+
+	// - Aadir una orden de dibujo
+	void add(uint64_t key, unsigned int index);
+
+	// - Ordenar las rdenes por clave (las de igual clave mantienen el orden en que se aadieron)
+	void sort();
+
+	// - rdenes de dibujo
+	const RenderItem& getItem(unsigned int pos);
+	unsigned int getNumItems();
+};
@@ -0,0 +1,207 @@
+#include "RenderStatistics.h"
+
+#ifdef ENABLE_RENDER_STATISTICS
+
+// - Singleton (inicializacin perezosa)
+RenderStatistics* RenderStatistics::instance = nullptr;
+
+// - Constructor
+RenderStatistics::RenderStatistics()
+{
+	currentProgram = 0;
+	currentFramebuffer = 0;
+}
+
+// - Acceder al singleton
+RenderStatistics* RenderStatistics::getInstance()
+{
+	if (instance == nullptr)
+	{
+		instance = new RenderStatistics();
+	}
+
+	return instance;
+}
+
+// - Inicio de frame: se ponen a cero los contadores del frame en curso
+void RenderStatistics::beginFrame()
+{
+	currentFrame.total.reset();
+	currentFrame.passes.clear();
+	unassigned.reset();
+	passStack.clear();
+}
+
+// - Fin de frame: se calcula el total y se guarda como ltimo frame completado
+void RenderStatistics::endFrame()
+{
+	currentFrame.total = unassigned;
+
+	for (unsigned int i = 0; i < currentFrame.passes.size(); i++)
+	{
+		currentFrame.total.add(currentFrame.passes[i].counters);
+	}
+
+	lastFrame = currentFrame;
+}
+
+// - Inicio de pasada. Las pasadas con el mismo nombre dentro de un frame se acumulan
+void RenderStatistics::beginPass(const std::string &name)
+{
+	int index = -1;
+
+	for (unsigned int i = 0; i < currentFrame.passes.size(); i++)
+	{
+		if (currentFrame.passes[i].name == name)
+		{
+			index = i;
+			break;
+		}
+	}
+
+	if (index < 0)
+	{
+		RenderPassCounters pass;
+		pass.name = name;
+		pass.invocations = 0;
+		currentFrame.passes.push_back(pass);
+		index = currentFrame.passes.size() - 1;
+	}
+
+	currentFrame.passes[index].invocations++;
+	passStack.push_back(index);
+}
+
+// - Fin de pasada
+void RenderStatistics::endPass()
+{
+	if (!passStack.empty())
+	{
+		passStack.pop_back();
+	}
+}
+
+// - Contadores de la pasada ms interna activa
+RenderCounters& RenderStatistics::activeCounters()
+{
+	if (passStack.empty())
+	{
+		return unassigned;
+	}
+
+	return currentFrame.passes[passStack.back()].counters;
+}
+
+// - Registrar una orden de dibujo y el nmero de tringulos que enva
+void RenderStatistics::registerDrawCall(GLenum mode, GLsizei count)
+{
+	RenderCounters &counters = activeCounters();
+	counters.drawCalls++;
+
+	switch (mode)
+	{
+		case GL_TRIANGLES:
+			counters.triangles += count / 3;
+			break;
+
+		case GL_TRIANGLES_ADJACENCY:
+			counters.triangles += count / 6;
+			break;
+
+		// - Aproximado: no se descuentan los ndices de reinicio de primitiva
+		case GL_TRIANGLE_STRIP:
+			counters.triangles += (count > 2) ? count - 2 : 0;
+			break;
+
+		default:
+			break;
+	}
+}
+
+// - Registrar la asignacin de un uniform
+void RenderStatistics::registerUniformUpdate()
+{
+	activeCounters().uniformUpdates++;
+}
+
+// - Registrar la activacin de un shader program
+void RenderStatistics::registerProgramSwitch(GLuint program)
+{
+	RenderCounters &counters = activeCounters();
+	counters.programSwitches++;
+
+	if (program == currentProgram)
+	{
+		counters.redundantProgramSwitches++;
+	}
+
+	currentProgram = program;
+}
+
+// - Registrar el enlazado de una textura en una unidad de textura
+void RenderStatistics::registerTextureBind(GLenum target, unsigned int unit, GLuint texture)
+{
+	RenderCounters &counters = activeCounters();
+	counters.textureBinds++;
+
+	unsigned long long key = ((unsigned long long) unit << 32) | target;
+	auto bound = boundTextures.find(key);
+
+	if (bound != boundTextures.end() && bound->second == texture)
+	{
+		counters.redundantTextureBinds++;
+	}
+
+	boundTextures[key] = texture;
+}
+
+// - Registrar el enlazado de un framebuffer
+void RenderStatistics::registerFramebufferSwitch(GLuint framebuffer)
+{
+	RenderCounters &counters = activeCounters();
+	counters.fboSwitches++;
+
+	if (framebuffer == currentFramebuffer)
+	{
+		counters.redundantFboSwitches++;
+	}
+
+	currentFramebuffer = framebuffer;
+}
+
+// - Registrar la subida de datos a un buffer. Se calcula una huella (FNV-1a) del contenido
+//   para detectar las subidas que repiten exactamente los mismos datos
+void RenderStatistics::registerBufferUpload(GLuint buffer, const void *data, size_t bytes)
+{
+	RenderCounters &counters = activeCounters();
+	counters.bufferUploads++;
+	counters.bytesUploaded += bytes;
+
+	unsigned long long fingerprint = 14695981039346656037ULL;
+	const unsigned char *bytePtr = static_cast<const unsigned char*>(data);
+
+	for (size_t i = 0; bytePtr != nullptr && i < bytes; i++)
+	{
+		fingerprint ^= bytePtr[i];
+		fingerprint *= 1099511628211ULL;
+	}
+
+	fingerprint ^= bytes;
+
+	std::unordered_map<GLuint, unsigned long long>::iterator it = bufferFingerprints.find(buffer);
+
+	if (it != bufferFingerprints.end() && it->second == fingerprint)
+	{
+		counters.redundantBufferUploads++;
+	}
+
+	bufferFingerprints[buffer] = fingerprint;
+}
+
+// - Estadsticas del ltimo frame completado
+const FrameStatistics& RenderStatistics::getLastFrame()
+{
+	return lastFrame;
+}
+
+#endif
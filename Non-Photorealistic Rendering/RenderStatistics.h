@@ -0,0 +1,176 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// - Las estadsticas de rendering slo se compilan si se define ENABLE_RENDER_STATISTICS
+//   (activado en las configuraciones Debug del proyecto). En Release las macros de
+//   instrumentacin se sustituyen por nada, de forma que no tienen ningn coste
+#ifdef ENABLE_RENDER_STATISTICS
+
+// - Contadores de llamadas a OpenGL y cambios de estado
+struct RenderCounters
+{
+	unsigned int drawCalls;
+	unsigned int triangles;
+	unsigned int uniformUpdates;
+	unsigned int programSwitches;
+	unsigned int redundantProgramSwitches;
+	unsigned int textureBinds;
+	unsigned int redundantTextureBinds;
+	unsigned int fboSwitches;
+	unsigned int redundantFboSwitches;
+	unsigned int bufferUploads;
+	unsigned int redundantBufferUploads;
+	size_t bytesUploaded;
+
+	// - Constructor por defecto
+	RenderCounters()
+	{
+		reset();
+	}
+
+	// - Poner a cero los contadores
+	void reset()
+	{
+		this->drawCalls = 0;
+		this->triangles = 0;
+		this->uniformUpdates = 0;
+		this->programSwitches = 0;
+		this->redundantProgramSwitches = 0;
+		this->textureBinds = 0;
+		this->redundantTextureBinds = 0;
+		this->fboSwitches = 0;
+		this->redundantFboSwitches = 0;
+		this->bufferUploads = 0;
+		this->redundantBufferUploads = 0;
+		this->bytesUploaded = 0;
+	}
+
+	// - Acumular los contadores de otra pasada
+	void add(const RenderCounters &counters)
+	{
+		this->drawCalls += counters.drawCalls;
+		this->triangles += counters.triangles;
+		this->uniformUpdates += counters.uniformUpdates;
+		this->programSwitches += counters.programSwitches;
+		this->redundantProgramSwitches += counters.redundantProgramSwitches;
+		this->textureBinds += counters.textureBinds;
+		this->redundantTextureBinds += counters.redundantTextureBinds;
+		this->fboSwitches += counters.fboSwitches;
+		this->redundantFboSwitches += counters.redundantFboSwitches;
+		this->bufferUploads += counters.bufferUploads;
+		this->redundantBufferUploads += counters.redundantBufferUploads;
+		this->bytesUploaded += counters.bytesUploaded;
+	}
+};
+
+// - Contadores de una pasada de rendering (identificada por su nombre)
+struct RenderPassCounters
+{
+	std::string name;
+	unsigned int invocations;
+	RenderCounters counters;
+};
+
+// - Estadsticas de un frame completo (total y desglose por pasadas)
+struct FrameStatistics
+{
+	RenderCounters total;
+	std::vector<RenderPassCounters> passes;
+};
+
+// - La clase RenderStatistics cuenta, frame a frame, las rdenes de dibujo y los cambios de
+//   estado que provoca cada pasada de rendering. Se implementa como un singleton para que
+//   pueda ser consultada desde las clases de bajo nivel (VAO, ShaderProgram, Texture, FBO)
+class RenderStatistics
+{
+private:
+	// - Singleton
+	static RenderStatistics* instance;
+
+	// - Constructor privado (singleton)
+	RenderStatistics();
+
+	// - Estadsticas del frame en curso y del ltimo frame completado
+	FrameStatistics currentFrame;
+	FrameStatistics lastFrame;
+
+	// - Pila de pasadas activas (los contadores se asignan a la pasada ms interna)
+	std::vector<int> passStack;
+
+	// - Estado enlazado actualmente (para detectar cambios redundantes). Cada unidad de textura
+	//   tiene un enlace por tipo de textura, as que las texturas se indexan por unidad y tipo
+	GLuint currentProgram;
+	GLuint currentFramebuffer;
+	std::unordered_map<unsigned long long, GLuint> boundTextures;
+
+	// - Huella del ltimo contenido subido a cada buffer (para detectar subidas redundantes)
+	std::unordered_map<GLuint, unsigned long long> bufferFingerprints;
+
+	// - Contadores de la pasada activa (o del frame si no hay ninguna)
+	RenderCounters& activeCounters();
+
+	// - Contadores "sin pasada" del frame en curso
+	RenderCounters unassigned;
+
+public:
+	// - Acceder al singleton
+	static RenderStatistics* getInstance();
+
+	// - Inicio y fin de frame
+	void beginFrame();
+	void endFrame();
+
+	// - Inicio y fin de pasada
+	void beginPass(const std::string &name);
+	void endPass();
+
+	// - Registrar eventos
+	void registerDrawCall(GLenum mode, GLsizei count);
+	void registerUniformUpdate();
+	void registerProgramSwitch(GLuint program);
+	void registerTextureBind(GLenum target, unsigned int unit, GLuint texture);
+	void registerFramebufferSwitch(GLuint framebuffer);
+	void registerBufferUpload(GLuint buffer, const void *data, size_t bytes);
+
+	// - Estadsticas del ltimo frame completado
+	const FrameStatistics& getLastFrame();
+};
+
+// - Objeto auxiliar que delimita una pasada de rendering durante su mbito
+class RenderPassScope
+{
+public:
+	RenderPassScope(const std::string &name) { RenderStatistics::getInstance()->beginPass(name); }
+	~RenderPassScope() { RenderStatistics::getInstance()->endPass(); }
+};
+
+#define RENDER_STATS_CONCAT_(a, b) a##b
+#define RENDER_STATS_CONCAT(a, b) RENDER_STATS_CONCAT_(a, b)
+
+#define RENDER_STATS_BEGIN_FRAME() RenderStatistics::getInstance()->beginFrame()
+#define RENDER_STATS_END_FRAME() RenderStatistics::getInstance()->endFrame()
+#define RENDER_STATS_PASS(name) RenderPassScope RENDER_STATS_CONCAT(renderPassScope, __LINE__)(name)
+#define RENDER_STATS_DRAW(mode, count) RenderStatistics::getInstance()->registerDrawCall(mode, count)
+#define RENDER_STATS_UNIFORM() RenderStatistics::getInstance()->registerUniformUpdate()
+#define RENDER_STATS_PROGRAM(program) RenderStatistics::getInstance()->registerProgramSwitch(program)
+#define RENDER_STATS_TEXTURE(target, unit, texture) RenderStatistics::getInstance()->registerTextureBind(target, unit, texture)
+#define RENDER_STATS_FRAMEBUFFER(framebuffer) RenderStatistics::getInstance()->registerFramebufferSwitch(framebuffer)
+#define RENDER_STATS_UPLOAD(buffer, data, bytes) RenderStatistics::getInstance()->registerBufferUpload(buffer, data, bytes)
+
+#else
+
+#define RENDER_STATS_BEGIN_FRAME()
+#define RENDER_STATS_END_FRAME()
+#define RENDER_STATS_PASS(name)
+#define RENDER_STATS_DRAW(mode, count)
+#define RENDER_STATS_UNIFORM()
+#define RENDER_STATS_PROGRAM(program)
+#define RENDER_STATS_TEXTURE(target, unit, texture)
+#define RENDER_STATS_FRAMEBUFFER(framebuffer)
+#define RENDER_STATS_UPLOAD(buffer, data, bytes)
+
+#endif
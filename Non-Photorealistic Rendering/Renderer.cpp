@@ -3,12 +3,23 @@
 #include "PointLightApplicator.h"
 #include "DirectionalLightApplicator.h"
 #include "SpotLightApplicator.h"
+#include "RenderStatistics.h"
+#include "LoadProfiler.h"
+#include "ResidencyManager.h"
+#include "GLStateCache.h"
+#include "LineArtExporter.h"
 
 // - Aqu se inicializa el singleton. Todava no se construye el objeto
 //   de la clase Renderer porque se usa inicializacin perezosa (lazy initialization)
 // - La primera vez que se consulte el singleton se inicializar
 Renderer* Renderer::instance = nullptr;
 
+// - Fragmentacin de la arena de buffers a partir de la cual se compacta tras cargar una escena
+static const float ARENA_DEFRAGMENTATION_THRESHOLD = 0.25f;
+
+// - Desplazamiento de la profundidad (coordenadas normalizadas) de las aristas caractersticas
+static const float FEATURE_EDGE_DEPTH_BIAS = 0.0005f;
+
 // - Constructor
 Renderer::Renderer()
 {
@@ -18,10 +29,18 @@ Renderer::Renderer()
 // - Destructor
 Renderer::~Renderer()
 {
+	// - La escena actual es una de las cargadas
 	delete scene1;
-	delete currentScene;
+	delete scene2;
+	delete scene3;
+	delete skybox;
 	delete camera;
 	delete fbo;
+	delete fboOutline;
+	delete gBuffer;
+	delete occlusionCuller;
+	delete overdrawCounter;
+	delete silhouetteExtractor;
 }
 
 // - Acceder al singleton.
@@ -66,16 +85,38 @@ void Renderer::frameBufferSizeCallback(int width, int height)
 	camera->setAspect(width, height);
 	mvp = camera->getViewProjectionMatrix() * currentScene->getModelMatrix();
 
-	// - FBO (Rendering a textura): Redimensionar buffers de color y profundidad
+	// - FBO (Rendering a textura): Redimensionar texturas de color y profundidad
 	if (fbo != nullptr)
 	{
 		fbo->bindRenderTexture();
 		fbo->createRenderTexture(width, height);
 		fbo->unbindRenderTexture();
 
-		fbo->bindDepthBuffer();
-		fbo->createDepthBuffer(width, height);
-		fbo->unbindDepthBuffer();
+		fbo->bindDepthTexture();
+		fbo->createDepthTexture(width, height);
+		fbo->unbindDepthTexture();
+	}
+
+	// - FBO del contorno en espacio de pantalla: redimensionar sus texturas
+	if (fboOutline != nullptr)
+	{
+		fboOutline->bindRenderTexture();
+		fboOutline->createRenderTexture(width, height);
+		fboOutline->unbindRenderTexture();
+
+		fboOutline->bindNormalTexture();
+		fboOutline->createNormalTexture(width, height);
+		fboOutline->unbindNormalTexture();
+
+		fboOutline->bindDepthTexture();
+		fboOutline->createDepthTexture(width, height);
+		fboOutline->unbindDepthTexture();
+	}
+
+	// - G-buffer (sombreado diferido): redimensionar sus texturas
+	if (gBuffer != nullptr)
+	{
+		gBuffer->resize(width, height);
 	}
 }
 
@@ -143,12 +184,50 @@ void Renderer::prepareOpenGL(int width, int height)
 	viewportWidth = width;
 	viewportHeight = height;
 
+	// - Frustum culling
+	enabledFrustumCulling = true;
+	enabledBVH = true;
+
+	// - Niveles de detalle
+	enabledLOD = true;
+	lodTriangles = 0;
+
+	for (unsigned int i = 0; i < Mesh::MAX_LODS; i++)
+	{
+		lodMeshes[i] = 0;
+	}
+
+	// - Pre-pasada de profundidad, occlusion culling y contador de sobredibujado
+	enabledDepthPrepass = false;
+	enabledOcclusionCulling = false;
+	occlusionCuller = new OcclusionCuller();
+	overdrawCounter = new OverdrawCounter();
+
+	// - Siluetas del contorno avanzado con compute shader (desactivadas: geometry shader)
+	enabledComputeSilhouettes = false;
+	silhouetteExtractor = new SilhouetteExtractor();
+
 	// - Nmero de escena seleccionada
 	selectedScene = 0;
 	loadedScene1 = false;
 	loadedScene2 = false;
 	loadedScene3 = false;
 
+	scene1 = nullptr;
+	scene2 = nullptr;
+	scene3 = nullptr;
+
+	// - Residencia: un recurso por escena, en el orden de selectedScene
+	pendingScene = -1;
+	ResidencyManager *residency = ResidencyManager::getInstance();
+
+	if (residency->getNumAssets() == 0)
+	{
+		residency->registerAsset("Scene 1");
+		residency->registerAsset("Scene 2");
+		residency->registerAsset("Scene 3");
+	}
+
 	// - Creacin del Skybox
 	skybox = new Cubemap();
 
@@ -161,33 +240,70 @@ void Renderer::prepareOpenGL(int width, int height)
 	// - Nmero de fuentes luminosas activas
 	numberOfLightsEnabled = 0;
 
-	// - Shader programs de modelos
-	realisticShader.createShaderProgram("Shaders/realistic");
-	realisticSkyboxShader.createShaderProgram("Shaders/realisticSkybox");
+	// - Compilacin bajo demanda: los shader programs se definen aqu y se compilan la primera vez que
+	//   se usa su tcnica o pasada (en segundo plano si el driver lo permite, con todos sus hilos)
+	if (ShaderProgram::isParallelCompileSupported())
+	{
+		if (GLEW_KHR_parallel_shader_compile)
+		{
+			glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+		}
+		else
+		{
+			glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+		}
+	}
+
+	// - Shader programs de modelos (las permutaciones se compilan al pedirlas)
+	realisticShaders.define("Shaders/realistic");
+	realisticSkyboxShader.defineShaderProgram("Shaders/realisticSkybox");
+
+	monochromeShaders.define("Shaders/monochrome");
+
+	celShadingShaders.define("Shaders/celShading");
+	celShadingSkyboxShader.defineShaderProgram("Shaders/celShadingSkybox");
 
-	monochromeShader.createShaderProgram("Shaders/monochrome");
+	hatchingShaders.define("Shaders/hatching");
+	hatchingSkyboxShader.defineShaderProgram("Shaders/hatchingSkybox");
 
-	celShadingShader.createShaderProgram("Shaders/celShading");
-	celShadingSkyboxShader.createShaderProgram("Shaders/celShadingSkybox");
+	goochShadingShaders.define("Shaders/goochShading");
 
-	hatchingShader.createShaderProgram("Shaders/hatching");
-	hatchingSkyboxShader.createShaderProgram("Shaders/hatchingSkybox");
+	// - Shader programs del sombreado diferido (permutaciones por tcnica y tipo de fuente luminosa)
+	gBufferShaders.define("Shaders/gBuffer");
+	deferredShaders.define("Shaders/deferred");
 
-	goochShadingShader.createShaderProgram("Shaders/goochShading");
+	depthPrepassShader.defineShaderProgram("Shaders/depthPrepass");
+
+	// - Shader programs de modelos instanciados (variantes instanciadas)
+	depthPrepassInstancedShader.defineShaderProgram("Shaders/depthPrepass", NO_GEOMETRY_SHADER, INSTANCED_VARIANT);
 
 	// - Shader programs de post-procesamiento
-	halftoneShader.createShaderProgram("Shaders/halftone");
-	ditheringShader.createShaderProgram("Shaders/dithering");
-	pixelArtShader.createShaderProgram("Shaders/pixelArt");
-	painterlyShader.createShaderProgram("Shaders/painterly");
-	charcoalShader.createShaderProgram("Shaders/charcoal");
+	halftoneShader.defineShaderProgram("Shaders/halftone");
+	ditheringShader.defineShaderProgram("Shaders/dithering");
+	pixelArtShader.defineShaderProgram("Shaders/pixelArt");
+	painterlyShader.defineShaderProgram("Shaders/painterly");
+	charcoalShader.defineShaderProgram("Shaders/charcoal");
 
 	// - Shader programs de dibujado de contornos
-	basicOutlineShader.createShaderProgram("Shaders/basicOutline");
-	advancedOutlineShader.createShaderProgram("Shaders/advancedOutline", GEOMETRY_SHADER);
+	basicOutlineShader.defineShaderProgram("Shaders/basicOutline");
+	advancedOutlineShader.defineShaderProgram("Shaders/advancedOutline", GEOMETRY_SHADER);
+	basicOutlineInstancedShader.defineShaderProgram("Shaders/basicOutline", NO_GEOMETRY_SHADER, INSTANCED_VARIANT);
+	advancedOutlineInstancedShader.defineShaderProgram("Shaders/advancedOutline", GEOMETRY_SHADER, INSTANCED_VARIANT);
+
+	// - Shader programs del contorno en espacio de pantalla (pre-pasada y pasada a pantalla completa)
+	edgePrepassShader.defineShaderProgram("Shaders/edgePrepass");
+	edgePrepassInstancedShader.defineShaderProgram("Shaders/edgePrepass", NO_GEOMETRY_SHADER, INSTANCED_VARIANT);
+	screenSpaceOutlineShader.defineShaderProgram("Shaders/screenSpaceOutline");
 
-	// - Inicialmente desactivar todas las formas de dibujado, menos la realista
+	// - Shader program de las aristas caractersticas (quads a partir de las lneas)
+	featureEdgesShader.defineShaderProgram("Shaders/featureEdges", GEOMETRY_SHADER);
+
+	// - Inicialmente desactivar todas las formas de dibujado, menos la realista (sus shader programs se
+	//   compilan ya)
 	enabledRealistic = true;
+	requestTechnique("realistic", true);
+	activeRenderingMode = "realistic";
+	compilingTechnique = false;
 
 	// - Inicialmente no hay activado ningn shader proram de post-procesamiento
 	enabledPostProcessing = false;
@@ -195,24 +311,23 @@ void Renderer::prepareOpenGL(int width, int height)
 	// - Crear FBO
 	fbo = new FBO();
 
-	// - Crear y enlazar buffers de color y profundidad
+	// - Crear y enlazar texturas de color y profundidad (las tcnicas de post-procesamiento pueden
+	//   leer la profundidad de la escena)
 	fbo->activeTextureUnit(0);
 	fbo->bindRenderTexture();
 	fbo->createRenderTexture(viewportWidth, viewportHeight);
-
-	fbo->bindDepthBuffer();
-	fbo->createDepthBuffer(viewportWidth, viewportHeight);
-
-	// - Desenlazar buffers de color y profundidad
 	fbo->unbindRenderTexture();
-	fbo->unbindDepthBuffer();
+
+	fbo->bindDepthTexture();
+	fbo->createDepthTexture(viewportWidth, viewportHeight);
+	fbo->unbindDepthTexture();
 
 	// - Enlazar FBO
 	fbo->bindFrameBuffer();
 
-	// - Enlazar buffers de color y profundidad al FBO
+	// - Enlazar texturas de color y profundidad al FBO
 	fbo->attachRenderTexture();
-	fbo->attachDepthBuffer();
+	fbo->attachDepthTexture();
 
 	// - Comprobar que el FBO se cre correctamente
 	fbo->checkStatus();
@@ -220,14 +335,48 @@ void Renderer::prepareOpenGL(int width, int height)
 	// - Desenlazar FBO (enlazar con el Window-System-Provided FrameBuffer)
 	fbo->unbindFrameBuffer();
 
+	// - Contorno en espacio de pantalla (desactivado inicialmente): crear FBO de su pre-pasada, con el
+	//   identificador del elemento y la normal como destinos de color (MRT) y la profundidad
+	enabledScreenSpaceOutline = false;
+	fboOutline = new FBO();
+
+	fboOutline->bindRenderTexture();
+	fboOutline->createRenderTexture(viewportWidth, viewportHeight);
+	fboOutline->unbindRenderTexture();
+
+	fboOutline->bindNormalTexture();
+	fboOutline->createNormalTexture(viewportWidth, viewportHeight);
+	fboOutline->unbindNormalTexture();
+
+	fboOutline->bindDepthTexture();
+	fboOutline->createDepthTexture(viewportWidth, viewportHeight);
+	fboOutline->unbindDepthTexture();
+
+	fboOutline->bindFrameBuffer();
+	fboOutline->attachRenderTexture();
+	fboOutline->attachNormalTexture();
+	fboOutline->attachDepthTexture();
+	fboOutline->checkStatus();
+	fboOutline->unbindFrameBuffer();
+
 	// - Crear FBO para capturas de pantalla
 	fboScreenshot = new FBO();
 
+	// - Sombreado diferido (desactivado inicialmente): crear G-buffer
+	enabledDeferredShading = false;
+	gBuffer = new GBuffer();
+	gBuffer->resize(viewportWidth, viewportHeight);
+
 	// - Inicializar contador de capturas de pantalla y flag para saber si se tom la captura
 	screenshotCounter = 0;
 	screenshotTaken = false;
 	screenshotName = "";
 
+	// - Inicializar exportacin de lneas
+	lineArtCounter = 0;
+	lineArtName = "";
+	lineArtExported = false;
+
 	// - GUI
 	enabledMainWindowGUI = true;
 	enabledScroll = false;
@@ -238,6 +387,17 @@ void Renderer::setupScene(unsigned int scene)
 {
 	selectedScene = scene;
 
+	// - Perfilado de carga de la escena (modelos, texturas y skybox)
+	LoadProfiler::getInstance()->beginScene("Scene " + std::to_string(scene + 1));
+
+	// - Residencia: si la escena no est cargada, los modelos que se carguen quedan asociados a ella
+	ResidencyManager *residency = ResidencyManager::getInstance();
+
+	if ((scene == 0 && !loadedScene1) || (scene == 1 && !loadedScene2) || (scene == 2 && !loadedScene3))
+	{
+		residency->beginLoad(scene);
+	}
+
 	if (selectedScene == 0)
 	{
 		/* 
@@ -579,11 +739,55 @@ void Renderer::setupScene(unsigned int scene)
 			// - Rendering (Gooch Shading)
 			statue->setGoochShadingTechnique(GoochShadingTechnique());
 
+			// - Modelo instanciado: cofres repartidos alrededor de la isla (un nico modelo, con una
+			//   llamada de dibujado instanciado por malla)
+			scatteredTreasures = new InstancedModel(new Model("Models/TreasureChest_v2_L3.123c5b4249fc-a18b-4453-afc1-661a6b421f86/10803_TreasureChest_v2_L3.obj"));
+
+			for (unsigned int i = 0; i < 48; i++)
+			{
+				float angle = glm::radians(360.f * i / 48.f);
+				float radius = 12.f + 2.f * (i % 3);
+
+				glm::mat4 instanceMatrix = glm::translate(glm::mat4(1.0f), glm::vec3(radius * glm::cos(angle), 0.25f, radius * glm::sin(angle)));
+				instanceMatrix = glm::rotate(instanceMatrix, -angle, glm::vec3(0.f, 1.f, 0.f));
+				instanceMatrix = glm::scale(instanceMatrix, glm::vec3(0.03f));
+
+				unsigned int instance = scatteredTreasures->addInstance(instanceMatrix);
+
+				// - Parmetros propios de algunas instancias (contorno y tonos de Cel-Shading)
+				if (i % 4 == 0)
+				{
+					scatteredTreasures->setInstanceOutline(instance, glm::vec3(0.5f, 0.25f, 0.f), -1.f);
+					scatteredTreasures->setInstanceCelShading(instance, 2.f, -1.f);
+				}
+			}
+
+			// - Contornos
+			scatteredTreasures->setBasicOutline(BasicOutline(glm::vec3(0.f), 0.005f));
+			scatteredTreasures->setAdvancedOutline(AdvancedOutline(glm::vec3(0.f), 0.005f, 0.0001f));
+
+			// - Rendering (Monochrome)
+			scatteredTreasures->setMonochromeTechnique(MonochromeTechnique(Material(glm::vec3(1.0f),
+																					glm::vec3(1.0f),
+																					glm::vec3(1.0f),
+																					8.f)));
+
+			// - Rendering (Cel-Shading)
+			scatteredTreasures->setCelShadingTechnique(CelShadingTechnique(3.f, 0.3f));
+
+			// - Rendering (Hatching)
+			scatteredTreasures->setHatchingTechnique(HatchingTechnique(6.f, 0.f, 0.f));
+			scatteredTreasures->setHatchingTextures("Textures/hatch_dark.png", "Textures/hatch_bright.png");
+
+			// - Rendering (Gooch Shading)
+			scatteredTreasures->setGoochShadingTechnique(GoochShadingTechnique());
+
 			// - Crear escena
 			scene3 = new Group3D();
 			scene3->addElement(island);
 			scene3->addElement(treasure);
 			scene3->addElement(statue);
+			scene3->addElement(scatteredTreasures);
 
 			// - Escena cargada
 			loadedScene3 = true;
@@ -612,6 +816,37 @@ void Renderer::setupScene(unsigned int scene)
 		currentElement = currentScene->getElement(selectedElementScene3);
 	}
 
+	LoadProfiler::getInstance()->endScene();
+
+	// - Respetar el presupuesto de memoria (las escenas descargadas dejan huecos en la arena)
+	residency->endLoad();
+	residency->touch(scene);
+	updateResidency();
+
+	// - Compactar la arena de buffers si los recursos liberados o los IBOs que han crecido han dejado
+	//   huecos, e informar de su utilizacin
+	BufferArena *arena = BufferArena::getInstance();
+
+	if (arena->getStatistics().fragmentation > ARENA_DEFRAGMENTATION_THRESHOLD)
+	{
+		arena->defragment();
+	}
+
+	arena->printReport();
+
+	// - Construir la BVH y el almacn de la escena y descartar las consultas de oclusin de la anterior
+	sceneBVH.build(currentScene);
+	sceneStore.build(currentScene);
+	occlusionCuller->clear();
+
+	// - Modelos instanciados (se dibujan con las variantes instanciadas de los shaders)
+	sceneHasInstances = false;
+
+	for (const BVHPrimitive &primitive : sceneBVH.getPrimitives())
+	{
+		sceneHasInstances = sceneHasInstances || primitive.instance >= 0;
+	}
+
 	// - Preparar la cmara virtual
 	setupCamera();
 
@@ -619,6 +854,114 @@ void Renderer::setupScene(unsigned int scene)
 	setupLighting();
 }
 
+// - Pedir una escena. Si se descarg para respetar el presupuesto de memoria, sus modelos se leen en
+//   segundo plano y render cambia a ella cuando terminan; si no, se prepara directamente
+void Renderer::requestScene(unsigned int scene)
+{
+	pendingScene = -1;
+
+	// - El perfilado detallado aplica los pasos de Assimp uno a uno, as que la carga es sncrona
+	if (!LoadProfiler::getInstance()->isEnabled() && ResidencyManager::getInstance()->prefetch(scene))
+	{
+		pendingScene = (int) scene;
+		return;
+	}
+
+	setupScene(scene);
+}
+
+// - Mtodo privado: medir la memoria de las escenas cargadas y, si se supera el presupuesto, liberar
+//   las imgenes decodificadas de las texturas y, si no basta, descargar las escenas usadas hace ms
+//   tiempo (nunca la actual)
+void Renderer::updateResidency()
+{
+	ResidencyManager *residency = ResidencyManager::getInstance();
+	Group3D* scenes[3] = { scene1, scene2, scene3 };
+
+	for (unsigned int i = 0; i < 3; i++)
+	{
+		if (scenes[i] != nullptr)
+		{
+			MemoryUsage usage;
+			scenes[i]->addMemoryUsage(usage);
+			residency->setUsage(i, usage);
+		}
+	}
+
+	MemoryUsage skyboxUsage;
+	skyboxUsage.gpuBytes = skybox->getGPUMemory();
+	residency->setSharedUsage(skyboxUsage);
+
+	// - Imgenes de las texturas (slo ocupan memoria de CPU)
+	while (residency->isOverHostBudget())
+	{
+		int asset = residency->findEvictionCandidate(-1, true);
+
+		if (asset < 0)
+		{
+			break;
+		}
+
+		scenes[asset]->releaseTextureImages();
+		residency->markTexturesReleased(asset);
+
+		MemoryUsage usage;
+		scenes[asset]->addMemoryUsage(usage);
+		residency->setUsage(asset, usage);
+	}
+
+	// - Escenas completas
+	while (residency->isOverGPUBudget() || residency->isOverHostBudget())
+	{
+		int asset = residency->findEvictionCandidate(selectedScene, false);
+
+		if (asset < 0)
+		{
+			break;
+		}
+
+		unloadScene(asset);
+	}
+}
+
+// - Mtodo privado: descargar una escena (modelos, texturas y buffers). Se vuelve a cargar al pedirla
+void Renderer::unloadScene(unsigned int scene)
+{
+	if (scene == 0)
+	{
+		delete scene1;
+		scene1 = nullptr;
+		ironMan = nullptr;
+		captainAmerica = nullptr;
+		hulk = nullptr;
+		spiderman = nullptr;
+		plane = nullptr;
+		loadedScene1 = false;
+	}
+	else if (scene == 1)
+	{
+		delete scene2;
+		scene2 = nullptr;
+		room = nullptr;
+		fruitBowl = nullptr;
+		loadedScene2 = false;
+	}
+	else if (scene == 2)
+	{
+		delete scene3;
+		scene3 = nullptr;
+		island = nullptr;
+		treasure = nullptr;
+		statue = nullptr;
+		scatteredTreasures = nullptr;
+		loadedScene3 = false;
+	}
+
+	ResidencyManager::getInstance()->markEvicted(scene);
+
+	std::cout << "Scene " << scene + 1 << " unloaded (memory budget)" << std::endl;
+}
+
 // - Mtodo privado: Configurar la cmara virtual
 void Renderer::setupCamera()
 {
@@ -993,7 +1336,7 @@ void Renderer::lightSourceReset(std::string type)
 }
 
 // - Activar/desactivar modos de dibujo
-void Renderer::setRenderingMode(std::string mode)
+void Renderer::setRenderingMode(std::string mode, bool wait)
 {
 	// - Desactivar Post-procesamiento
 	enabledPostProcessing = false;
@@ -1077,6 +1420,138 @@ void Renderer::setRenderingMode(std::string mode)
 		enabledPixelArt = true;
 		selectedTechnique = 9;
 	}
+
+	// - Compilacin bajo demanda: si los shader programs del modo no estn listos, se sigue dibujando
+	//   el modo anterior. La tcnica seleccionada no cambia, as que la GUI vuelve a pedir el modo en
+	//   el siguiente frame y se cambia cuando el driver termina de compilarlos
+	compilingTechnique = !requestTechnique(mode, wait);
+
+	if (!compilingTechnique)
+	{
+		activeRenderingMode = mode;
+	}
+	else if (activeRenderingMode != mode)
+	{
+		int requestedTechnique = selectedTechnique;
+
+		resetAllRenderingModes();
+		setRenderingMode(activeRenderingMode);
+
+		selectedTechnique = requestedTechnique;
+		compilingTechnique = true;
+	}
+}
+
+// - Mtodo privado: pedir los shader programs de un modo de dibujo (incluidos los de la tcnica que
+//   dibuja la escena antes del post-procesamiento). Devuelve true si estn listos
+bool Renderer::requestTechnique(const std::string &mode, bool wait)
+{
+	std::vector<ShaderProgram*> shaders;
+	ShaderPermutations *permutations = nullptr;
+	unsigned int technique = DEFAULT_VARIANT;
+
+	if (mode == "realistic" || mode == "dithering" || mode == "pixelArt" || mode == "painterly" || mode == "charcoal")
+	{
+		permutations = &realisticShaders;
+		shaders = { &realisticSkyboxShader };
+	}
+	else if (mode == "monochrome")
+	{
+		permutations = &monochromeShaders;
+		technique = MONOCHROME_VARIANT;
+		shaders = { &realisticSkyboxShader };
+	}
+	else if (mode == "celShading" || mode == "halftone")
+	{
+		permutations = &celShadingShaders;
+		technique = CEL_SHADING_VARIANT;
+		shaders = { &celShadingSkyboxShader };
+	}
+	else if (mode == "hatching")
+	{
+		permutations = &hatchingShaders;
+		technique = HATCHING_VARIANT;
+		shaders = { &hatchingSkyboxShader };
+	}
+	else if (mode == "goochShading")
+	{
+		permutations = &goochShadingShaders;
+		technique = GOOCH_SHADING_VARIANT;
+		shaders = { &realisticSkyboxShader };
+	}
+
+	if (mode == "halftone")
+	{
+		shaders.push_back(&halftoneShader);
+	}
+	else if (mode == "dithering")
+	{
+		shaders.push_back(&ditheringShader);
+	}
+	else if (mode == "pixelArt")
+	{
+		shaders.push_back(&pixelArtShader);
+	}
+	else if (mode == "painterly")
+	{
+		shaders.push_back(&painterlyShader);
+	}
+	else if (mode == "charcoal")
+	{
+		shaders.push_back(&charcoalShader);
+	}
+
+	bool ready = requestShaderPrograms(shaders, wait);
+
+	// - Permutaciones de la tcnica para las fuentes luminosas de la escena: las del sombreado directo
+	//   o, con el sombreado diferido, las de la pasada de geometra y las de iluminacin
+	if (permutations != nullptr && !enabledDeferredShading)
+	{
+		ready = requestLightPermutations(*permutations, wait) && ready;
+	}
+	else if (permutations != nullptr)
+	{
+		ready = gBufferShaders.request(technique, wait) && ready;
+		ready = gBufferShaders.request(technique | INSTANCED_VARIANT, wait) && ready;
+
+		for (unsigned int i = 0; i < lights.size(); i++)
+		{
+			ready = deferredShaders.request(technique | lights[i]->getVariant(), wait) && ready;
+		}
+	}
+
+	return ready;
+}
+
+// - Mtodo privado: pedir varios shader programs. Se piden todos (para que se compilen a la vez) y
+//   devuelve true si todos estn listos
+bool Renderer::requestShaderPrograms(const std::vector<ShaderProgram*> &shaders, bool wait)
+{
+	bool ready = true;
+
+	for (ShaderProgram *shader : shaders)
+	{
+		ready = shader->request(wait) && ready;
+	}
+
+	return ready;
+}
+
+// - Mtodo privado: pedir las permutaciones de una tcnica para los tipos de fuente luminosa de la
+//   escena (variantes normal e instanciada). Devuelve true si todas estn listas
+bool Renderer::requestLightPermutations(ShaderPermutations &permutations, bool wait)
+{
+	bool ready = true;
+
+	for (unsigned int i = 0; i < lights.size(); i++)
+	{
+		unsigned int lightVariant = lights[i]->getVariant();
+
+		ready = permutations.request(lightVariant, wait) && ready;
+		ready = permutations.request(lightVariant | INSTANCED_VARIANT, wait) && ready;
+	}
+
+	return ready;
 }
 
 // - Desactivar todos los modos de dibujado
@@ -1100,6 +1575,45 @@ void Renderer::resetAllRenderingModes()
 // - Mtodo para dibujar la escena
 void Renderer::render()
 {
+	// - Cach de estado: contadores del frame anterior y estado desconocido (ImGui y el cdigo de fuera
+	//   del renderer pueden haberlo cambiado)
+	GLStateCache::getInstance()->beginFrame();
+
+	// - Jerarquas de siluetas: contadores del frame anterior
+	SilhouetteClusters::beginFrame();
+
+	// - Residencia: cambiar a la escena pedida cuando se han ledo sus modelos y marcar la actual
+	//   como usada en este frame
+	ResidencyManager *residency = ResidencyManager::getInstance();
+
+	if (pendingScene >= 0 && residency->isPrefetched(pendingScene))
+	{
+		unsigned int scene = (unsigned int) pendingScene;
+		pendingScene = -1;
+		setupScene(scene);
+	}
+
+	residency->beginFrame();
+	residency->touch(selectedScene);
+
+	// - Estadsticas de rendering: inicio de frame
+	RENDER_STATS_BEGIN_FRAME();
+
+	// - Frustum culling: visibilidad de elementos y mallas para todas las pasadas del frame
+	updateVisibility();
+
+	// - Niveles de detalle de las mallas visibles
+	updateLevelsOfDetail();
+
+	// - Matrices del frame de todos los elementos de la escena (en un lote)
+	sceneStore.update(camera->getViewMatrix(), camera->getProjectionMatrix());
+
+	// - Cach de transformaciones: vrtices de las mallas visibles transformados para todas las pasadas
+	transformVertices();
+
+	// - Contador de sobredibujado: resultados de frames anteriores
+	overdrawCounter->beginFrame(viewportWidth, viewportHeight);
+
 	// - Reiniciar contador de luces activadas
 	numberOfLightsEnabled = 0;
 
@@ -1181,181 +1695,327 @@ void Renderer::render()
 	{
 		pixelArt();
 	}
-}
 
-/*
- **********************************************
-		      RENDERING (MODELOS)
- **********************************************
- */
+	// - Estadsticas de rendering: fin de frame
+	RENDER_STATS_END_FRAME();
+}
 
-// - Rendering realista
-void Renderer::realistic()
+// - Mtodo privado: Frustum culling. Se calcula la visibilidad una vez por frame con el frustum de
+//   la cmara; con el culling desactivado, el frustum por defecto acepta todos los elementos
+void Renderer::updateVisibility()
 {
-	// - Flag para comprobar la primera fuenta activa
-	bool firstLightEnabled = false;
+	Frustum frustum;
 
-	// - Iluminacin
-	for (unsigned int i = 0; i < lights.size(); i++)
+	if (enabledFrustumCulling)
 	{
-		// - Dibujar contorno bsico
-		basicOutline();
-
-		// - Dibujar contorno avanzado
-		advancedOutline();
+		frustum.extract(camera->getViewProjectionMatrix());
+	}
 
-		// - Activar shader
-		realisticShader.use();
+	cullingStatistics.reset();
 
-		// - Aplicar fuente luminosa si est activada
-		if (lights[i]->isLightEnabled())
+	// - Con la BVH se reajustan las cajas si ha cambiado alguna matriz de modelado
+	if (enabledBVH)
+	{
+		if (sceneBVH.needsRefit())
 		{
-			if (!firstLightEnabled)
-			{
-				// - Si es la primera, activar este modo de mezcla
-				glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-				firstLightEnabled = true;
-			}
-			else
-			{
-				// - Para el resto de fuentes luminosas activar este otro modo
-				glBlendFunc(GL_SRC_ALPHA, GL_ONE);
-			}
-
-			lights[i]->apply(realisticShader);
+			sceneBVH.refit();
 		}
 
-		// - Dibujar la escena
-		currentScene->drawRealistic(realisticShader, currentScene->getModelMatrix(), 
-								    camera->getViewMatrix(), camera->getProjectionMatrix());
+		sceneBVH.cullFrustum(frustum, cullingStatistics);
+	}
+	else
+	{
+		currentScene->updateVisibility(frustum, currentScene->getModelMatrix(), cullingStatistics);
 	}
-
-	// - Dibujado de skybox
-	realisticSkyboxShader.use();
-	glm::mat4 skyboxVP = camera->getProjectionMatrix() * glm::mat4(glm::mat3(camera->getViewMatrix()));
-	skybox->drawRealistic(realisticSkyboxShader, skyboxVP);
 }
 
-// - Rendering Monochrome
-void Renderer::monochrome()
+// - Mtodo privado: Niveles de detalle. El tamao en pantalla de cada malla visible es el radio de
+//   su esfera envolvente proyectado en coordenadas normalizadas (mitad de la altura del viewport)
+void Renderer::updateLevelsOfDetail()
 {
-	// - Flag para comprobar la primera fuenta activa
-	bool firstLightEnabled = false;
+	for (unsigned int i = 0; i < Mesh::MAX_LODS; i++)
+	{
+		lodMeshes[i] = 0;
+	}
 
-	// - Iluminacin
-	for (unsigned int i = 0; i < lights.size(); i++)
+	lodTriangles = 0;
+
+	const std::vector<BVHPrimitive> &primitives = sceneBVH.getPrimitives();
+	glm::vec3 eye = camera->getPosition();
+	float zNear = camera->getZNear();
+	float projectionScale = camera->getProjectionMatrix()[1][1];
+
+	for (const BVHPrimitive &primitive : primitives)
 	{
-		// - Dibujar contorno bsico
-		basicOutline();
+		Mesh *mesh = primitive.mesh;
 
-		// - Dibujar contorno avanzado
-		advancedOutline();
+		// - Instancias de un modelo instanciado: nivel de detalle segn su caja (sin niveles de
+		//   detalle, tamao mximo)
+		if (primitive.instance >= 0)
+		{
+			float radius = glm::length(primitive.bounds.getExtents());
+			float distance = std::max(glm::length(primitive.bounds.getCenter() - eye), zNear);
 
-		// - Activar shader
-		monochromeShader.use();
+			primitive.owner->selectInstanceLOD(primitive.instance,
+											   enabledLOD ? radius * projectionScale / distance : std::numeric_limits<float>::max());
+			continue;
+		}
 
-		// - Aplicar fuente luminosa si est activada
-		if (lights[i]->isLightEnabled())
+		if (mesh == nullptr)
 		{
-			if (!firstLightEnabled)
-			{
-				// - Si es la primera, activar este modo de mezcla
-				glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-				firstLightEnabled = true;
-			}
-			else
-			{
-				// - Para el resto de fuentes luminosas activar este otro modo
-				glBlendFunc(GL_SRC_ALPHA, GL_ONE);
-			}
+			continue;
+		}
 
-			lights[i]->apply(monochromeShader);
+		if (!enabledLOD)
+		{
+			mesh->setLOD(0);
+		}
+		else
+		{
+			BoundingSphere sphere = mesh->getBoundingSphere().transform(primitive.mModel);
+			float distance = std::max(glm::length(sphere.center - eye), zNear);
+
+			mesh->selectLOD(sphere.radius * projectionScale / distance);
 		}
 
-		// - Dibujar la escena
-		currentScene->drawMonochrome(monochromeShader, currentScene->getModelMatrix(), camera->getViewMatrix(),
-									camera->getProjectionMatrix());
+		if (mesh->isVisible())
+		{
+			lodMeshes[mesh->getCurrentLOD()]++;
+			lodTriangles += mesh->getNumTriangles(mesh->getCurrentLOD());
+		}
 	}
+}
 
-	// - Dibujado de skybox
-	realisticSkyboxShader.use();
-	glm::mat4 skyboxVP = camera->getProjectionMatrix() * glm::mat4(glm::mat3(camera->getViewMatrix()));
-	skybox->drawRealistic(realisticSkyboxShader, skyboxVP);
+// - Mtodo privado: Cach de transformaciones. Los vrtices de las mallas visibles se transforman
+//   al espacio de visin con transform feedback antes de las pasadas del frame, que los leen con la
+//   matriz de modelado-visin identidad. Mientras el shader program se compila (o con la cach
+//   desactivada) se invalida, y las pasadas transforman los vrtices del modelo
+void Renderer::transformVertices()
+{
+	TransformCache *transformCache = TransformCache::getInstance();
+
+	if (!transformCache->isEnabled() || !transformCache->request(false))
+	{
+		transformCache->invalidate();
+		return;
+	}
+
+	// - Estadsticas de rendering: pasada "Transform cache"
+	RENDER_STATS_PASS("Transform cache");
+
+	ShaderProgram &shader = transformCache->begin(camera->getViewMatrix());
+	sceneStore.draw(shader, PASS_TRANSFORM_CACHE, camera->getViewMatrix(), camera->getProjectionMatrix());
+	transformCache->end();
 }
 
-// - Tcnica de rendering NPR: Cel-Shading
-void Renderer::celShading()
+// - Mtodo privado: Pre-pasada de profundidad. Se dibuja slo la profundidad de las mallas
+//   visibles, de delante hacia atrs segn la BVH, para que las pasadas de sombreado (una por luz)
+//   slo sombreen el fragmento visible de cada pixel. Con el occlusion culling se descartan antes
+//   las mallas ocultas en el frame anterior y, tras la pre-pasada, se lanzan las consultas de este
+void Renderer::depthPrepass()
 {
-	// - Flag para comprobar la primera fuenta activa
-	bool firstLightEnabled = false;
+	if (!enabledDepthPrepass)
+	{
+		return;
+	}
 
-	// - Intensidad de la fuente luminosa ambiente
-	glm::vec3 Ia = glm::vec3(0.f);
+	// - Los shader programs de la pre-pasada se compilan al activarla (las pasadas de sombreado
+	//   dependen de su profundidad, as que se espera a que estn listos)
+	requestShaderPrograms({ &depthPrepassShader, &depthPrepassInstancedShader }, true);
 
-	// - Iluminacin
-	for (unsigned int i = 0; i < lights.size(); i++)
+	// - Estadsticas de rendering: pasada "Depth pre-pass"
+	RENDER_STATS_PASS("Depth pre-pass");
+
+	if (sceneBVH.needsRefit())
 	{
-		// - Dibujar contorno bsico
-		basicOutline();
+		sceneBVH.refit();
+	}
 
-		// - Dibujar contorno avanzado
-		advancedOutline();
+	const std::vector<BVHPrimitive> &primitives = sceneBVH.getPrimitives();
+	glm::mat4 mView = camera->getViewMatrix();
+	glm::mat4 mProjection = camera->getProjectionMatrix();
 
-		// - Activar shader
-		celShadingShader.use();
+	// - Occlusion culling: ocultar las mallas que estaban ocultas en el frame anterior
+	if (enabledOcclusionCulling)
+	{
+		occlusionCuller->applyResults(primitives, camera->getPosition(), camera->getZNear());
+	}
 
-		// - Aplicar fuente luminosa si est activada
-		if (lights[i]->isLightEnabled())
+	// - Slo profundidad
+	depthPrepassShader.use();
+	glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+
+	if (enabledBVH)
+	{
+		// - Mallas de delante hacia atrs, con las matrices del frame del almacn de la escena (las
+		//   de las pasadas de sombreado: la profundidad tiene que coincidir con GL_EQUAL)
+		sceneBVH.frontToBackPrimitives(camera->getPosition(), depthPrepassOrder);
+
+		for (unsigned int i = 0; i < depthPrepassOrder.size(); i++)
 		{
-			if (!firstLightEnabled)
+			const BVHPrimitive &primitive = primitives[depthPrepassOrder[i]];
+			const glm::mat4 *frameModelView = nullptr;
+			const glm::mat4 *frameMVP = nullptr;
+			bool stored = sceneStore.getFrameMatrices(primitive.owner, primitive.mModel, mView, mProjection,
+													  frameModelView, frameMVP);
+
+			if (primitive.mesh != nullptr)
 			{
-				// - Si es la primera, activar este modo de mezcla
-				glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-				firstLightEnabled = true;
+				if (primitive.mesh->isVisible())
+				{
+					// - Con la cach de transformaciones, la malla lee sus vrtices transformados si su
+					//   modelo se dibuja desde ella, con la misma regla que las pasadas de sombreado
+					if (primitive.owner->isTransformCached(mView))
+					{
+						depthPrepassShader.setUniform("mvpMatrix", mProjection);
+						primitive.mesh->bindTransformCache(true);
+						primitive.mesh->draw(depthPrepassShader);
+						primitive.mesh->bindTransformCache(false);
+					}
+					else
+					{
+						depthPrepassShader.setUniform("mvpMatrix", stored ? *frameMVP : mProjection * mView * primitive.mModel);
+						primitive.mesh->draw(depthPrepassShader);
+					}
+				}
 			}
-			else
+			else if (primitive.instance < 0 && primitive.owner->isVisible())
 			{
-				// - Para el resto de fuentes luminosas activar este otro modo
-				glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+				primitive.owner->setFrameMatrices(frameModelView, frameMVP);
+				primitive.owner->drawDepth(depthPrepassShader, primitive.mModel, mView, mProjection);
+				primitive.owner->setFrameMatrices(nullptr, nullptr);
 			}
+		}
+	}
+	else
+	{
+		// - Sin BVH, en el orden de la escena
+		sceneStore.draw(depthPrepassShader, PASS_DEPTH, mView, mProjection);
+	}
 
-			// - Obtener intensidad de la fuente ambiente para calcular color final del skybox
-			if (lights[i]->getType() == "Ambient")
-			{
-				Ia = lights[i]->getIa() / glm::vec3(2.f);
-			}
+	// - Modelos instanciados: todas las instancias visibles de cada uno a la vez
+	if (sceneHasInstances)
+	{
+		depthPrepassInstancedShader.use();
+		sceneStore.draw(depthPrepassInstancedShader, PASS_DEPTH, mView, mProjection);
+		depthPrepassShader.use();
+	}
 
-			lights[i]->apply(celShadingShader);
-		}
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+
+	// - Occlusion culling: consultas de este frame contra la profundidad de la pre-pasada
+	if (enabledOcclusionCulling)
+	{
+		occlusionCuller->issueQueries(depthPrepassShader, primitives, camera->getViewProjectionMatrix());
+	}
+}
 
-		// - Dibujar la escena
-		currentScene->drawCelShading(celShadingShader, currentScene->getModelMatrix(), camera->getViewMatrix(),
-									camera->getProjectionMatrix());
+// - Mtodo privado: Inicio de una pasada de sombreado. Con la pre-pasada, slo pasan los
+//   fragmentos con la misma profundidad que la guardada y no se escribe profundidad
+void Renderer::beginShading()
+{
+	if (enabledDepthPrepass)
+	{
+		glDepthFunc(GL_EQUAL);
+		glDepthMask(GL_FALSE);
 	}
 
-	// - Dibujado de skybox
-	celShadingSkyboxShader.use();
-	glm::mat4 skyboxVP = camera->getProjectionMatrix() * glm::mat4(glm::mat3(camera->getViewMatrix()));
-	skybox->drawCelShading(celShadingSkyboxShader, skyboxVP, Ia);
+	overdrawCounter->beginShading();
 }
 
-// - Tcnica de rendering NPR: Hatching
-void Renderer::hatching()
+// - Mtodo privado: Fin de una pasada de sombreado (se restaura el test de profundidad por defecto
+//   para los contornos y el skybox)
+void Renderer::endShading()
 {
+	overdrawCounter->endShading();
+
+	if (enabledDepthPrepass)
+	{
+		glDepthFunc(GL_LEQUAL);
+		glDepthMask(GL_TRUE);
+	}
+}
+
+// - Seleccionar el elemento de la escena actual bajo un punto del viewport: se deshace la
+//   proyeccin del punto en los planos cercano y lejano y se lanza un rayo contra la BVH
+bool Renderer::selectElementAt(float x, float y)
+{
+	glm::mat4 inverseViewProjection = glm::inverse(camera->getViewProjectionMatrix());
+	glm::vec4 nearPoint = inverseViewProjection * glm::vec4(x, y, -1.f, 1.f);
+	glm::vec4 farPoint = inverseViewProjection * glm::vec4(x, y, 1.f, 1.f);
+	glm::vec3 origin = glm::vec3(nearPoint) / nearPoint.w;
+	glm::vec3 direction = glm::vec3(farPoint) / farPoint.w - origin;
+
+	if (sceneBVH.needsRefit())
+	{
+		sceneBVH.refit();
+	}
+
+	float distance;
+	int element = sceneBVH.intersectRay(origin, direction, distance);
+
+	if (element < 0)
+	{
+		return false;
+	}
+
+	if (currentScene == scene1)
+	{
+		selectedElementScene1 = element;
+	}
+	else if (currentScene == scene2)
+	{
+		selectedElementScene2 = element;
+	}
+	else if (currentScene == scene3)
+	{
+		selectedElementScene3 = element;
+	}
+
+	currentElement = currentScene->getElement(element);
+
+	return true;
+}
+
+// - Medir la BVH sobre la escena 2 (habitacin y frutero) desde la cmara de la escena
+void Renderer::benchmarkBVH(unsigned int iterations)
+{
+	selectedScene = 1;
+	setupScene(1);
+
+	BVH::benchmark(currentScene, camera->getViewProjectionMatrix(), camera->getPosition(), iterations);
+}
+
+/*
+ **********************************************
+		      RENDERING (MODELOS)
+ **********************************************
+ */
+
+// - Mtodo privado: sombreado directo. Por cada fuente luminosa se dibujan los contornos y la escena
+//   con la permutacin del shader de la tcnica para su tipo, sumando su contribucin con blending
+void Renderer::forwardShading(ShaderPermutations &shaders, ElementDrawPass pass)
+{
+	// - Pre-pasada de profundidad y occlusion culling
+	depthPrepass();
+
 	// - Flag para comprobar la primera fuenta activa
 	bool firstLightEnabled = false;
 
 	// - Iluminacin
 	for (unsigned int i = 0; i < lights.size(); i++)
 	{
-		// - Dibujar contorno bsico
-		basicOutline();
-
-		// - Dibujar contorno avanzado
-		advancedOutline();
+		// - Dibujar contornos bsico y avanzado (el contorno en espacio de pantalla se dibuja una vez,
+		//   sobre la escena ya iluminada)
+		if (!enabledScreenSpaceOutline)
+		{
+			basicOutline();
+			advancedOutline();
+		}
 
-		// - Activar shader
-		hatchingShader.use();
+		// - Activar la permutacin del shader para el tipo de la fuente luminosa
+		unsigned int lightVariant = lights[i]->getVariant();
+		ShaderProgram *shader = shaders.use(lightVariant);
 
 		// - Aplicar fuente luminosa si est activada
 		if (lights[i]->isLightEnabled())
@@ -1363,74 +2023,304 @@ void Renderer::hatching()
 			if (!firstLightEnabled)
 			{
 				// - Si es la primera, activar este modo de mezcla
-				glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+				GLStateCache::getInstance()->blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 				firstLightEnabled = true;
 			}
 			else
 			{
 				// - Para el resto de fuentes luminosas activar este otro modo
-				glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+				GLStateCache::getInstance()->blendFunc(GL_SRC_ALPHA, GL_ONE);
 			}
 
-			lights[i]->apply(hatchingShader);
+			lights[i]->apply(*shader);
 		}
 
-		// - Dibujar la escena
-		currentScene->drawHatching(hatchingShader, currentScene->getModelMatrix(), camera->getViewMatrix(),
-								  camera->getProjectionMatrix());
+		// - Dibujar la escena (con la pre-pasada, slo los fragmentos visibles)
+		beginShading();
+		sceneStore.draw(*shader, pass, camera->getViewMatrix(), camera->getProjectionMatrix());
+
+		// - Dibujar los modelos instanciados con la variante instanciada del shader
+		if (sceneHasInstances)
+		{
+			ShaderProgram *instancedShader = shaders.use(lightVariant | INSTANCED_VARIANT);
+
+			if (lights[i]->isLightEnabled())
+			{
+				lights[i]->apply(*instancedShader);
+			}
+
+			sceneStore.draw(*instancedShader, pass, camera->getViewMatrix(), camera->getProjectionMatrix());
+		}
+
+		endShading();
 	}
 
-	// - Dibujado de skybox
-	hatchingSkyboxShader.use();
-	glm::mat4 skyboxVP = camera->getProjectionMatrix() * glm::mat4(glm::mat3(camera->getViewMatrix()));
-	skybox->drawHatching(hatchingSkyboxShader, skyboxVP);
+	// - Aristas caractersticas (una vez, sobre la escena ya iluminada)
+	featureEdges();
+
+	// - Contorno en espacio de pantalla
+	if (enabledScreenSpaceOutline)
+	{
+		screenSpaceOutline(false);
+	}
 }
 
-// - Tcnica de rendering NPR: Gooch Shading
-void Renderer::goochShading()
+// - Mtodo privado: sombreado diferido. La pasada de geometra escribe en el G-buffer el material y
+//   los parmetros de la tcnica de cada pxel visible (con la pre-pasada de profundidad y el
+//   occlusion culling si estn activados); despus, cada fuente luminosa activa se aplica con un quad
+//   a pantalla completa sobre el frame buffer enlazado (la pantalla o el FBO del post-procesamiento)
+//   y los contornos se dibujan una sola vez sobre la profundidad de la escena
+void Renderer::deferredShading(unsigned int technique, ElementDrawPass pass)
 {
-	// - Flag para comprobar la primera fuenta activa
-	bool firstLightEnabled = false;
+	glm::mat4 mView = camera->getViewMatrix();
+	glm::mat4 mProjection = camera->getProjectionMatrix();
 
-	// - Iluminacin
-	for (unsigned int i = 0; i < lights.size(); i++)
+	// - 1 PASADA: geometra en el G-buffer (sin blending: el alfa del albedo marca la geometra)
 	{
-		// - Dibujar contorno bsico
-		basicOutline();
+		RENDER_STATS_PASS("G-buffer");
 
-		// - Dibujar contorno avanzado
-		advancedOutline();
+		gBuffer->bindFrameBuffer();
+		glDisable(GL_BLEND);
 
-		// - Activar shader
-		goochShadingShader.use();
+		depthPrepass();
 
-		// - Aplicar fuente luminosa si est activada
-		if (lights[i]->isLightEnabled())
+		beginShading();
+		ShaderProgram *shader = gBufferShaders.use(technique);
+		sceneStore.draw(*shader, pass, mView, mProjection);
+
+		// - Modelos instanciados con la variante instanciada del shader
+		if (sceneHasInstances)
 		{
+			ShaderProgram *instancedShader = gBufferShaders.use(technique | INSTANCED_VARIANT);
+			sceneStore.draw(*instancedShader, pass, mView, mProjection);
+		}
+
+		endShading();
+
+		gBuffer->unbindFrameBuffer();
+
+		if (numberOfLightsEnabled > 0)
+		{
+			glEnable(GL_BLEND);
+		}
+	}
+
+	// - 2 PASADA: fuentes luminosas. Los quads escriben la profundidad del G-buffer sin compararla
+	{
+		RENDER_STATS_PASS("Deferred lighting");
+
+		glm::mat4 mInverseProjection = glm::inverse(mProjection);
+		bool firstLightEnabled = false;
+
+		glDepthFunc(GL_ALWAYS);
+
+		for (unsigned int i = 0; i < lights.size(); i++)
+		{
+			if (!lights[i]->isLightEnabled())
+			{
+				continue;
+			}
+
 			if (!firstLightEnabled)
 			{
 				// - Si es la primera, activar este modo de mezcla
-				glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+				GLStateCache::getInstance()->blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 				firstLightEnabled = true;
 			}
 			else
 			{
 				// - Para el resto de fuentes luminosas activar este otro modo
-				glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+				GLStateCache::getInstance()->blendFunc(GL_SRC_ALPHA, GL_ONE);
 			}
 
-			lights[i]->apply(goochShadingShader);
+			ShaderProgram *shader = deferredShaders.use(technique | lights[i]->getVariant());
+			lights[i]->apply(*shader);
+			drawDeferredLight(*shader, mInverseProjection);
+		}
+
+		// - Sin fuentes activas, la geometra se dibuja sin iluminar (fuente ambiente apagada)
+		if (!firstLightEnabled)
+		{
+			ShaderProgram *shader = deferredShaders.use(technique | AMBIENT_LIGHT_VARIANT);
+			shader->setUniform("Ia", glm::vec3(0.f));
+			drawDeferredLight(*shader, mInverseProjection);
 		}
 
-		// - Dibujar la escena
-		currentScene->drawGoochShading(goochShadingShader, currentScene->getModelMatrix(), camera->getViewMatrix(),
-									  camera->getProjectionMatrix());
+		glDepthFunc(GL_LEQUAL);
+	}
+
+	// - Aristas caractersticas
+	featureEdges();
+
+	// - Contornos (el de espacio de pantalla lee la normal y la profundidad del G-buffer)
+	if (enabledScreenSpaceOutline)
+	{
+		screenSpaceOutline(true);
+	}
+	else
+	{
+		basicOutline();
+		advancedOutline();
+	}
+}
+
+// - Mtodo privado: dibujar el quad de una fuente luminosa del sombreado diferido
+void Renderer::drawDeferredLight(ShaderProgram &shader, const glm::mat4 &mInverseProjection)
+{
+	gBuffer->bindTextures(shader, 0);
+
+	if (shader.hasUniform("mInverseProjection"))
+	{
+		shader.setUniform("mInverseProjection", mInverseProjection);
+	}
+
+	quad->draw();
+}
+
+// - Rendering realista
+void Renderer::realistic()
+{
+	// - Estadsticas de rendering: pasada "Realistic"
+	RENDER_STATS_PASS("Realistic");
+
+	// - Iluminacin: sombreado diferido (la escena se rasteriza una vez en el G-buffer) o una pasada
+	//   por fuente luminosa
+	if (enabledDeferredShading)
+	{
+		deferredShading(DEFAULT_VARIANT, PASS_REALISTIC);
+	}
+	else
+	{
+		forwardShading(realisticShaders, PASS_REALISTIC);
+	}
+
+	// - Dibujado de skybox
+	{
+		RENDER_STATS_PASS("Skybox");
+
+		realisticSkyboxShader.use();
+		glm::mat4 skyboxVP = camera->getProjectionMatrix() * glm::mat4(glm::mat3(camera->getViewMatrix()));
+		skybox->drawRealistic(realisticSkyboxShader, skyboxVP);
+	}
+}
+
+// - Rendering Monochrome
+void Renderer::monochrome()
+{
+	// - Estadsticas de rendering: pasada "Monochrome"
+	RENDER_STATS_PASS("Monochrome");
+
+	// - Iluminacin: sombreado diferido (la escena se rasteriza una vez en el G-buffer) o una pasada
+	//   por fuente luminosa
+	if (enabledDeferredShading)
+	{
+		deferredShading(MONOCHROME_VARIANT, PASS_MONOCHROME);
+	}
+	else
+	{
+		forwardShading(monochromeShaders, PASS_MONOCHROME);
+	}
+
+	// - Dibujado de skybox
+	{
+		RENDER_STATS_PASS("Skybox");
+
+		realisticSkyboxShader.use();
+		glm::mat4 skyboxVP = camera->getProjectionMatrix() * glm::mat4(glm::mat3(camera->getViewMatrix()));
+		skybox->drawRealistic(realisticSkyboxShader, skyboxVP);
+	}
+}
+
+// - Tcnica de rendering NPR: Cel-Shading
+void Renderer::celShading()
+{
+	// - Estadsticas de rendering: pasada "Cel-Shading"
+	RENDER_STATS_PASS("Cel-Shading");
+
+	// - Iluminacin: sombreado diferido (la escena se rasteriza una vez en el G-buffer) o una pasada
+	//   por fuente luminosa
+	if (enabledDeferredShading)
+	{
+		deferredShading(CEL_SHADING_VARIANT, PASS_CEL_SHADING);
+	}
+	else
+	{
+		forwardShading(celShadingShaders, PASS_CEL_SHADING);
+	}
+
+	// - Intensidad de la fuente luminosa ambiente (para calcular el color final del skybox)
+	glm::vec3 Ia = glm::vec3(0.f);
+
+	for (unsigned int i = 0; i < lights.size(); i++)
+	{
+		if (lights[i]->isLightEnabled() && lights[i]->getType() == "Ambient")
+		{
+			Ia = lights[i]->getIa() / glm::vec3(2.f);
+		}
+	}
+
+	// - Dibujado de skybox
+	{
+		RENDER_STATS_PASS("Skybox");
+
+		celShadingSkyboxShader.use();
+		glm::mat4 skyboxVP = camera->getProjectionMatrix() * glm::mat4(glm::mat3(camera->getViewMatrix()));
+		skybox->drawCelShading(celShadingSkyboxShader, skyboxVP, Ia);
+	}
+}
+
+// - Tcnica de rendering NPR: Hatching
+void Renderer::hatching()
+{
+	// - Estadsticas de rendering: pasada "Hatching"
+	RENDER_STATS_PASS("Hatching");
+
+	// - Iluminacin: sombreado diferido (la escena se rasteriza una vez en el G-buffer) o una pasada
+	//   por fuente luminosa
+	if (enabledDeferredShading)
+	{
+		deferredShading(HATCHING_VARIANT, PASS_HATCHING);
+	}
+	else
+	{
+		forwardShading(hatchingShaders, PASS_HATCHING);
+	}
+
+	// - Dibujado de skybox
+	{
+		RENDER_STATS_PASS("Skybox");
+
+		hatchingSkyboxShader.use();
+		glm::mat4 skyboxVP = camera->getProjectionMatrix() * glm::mat4(glm::mat3(camera->getViewMatrix()));
+		skybox->drawHatching(hatchingSkyboxShader, skyboxVP);
+	}
+}
+
+// - Tcnica de rendering NPR: Gooch Shading
+void Renderer::goochShading()
+{
+	// - Estadsticas de rendering: pasada "Gooch Shading"
+	RENDER_STATS_PASS("Gooch Shading");
+
+	// - Iluminacin: sombreado diferido (la escena se rasteriza una vez en el G-buffer) o una pasada
+	//   por fuente luminosa
+	if (enabledDeferredShading)
+	{
+		deferredShading(GOOCH_SHADING_VARIANT, PASS_GOOCH_SHADING);
+	}
+	else
+	{
+		forwardShading(goochShadingShaders, PASS_GOOCH_SHADING);
 	}
 
 	// - Dibujado de skybox
-	realisticSkyboxShader.use();
-	glm::mat4 skyboxVP = camera->getProjectionMatrix() * glm::mat4(glm::mat3(camera->getViewMatrix()));
-	skybox->drawRealistic(realisticSkyboxShader, skyboxVP);
+	{
+		RENDER_STATS_PASS("Skybox");
+
+		realisticSkyboxShader.use();
+		glm::mat4 skyboxVP = camera->getProjectionMatrix() * glm::mat4(glm::mat3(camera->getViewMatrix()));
+		skybox->drawRealistic(realisticSkyboxShader, skyboxVP);
+	}
 }
 
 /*
@@ -1442,6 +2332,9 @@ void Renderer::goochShading()
 // - Tcnica de rendering NPR: Halftone
 void Renderer::halftone()
 {
+	// - Estadsticas de rendering: pasada "Halftone"
+	RENDER_STATS_PASS("Halftone");
+
 	// - 1 PASADA: Dibujar la escena en la textura del FBO
 
 	// - Enlazar FBO
@@ -1461,24 +2354,24 @@ void Renderer::halftone()
 	// - Limpiar buffers de color y profundidad
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-	// - Enlazar texturas de color y profundidad
+	// - Enlazar textura de color
 	fbo->activeTextureUnit(0);
 	fbo->bindRenderTexture();
 
-	fbo->bindDepthBuffer();
-
 	// - Dibujar Quad con la textura de la escena
 	halftoneShader.use();
 	quad->drawHalftone(halftoneShader, 0);
 
-	// - Desenlazar texturas de color y profundiad
+	// - Desenlazar textura de color
 	fbo->unbindRenderTexture();
-	fbo->unbindDepthBuffer();
 }
 
 // - Tcnica de rendering NPR: Dithering
 void Renderer::dithering()
 {
+	// - Estadsticas de rendering: pasada "Dithering"
+	RENDER_STATS_PASS("Dithering");
+
 	// - 1 PASADA: Dibujar la escena en la textura del FBO
 
 	// - Enlazar FBO
@@ -1498,24 +2391,24 @@ void Renderer::dithering()
 	// - Limpiar buffers de color y profundidad
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-	// - Enlazar texturas de color y profundidad
+	// - Enlazar textura de color
 	fbo->activeTextureUnit(0);
 	fbo->bindRenderTexture();
 
-	fbo->bindDepthBuffer();
-
 	// - Dibujar Quad con la textura de la escena
 	ditheringShader.use();
 	quad->drawDithering(ditheringShader, 0);
 
-	// - Desenlazar texturas de color y profundiad
+	// - Desenlazar textura de color
 	fbo->unbindRenderTexture();
-	fbo->unbindDepthBuffer();
 }
 
 // - Tcnica de rendering NPR: PixelArt
 void Renderer::pixelArt()
 {
+	// - Estadsticas de rendering: pasada "Pixel Art"
+	RENDER_STATS_PASS("Pixel Art");
+
 	// - 1 PASADA: Dibujar la escena en la textura del FBO
 
 	// - Enlazar FBO
@@ -1535,24 +2428,24 @@ void Renderer::pixelArt()
 	// - Limpiar buffers de color y profundidad
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-	// - Enlazar texturas de color y profundidad
+	// - Enlazar textura de color
 	fbo->activeTextureUnit(0);
 	fbo->bindRenderTexture();
 
-	fbo->bindDepthBuffer();
-
 	// - Dibujar Quad con la textura de la escena
 	pixelArtShader.use();
 	quad->drawPixelArt(pixelArtShader, 0);
 
-	// - Desenlazar texturas de color y profundiad
+	// - Desenlazar textura de color
 	fbo->unbindRenderTexture();
-	fbo->unbindDepthBuffer();
 }
 
 // - Tcnica de rendering NPR: Painterly (leo)
 void Renderer::painterly()
 {
+	// - Estadsticas de rendering: pasada "Painterly"
+	RENDER_STATS_PASS("Painterly");
+
 	// - 1 PASADA: Dibujar la escena en la textura del FBO
 
 	// - Enlazar FBO
@@ -1572,24 +2465,24 @@ void Renderer::painterly()
 	// - Limpiar buffers de color y profundidad
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-	// - Enlazar texturas de color y profundidad
+	// - Enlazar textura de color
 	fbo->activeTextureUnit(0);
 	fbo->bindRenderTexture();
 
-	fbo->bindDepthBuffer();
-
 	// - Dibujar Quad con la textura de la escena
 	painterlyShader.use();
 	quad->drawPainterly(painterlyShader, 0);
 
-	// - Desenlazar texturas de color y profundiad
+	// - Desenlazar textura de color
 	fbo->unbindRenderTexture();
-	fbo->unbindDepthBuffer();
 }
 
 // - Tcnica de rendering NPR: Charcoal (carboncillo)
 void Renderer::charcoal()
 {
+	// - Estadsticas de rendering: pasada "Charcoal"
+	RENDER_STATS_PASS("Charcoal");
+
 	// - 1 PASADA: Dibujar la escena en la textura del FBO
 
 	// - Enlazar FBO
@@ -1613,15 +2506,18 @@ void Renderer::charcoal()
 	fbo->activeTextureUnit(0);
 	fbo->bindRenderTexture();
 
-	fbo->bindDepthBuffer();
+	fbo->activeTextureUnit(1);
+	fbo->bindDepthTexture();
 
 	// - Dibujar Quad con la textura de la escena
 	charcoalShader.use();
-	quad->drawCharcoal(charcoalShader, 0);
+	quad->drawCharcoal(charcoalShader, 0, 1, glm::inverse(camera->getProjectionMatrix()));
 
 	// - Desenlazar texturas de color y profundiad
+	fbo->unbindDepthTexture();
+
+	fbo->activeTextureUnit(0);
 	fbo->unbindRenderTexture();
-	fbo->unbindDepthBuffer();
 }
 
 /*
@@ -1633,44 +2529,213 @@ void Renderer::charcoal()
 // - Dibujar contorno bsico alrededor de los objetos
 void Renderer::basicOutline()
 {
+	// - Compilacin bajo demanda: los contornos se dibujan cuando sus shader programs estn listos
+	if (!requestShaderPrograms({ &basicOutlineShader, &basicOutlineInstancedShader }, false))
+	{
+		return;
+	}
+
+	// - Estadsticas de rendering: pasada "Basic outline"
+	RENDER_STATS_PASS("Basic outline");
+
 	// - Activar Front Face-culling
 	glEnable(GL_CULL_FACE);
 	glCullFace(GL_FRONT);
 
-	// - Dibujar contornos para los elementos de la escena que lo tengan activado
-	for (int i = 0; i < currentScene->getNumElements(); i++)
+	// - Variantes del shader (los modelos instanciados usan la instanciada)
+	ShaderProgram *shaders[2] = { &basicOutlineShader, &basicOutlineInstancedShader };
+
+	// - Dibujar contornos (modelos escalados con un color especfico) para los elementos de la escena
+	//   que lo tengan activado
+	for (ShaderProgram *shader : shaders)
 	{
-		if (currentScene->getElement(i)->getBasicOutline().enabled)
+		shader->use();
+		sceneStore.draw(*shader, PASS_BASIC_OUTLINE, camera->getViewMatrix(), camera->getProjectionMatrix());
+	}
+	
+	// - Desactivar Face-culling
+	glDisable(GL_CULL_FACE);
+}
+
+// - Dibujar contorno avanzado alrededor de los objetos
+void Renderer::advancedOutline()
+{
+	// - Compilacin bajo demanda: los contornos se dibujan cuando sus shader programs estn listos
+	if (!requestShaderPrograms({ &advancedOutlineShader, &advancedOutlineInstancedShader }, false))
+	{
+		return;
+	}
+
+	// - Estadsticas de rendering: pasada "Advanced outline"
+	RENDER_STATS_PASS("Advanced outline");
+
+	// - Variantes del shader (los modelos instanciados usan la instanciada)
+	ShaderProgram *shaders[2] = { &advancedOutlineShader, &advancedOutlineInstancedShader };
+
+	// - Siluetas con compute shader: las mallas lanzan la bsqueda de sus aristas y los quads de
+	//   todas se dibujan con una sola orden indirecta. Los modelos instanciados siguen usando el
+	//   geometry shader
+	if (enabledComputeSilhouettes && silhouetteExtractor->request(false))
+	{
+		RENDER_STATS_PASS("Compute silhouettes");
+
+		ShaderProgram &computeShader = silhouetteExtractor->begin();
+		sceneStore.draw(computeShader, PASS_ADVANCED_OUTLINE, camera->getViewMatrix(), camera->getProjectionMatrix());
+		silhouetteExtractor->draw();
+
+		shaders[0] = nullptr;
+	}
+
+	// - Dibujar contornos (usando adyacencias de tringulos en las mallas de los modelos) para los
+	//   elementos de la escena que lo tengan activado
+	for (ShaderProgram *shader : shaders)
+	{
+		if (shader == nullptr)
 		{
-			// - Dibujado de contornos (modelos escalados con un color especfico)
-			basicOutlineShader.use();
-			currentScene->getElement(i)->drawBasicOutline(basicOutlineShader, 
-														  currentScene->getElement(i)->getModelMatrix(),
-														  camera->getViewMatrix(), 
-														  camera->getProjectionMatrix());
+			continue;
 		}
+
+		shader->use();
+		sceneStore.draw(*shader, PASS_ADVANCED_OUTLINE, camera->getViewMatrix(), camera->getProjectionMatrix());
+	}
+}
+
+// - Mtodo privado: dibujar el contorno en espacio de pantalla. Con el sombreado directo, una
+//   pre-pasada escribe en su FBO el identificador, la normal y la profundidad de la escena (una sola
+//   vez por frame, con independencia del nmero de fuentes luminosas); con el diferido se usan la
+//   normal y la profundidad del G-buffer. Despus un quad a pantalla completa dibuja el contorno en
+//   los pxeles con discontinuidades, sin comparar ni escribir la profundidad
+void Renderer::screenSpaceOutline(bool deferred)
+{
+	// - Compilacin bajo demanda: el contorno se dibuja cuando sus shader programs estn listos
+	if (!requestShaderPrograms({ &edgePrepassShader, &edgePrepassInstancedShader, &screenSpaceOutlineShader }, false))
+	{
+		return;
+	}
+
+	// - Estadsticas de rendering: pasada "Screen-space outline"
+	RENDER_STATS_PASS("Screen-space outline");
+
+	GLStateCache *stateCache = GLStateCache::getInstance();
+	glm::mat4 mView = camera->getViewMatrix();
+	glm::mat4 mProjection = camera->getProjectionMatrix();
+
+	// - Pre-pasada (slo con el sombreado directo)
+	if (!deferred)
+	{
+		RENDER_STATS_PASS("Edge pre-pass");
+
+		// - Frame buffer enlazado (la pantalla o el FBO del post-procesamiento), al que se vuelve despus
+		GLint previousFrameBuffer = 0;
+		glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFrameBuffer);
+
+		fboOutline->bindFrameBuffer();
+
+		// - Limpiar destinos (identificador y normal a cero) y profundidad
+		const GLfloat zero[4] = { 0.f, 0.f, 0.f, 0.f };
+		const GLfloat one = 1.f;
+
+		glClearBufferfv(GL_COLOR, 0, zero);
+		glClearBufferfv(GL_COLOR, 1, zero);
+		glClearBufferfv(GL_DEPTH, 0, &one);
+
+		// - Dibujar la escena (sin blending: se escriben los datos de cada pxel)
+		GLboolean blending = glIsEnabled(GL_BLEND);
+		glDisable(GL_BLEND);
+
+		ShaderProgram *shaders[2] = { &edgePrepassShader, &edgePrepassInstancedShader };
+
+		for (ShaderProgram *shader : shaders)
+		{
+			shader->use();
+			sceneStore.draw(*shader, PASS_NORMALS, mView, mProjection);
+		}
+
+		if (blending)
+		{
+			glEnable(GL_BLEND);
+		}
+
+		glBindFramebuffer(GL_FRAMEBUFFER, previousFrameBuffer);
+		RENDER_STATS_FRAMEBUFFER(previousFrameBuffer);
+	}
+
+	// - Texturas de normal, profundidad e identificador (el G-buffer no tiene identificadores: el
+	//   sampler se asigna a la unidad de la normal)
+	if (deferred)
+	{
+		stateCache->bindTexture(GL_TEXTURE_2D, 0, gBuffer->getTexture(GBUFFER_NORMAL));
+		stateCache->bindTexture(GL_TEXTURE_2D, 1, gBuffer->getDepthTexture());
+	}
+	else
+	{
+		fboOutline->activeTextureUnit(0);
+		fboOutline->bindNormalTexture();
+
+		fboOutline->activeTextureUnit(1);
+		fboOutline->bindDepthTexture();
+
+		fboOutline->activeTextureUnit(2);
+		fboOutline->bindRenderTexture();
 	}
-	
-	// - Desactivar Face-culling
-	glDisable(GL_CULL_FACE);
+
+	screenSpaceOutlineShader.use();
+	screenSpaceOutlineShader.setUniform("TexNormal", 0);
+	screenSpaceOutlineShader.setUniform("TexDepth", 1);
+	screenSpaceOutlineShader.setUniform("TexElementId", deferred ? 0 : 2);
+	screenSpaceOutlineShader.setUniform("useElementIds", !deferred);
+	screenSpaceOutlineShader.setUniform("mInverseProjection", glm::inverse(mProjection));
+	screenSpaceOutlineShader.setUniform("outlineColor", screenSpaceOutlineSettings.color);
+	screenSpaceOutlineShader.setUniform("outlineThickness", (GLint) screenSpaceOutlineSettings.thickness);
+	screenSpaceOutlineShader.setUniform("depthThreshold", screenSpaceOutlineSettings.depthThreshold);
+	screenSpaceOutlineShader.setUniform("normalThreshold", screenSpaceOutlineSettings.normalThreshold);
+
+	// - Dibujar el quad sobre la escena (el contorno sustituye al color de sus pxeles)
+	stateCache->blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glDepthFunc(GL_ALWAYS);
+	glDepthMask(GL_FALSE);
+
+	quad->draw();
+
+	glDepthMask(GL_TRUE);
+	glDepthFunc(GL_LEQUAL);
 }
 
-// - Dibujar contorno avanzado alrededor de los objetos
-void Renderer::advancedOutline()
+// - Mtodo privado: dibujar las aristas caractersticas de todos los elementos. Las lneas se
+//   prueban contra la profundidad de la escena (desplazadas hacia el observador para no quedar
+//   ocultas por sus propias caras) sin escribirla, y se mezclan por su suavizado
+void Renderer::featureEdges()
 {
-	// - Dibujar contornos para los elementos de la escena que lo tengan activado
-	for (int i = 0; i < currentScene->getNumElements(); i++)
+	// - Parmetros de la extraccin (si han cambiado, los modelos vuelven a extraer sus aristas al
+	//   dibujarlas)
+	FeatureEdges::setSettings(featureEdgeSettings);
+
+	if (!featureEdgeSettings.enabled)
 	{
-		if (currentScene->getElement(i)->getAdvancedOutline().enabled)
-		{
-			// - Dibujado de contornos (usando adyacencias de tringulos en las mallas de los modelos)
-			advancedOutlineShader.use();
-			currentScene->getElement(i)->drawAdvancedOutline(advancedOutlineShader,
-															 currentScene->getElement(i)->getModelMatrix(),
-															 camera->getViewMatrix(),
-															 camera->getProjectionMatrix());
-		}
+		return;
 	}
+
+	// - Compilacin bajo demanda: las aristas se dibujan cuando su shader program est listo
+	if (!requestShaderPrograms({ &featureEdgesShader }, false))
+	{
+		return;
+	}
+
+	// - Estadsticas de rendering: pasada "Feature edges"
+	RENDER_STATS_PASS("Feature edges");
+
+	featureEdgesShader.use();
+	featureEdgesShader.setUniform("viewportSize", glm::vec2(viewportWidth, viewportHeight));
+	featureEdgesShader.setUniform("lineWidth", featureEdgeSettings.width);
+	featureEdgesShader.setUniform("lineColor", featureEdgeSettings.color);
+	featureEdgesShader.setUniform("depthBias", FEATURE_EDGE_DEPTH_BIAS);
+
+	GLStateCache::getInstance()->blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glDepthMask(GL_FALSE);
+
+	sceneStore.draw(featureEdgesShader, PASS_FEATURE_EDGES, camera->getViewMatrix(), camera->getProjectionMatrix());
+
+	glDepthMask(GL_TRUE);
 }
 
 // - Activar/desactivar dibujado de contornos
@@ -1685,6 +2750,48 @@ void Renderer::toggleAdvancedOutline()
 	currentElement->getAdvancedOutline().enabled = !currentElement->getAdvancedOutline().enabled;
 }
 
+// - Activar/desactivar dibujado de contornos en todos los elementos de la escena actual
+void Renderer::setOutlines(bool basicOutlineEnabled, bool advancedOutlineEnabled)
+{
+	// - Compilar ya los shader programs de los contornos que se activan
+	if (basicOutlineEnabled)
+	{
+		requestShaderPrograms({ &basicOutlineShader, &basicOutlineInstancedShader }, true);
+	}
+
+	if (advancedOutlineEnabled)
+	{
+		requestShaderPrograms({ &advancedOutlineShader, &advancedOutlineInstancedShader }, true);
+	}
+
+	for (int i = 0; i < currentScene->getNumElements(); i++)
+	{
+		currentScene->getElement(i)->getBasicOutline().enabled = basicOutlineEnabled;
+		currentScene->getElement(i)->getAdvancedOutline().enabled = advancedOutlineEnabled;
+	}
+}
+
+// - Activar/desactivar las siluetas del contorno avanzado con compute shader (se compilan ya sus
+//   shader programs)
+bool Renderer::setComputeSilhouettes(bool enabled)
+{
+	if (enabled && !silhouetteExtractor->request(true))
+	{
+		enabledComputeSilhouettes = false;
+		return false;
+	}
+
+	enabledComputeSilhouettes = enabled;
+
+	return true;
+}
+
+// - Saber si el driver admite las siluetas con compute shader
+bool Renderer::isComputeSilhouetteSupported()
+{
+	return silhouetteExtractor->isSupported();
+}
+
 /*
  **********************************************
 				    CMARA
@@ -1882,7 +2989,8 @@ void Renderer::scenesGUI()
 		{
 			"Island",
 			"Treasure chest",
-			"Statue"
+			"Statue",
+			"Scattered chests"
 		};
 
 		bool sceneSwitched = false;
@@ -1900,9 +3008,9 @@ void Renderer::scenesGUI()
 					// - Texto (elemento seleccionado)
 					ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "Selected element:");
 
-					// - Crear ListBox de los elementos de la escena 1
-					ImGui::ListBox("##ListBoxElements1", &selectedElementScene1, scene1Names,
-								   IM_ARRAYSIZE(scene1Names), (sizeof(scene1Names) / sizeof(*scene1Names) + 1));
+					// - Nombre del elemento seleccionado (se selecciona haciendo click sobre l)
+					ImGui::Text("%s", scene1Names[selectedElementScene1]);
+					ImGui::TextDisabled("Click on an element to select it");
 
 					// - Actualizar elemento seleccionado actualmente
 					currentElement = currentScene->getElement(selectedElementScene1);
@@ -1915,7 +3023,7 @@ void Renderer::scenesGUI()
 					// - Botn para cambiar la escena
 					if (ImGui::Button("Change scene"))
 					{
-						setupScene(0);
+						requestScene(0);
 					}
 				}
 
@@ -1931,9 +3039,9 @@ void Renderer::scenesGUI()
 					// - Texto (elemento seleccionado)
 					ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "Selected element:");
 
-					// - Crear ListBox de los elementos de la escena 2
-					ImGui::ListBox("##ListBoxElements2", &selectedElementScene2, scene2Names,
-								   IM_ARRAYSIZE(scene2Names), (sizeof(scene2Names) / sizeof(*scene2Names) + 1));
+					// - Nombre del elemento seleccionado (se selecciona haciendo click sobre l)
+					ImGui::Text("%s", scene2Names[selectedElementScene2]);
+					ImGui::TextDisabled("Click on an element to select it");
 
 					// - Actualizar elemento seleccionado actualmente
 					currentElement = currentScene->getElement(selectedElementScene2);
@@ -1946,7 +3054,7 @@ void Renderer::scenesGUI()
 					// - Botn para cambiar la escena
 					if (ImGui::Button("Change scene"))
 					{
-						setupScene(1);
+						requestScene(1);
 					}
 				}
 
@@ -1962,9 +3070,9 @@ void Renderer::scenesGUI()
 					// - Texto (elemento seleccionado)
 					ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "Selected element:");
 
-					// - Crear ListBox de los elementos de la escena 2
-					ImGui::ListBox("##ListBoxElements3", &selectedElementScene3, scene3Names,
-								   IM_ARRAYSIZE(scene3Names), (sizeof(scene3Names) / sizeof(*scene3Names) + 1));
+					// - Nombre del elemento seleccionado (se selecciona haciendo click sobre l)
+					ImGui::Text("%s", scene3Names[selectedElementScene3]);
+					ImGui::TextDisabled("Click on an element to select it");
 
 					// - Actualizar elemento seleccionado actualmente
 					currentElement = currentScene->getElement(selectedElementScene3);
@@ -1977,7 +3085,7 @@ void Renderer::scenesGUI()
 					// - Botn para cambiar la escena
 					if (ImGui::Button("Change scene"))
 					{
-						setupScene(2);
+						requestScene(2);
 					}
 				}
 
@@ -2206,6 +3314,12 @@ void Renderer::renderingGUI()
 		ImGui::ListBox("##ListBoxRendering", &selectedTechnique, techniques,
 					   IM_ARRAYSIZE(techniques), (sizeof(techniques) / sizeof(*techniques) + 1));
 
+		// - Compilacin bajo demanda: la tcnica seleccionada se dibuja cuando termina de compilarse
+		if (compilingTechnique)
+		{
+			ImGui::TextColored(ImVec4(1.0f, 0.5f, 0.0f, 1.0f), "Compiling shader programs...");
+		}
+
 		// - Configuracin del dibujado de contornos (si el modelo no es un plano)
 		if (!currentElement->elementIsPlane())
 		{
@@ -2253,6 +3367,16 @@ void Renderer::renderingGUI()
 				ImGui::SliderFloat("Extension", &currentElement->getAdvancedOutline().extension,
 								   0.f, 0.05f, "%.4f");
 
+				// - Siluetas con compute shader (todos los elementos)
+				if (silhouetteExtractor->isSupported())
+				{
+					ImGui::Checkbox("Compute shader##Advanced", &enabledComputeSilhouettes);
+				}
+				else
+				{
+					ImGui::TextDisabled("Compute shader: not supported");
+				}
+
 				// - Aadir espacio
 				ImGui::Spacing();
 
@@ -2264,6 +3388,73 @@ void Renderer::renderingGUI()
 			}
 		}
 
+		// - Separador
+		ImGui::Separator();
+
+		// - Contorno en espacio de pantalla (todos los elementos, en lugar de los contornos bsico y
+		//   avanzado)
+		ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "Outline (Screen space):");
+		ImGui::Checkbox("Enabled##ScreenSpace", &enabledScreenSpaceOutline);
+
+		if (enabledScreenSpaceOutline)
+		{
+			ImGui::ColorEdit3("Color##ScreenSpace", &screenSpaceOutlineSettings.color[0]);
+
+			ImGui::SliderInt("Thickness##ScreenSpace", &screenSpaceOutlineSettings.thickness, 1, 4, "%d px");
+
+			ImGui::SliderFloat("Depth threshold##ScreenSpace", &screenSpaceOutlineSettings.depthThreshold,
+							   0.001f, 0.1f, "%.3f");
+
+			ImGui::SliderFloat("Normal threshold##ScreenSpace", &screenSpaceOutlineSettings.normalThreshold,
+							   0.05f, 1.f, "%.2f");
+
+			// - Aadir espacio
+			ImGui::Spacing();
+
+			// - Botn para restaurar a estado por defecto
+			if (ImGui::Button("Default##ScreenSpace"))
+			{
+				screenSpaceOutlineSettings = ScreenSpaceOutline();
+			}
+		}
+
+		// - Separador
+		ImGui::Separator();
+
+		// - Aristas caractersticas (todos los modelos, junto con los contornos)
+		ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "Feature edges:");
+		ImGui::Checkbox("Enabled##FeatureEdges", &featureEdgeSettings.enabled);
+
+		if (featureEdgeSettings.enabled)
+		{
+			ImGui::ColorEdit3("Color##FeatureEdges", &featureEdgeSettings.color[0]);
+
+			ImGui::SliderFloat("Width##FeatureEdges", &featureEdgeSettings.width, 1.f, 5.f, "%.1f px");
+
+			// - Tipos de arista (al cambiarlos se vuelven a extraer en segundo plano)
+			ImGui::SliderFloat("Crease angle##FeatureEdges", &featureEdgeSettings.creaseAngle, 1.f, 180.f, "%.0f deg");
+			ImGui::Checkbox("UV seams##FeatureEdges", &featureEdgeSettings.uvSeams);
+			ImGui::SameLine();
+			ImGui::Checkbox("Materials##FeatureEdges", &featureEdgeSettings.materialBoundaries);
+			ImGui::SameLine();
+			ImGui::Checkbox("Boundaries##FeatureEdges", &featureEdgeSettings.boundaries);
+
+			if (FeatureEdges::getPendingJobs() > 0)
+			{
+				ImGui::TextDisabled("Extracting feature edges (%u models)...", FeatureEdges::getPendingJobs());
+			}
+
+			// - Aadir espacio
+			ImGui::Spacing();
+
+			// - Botn para restaurar a estado por defecto
+			if (ImGui::Button("Default##FeatureEdges"))
+			{
+				featureEdgeSettings = FeatureEdgeSettings();
+				featureEdgeSettings.enabled = true;
+			}
+		}
+
 		// - Constante cero
 		static float zero = 0.f;
 
@@ -2583,6 +3774,17 @@ void Renderer::renderingGUI()
 					ImGui::SliderFloat("Threshold##Charcoal",
 									   &quad->getCharcoalTechnique().threshold,
 									   0.01f, 0.1f, "%.3f");
+
+					// - Contornos por saltos de profundidad y su umbral
+					ImGui::Checkbox("Depth edges##Charcoal",
+									&quad->getCharcoalTechnique().depthEdges);
+
+					if (quad->getCharcoalTechnique().depthEdges)
+					{
+						ImGui::SliderFloat("Depth threshold##Charcoal",
+										   &quad->getCharcoalTechnique().depthThreshold,
+										   0.01f, 1.f, "%.2f");
+					}
 				}
 
 				// - Separador
@@ -2761,6 +3963,230 @@ void Renderer::miscellaneousGUI()
 		// - Separador
 		ImGui::Separator();
 
+		// - Frustum culling (activacin y elementos/mallas descartados en el ltimo frame)
+		ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "Frustum culling:");
+		ImGui::Checkbox("Enabled##FrustumCulling", &enabledFrustumCulling);
+		ImGui::SameLine();
+		ImGui::Checkbox("BVH##FrustumCulling", &enabledBVH);
+		ImGui::Text("Elements: %u visible, %u culled",
+					cullingStatistics.elementsTested - cullingStatistics.elementsCulled, cullingStatistics.elementsCulled);
+		ImGui::Text("Meshes: %u visible, %u culled",
+					cullingStatistics.meshesTested - cullingStatistics.meshesCulled, cullingStatistics.meshesCulled);
+
+		// - Separador
+		ImGui::Separator();
+
+		// - Niveles de detalle (mallas visibles en cada nivel y tringulos dibujados por pasada)
+		ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "Level of detail:");
+		ImGui::Checkbox("Enabled##LevelOfDetail", &enabledLOD);
+		ImGui::Text("Meshes per LOD: %u / %u / %u / %u", lodMeshes[0], lodMeshes[1], lodMeshes[2], lodMeshes[3]);
+		ImGui::Text("Triangles per pass: %u", lodTriangles);
+
+		// - Separador
+		ImGui::Separator();
+
+		// - Jerarquas de siluetas (tringulos de adyacencias descartados por el contorno avanzado)
+		const SilhouetteClusterStatistics &clusterStatistics = SilhouetteClusters::getLastFrame();
+		bool enabledSilhouetteClusters = SilhouetteClusters::isEnabled();
+
+		ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "Silhouette clusters:");
+
+		if (ImGui::Checkbox("Enabled##SilhouetteClusters", &enabledSilhouetteClusters))
+		{
+			SilhouetteClusters::setEnabled(enabledSilhouetteClusters);
+		}
+
+		ImGui::Text("Adjacency triangles: %u searched, %u culled",
+					clusterStatistics.trianglesTested - clusterStatistics.trianglesCulled, clusterStatistics.trianglesCulled);
+		ImGui::Text("Nodes visited: %u", clusterStatistics.nodesVisited);
+
+		// - Separador
+		ImGui::Separator();
+
+		// - Pre-pasada de profundidad y occlusion culling (fragmentos sombreados y sobredibujado)
+		ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "Depth pre-pass:");
+		ImGui::Checkbox("Enabled##DepthPrepass", &enabledDepthPrepass);
+		ImGui::SameLine();
+		ImGui::Checkbox("Occlusion culling##DepthPrepass", &enabledOcclusionCulling);
+		ImGui::Text("Meshes occluded: %u", (enabledDepthPrepass && enabledOcclusionCulling) ? occlusionCuller->getOccludedMeshes() : 0);
+		ImGui::Text("Shaded fragments: %llu", (unsigned long long) overdrawCounter->getShadedFragments());
+		ImGui::Text("Overdraw: %.2f fragments/pixel per light pass", overdrawCounter->getOverdrawRatio());
+
+		// - Separador
+		ImGui::Separator();
+
+		// - Sombreado diferido (G-buffer): la escena se rasteriza una vez para todas las fuentes luminosas
+		ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "Deferred shading:");
+		ImGui::Checkbox("Enabled##DeferredShading", &enabledDeferredShading);
+		ImGui::Text("Geometry passes per frame: %u", enabledDeferredShading ? 1u : (unsigned int) lights.size());
+
+		// - Separador
+		ImGui::Separator();
+
+		// - Dibujado por lotes desde el almacn de geometra compartido
+		GeometryStore *geometryStore = GeometryStore::getInstance();
+		bool enabledBatching = geometryStore->isEnabled();
+
+		ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "Batched draws:");
+
+		if (ImGui::Checkbox("Enabled##BatchedDraws", &enabledBatching))
+		{
+			geometryStore->setEnabled(enabledBatching);
+		}
+
+		ImGui::Text("Submission: %s", geometryStore->isIndirect() ? "glMultiDrawElementsIndirect" : "glMultiDrawElementsBaseVertex");
+		ImGui::Text("Geometry store: %.2f MB", geometryStore->getMemory() / (1024.f * 1024.f));
+
+		// - Separador
+		ImGui::Separator();
+
+		// - Cach de transformaciones (vrtices transformados una vez por frame para todas las pasadas)
+		TransformCache *transformCache = TransformCache::getInstance();
+		bool enabledTransformCache = transformCache->isEnabled();
+
+		ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "Transform cache:");
+
+		if (ImGui::Checkbox("Enabled##TransformCache", &enabledTransformCache))
+		{
+			transformCache->setEnabled(enabledTransformCache);
+		}
+
+		ImGui::Text("Transformed: %u meshes, %u vertices", transformCache->getNumMeshes(), transformCache->getNumVertices());
+		ImGui::Text("Buffer: %.2f MB", transformCache->getCapacity() / (1024.f * 1024.f));
+
+		// - Separador
+		ImGui::Separator();
+
+		// - Arena de buffers (VBOs e IBOs de todos los VAOs): utilizacin y fragmentacin
+		BufferArena *arena = BufferArena::getInstance();
+		ArenaStatistics arenaStatistics = arena->getStatistics();
+
+		ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "Buffer arena:");
+		ImGui::Text("Allocations: %u in %u blocks", arenaStatistics.allocations, arenaStatistics.blocks);
+		ImGui::Text("Used: %.2f / %.2f MB (%.1f%% utilisation)", arenaStatistics.usedBytes / (1024.f * 1024.f),
+					arenaStatistics.reservedBytes / (1024.f * 1024.f), arenaStatistics.utilisation * 100.f);
+		ImGui::Text("Free ranges: %u (%.1f%% fragmentation)", arenaStatistics.freeRanges, arenaStatistics.fragmentation * 100.f);
+
+		if (ImGui::Button("Defragment##BufferArena"))
+		{
+			arena->defragment();
+			arena->printReport();
+		}
+
+		// - Separador
+		ImGui::Separator();
+
+		// - Texto (residencia de las escenas y presupuesto de memoria)
+		ResidencyManager *residency = ResidencyManager::getInstance();
+		MemoryUsage totalUsage = residency->getTotalUsage();
+
+		ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "Memory residency:");
+		ImGui::Text("GPU: %.2f / %zu MB", totalUsage.gpuBytes / (1024.f * 1024.f), residency->getGPUBudget() / (1024 * 1024));
+		ImGui::Text("Host: %.2f / %zu MB", totalUsage.hostBytes / (1024.f * 1024.f), residency->getHostBudget() / (1024 * 1024));
+		ImGui::Text("Skybox (shared): %.2f MB", skybox->getGPUMemory() / (1024.f * 1024.f));
+
+		ImGui::Columns(5, "##Residency");
+		ImGui::Text("Scene"); ImGui::NextColumn();
+		ImGui::Text("State"); ImGui::NextColumn();
+		ImGui::Text("GPU (MB)"); ImGui::NextColumn();
+		ImGui::Text("Host (MB)"); ImGui::NextColumn();
+		ImGui::Text("Last use"); ImGui::NextColumn();
+		ImGui::Separator();
+
+		static const char* residencyStates[] = { "Resident", "Evicted", "Loading" };
+
+		for (unsigned int i = 0; i < residency->getNumAssets(); i++)
+		{
+			const ResidentAsset &asset = residency->getAsset(i);
+
+			ImGui::Text("%s", asset.name.c_str()); ImGui::NextColumn();
+			ImGui::Text("%s%s", residencyStates[asset.state], asset.texturesReleased ? " (no images)" : ""); ImGui::NextColumn();
+			ImGui::Text("%.2f", asset.usage.gpuBytes / (1024.f * 1024.f)); ImGui::NextColumn();
+			ImGui::Text("%.2f", asset.usage.hostBytes / (1024.f * 1024.f)); ImGui::NextColumn();
+			ImGui::Text("%u frames ago", residency->getFrame() - asset.lastUsedFrame); ImGui::NextColumn();
+		}
+
+		ImGui::Columns(1);
+
+		// - Presupuestos (se aplican al cambiarlos)
+		int gpuBudgetMB = (int) (residency->getGPUBudget() / (1024 * 1024));
+		int hostBudgetMB = (int) (residency->getHostBudget() / (1024 * 1024));
+
+		bool budgetChanged = ImGui::SliderInt("GPU budget (MB)##Residency", &gpuBudgetMB, 64, 8192);
+		budgetChanged = ImGui::SliderInt("Host budget (MB)##Residency", &hostBudgetMB, 64, 8192) || budgetChanged;
+
+		if (budgetChanged)
+		{
+			residency->setBudget((size_t) gpuBudgetMB * 1024 * 1024, (size_t) hostBudgetMB * 1024 * 1024);
+			updateResidency();
+		}
+
+		// - Separador
+		ImGui::Separator();
+
+		// - Texto (cambios de estado enviados y evitados por la cach en el ltimo frame)
+		const StateCacheCounters &stateCounters = GLStateCache::getInstance()->getLastFrame();
+
+		ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "State cache (last frame):");
+		ImGui::Text("State changes: %u issued, %u saved", stateCounters.getIssued(), stateCounters.getSkipped());
+		ImGui::Text("Programs: %u (%u saved)", stateCounters.programs, stateCounters.skippedPrograms);
+		ImGui::Text("Textures: %u (%u saved)", stateCounters.textures, stateCounters.skippedTextures);
+		ImGui::Text("VAOs: %u (%u saved)", stateCounters.vertexArrays, stateCounters.skippedVertexArrays);
+		ImGui::Text("Blend functions: %u (%u saved)", stateCounters.blendFuncs, stateCounters.skippedBlendFuncs);
+
+#ifdef ENABLE_RENDER_STATISTICS
+		// - Separador
+		ImGui::Separator();
+
+		// - Texto (estadsticas de rendering del ltimo frame)
+		ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "Render statistics (last frame):");
+		ImGui::Text("Redundant operations between parentheses");
+
+		// - Tabla de estadsticas: una fila por pasada y una fila final con el total del frame
+		const FrameStatistics &frameStatistics = RenderStatistics::getInstance()->getLastFrame();
+
+		ImGui::Columns(8, "##RenderStatistics");
+		ImGui::Text("Pass"); ImGui::NextColumn();
+		ImGui::Text("Draws"); ImGui::NextColumn();
+		ImGui::Text("Triangles"); ImGui::NextColumn();
+		ImGui::Text("Uniforms"); ImGui::NextColumn();
+		ImGui::Text("Programs"); ImGui::NextColumn();
+		ImGui::Text("Textures"); ImGui::NextColumn();
+		ImGui::Text("FBOs"); ImGui::NextColumn();
+		ImGui::Text("Uploads (KB)"); ImGui::NextColumn();
+		ImGui::Separator();
+
+		for (unsigned int i = 0; i <= frameStatistics.passes.size(); i++)
+		{
+			bool totalRow = (i == frameStatistics.passes.size());
+			const RenderCounters &counters = totalRow ? frameStatistics.total : frameStatistics.passes[i].counters;
+
+			if (totalRow)
+			{
+				ImGui::Separator();
+				ImGui::Text("Total");
+			}
+			else
+			{
+				ImGui::Text("%s (x%u)", frameStatistics.passes[i].name.c_str(), frameStatistics.passes[i].invocations);
+			}
+
+			ImGui::NextColumn();
+			ImGui::Text("%u", counters.drawCalls); ImGui::NextColumn();
+			ImGui::Text("%u", counters.triangles); ImGui::NextColumn();
+			ImGui::Text("%u", counters.uniformUpdates); ImGui::NextColumn();
+			ImGui::Text("%u (%u)", counters.programSwitches, counters.redundantProgramSwitches); ImGui::NextColumn();
+			ImGui::Text("%u (%u)", counters.textureBinds, counters.redundantTextureBinds); ImGui::NextColumn();
+			ImGui::Text("%u (%u)", counters.fboSwitches, counters.redundantFboSwitches); ImGui::NextColumn();
+			ImGui::Text("%.1f (%u)", counters.bytesUploaded / 1024.0f, counters.redundantBufferUploads); ImGui::NextColumn();
+		}
+
+		ImGui::Columns(1);
+#endif
+
+		// - Separador
+		ImGui::Separator();
+
 		// - Permitir seleccionar resolucin de la captura de pantalla (no disponible para tcnicas
 		//   de post-procesamiento)
 		if (enabledPostProcessing)
@@ -2833,10 +4259,44 @@ void Renderer::miscellaneousGUI()
 			std::string message = screenshotName + std::string(" was saved successfully!");
 			ImGui::TextColored(ImVec4(0.0f, 0.8f, 0.0f, 1.0f), message.c_str());
 		}
+
+		// - Separador
+		ImGui::Separator();
+
+		// - Exportacin de lneas: tipos de arista, ngulo de los pliegues y formato
+		ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "Line art export:");
+		ImGui::Checkbox("Silhouettes##LineArt", &lineArtSettings.silhouettes);
+		ImGui::SameLine();
+		ImGui::Checkbox("Creases##LineArt", &lineArtSettings.creases);
+		ImGui::SameLine();
+		ImGui::Checkbox("Boundaries##LineArt", &lineArtSettings.boundaries);
+		ImGui::SliderFloat("Crease angle##LineArt", &lineArtSettings.creaseAngle, 1.0f, 179.0f, "%.0f deg");
+
+		if (ImGui::Button("Export SVG"))
+		{
+			lineArtName = "LineArt-" + std::to_string(++lineArtCounter) + ".svg";
+			lineArtExported = exportLineArt(lineArtName);
+		}
+
+		ImGui::SameLine();
+
+		if (ImGui::Button("Export PDF"))
+		{
+			lineArtName = "LineArt-" + std::to_string(++lineArtCounter) + ".pdf";
+			lineArtExported = exportLineArt(lineArtName);
+		}
+
+		// - Notificar que las lneas fueron guardadas
+		if (lineArtExported)
+		{
+			std::string message = lineArtName + std::string(" was saved successfully!");
+			ImGui::TextColored(ImVec4(0.0f, 0.8f, 0.0f, 1.0f), message.c_str());
+		}
 	}
 	else
 	{
 		screenshotTaken = false;
+		lineArtExported = false;
 	}
 }
 
@@ -2913,4 +4373,116 @@ void Renderer::takeScreenshot()
 	// - Recalcular aspect ratio y matriz de modelado, visin y proyeccin
 	camera->setAspect(viewportWidth, viewportHeight);
 	mvp = camera->getViewProjectionMatrix() * currentScene->getModelMatrix();
+}
+
+// - Exportar las lneas visibles de la vista actual. La profundidad de la escena se dibuja con la
+//   pre-pasada del contorno en espacio de pantalla (en su FBO, sin tocar el frame en pantalla) y se
+//   lee a la CPU, donde se resuelve la visibilidad de las aristas. Todas las mallas usan la malla
+//   original (sin niveles de detalle). Los modelos instanciados y el plano no tienen adyacencias,
+//   as que no se exportan
+bool Renderer::exportLineArt(const std::string &path)
+{
+	requestShaderPrograms({ &edgePrepassShader, &edgePrepassInstancedShader }, true);
+
+	if (sceneBVH.needsRefit())
+	{
+		sceneBVH.refit();
+	}
+
+	const std::vector<BVHPrimitive> &primitives = sceneBVH.getPrimitives();
+	glm::mat4 mView = camera->getViewMatrix();
+	glm::mat4 mProjection = camera->getProjectionMatrix();
+
+	// - Malla original en todas las mallas (se restaura el nivel de detalle al terminar)
+	std::vector<unsigned int> levelsOfDetail(primitives.size(), 0);
+
+	for (unsigned int i = 0; i < primitives.size(); i++)
+	{
+		if (primitives[i].mesh != nullptr)
+		{
+			levelsOfDetail[i] = primitives[i].mesh->getCurrentLOD();
+			primitives[i].mesh->setLOD(0);
+		}
+	}
+
+	// - Profundidad de la escena
+	std::vector<float> depth((size_t) viewportWidth * viewportHeight);
+
+	{
+		RENDER_STATS_PASS("Line art depth");
+
+		GLint previousFrameBuffer = 0;
+		glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFrameBuffer);
+
+		fboOutline->bindFrameBuffer();
+
+		const GLfloat zero[4] = { 0.f, 0.f, 0.f, 0.f };
+		const GLfloat one = 1.f;
+
+		glClearBufferfv(GL_COLOR, 0, zero);
+		glClearBufferfv(GL_COLOR, 1, zero);
+		glClearBufferfv(GL_DEPTH, 0, &one);
+
+		GLboolean blending = glIsEnabled(GL_BLEND);
+		glDisable(GL_BLEND);
+
+		ShaderProgram *shaders[2] = { &edgePrepassShader, &edgePrepassInstancedShader };
+
+		for (ShaderProgram *shader : shaders)
+		{
+			shader->use();
+			sceneStore.draw(*shader, PASS_NORMALS, mView, mProjection);
+		}
+
+		if (blending)
+		{
+			glEnable(GL_BLEND);
+		}
+
+		glReadPixels(0, 0, viewportWidth, viewportHeight, GL_DEPTH_COMPONENT, GL_FLOAT, depth.data());
+
+		glBindFramebuffer(GL_FRAMEBUFFER, previousFrameBuffer);
+		RENDER_STATS_FRAMEBUFFER(previousFrameBuffer);
+	}
+
+	// - Mallas visibles, con el color y el grosor del contorno avanzado de su elemento
+	LineArtExporter exporter(lineArtSettings);
+
+	for (const BVHPrimitive &primitive : primitives)
+	{
+		if (primitive.mesh == nullptr || !primitive.mesh->isVisible())
+		{
+			continue;
+		}
+
+		AdvancedOutline outline;
+
+		if (primitive.sceneElement >= 0)
+		{
+			outline = currentScene->getElement(primitive.sceneElement)->getAdvancedOutline();
+		}
+
+		exporter.addMesh(primitive.mesh, primitive.mModel, outline.color, outline.enabled ? outline.thickness : 0.f);
+	}
+
+	exporter.extract(mView, mProjection, viewportWidth, viewportHeight, depth);
+
+	for (unsigned int i = 0; i < primitives.size(); i++)
+	{
+		if (primitives[i].mesh != nullptr)
+		{
+			primitives[i].mesh->setLOD(levelsOfDetail[i]);
+		}
+	}
+
+	// - Formato segn la extensin
+	bool pdf = path.size() >= 4 && path.compare(path.size() - 4, 4, ".pdf") == 0;
+	bool saved = pdf ? exporter.writePDF(path) : exporter.writeSVG(path);
+
+	if (saved)
+	{
+		std::cout << "Line art exported: " << path << " (" << exporter.getNumPolylines() << " polylines)" << std::endl;
+	}
+
+	return saved;
 }
\ No newline at end of file
@@ -1,21 +1,33 @@
 #pragma once
 
+#include <algorithm>
 #include <cstdlib>
 #include <string>
 #include <iostream>
+#include <limits>
 #include <GL/glew.h>
 
 #include "ShaderProgram.h"
+#include "ShaderPermutations.h"
 #include "Camera.h"
 #include "Plane.h"
 #include "Group3D.h"
+#include "BVH.h"
+#include "SceneStore.h"
+#include "OcclusionCuller.h"
+#include "SilhouetteExtractor.h"
+#include "TransformCache.h"
+#include "OverdrawCounter.h"
+#include "ResidencyManager.h"
 #include "LightSource.h"
 
 #include "Model.h"
+#include "InstancedModel.h"
 #include "Cubemap.h"
 #include "Quad.h"
 
 #include "FBO.h"
+#include "GBuffer.h"
 
 // - GUI
 #include "imgui.h"
@@ -56,6 +68,7 @@ private:
 	Model *island;
 	Model *statue;
 	Model *treasure;
+	InstancedModel *scatteredTreasures;
 
 	// - Escenas 3D (plano)
 	Plane *plane;
@@ -74,6 +87,14 @@ private:
 	bool loadedScene2;
 	bool loadedScene3;
 
+	// - Escena pedida cuyos modelos se estn leyendo en segundo plano (-1 si ninguna)
+	int pendingScene;
+
+	// - Residencia: medir la memoria de las escenas cargadas y respetar el presupuesto, y descargar
+	//   una escena
+	void updateResidency();
+	void unloadScene(unsigned int scene);
+
 	// - Iluminacin
 	std::vector<LightSource*> lights;
 	int numberOfLightsEnabled;
@@ -96,19 +117,29 @@ private:
 	// - Quad (rendering a textura)
 	Quad *quad;
 
-	// - Rendering: Shader programs (modelos 3D y skyboxes)
-	ShaderProgram realisticShader;
+	// - Rendering: Shader programs (modelos 3D y skyboxes). Los de los modelos son conjuntos de
+	//   permutaciones: una variante por tipo de fuente luminosa, normal e instanciada
+	ShaderPermutations realisticShaders;
 	ShaderProgram realisticSkyboxShader;
 
-	ShaderProgram monochromeShader;
+	ShaderPermutations monochromeShaders;
 
-	ShaderProgram celShadingShader;
+	ShaderPermutations celShadingShaders;
 	ShaderProgram celShadingSkyboxShader;
 
-	ShaderProgram hatchingShader;
+	ShaderPermutations hatchingShaders;
 	ShaderProgram hatchingSkyboxShader;
 
-	ShaderProgram goochShadingShader;
+	ShaderPermutations goochShadingShaders;
+
+	// - Iluminacin de las tcnicas: una pasada por fuente luminosa (sombreado directo) o sombreado
+	//   diferido sobre el G-buffer
+	void forwardShading(ShaderPermutations &shaders, ElementDrawPass pass);
+	void deferredShading(unsigned int technique, ElementDrawPass pass);
+	void drawDeferredLight(ShaderProgram &shader, const glm::mat4 &mInverseProjection);
+
+	// - Flag para saber si la escena actual tiene modelos instanciados
+	bool sceneHasInstances;
 
 	// - Rendering: Tcnicas (modelos 3D)
 	void realistic();
@@ -145,18 +176,100 @@ private:
 	bool enabledPainterly;
 	bool enabledCharcoal;
 
+	// - Compilacin bajo demanda: tcnica que se est dibujando (la seleccionada se dibuja cuando
+	//   sus shader programs estn listos) y peticin de los shader programs de una tcnica o pasada
+	std::string activeRenderingMode;
+	bool compilingTechnique;
+	bool requestTechnique(const std::string &mode, bool wait);
+	bool requestShaderPrograms(const std::vector<ShaderProgram*> &shaders, bool wait);
+	bool requestLightPermutations(ShaderPermutations &permutations, bool wait);
+
 	// - Rendering: Shader programs (contornos)
 	ShaderProgram basicOutlineShader;
 	ShaderProgram advancedOutlineShader;
+	ShaderProgram basicOutlineInstancedShader;
+	ShaderProgram advancedOutlineInstancedShader;
+	ShaderProgram edgePrepassShader;
+	ShaderProgram edgePrepassInstancedShader;
+	ShaderProgram screenSpaceOutlineShader;
 
 	// - Rendering: Contornos
 	void basicOutline();
 	void advancedOutline();
 
+	// - Siluetas del contorno avanzado con un compute shader y dibujado indirecto (si el driver lo
+	//   admite; si no, o desactivado, se usa el geometry shader)
+	bool enabledComputeSilhouettes;
+	SilhouetteExtractor *silhouetteExtractor;
+
+	// - Contorno en espacio de pantalla: sustituye a los contornos bsico y avanzado de todos los
+	//   elementos por una pasada a pantalla completa que busca discontinuidades de profundidad, normal
+	//   y elemento (coste fijo por pxel en lugar de por tringulo). Lee el G-buffer con el sombreado
+	//   diferido o, con el directo, una pre-pasada en su FBO (identificador, normal y profundidad)
+	bool enabledScreenSpaceOutline;
+	ScreenSpaceOutline screenSpaceOutlineSettings;
+	FBO *fboOutline;
+	void screenSpaceOutline(bool deferred);
+
+	// - Aristas caractersticas (pliegues, costuras, cambios de material y fronteras): ndices de
+	//   GL_LINES extrados al cargar cada modelo, que un geometry shader convierte en quads del grosor
+	//   indicado en pxeles. Al cambiar los tipos de arista o el ngulo, los modelos las vuelven a
+	//   extraer en segundo plano
+	FeatureEdgeSettings featureEdgeSettings;
+	ShaderProgram featureEdgesShader;
+	void featureEdges();
+
+	// - Frustum culling (activacin y contadores del ltimo frame)
+	bool enabledFrustumCulling;
+	CullingStatistics cullingStatistics;
+	void updateVisibility();
+
+	// - Jerarqua de volmenes envolventes de la escena actual (culling, seleccin y ordenacin)
+	BVH sceneBVH;
+	bool enabledBVH;
+
+	// - Almacn de la escena actual (elementos y matrices del frame en arrays contiguos, orden de dibujado)
+	SceneStore sceneStore;
+
+	// - Cach de transformaciones: vrtices de las mallas visibles en el espacio de visin, una vez
+	//   por frame para todas las pasadas
+	void transformVertices();
+
+	// - Niveles de detalle (seleccin segn el tamao en pantalla y contadores del ltimo frame)
+	bool enabledLOD;
+	unsigned int lodMeshes[Mesh::MAX_LODS];
+	unsigned int lodTriangles;
+	void updateLevelsOfDetail();
+
+	// - Pre-pasada de profundidad (las pasadas de sombreado usan GL_EQUAL sin escribir profundidad)
+	bool enabledDepthPrepass;
+	ShaderProgram depthPrepassShader;
+	ShaderProgram depthPrepassInstancedShader;
+	std::vector<unsigned int> depthPrepassOrder;
+	void depthPrepass();
+
+	// - Occlusion culling (consultas de oclusin sobre la profundidad de la pre-pasada)
+	bool enabledOcclusionCulling;
+	OcclusionCuller *occlusionCuller;
+
+	// - Fragmentos sombreados y sobredibujado
+	OverdrawCounter *overdrawCounter;
+
+	// - Inicio y fin de una pasada de sombreado (test de profundidad y contador de fragmentos)
+	void beginShading();
+	void endShading();
+
 	// - FBO (rendering a textura y captura de pantalla)
 	FBO *fbo;
 	FBO *fboScreenshot;
 
+	// - Sombreado diferido: G-buffer y shader programs de la pasada de geometra (permutaciones por
+	//   tcnica) y de las fuentes luminosas (por tcnica y tipo de fuente)
+	bool enabledDeferredShading;
+	GBuffer *gBuffer;
+	ShaderPermutations gBufferShaders;
+	ShaderPermutations deferredShaders;
+
 	// - GUI (control sobre la ventana principal)
 	bool enabledMainWindowGUI;
 	bool enabledScroll;
@@ -185,6 +298,12 @@ private:
 	unsigned int screenshotCounter;
 	std::string screenshotName;
 
+	// - Exportacin de lneas (parmetros, contador, nombre del ltimo archivo y flag de xito)
+	LineArtSettings lineArtSettings;
+	unsigned int lineArtCounter;
+	std::string lineArtName;
+	bool lineArtExported;
+
 	// - Captura de pantalla (control sobre tipo de tcnica utilizada, para utilizar tamao de ventana)
 	bool enabledPostProcessing;
 
@@ -211,17 +330,36 @@ public:
 	// - Rendering (renderizar escena)
 	void render();
 
-	// - Rendering (activar modo de rendering y desactivar todos los modos de rendering)
-	void setRenderingMode(std::string mode);
+	// - Rendering (activar modo de rendering y desactivar todos los modos de rendering). Si los shader
+	//   programs del modo an se estn compilando, se sigue dibujando el anterior salvo con wait
+	void setRenderingMode(std::string mode, bool wait = false);
 	void resetAllRenderingModes();
 
 	// - Preparar escena
 	void setupScene(unsigned int scene);
 
+	// - Pedir una escena (si se descarg, se cambia a ella cuando se hayan ledo sus modelos)
+	void requestScene(unsigned int scene);
+
+	// - Seleccionar el elemento de la escena actual bajo un punto del viewport (coordenadas
+	//   normalizadas en [-1, 1]). Devuelve true si se ha seleccionado algn elemento
+	bool selectElementAt(float x, float y);
+
+	// - Medir la BVH sobre la escena 2 (habitacin y frutero)
+	void benchmarkBVH(unsigned int iterations);
+
 	// - Contornos (Activar/desactivar dibujado)
 	void toggleBasicOutline();
 	void toggleAdvancedOutline();
 
+	// - Contornos (activar/desactivar en todos los elementos de la escena actual)
+	void setOutlines(bool basicOutlineEnabled, bool advancedOutlineEnabled);
+
+	// - Siluetas del contorno avanzado con compute shader (activar y saber si el driver lo admite).
+	//   setComputeSilhouettes devuelve false si no se admite
+	bool setComputeSilhouettes(bool enabled);
+	bool isComputeSilhouetteSupported();
+
 	// - Cmara (asignar posicin y aspect ratio)
 	void setCameraPosition(glm::vec3 position);
 	void setCameraAspect(int width, int height);
@@ -250,4 +388,8 @@ public:
 	// - Captura de pantalla (asignar dimensiones, capturar pantalla)
 	void setScreenshotDimensions(unsigned int width, unsigned int height);
 	void takeScreenshot();
+
+	// - Exportar las lneas visibles (silueta, pliegues y fronteras) de la vista actual como SVG o
+	//   PDF, segn la extensin del archivo
+	bool exportLineArt(const std::string &path);
 };
\ No newline at end of file
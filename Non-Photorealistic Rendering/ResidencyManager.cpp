@@ -0,0 +1,265 @@
+#include "ResidencyManager.h"
+#include "Model.h"
+
+#include <chrono>
+
+// - Singleton (inicializacin perezosa)
+ResidencyManager* ResidencyManager::instance = nullptr;
+
+// - Constructor
+ResidencyManager::ResidencyManager()
+{
+	loadingAsset = -1;
+	frame = 0;
+
+	gpuBudget = DEFAULT_GPU_BUDGET_MB * 1024 * 1024;
+	hostBudget = DEFAULT_HOST_BUDGET_MB * 1024 * 1024;
+}
+
+// - Destructor: esperar a las lecturas pendientes y liberar las que no se han recogido
+ResidencyManager::~ResidencyManager()
+{
+	for (auto &import : imports)
+	{
+		delete import.second.get();
+	}
+	imports.clear();
+}
+
+// - Acceder al singleton
+ResidencyManager* ResidencyManager::getInstance()
+{
+	if (instance == nullptr)
+	{
+		instance = new ResidencyManager();
+	}
+
+	return instance;
+}
+
+// - Registrar un recurso
+unsigned int ResidencyManager::registerAsset(const std::string &name)
+{
+	assets.push_back(ResidentAsset(name));
+
+	return (unsigned int) assets.size() - 1;
+}
+
+// - Asignar presupuestos de memoria
+void ResidencyManager::setBudget(size_t gpuBytes, size_t hostBytes)
+{
+	gpuBudget = gpuBytes;
+	hostBudget = hostBytes;
+}
+
+// - Obtener presupuesto de GPU
+size_t ResidencyManager::getGPUBudget()
+{
+	return gpuBudget;
+}
+
+// - Obtener presupuesto de CPU
+size_t ResidencyManager::getHostBudget()
+{
+	return hostBudget;
+}
+
+// - Empezar la carga de un recurso: se vuelven a registrar sus modelos
+void ResidencyManager::beginLoad(unsigned int asset)
+{
+	loadingAsset = (int) asset;
+	assets[asset].modelPaths.clear();
+}
+
+// - Registrar un modelo del recurso que se est cargando
+void ResidencyManager::recordModel(const std::string &path)
+{
+	if (loadingAsset >= 0)
+	{
+		assets[loadingAsset].modelPaths.push_back(path);
+	}
+}
+
+// - Terminar la carga de un recurso
+void ResidencyManager::endLoad()
+{
+	if (loadingAsset >= 0)
+	{
+		assets[loadingAsset].state = ASSET_RESIDENT;
+		assets[loadingAsset].texturesReleased = false;
+		loadingAsset = -1;
+	}
+}
+
+// - Asignar la memoria medida de un recurso
+void ResidencyManager::setUsage(unsigned int asset, const MemoryUsage &usage)
+{
+	assets[asset].usage = usage;
+}
+
+// - Asignar la memoria compartida por todas las escenas
+void ResidencyManager::setSharedUsage(const MemoryUsage &usage)
+{
+	sharedUsage = usage;
+}
+
+// - Memoria de los recursos residentes y compartida
+MemoryUsage ResidencyManager::getTotalUsage()
+{
+	MemoryUsage total = sharedUsage;
+
+	for (unsigned int i = 0; i < assets.size(); i++)
+	{
+		if (assets[i].state == ASSET_RESIDENT)
+		{
+			total.gpuBytes += assets[i].usage.gpuBytes;
+			total.hostBytes += assets[i].usage.hostBytes;
+		}
+	}
+
+	return total;
+}
+
+// - Saber si se supera el presupuesto de GPU
+bool ResidencyManager::isOverGPUBudget()
+{
+	return getTotalUsage().gpuBytes > gpuBudget;
+}
+
+// - Saber si se supera el presupuesto de CPU
+bool ResidencyManager::isOverHostBudget()
+{
+	return getTotalUsage().hostBytes > hostBudget;
+}
+
+// - Empezar un frame
+void ResidencyManager::beginFrame()
+{
+	frame++;
+}
+
+// - Marcar un recurso como usado en el frame actual
+void ResidencyManager::touch(unsigned int asset)
+{
+	assets[asset].lastUsedFrame = frame;
+}
+
+// - Obtener frame actual
+unsigned int ResidencyManager::getFrame()
+{
+	return frame;
+}
+
+// - Buscar el recurso residente usado hace ms tiempo
+int ResidencyManager::findEvictionCandidate(int excluded, bool textures)
+{
+	int candidate = -1;
+
+	for (unsigned int i = 0; i < assets.size(); i++)
+	{
+		if ((int) i == excluded || assets[i].state != ASSET_RESIDENT || (textures && assets[i].texturesReleased))
+		{
+			continue;
+		}
+
+		if (candidate < 0 || assets[i].lastUsedFrame < assets[candidate].lastUsedFrame)
+		{
+			candidate = (int) i;
+		}
+	}
+
+	return candidate;
+}
+
+// - Marcar las imgenes de las texturas de un recurso como liberadas
+void ResidencyManager::markTexturesReleased(unsigned int asset)
+{
+	assets[asset].texturesReleased = true;
+}
+
+// - Marcar un recurso como descargado
+void ResidencyManager::markEvicted(unsigned int asset)
+{
+	assets[asset].state = ASSET_EVICTED;
+	assets[asset].usage = MemoryUsage();
+}
+
+// - Leer en segundo plano los modelos de un recurso descargado (uno por hilo). Devuelve false si no
+//   hay nada que leer (recurso nunca cargado o ya residente)
+bool ResidencyManager::prefetch(unsigned int asset)
+{
+	ResidentAsset &resident = assets[asset];
+
+	if (resident.state == ASSET_LOADING)
+	{
+		return true;
+	}
+
+	if (resident.state != ASSET_EVICTED || resident.modelPaths.empty())
+	{
+		return false;
+	}
+
+	for (const std::string &path : resident.modelPaths)
+	{
+		if (imports.find(path) == imports.end())
+		{
+			imports[path] = std::async(std::launch::async, [path]()
+			{
+				Assimp::Importer *importer = new Assimp::Importer();
+				Model::importFile(*importer, path);
+
+				return importer;
+			});
+		}
+	}
+
+	resident.state = ASSET_LOADING;
+
+	return true;
+}
+
+// - Saber si han terminado las lecturas de los modelos de un recurso
+bool ResidencyManager::isPrefetched(unsigned int asset)
+{
+	for (const std::string &path : assets[asset].modelPaths)
+	{
+		auto import = imports.find(path);
+
+		if (import != imports.end() &&
+			import->second.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// - Recoger la lectura en segundo plano de un modelo (el importador pasa a ser de quien lo recoge)
+Assimp::Importer* ResidencyManager::takeImport(const std::string &path)
+{
+	auto import = imports.find(path);
+
+	if (import == imports.end())
+	{
+		return nullptr;
+	}
+
+	Assimp::Importer *importer = import->second.get();
+	imports.erase(import);
+
+	return importer;
+}
+
+// - Obtener un recurso
+const ResidentAsset& ResidencyManager::getAsset(unsigned int asset)
+{
+	return assets[asset];
+}
+
+// - Obtener nmero de recursos
+unsigned int ResidencyManager::getNumAssets()
+{
+	return (unsigned int) assets.size();
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <future>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <assimp/Importer.hpp>
+
+#include "Enumerations.h"
+#include "Structures.h"
+
+// - Recurso gestionado (escena): estado, memoria medida al cargarlo, ltimo frame en que se us y
+//   modelos que lo forman (para volver a leerlos en segundo plano si se descarga)
+struct ResidentAsset
+{
+	std::string name;
+	ResidencyState state;
+	MemoryUsage usage;
+	unsigned int lastUsedFrame;
+	bool texturesReleased;
+	std::vector<std::string> modelPaths;
+
+	ResidentAsset(std::string name)
+	{
+		this->name = name;
+		this->state = ASSET_EVICTED;
+		this->lastUsedFrame = 0;
+		this->texturesReleased = false;
+	}
+};
+
+// - La clase ResidencyManager mantiene la memoria de las escenas cargadas dentro de un presupuesto de
+//   GPU y de CPU. Al superarlo, primero se liberan las imgenes decodificadas de las texturas de las
+//   escenas usadas hace ms tiempo (LRU) y, si no basta, se descargan esas escenas. Los modelos de una
+//   escena descargada se vuelven a leer con Assimp en hilos de fondo cuando se pide; la subida a la GPU
+//   se hace despus en el hilo principal (el contexto OpenGL es de ese hilo). Se implementa como un
+//   singleton para que lo usen Model y Renderer
+class ResidencyManager
+{
+private:
+	// - Singleton
+	static ResidencyManager* instance;
+
+	// - Constructor privado (singleton)
+	ResidencyManager();
+
+	// - Recursos, recurso que se est cargando (-1 si ninguno) y frame actual
+	std::vector<ResidentAsset> assets;
+	int loadingAsset;
+	unsigned int frame;
+
+	// - Presupuestos (bytes) y memoria compartida por todas las escenas (skybox)
+	size_t gpuBudget;
+	size_t hostBudget;
+	MemoryUsage sharedUsage;
+
+	// - Lecturas de modelos en segundo plano, por ruta
+	std::map<std::string, std::future<Assimp::Importer*>> imports;
+
+public:
+	// - Presupuestos por defecto (MB)
+	static const size_t DEFAULT_GPU_BUDGET_MB = 1024;
+	static const size_t DEFAULT_HOST_BUDGET_MB = 2048;
+
+	// - Acceder al singleton
+	static ResidencyManager* getInstance();
+
+	// - Destructor
+	~ResidencyManager();
+
+	// - Registrar un recurso. Devuelve su posicin
+	unsigned int registerAsset(const std::string &name);
+
+	// - Presupuestos de memoria (bytes)
+	void setBudget(size_t gpuBytes, size_t hostBytes);
+	size_t getGPUBudget();
+	size_t getHostBudget();
+
+	// - Carga de un recurso: los modelos que se cargan entre beginLoad y endLoad quedan asociados a l
+	void beginLoad(unsigned int asset);
+	void recordModel(const std::string &path);
+	void endLoad();
+
+	// - Memoria medida de un recurso y memoria compartida
+	void setUsage(unsigned int asset, const MemoryUsage &usage);
+	void setSharedUsage(const MemoryUsage &usage);
+	MemoryUsage getTotalUsage();
+	bool isOverGPUBudget();
+	bool isOverHostBudget();
+
+	// - Uso por frame (LRU)
+	void beginFrame();
+	void touch(unsigned int asset);
+	unsigned int getFrame();
+
+	// - Recurso residente usado hace ms tiempo, sin contar excluded (-1 para no excluir ninguno). Si
+	//   textures es true, slo los que an tienen las imgenes de sus texturas. Devuelve -1 si no hay
+	int findEvictionCandidate(int excluded, bool textures);
+	void markTexturesReleased(unsigned int asset);
+	void markEvicted(unsigned int asset);
+
+	// - Recarga en segundo plano: leer los modelos de un recurso descargado, saber si han terminado
+	//   y recoger la lectura de un modelo (nullptr si no se ha ledo en segundo plano)
+	bool prefetch(unsigned int asset);
+	bool isPrefetched(unsigned int asset);
+	Assimp::Importer* takeImport(const std::string &path);
+
+	// - Recursos (GUI)
+	const ResidentAsset& getAsset(unsigned int asset);
+	unsigned int getNumAssets();
+};
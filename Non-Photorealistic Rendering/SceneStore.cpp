@@ -0,0 +1,266 @@
+#include "SceneStore.h"
+
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+#include <xmmintrin.h>
+#define SCENE_STORE_SSE
+#endif
+
+// - Constructor
+SceneStore::SceneStore()
+{
+	scene = nullptr;
+	transformVersion = 0;
+}
+
+// - Mtodo privado: aadir un elemento. Los grupos no se dibujan, slo sus elementos
+void SceneStore::collect(Element3D *element, const glm::mat4 &mModel)
+{
+	Group3D *group = dynamic_cast<Group3D*>(element);
+
+	if (group != nullptr)
+	{
+		for (int i = 0; i < group->getNumElements(); i++)
+		{
+			collect(group->getElement(i), mModel * group->getElement(i)->getModelMatrix());
+		}
+
+		return;
+	}
+
+	elementIndices.insert(std::make_pair(element, (unsigned int) elements.size()));
+	elements.push_back(element);
+	world.push_back(mModel);
+	textures.push_back(element->getSortTexture());
+	vertexArrays.push_back(element->getSortVertexArray());
+}
+
+// - Construir el almacn
+void SceneStore::build(Group3D *scene)
+{
+	this->scene = scene;
+	transformVersion = Element3D::getTransformVersion();
+
+	elements.clear();
+	elementIndices.clear();
+	world.clear();
+	textures.clear();
+	vertexArrays.clear();
+
+	if (scene != nullptr)
+	{
+		collect(scene, scene->getModelMatrix());
+	}
+
+	modelView.resize(elements.size());
+	mvp.resize(elements.size());
+	depths.resize(elements.size());
+
+	// - Las matrices del frame se calculan en la siguiente actualizacin
+	view = glm::mat4(0.f);
+	projection = glm::mat4(0.f);
+}
+
+// - Calcular las matrices del frame: modelado-visin y MVP de todos los elementos en dos lotes. La
+//   profundidad de cada elemento es la de su origen en el espacio de visin, normalizada con la del
+//   ms lejano
+void SceneStore::update(const glm::mat4 &view, const glm::mat4 &projection)
+{
+	if (transformVersion != Element3D::getTransformVersion())
+	{
+		build(scene);
+	}
+
+	this->view = view;
+	this->projection = projection;
+
+	if (elements.empty())
+	{
+		return;
+	}
+
+	multiplyMatrices(view, world.data(), modelView.data(), elements.size());
+	multiplyMatrices(projection, modelView.data(), mvp.data(), elements.size());
+
+	float maxDepth = 0.f;
+
+	for (unsigned int i = 0; i < elements.size(); i++)
+	{
+		depths[i] = -modelView[i][3][2];
+		maxDepth = std::max(maxDepth, depths[i]);
+	}
+
+	for (unsigned int i = 0; i < elements.size(); i++)
+	{
+		depths[i] = maxDepth > 0.f ? depths[i] / maxDepth : 0.f;
+	}
+}
+
+// - Dibujar los elementos con una pasada. Si la cmara ha cambiado desde la ltima actualizacin
+//   (p. ej. captura de pantalla con otra proporcin), las matrices se vuelven a calcular
+void SceneStore::draw(ShaderProgram &shader, ElementDrawPass pass, const glm::mat4 &view, const glm::mat4 &projection)
+{
+	if (view != this->view || projection != this->projection || transformVersion != Element3D::getTransformVersion())
+	{
+		update(view, projection);
+	}
+
+	// - Cola de la pasada: elementos que se dibujan, ordenados por clave. La cach de transformaciones
+	//   incluye los elementos que slo son visibles para los contornos
+	bool outline = (pass == PASS_BASIC_OUTLINE || pass == PASS_ADVANCED_OUTLINE || pass == PASS_TRANSFORM_CACHE);
+	queue.clear();
+
+	for (unsigned int index = 0; index < elements.size(); index++)
+	{
+		Element3D *element = elements[index];
+
+		// - Frustum culling (los contornos desplazan los vrtices y tienen su propia visibilidad)
+		if (outline ? !element->isOutlineVisible() : !element->isVisible())
+		{
+			continue;
+		}
+
+		if ((pass == PASS_BASIC_OUTLINE && !element->getBasicOutline().enabled) ||
+			(pass == PASS_ADVANCED_OUTLINE && !element->getAdvancedOutline().enabled))
+		{
+			continue;
+		}
+
+		// - Variante del shader (instanciada o no) con la que se dibuja el elemento
+		if (!element->acceptsShader(shader))
+		{
+			continue;
+		}
+
+		queue.add(RenderQueue::makeKey(pass, shader.getHandler(), textures[index], vertexArrays[index], depths[index]), index);
+	}
+
+	queue.sort();
+
+	for (unsigned int i = 0; i < queue.getNumItems(); i++)
+	{
+		unsigned int index = queue.getItem(i).index;
+		Element3D *element = elements[index];
+
+		element->setFrameMatrices(&modelView[index], &mvp[index]);
+
+		switch (pass)
+		{
+			case PASS_REALISTIC:
+				element->drawRealistic(shader, world[index], view, projection);
+				break;
+
+			case PASS_MONOCHROME:
+				element->drawMonochrome(shader, world[index], view, projection);
+				break;
+
+			case PASS_CEL_SHADING:
+				element->drawCelShading(shader, world[index], view, projection);
+				break;
+
+			case PASS_HATCHING:
+				element->drawHatching(shader, world[index], view, projection);
+				break;
+
+			case PASS_GOOCH_SHADING:
+				element->drawGoochShading(shader, world[index], view, projection);
+				break;
+
+			case PASS_DEPTH:
+				element->drawDepth(shader, world[index], view, projection);
+				break;
+
+			case PASS_BASIC_OUTLINE:
+				element->drawBasicOutline(shader, world[index], view, projection);
+				break;
+
+			case PASS_ADVANCED_OUTLINE:
+				element->drawAdvancedOutline(shader, world[index], view, projection);
+				break;
+
+			case PASS_NORMALS:
+				// - Identificador del elemento (el contorno en espacio de pantalla separa elementos que
+				//   se tocan a la misma profundidad)
+				shader.setUniform("elementId", (GLint) (index + 1));
+				element->drawNormals(shader, world[index], view, projection);
+				break;
+
+			case PASS_FEATURE_EDGES:
+				element->drawFeatureEdges(shader, world[index], view, projection);
+				break;
+
+			case PASS_TRANSFORM_CACHE:
+				element->captureTransform(shader, world[index], view);
+				break;
+		}
+
+		element->setFrameMatrices(nullptr, nullptr);
+	}
+}
+
+// - Obtener las matrices del frame de un elemento. Si la cmara ha cambiado, se vuelven a calcular
+//   igual que al dibujar una pasada
+bool SceneStore::getFrameMatrices(Element3D *element, const glm::mat4 &mModel, const glm::mat4 &view,
+								  const glm::mat4 &projection, const glm::mat4 *&modelView, const glm::mat4 *&mvp)
+{
+	if (view != this->view || projection != this->projection || transformVersion != Element3D::getTransformVersion())
+	{
+		update(view, projection);
+	}
+
+	auto range = elementIndices.equal_range(element);
+
+	for (auto entry = range.first; entry != range.second; ++entry)
+	{
+		if (world[entry->second] == mModel)
+		{
+			modelView = &this->modelView[entry->second];
+			mvp = &this->mvp[entry->second];
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// - Obtener nmero de elementos
+unsigned int SceneStore::getNumElements()
+{
+	return (unsigned int) elements.size();
+}
+
+// - Multiplicar una matriz por un array de matrices. Las matrices de GLM se guardan por columnas:
+//   cada columna del resultado es la combinacin de las columnas de left con los coeficientes de
+//   la columna de right, que con SSE son cuatro multiplicaciones y sumas de 4 floats
+void SceneStore::multiplyMatrices(const glm::mat4 &left, const glm::mat4 *right, glm::mat4 *result, size_t count)
+{
+#ifdef SCENE_STORE_SSE
+	__m128 column0 = _mm_loadu_ps(&left[0][0]);
+	__m128 column1 = _mm_loadu_ps(&left[1][0]);
+	__m128 column2 = _mm_loadu_ps(&left[2][0]);
+	__m128 column3 = _mm_loadu_ps(&left[3][0]);
+
+	for (size_t i = 0; i < count; i++)
+	{
+		const float *source = &right[i][0][0];
+		float *destination = &result[i][0][0];
+
+		for (int j = 0; j < 4; j++)
+		{
+			__m128 value = _mm_mul_ps(column0, _mm_set1_ps(source[4 * j]));
+			value = _mm_add_ps(value, _mm_mul_ps(column1, _mm_set1_ps(source[4 * j + 1])));
+			value = _mm_add_ps(value, _mm_mul_ps(column2, _mm_set1_ps(source[4 * j + 2])));
+			value = _mm_add_ps(value, _mm_mul_ps(column3, _mm_set1_ps(source[4 * j + 3])));
+
+			_mm_storeu_ps(destination + 4 * j, value);
+		}
+	}
+#else
+	for (size_t i = 0; i < count; i++)
+	{
+		result[i] = left * right[i];
+	}
+#endif
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm.hpp>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "Enumerations.h"
+#include "Element3D.h"
+#include "Group3D.h"
+#include "ShaderProgram.h"
+#include "RenderQueue.h"
+
+// - La clase SceneStore guarda los elementos de la escena (recorriendo los grupos) en arrays
+//   contiguos: elemento, matriz de mundo, matrices de modelado-visin y MVP, textura, VAO y
+//   profundidad. Las matrices del frame se calculan en un solo lote (SSE) al empezar el frame, en
+//   lugar de multiplicarlas en cada elemento y en cada pasada, y cada pasada dibuja sus elementos
+//   desde una cola ordenada por clave (pasada, shader, textura, VAO y profundidad) para agrupar los
+//   cambios de estado. Element3D sigue siendo la fachada con la que se dibuja cada elemento: el
+//   almacn le pasa sus matrices antes de llamar a la funcin de dibujado de la pasada
+class SceneStore
+{
+private:
+	// - Escena y contador de cambios de matrices de modelado con el que se construy
+	Group3D *scene;
+	unsigned int transformVersion;
+
+	// - Elementos (hojas de la escena), matrices, estado con el que se ordenan (textura y VAO) y
+	//   profundidad normalizada en el frame
+	std::vector<Element3D*> elements;
+	std::vector<glm::mat4> world;
+	std::vector<glm::mat4> modelView;
+	std::vector<glm::mat4> mvp;
+	std::vector<GLuint> textures;
+	std::vector<GLuint> vertexArrays;
+	std::vector<float> depths;
+
+	// - Posiciones de cada elemento en los arrays (un elemento puede estar varias veces en la escena)
+	std::unordered_multimap<Element3D*, unsigned int> elementIndices;
+
+	// - Cola de la pasada que se est dibujando
+	RenderQueue queue;
+
+	// - Matrices de visin y proyeccin con las que se calcularon las del frame
+	glm::mat4 view;
+	glm::mat4 projection;
+
+	// - Aadir un elemento (o los elementos de un grupo) con la matriz de modelado acumulada
+	void collect(Element3D *element, const glm::mat4 &mModel);
+
+public:
+	// - Constructor
+	SceneStore();
+
+	// - Construir el almacn a partir de la escena
+	void build(Group3D *scene);
+
+	// - Calcular las matrices del frame (reconstruyendo el almacn si alguna matriz de modelado ha
+	//   cambiado)
+	void update(const glm::mat4 &view, const glm::mat4 &projection);
+
+	// - Dibujar los elementos visibles que aceptan el shader con una pasada (en el orden de la cola)
+	void draw(ShaderProgram &shader, ElementDrawPass pass, const glm::mat4 &view, const glm::mat4 &projection);
+
+	// - Matrices del frame de un elemento con su matriz de modelado (mundo), para dibujarlo fuera del
+	//   almacn con las mismas matrices que las pasadas. Devuelve false si no est en el almacn
+	bool getFrameMatrices(Element3D *element, const glm::mat4 &mModel, const glm::mat4 &view, const glm::mat4 &projection,
+						  const glm::mat4 *&modelView, const glm::mat4 *&mvp);
+
+	// - Nmero de elementos
+	unsigned int getNumElements();
+
+	// - Multiplicar una matriz por un array de matrices (result[i] = left * right[i])
+	static void multiplyMatrices(const glm::mat4 &left, const glm::mat4 *right, glm::mat4 *result, size_t count);
+};
@@ -0,0 +1,66 @@
+#include "ShaderPermutations.h"
+
+// - Constructor
+ShaderPermutations::ShaderPermutations()
+{
+	flags = NO_GEOMETRY_SHADER;
+}
+
+// - Destructor
+ShaderPermutations::~ShaderPermutations()
+{
+	for (auto &program : programs)
+	{
+		delete program.second;
+	}
+
+	programs.clear();
+}
+
+// - Definir el cdigo fuente de las variantes
+void ShaderPermutations::define(const char *fileName, ShaderProgramFlags flags)
+{
+	this->fileName = fileName;
+	this->flags = flags;
+}
+
+// - Obtener una variante. La primera vez que se pide se define (se compila al pedirla con request)
+ShaderProgram* ShaderPermutations::get(unsigned int variant)
+{
+	auto it = programs.find(variant);
+
+	if (it != programs.end())
+	{
+		return it->second;
+	}
+
+	ShaderProgram *program = new ShaderProgram();
+	program->defineShaderProgram(fileName.c_str(), flags, variant);
+	programs[variant] = program;
+
+	return program;
+}
+
+// - Pedir una variante
+bool ShaderPermutations::request(unsigned int variant, bool wait)
+{
+	return get(variant)->request(wait);
+}
+
+// - Activar una variante. Si se pide una que no estaba prevista (por ejemplo, un tipo de fuente
+//   luminosa nuevo en la escena), se compila en este momento
+ShaderProgram* ShaderPermutations::use(unsigned int variant)
+{
+	ShaderProgram *program = get(variant);
+
+	program->request(true);
+	program->use();
+
+	return program;
+}
+
+// - Obtener nmero de variantes definidas
+unsigned int ShaderPermutations::getNumPrograms()
+{
+	return (unsigned int) programs.size();
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <map>
+
+#include "ShaderProgram.h"
+
+// - La clase ShaderPermutations agrupa las variantes (permutaciones) de un shader program que se
+//   generan a partir del mismo cdigo fuente: cada una se identifica por su mscara de
+//   ShaderProgramVariant (tipo de fuente luminosa, instanciada) y se compila con sus "#define" en
+//   lugar de elegir el camino en tiempo de ejecucin con subrutinas. Las variantes se definen y
+//   compilan bajo demanda, la primera vez que se piden, y su binario se guarda en la cach de
+//   binarios (la huella incluye las definiciones)
+class ShaderPermutations
+{
+private:
+	// - Archivos del shader program (nombre genrico y geometry shader opcional)
+	std::string fileName;
+	ShaderProgramFlags flags;
+
+	// - Variantes definidas, por mscara
+	std::map<unsigned int, ShaderProgram*> programs;
+
+public:
+	// - Constructor
+	ShaderPermutations();
+
+	// - Destructor
+	~ShaderPermutations();
+
+	// - Definir el cdigo fuente de las variantes (no se compila ninguna)
+	void define(const char *fileName, ShaderProgramFlags flags = NO_GEOMETRY_SHADER);
+
+	// - Obtener una variante (se define si no exista, sin compilarla)
+	ShaderProgram* get(unsigned int variant);
+
+	// - Pedir una variante (empieza su compilacin). Devuelve true cuando est lista; con wait, espera
+	//   a que termine
+	bool request(unsigned int variant, bool wait = false);
+
+	// - Activar una variante, compilndola y esperando a que termine si an no est lista
+	ShaderProgram* use(unsigned int variant);
+
+	// - Obtener nmero de variantes definidas
+	unsigned int getNumPrograms();
+};
@@ -1,4 +1,10 @@
 #include "ShaderProgram.h"
+#include "RenderStatistics.h"
+#include "GLStateCache.h"
+#include "ProgramBinaryCache.h"
+
+#include <chrono>
+#include <vector>
 
 // - Constructor
 ShaderProgram::ShaderProgram()
@@ -6,12 +12,17 @@ ShaderProgram::ShaderProgram()
 	handler = 0;
 	linked = false;
 	logString = "";
+	variant = DEFAULT_VARIANT;
+	flags = NO_GEOMETRY_SHADER;
+	status = PROGRAM_DEFERRED;
+	binaryKey = 0;
 }
 
 // - Destructor
 ShaderProgram::~ShaderProgram()
 {
 	// - Liberamos recursos en la GPU
+	GLStateCache::getInstance()->forgetProgram(handler);
 	glDeleteProgram(handler);
 	linked = false;
 	logString = "";
@@ -23,73 +34,198 @@ ShaderProgram::~ShaderProgram()
 //   shader program.
 //   (Opcionalmente) Se puede crear un Geometry Shader object usando el flag de ShaderProgramFlags,
 //   estando desactivado por defecto. Si est activado, busca entre los recursos de la aplcacin un archivo
-//   [filename]-geom.glsl y crea el shader program junto a los vertex y fragment shader objects
-GLuint ShaderProgram::createShaderProgram(const char *fileName, ShaderProgramFlags flags)
+//   [filename]-geom.glsl y crea el shader program junto a los vertex y fragment shader objects.
+//   (Opcionalmente) La variante (mscara de ShaderProgramVariant) aade sus definiciones ("#define
+//   INSTANCED", "#define POINT_LIGHT"...) tras la directiva #version de cada shader object
+GLuint ShaderProgram::createShaderProgram(const char *fileName, ShaderProgramFlags flags, unsigned int variant)
+{
+	defineShaderProgram(fileName, flags, variant);
+
+	return request(true) ? handler : 0;
+}
+
+// - Definir un shader program sin compilarlo: se compila al pedirlo por primera vez con request
+void ShaderProgram::defineShaderProgram(const char *fileName, ShaderProgramFlags flags, unsigned int variant)
 {
+	this->fileName = fileName;
+	this->flags = flags;
+	this->variant = variant;
+
+	linked = false;
+	status = PROGRAM_DEFERRED;
+}
+
+// - Pedir el shader program. Si est sin compilar, empieza su compilacin: con la extensin
+//   KHR_parallel_shader_compile (o la ARB) el driver compila y enlaza en segundo plano y las
+//   siguientes peticiones consultan GL_COMPLETION_STATUS_KHR sin bloquear; sin ella, o si wait es
+//   true, se espera al enlazado. Devuelve true si el shader program est listo para usarse
+bool ShaderProgram::request(bool wait)
+{
+	if (status == PROGRAM_DEFERRED)
+	{
+		beginLink();
+	}
+
+	if (status == PROGRAM_COMPILING)
+	{
+		GLint completed = GL_TRUE;
+
+		if (!wait && isParallelCompileSupported())
+		{
+			glGetProgramiv(handler, GL_COMPLETION_STATUS_KHR, &completed);
+		}
+
+		if (completed == GL_TRUE)
+		{
+			finishLink();
+		}
+	}
+
+	return status == PROGRAM_LINKED;
+}
+
+// - Obtener estado de la compilacin
+ShaderProgramStatus ShaderProgram::getStatus()
+{
+	return status;
+}
+
+// - Asignar las variables de salida que se capturan con transform feedback
+void ShaderProgram::setFeedbackVaryings(const std::vector<std::string> &varyings)
+{
+	feedbackVaryings = varyings;
+}
+
+// - Saber si el driver compila y enlaza en segundo plano
+bool ShaderProgram::isParallelCompileSupported()
+{
+	return GLEW_KHR_parallel_shader_compile || GLEW_ARB_parallel_shader_compile;
+}
+
+// - Mtodo privado: leer el cdigo fuente, cargar el binario de la cach si lo hay y, si no, compilar
+//   y enlazar (el resultado se comprueba en finishLink)
+void ShaderProgram::beginLink()
+{
+	// - Tiempo de creacin del programa (lectura, y carga del binario o compilacin y enlazado)
+	linkStart = std::chrono::high_resolution_clock::now();
+	status = PROGRAM_FAILED;
+	uniformLocations.clear();
+
 	// - Se crea el shader program y se almacena su identificador
 	if (handler <= 0)
 	{
 		handler = glCreateProgram();
 		if (handler == 0)
 		{
-			fprintf(stderr, "Cannot create shader program: %s.\n", fileName);
-			return 0;
+			fprintf(stderr, "Cannot create shader program: %s.\n", fileName.c_str());
+			return;
 		}
 	}
 
-	// - Se carga y compila el vertex shader object
-	char fileNameComplete[256];
-	strcpy_s(fileNameComplete, fileName);
-	strcat_s(fileNameComplete, "-vert.glsl");
-	GLuint vertexShaderObject = compileShader(fileNameComplete, GL_VERTEX_SHADER);
+	// - Se lee el cdigo fuente de los shader objects: vertex, fragment y (opcional) geometry shader, un
+	//   nico compute shader o un nico vertex shader (transform feedback)
+	const char *suffixes[] = { "-vert.glsl", "-frag.glsl", "-geom.glsl" };
+	unsigned int numShaders = (flags == COMPUTE_SHADER || flags == TRANSFORM_FEEDBACK) ? 1 : ((flags == GEOMETRY_SHADER) ? 3 : 2);
 
-	if (vertexShaderObject == 0)
+	if (flags == COMPUTE_SHADER)
 	{
-		return 0;
+		suffixes[0] = "-comp.glsl";
 	}
 
-	// - Asociar vertex shader object
-	glAttachShader(handler, vertexShaderObject);
+	std::vector<std::string> sources(numShaders);
+
+	for (unsigned int i = 0; i < numShaders; i++)
+	{
+		if (!readShaderSource((fileName + suffixes[i]).c_str(), sources[i]))
+		{
+			return;
+		}
+	}
 
-	// - Se carga y compila el fragment shader object
-	strcpy_s(fileNameComplete, fileName);
-	strcat_s(fileNameComplete, "-frag.glsl");
-	GLuint fragmentShaderObject = compileShader(fileNameComplete, GL_FRAGMENT_SHADER);
+	// - Cach de binarios: si el programa ya se enlaz con el mismo cdigo fuente y el mismo driver,
+	//   se carga su binario y no hay que compilar ni enlazar
+	ProgramBinaryCache *binaryCache = ProgramBinaryCache::getInstance();
+	binaryKey = binaryCache->computeKey(sources);
 
-	if (fragmentShaderObject == 0)
+	for (const std::string &varying : feedbackVaryings)
 	{
-		return 0;
+		binaryKey = ProgramBinaryCache::hashString(varying, binaryKey);
+	}
+
+	if (binaryCache->load(binaryKey, handler))
+	{
+		linked = true;
+		status = PROGRAM_LINKED;
+		binaryCache->registerProgram(true, std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - linkStart).count());
+		return;
 	}
 
-	// - Asociar fragment shader object
-	glAttachShader(handler, fragmentShaderObject);
+	// - Se compila cada shader object y se asocia al shader program. Los errores de compilacin se
+	//   comprueban al terminar el enlazado, para no esperar a cada shader object
+	GLenum shaderTypes[] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER, GL_GEOMETRY_SHADER };
+
+	if (flags == COMPUTE_SHADER)
+	{
+		shaderTypes[0] = GL_COMPUTE_SHADER;
+	}
+
+	for (unsigned int i = 0; i < numShaders; i++)
+	{
+		GLuint shaderObject = compileShader(sources[i], shaderTypes[i]);
+
+		// - Si falla un shader object se liberan los que ya estaban asociados al programa
+		if (shaderObject == 0)
+		{
+			for (unsigned int j = 0; j < shaderObjects.size(); j++)
+			{
+				glDetachShader(handler, shaderObjects[j]);
+				glDeleteShader(shaderObjects[j]);
+			}
+
+			shaderObjects.clear();
+			shaderObjectTypes.clear();
+			return;
+		}
+
+		glAttachShader(handler, shaderObject);
+		shaderObjects.push_back(shaderObject);
+		shaderObjectTypes.push_back(shaderTypes[i]);
+	}
 
-	// - Opcional: Se crea el Geometry Shader object, si el flag est activo, y se asocia al shader program
-	//   si la compilacin fue exitosa
-	if (flags == GEOMETRY_SHADER)
+	// - Transform feedback: las variables capturadas se asignan antes de enlazar
+	if (!feedbackVaryings.empty())
 	{
-		// - Se carga y compila el geometry shader object
-		strcpy_s(fileNameComplete, fileName);
-		strcat_s(fileNameComplete, "-geom.glsl");
-		GLuint geometryShaderObject = compileShader(fileNameComplete, GL_GEOMETRY_SHADER);
+		std::vector<const char*> varyings;
 
-		if (geometryShaderObject == 0)
+		for (const std::string &varying : feedbackVaryings)
 		{
-			return 0;
+			varyings.push_back(varying.c_str());
 		}
 
-		// - Asociar geometry shader object
-		glAttachShader(handler, geometryShaderObject);
+		glTransformFeedbackVaryings(handler, (GLsizei) varyings.size(), varyings.data(), GL_INTERLEAVED_ATTRIBS);
 	}
 
-	// - Se enlaza el shader program y se comprueba si hay errores
+	binaryCache->prepare(handler);
+
+	// - Se enlaza el shader program
 	glLinkProgram(handler);
+	status = PROGRAM_COMPILING;
+}
 
+// - Mtodo privado: comprobar el resultado del enlazado, guardar el binario para los siguientes
+//   arranques y liberar los shader objects (ya forman parte del programa)
+void ShaderProgram::finishLink()
+{
 	GLint linkSuccess = 0;
 	glGetProgramiv(handler, GL_LINK_STATUS, &linkSuccess);
 
 	if (linkSuccess == GL_FALSE)
 	{
+		for (unsigned int i = 0; i < shaderObjects.size(); i++)
+		{
+			checkShader(shaderObjects[i], shaderObjectTypes[i]);
+		}
+
 		GLint logLen = 0;
 		glGetProgramiv(handler, GL_INFO_LOG_LENGTH, &logLen);
 
@@ -102,13 +238,51 @@ GLuint ShaderProgram::createShaderProgram(const char *fileName, ShaderProgramFla
 			delete[] cLogString;
 			std::cout << "Cannot link shader " << fileName << std::endl << logString << std::endl;
 		}
-		return 0;
+
+		status = PROGRAM_FAILED;
 	}
 	else
 	{
 		linked = true;
+		status = PROGRAM_LINKED;
+
+		// - Guardar el binario para los siguientes arranques
+		ProgramBinaryCache *binaryCache = ProgramBinaryCache::getInstance();
+		binaryCache->store(binaryKey, handler);
+		binaryCache->registerProgram(false, std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - linkStart).count());
 	}
 
+	for (unsigned int i = 0; i < shaderObjects.size(); i++)
+	{
+		glDetachShader(handler, shaderObjects[i]);
+		glDeleteShader(shaderObjects[i]);
+	}
+
+	shaderObjects.clear();
+	shaderObjectTypes.clear();
+}
+
+// - Saber si es la variante instanciada
+bool ShaderProgram::isInstanced()
+{
+	return (variant & INSTANCED_VARIANT) != 0;
+}
+
+// - Saber si es un compute shader (se lanza con glDispatchCompute en lugar de dibujar)
+bool ShaderProgram::isCompute()
+{
+	return flags == COMPUTE_SHADER;
+}
+
+// - Obtener variante (mscara de ShaderProgramVariant)
+unsigned int ShaderProgram::getVariant()
+{
+	return variant;
+}
+
+// - Obtener identificador del shader program
+GLuint ShaderProgram::getHandler()
+{
 	return handler;
 }
 
@@ -120,7 +294,8 @@ bool ShaderProgram::use()
 	// si se ha creado bien y se ha enlazado bien
 	if ((handler > 0) && (linked)) 
 	{
-		glUseProgram(handler);
+		// - Si ya est activo, la cach de estado no vuelve a activarlo
+		GLStateCache::getInstance()->useProgram(handler);
 		return true;
 	}
 	else 
@@ -130,27 +305,55 @@ bool ShaderProgram::use()
 	}
 }
 
+// - Saber si el shader program usa un uniform (el compilador descarta los que una permutacin no usa)
+bool ShaderProgram::hasUniform(std::string name)
+{
+	return getUniformLocation(name) >= 0;
+}
+
+// - Mtodo privado: buscar la localizacin de un uniform. Las variantes eliminan los uniforms que no
+//   usan (el material que no necesita un tipo de fuente luminosa), as que una localizacin -1 no
+//   es un error: se guarda y las asignaciones de ese uniform se ignoran sin consultar al driver
+GLint ShaderProgram::getUniformLocation(const std::string &name)
+{
+	std::unordered_map<std::string, GLint>::iterator location = uniformLocations.find(name);
+
+	if (location != uniformLocations.end())
+	{
+		return location->second;
+	}
+
+	GLint value = glGetUniformLocation(handler, name.c_str());
+
+	// - Slo se guardan las localizaciones del programa enlazado
+	if (linked)
+	{
+		uniformLocations[name] = value;
+	}
+
+	return value;
+}
+
 // - Permite asignar parmetros de tipo uniform al shader (int)
 bool ShaderProgram::setUniform(std::string name, GLint value)
 {
 	// - Para asignar valor a un uniform, primero hay que buscar si en el shader
 	//   program existe alguna variable de tipo uniform cuyo nombre coincida con
 	//   el que pasamos como argumento
-	GLint location = glGetUniformLocation(handler, name.c_str());
+	GLint location = getUniformLocation(name);
 
 	// - Si location es un valor positivo, es que existe el uniform y podemos
-	//   asignarlo
+	//   asignarlo (los uniforms que la variante no usa no tienen localizacin y
+	//   no se asignan)
 	if (location >= 0) 
 	{
 		// - Aqu usamos la funcin glUniform que recibe un argumento de tipo GLint
 		glUniform1i(location, value);
+		RENDER_STATS_UNIFORM();
 		return true;
 	}
-	else 
-	{
-		std::cout << "Cannot find localization for: " << name << std::endl;
-		return false;
-	}
+
+	return false;
 }
 
 // - Permite asignar parmetros de tipo uniform al shader (float)
@@ -159,21 +362,20 @@ bool ShaderProgram::setUniform(std::string name, GLfloat value)
 	// - Para asignar valor a un uniform, primero hay que buscar si en el shader
 	//   program existe alguna variable de tipo uniform cuyo nombre coincida con
 	//   el que pasamos como argumento
-	GLint location = glGetUniformLocation(handler, name.c_str());
+	GLint location = getUniformLocation(name);
 
 	// - Si location es un valor positivo, es que existe el uniform y podemos
-	//   asignarlo
+	//   asignarlo (los uniforms que la variante no usa no tienen localizacin y
+	//   no se asignan)
 	if (location >= 0) 
 	{
 		// - Aqu usamos la funcin glUniform que recibe un argumento de tipo GLfloat
 		glUniform1f(location, value);
+		RENDER_STATS_UNIFORM();
 		return true;
 	}
-	else
-	{
-		std::cout << "Cannot find localization for: " << name << std::endl;
-		return false;
-	}
+
+	return false;
 }
 
 // - Permite asignar parmetros de tipo uniform al shader (bool)
@@ -182,21 +384,20 @@ bool ShaderProgram::setUniform(std::string name, GLboolean value)
 	// - Para asignar valor a un uniform, primero hay que buscar si en el shader
 	//   program existe alguna variable de tipo uniform cuyo nombre coincida con
 	//   el que pasamos como argumento
-	GLint location = glGetUniformLocation(handler, name.c_str());
+	GLint location = getUniformLocation(name);
 
 	// - Si location es un valor positivo, es que existe el uniform y podemos
-	//   asignarlo
+	//   asignarlo (los uniforms que la variante no usa no tienen localizacin y
+	//   no se asignan)
 	if (location >= 0)
 	{
 		// - Aqu usamos la funcin glUniform que recibe un argumento de tipo GLfloat
 		glUniform1i(location, value);
+		RENDER_STATS_UNIFORM();
 		return true;
 	}
-	else
-	{
-		std::cout << "Cannot find localization for: " << name << std::endl;
-		return false;
-	}
+
+	return false;
 }
 
 // - Permite asignar parmetros de tipo uniform al shader (mat2)
@@ -205,22 +406,21 @@ bool ShaderProgram::setUniform(std::string name, glm::mat2 value)
 	// - Para asignar valor a un uniform, primero hay que buscar si en el shader
 	//   program existe alguna variable de tipo uniform cuyo nombre coincida con
 	//   el que pasamos como argumento
-	GLint location = glGetUniformLocation(handler, name.c_str());
+	GLint location = getUniformLocation(name);
 
 	// - Si location es un valor positivo, es que existe el uniform y podemos
-	//   asignarlo
+	//   asignarlo (los uniforms que la variante no usa no tienen localizacin y
+	//   no se asignan)
 	if (location >= 0)
 	{
 		// - Aqu usamos la funcin glUniform que recibe un argumento de tipo
 		//   mat2 con valores GLfloat y expresado como un array
 		glUniformMatrix2fv(location, 1, GL_FALSE, &value[0][0]);
+		RENDER_STATS_UNIFORM();
 		return true;
 	}
-	else
-	{
-		std::cout << "Cannot find localization for: " << name << std::endl;
-		return false;
-	}
+
+	return false;
 }
 
 // - Permite asignar parmetros de tipo uniform al shader (mat3)
@@ -229,22 +429,21 @@ bool ShaderProgram::setUniform(std::string name, glm::mat3 value)
 	// - Para asignar valor a un uniform, primero hay que buscar si en el shader
 	//   program existe alguna variable de tipo uniform cuyo nombre coincida con
 	//   el que pasamos como argumento
-	GLint location = glGetUniformLocation(handler, name.c_str());
+	GLint location = getUniformLocation(name);
 
 	// - Si location es un valor positivo, es que existe el uniform y podemos
-	//   asignarlo
+	//   asignarlo (los uniforms que la variante no usa no tienen localizacin y
+	//   no se asignan)
 	if (location >= 0)
 	{
 		// - Aqu usamos la funcin glUniform que recibe un argumento de tipo
 		//   mat3 con valores GLfloat y expresado como un array
 		glUniformMatrix3fv(location, 1, GL_FALSE, &value[0][0]);
+		RENDER_STATS_UNIFORM();
 		return true;
 	}
-	else
-	{
-		std::cout << "Cannot find localization for: " << name << std::endl;
-		return false;
-	}
+
+	return false;
 }
 
 // - Permite asignar parmetros de tipo uniform al shader (mat4)
@@ -253,22 +452,21 @@ bool ShaderProgram::setUniform(std::string name, glm::mat4 value)
 	// - Para asignar valor a un uniform, primero hay que buscar si en el shader
 	//   program existe alguna variable de tipo uniform cuyo nombre coincida con
 	//   el que pasamos como argumento
-	GLint location = glGetUniformLocation(handler, name.c_str());
+	GLint location = getUniformLocation(name);
 
 	// - Si location es un valor positivo, es que existe el uniform y podemos
-	//   asignarlo
+	//   asignarlo (los uniforms que la variante no usa no tienen localizacin y
+	//   no se asignan)
 	if (location >= 0) 
 	{
 		// - Aqu usamos la funcin glUniform que recibe un argumento de tipo
 		//   mat4 con valores GLfloat y expresado como un array
 		glUniformMatrix4fv(location, 1, GL_FALSE, &value[0][0]);
+		RENDER_STATS_UNIFORM();
 		return true;
 	}
-	else 
-	{
-		std::cout << "Cannot find localization for: " << name << std::endl;
-		return false;
-	}
+
+	return false;
 }
 
 // - Permite asignar parmetros de tipo uniform al shader (vec2)
@@ -277,22 +475,21 @@ bool ShaderProgram::setUniform(std::string name, glm::vec2 value)
 	// - Para asignar valor a un uniform, primero hay que buscar si en el shader
 	//   program existe alguna variable de tipo uniform cuyo nombre coincida con
 	//   el que pasamos como argumento
-	GLint location = glGetUniformLocation(handler, name.c_str());
+	GLint location = getUniformLocation(name);
 
 	// - Si location es un valor positivo, es que existe el uniform y podemos
-	//   asignarlo
+	//   asignarlo (los uniforms que la variante no usa no tienen localizacin y
+	//   no se asignan)
 	if (location >= 0)
 	{
 		// - Aqu usamos la funcin glUniform que recibe un argumento de tipo
-		//   vec3 con valores GLfloat y expresado como un array
-		glUniform3fv(location, 1, &value[0]);
+		//   vec2 con valores GLfloat y expresado como un array
+		glUniform2fv(location, 1, &value[0]);
+		RENDER_STATS_UNIFORM();
 		return true;
 	}
-	else
-	{
-		std::cout << "Cannot find localization for: " << name << std::endl;
-		return false;
-	}
+
+	return false;
 }
 
 // - Permite asignar parmetros de tipo uniform al shader (vec3)
@@ -301,58 +498,32 @@ bool ShaderProgram::setUniform(std::string name, glm::vec3 value)
 	// - Para asignar valor a un uniform, primero hay que buscar si en el shader
 	//   program existe alguna variable de tipo uniform cuyo nombre coincida con
 	//   el que pasamos como argumento
-	GLint location = glGetUniformLocation(handler, name.c_str());
+	GLint location = getUniformLocation(name);
 
 	// - Si location es un valor positivo, es que existe el uniform y podemos
-	//   asignarlo
+	//   asignarlo (los uniforms que la variante no usa no tienen localizacin y
+	//   no se asignan)
 	if (location >= 0)
 	{
 		// - Aqu usamos la funcin glUniform que recibe un argumento de tipo
 		//   vec3 con valores GLfloat y expresado como un array
 		glUniform3fv(location, 1, &value[0]);
+		RENDER_STATS_UNIFORM();
 		return true;
 	}
-	else
-	{
-		std::cout << "Cannot find localization for: " << name << std::endl;
-		return false;
-	}
-}
-
-// - Asignar subrutina
-bool ShaderProgram::setSubroutine(std::string uniformName, std::string subroutineName,
-								  GLenum shaderType, GLsizei count)
-{
-	// - Primero hay que buscar si en el shader program existe el uniform de la subrutina
-	//   cuyo nombre coincida con el que se pasa como argumento
-	GLint location = glGetSubroutineUniformLocation(handler, shaderType, uniformName.c_str());
 
-	// - Si location es un valor positivo, es que existe la subrutina y podemos asignarlo
-	if (location >= 0)
-	{
-		// - Averiguar el identificador de la subroutine que nos interesa seleccionar para que se ejecute
-		GLuint index = glGetSubroutineIndex(handler, shaderType, subroutineName.c_str());
-
-		// - Activar la subrutina
-		glUniformSubroutinesuiv(shaderType, count, &index);
-		return true;
-	}
-	else
-	{
-		std::cout << "Cannot find localization for: " << uniformName << std::endl;
-		return false;
-	}
+	return false;
 }
 
-// - Mtodo privado que compila cada una de las partes del shader program 
-GLuint ShaderProgram::compileShader(const char *filename, GLenum shaderType)
+// - Mtodo privado que lee el cdigo fuente de una de las partes del shader program
+bool ShaderProgram::readShaderSource(const char *filename, std::string &source)
 {
 	// - Comprobamos si en la solucin existe algn archivo de recursos con el
 	//   nombre que se pasa como argumento
 	if (!fileExists(filename)) 
 	{
 		fprintf(stderr, "Shader source file %s not found.\n", filename);
-		return 0;
+		return false;
 	}
 
 	// - Si existe se lee en una cadena de caracteres que contiene el listado
@@ -363,14 +534,51 @@ GLuint ShaderProgram::compileShader(const char *filename, GLenum shaderType)
 	if (!shaderSourceFile)
 	{
 		fprintf(stderr, "Cannot open shader source file.\n");
-		return 0;
+		return false;
 	}
 
 	std::stringstream shaderSourceStream;
 	shaderSourceStream << shaderSourceFile.rdbuf();
-	std::string shaderSourceString = shaderSourceStream.str();
+	source = shaderSourceStream.str();
 	shaderSourceFile.close();
 
+	// - Definiciones de la variante: van despus de la directiva #version (primera lnea)
+	static const struct { ShaderProgramVariant bit; const char *define; } variantDefines[] =
+	{
+		{ INSTANCED_VARIANT, "#define INSTANCED\n" },
+		{ AMBIENT_LIGHT_VARIANT, "#define AMBIENT_LIGHT\n" },
+		{ POINT_LIGHT_VARIANT, "#define POINT_LIGHT\n" },
+		{ DIRECTIONAL_LIGHT_VARIANT, "#define DIRECTIONAL_LIGHT\n" },
+		{ SPOT_LIGHT_VARIANT, "#define SPOT_LIGHT\n" },
+		{ MONOCHROME_VARIANT, "#define MONOCHROME\n" },
+		{ CEL_SHADING_VARIANT, "#define CEL_SHADING\n" },
+		{ HATCHING_VARIANT, "#define HATCHING\n" },
+		{ GOOCH_SHADING_VARIANT, "#define GOOCH_SHADING\n" }
+	};
+
+	std::string defines;
+
+	for (const auto &variantDefine : variantDefines)
+	{
+		if ((variant & variantDefine.bit) != 0)
+		{
+			defines += variantDefine.define;
+		}
+	}
+
+	size_t versionEnd = source.find('\n');
+
+	if (!defines.empty() && versionEnd != std::string::npos)
+	{
+		source.insert(versionEnd + 1, defines);
+	}
+
+	return true;
+}
+
+// - Mtodo privado que compila cada una de las partes del shader program 
+GLuint ShaderProgram::compileShader(const std::string &source, GLenum shaderType)
+{
 	// - Creamos un shader object para ese archivo que se ha ledo
 	GLuint shaderHandler = glCreateShader(shaderType);
 
@@ -381,11 +589,16 @@ GLuint ShaderProgram::compileShader(const char *filename, GLenum shaderType)
 	}
 
 	// - Le asignamos el cdigo fuente ledo y lo compilamos
-	const char * shaderSourceCString = shaderSourceString.c_str();
+	const char * shaderSourceCString = source.c_str();
 	glShaderSource(shaderHandler, 1, &shaderSourceCString, NULL);
 	glCompileShader(shaderHandler);
 
-	// - Se comprueba si la compilacin se ha realizado con xito
+	return shaderHandler;
+}
+
+// - Mtodo privado que comprueba si la compilacin de una de las partes se ha realizado con xito
+bool ShaderProgram::checkShader(GLuint shaderHandler, GLenum shaderType)
+{
 	GLint compileResult;
 	glGetShaderiv(shaderHandler, GL_COMPILE_STATUS, &compileResult);
 
@@ -406,7 +619,7 @@ GLuint ShaderProgram::compileShader(const char *filename, GLenum shaderType)
 		}
 	}
 
-	return shaderHandler;
+	return compileResult == GL_TRUE;
 }
 
 // - Mtodo auxiliar para comprobar si un archivo de recursos est presente
@@ -3,6 +3,10 @@
 #include <GL\glew.h>
 #include <fstream>
 #include <sstream>
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
 #include "glm.hpp"
 
 #include "Enumerations.h"
@@ -23,8 +27,41 @@ private:
 	// - Cadena de caracteres que contiene el mensaje de error de la ltima operacin sobre el shader
 	std::string logString;
 
-	// - Mtodo privado que compila cada una de las partes del shader program
-	GLuint compileShader(const char *filename, GLenum shaderType);
+	// - Variante del shader program (mscara de ShaderProgramVariant con las definiciones aadidas al
+	//   cdigo fuente)
+	unsigned int variant;
+
+	// - Archivos del shader program (nombre genrico y geometry shader opcional) y estado de su
+	//   compilacin, que puede hacerse bajo demanda y en segundo plano
+	std::string fileName;
+	ShaderProgramFlags flags;
+	ShaderProgramStatus status;
+
+	// - Compilacin en curso: shader objects, huella en la cach de binarios e inicio
+	std::vector<GLuint> shaderObjects;
+	std::vector<GLenum> shaderObjectTypes;
+	uint64_t binaryKey;
+	std::chrono::high_resolution_clock::time_point linkStart;
+
+	// - Variables de salida que se capturan con transform feedback (entrelazadas)
+	std::vector<std::string> feedbackVaryings;
+
+	// - Cach de localizaciones de los uniforms (-1 si el programa no usa el uniform), que se vaca
+	//   al volver a enlazar el programa
+	std::unordered_map<std::string, GLint> uniformLocations;
+
+	// - Buscar la localizacin de un uniform en la cach (o en el programa, la primera vez)
+	GLint getUniformLocation(const std::string &name);
+
+	// - Empezar y terminar la compilacin y el enlazado
+	void beginLink();
+	void finishLink();
+
+	// - Mtodos privados que leen (con las definiciones de la variante), compilan y comprueban cada
+	//   una de las partes del shader program
+	bool readShaderSource(const char *filename, std::string &source);
+	GLuint compileShader(const std::string &source, GLenum shaderType);
+	bool checkShader(GLuint shaderHandler, GLenum shaderType);
 
 	// - Mtodo auxiliar para comprobar si un archivo de recursos est presente
 	bool fileExists(const std::string & fileName);
@@ -40,12 +77,42 @@ public:
 	// - Crea un shader program a partir del cdigo fuente que se pasa en
 	//   los archivos cuyo nombre genrico se pasa en el argumento filename.
 	//   (Opcionalmente) Se puede crear un Geometry Shader object usando el flag de ShaderProgramFlags,
-	//   estando desactivado por defecto
-	GLuint createShaderProgram(const char *filename, ShaderProgramFlags flags = NO_GEOMETRY_SHADER);
+	//   estando desactivado por defecto. Tambin se puede compilar una variante del shader (mscara de
+	//   ShaderProgramVariant: instanciada, tipo de fuente luminosa)
+	GLuint createShaderProgram(const char *filename, ShaderProgramFlags flags = NO_GEOMETRY_SHADER,
+							   unsigned int variant = DEFAULT_VARIANT);
+
+	// - Compilacin bajo demanda: definir el shader program sin compilarlo y pedirlo (empieza la
+	//   compilacin la primera vez). request devuelve true cuando el shader program est listo; con
+	//   wait, espera a que termine
+	void defineShaderProgram(const char *filename, ShaderProgramFlags flags = NO_GEOMETRY_SHADER,
+							 unsigned int variant = DEFAULT_VARIANT);
+	bool request(bool wait = false);
+	ShaderProgramStatus getStatus();
+
+	// - Transform feedback: variables de salida del vertex shader que se capturan (se asignan antes
+	//   de pedir el shader program, que slo tiene vertex shader con el flag TRANSFORM_FEEDBACK)
+	void setFeedbackVaryings(const std::vector<std::string> &varyings);
+
+	// - Saber si el driver compila los shader programs en segundo plano (KHR_parallel_shader_compile)
+	static bool isParallelCompileSupported();
 
 	// - Activar el shader program
 	bool use();
 
+	// - Saber si es la variante instanciada y obtener la variante
+	bool isInstanced();
+	unsigned int getVariant();
+
+	// - Saber si es un compute shader
+	bool isCompute();
+
+	// - Obtener identificador del shader program
+	GLuint getHandler();
+
+	// - Saber si el shader program usa un uniform
+	bool hasUniform(std::string name);
+
 	// - Los siguientes mtodos estn sobrecargados. Permiten asignar parmetros de tipo uniform al shader
 	bool setUniform(std::string name, GLfloat value);
 	bool setUniform(std::string name, GLint value);
@@ -55,7 +122,4 @@ public:
 	bool setUniform(std::string name, glm::mat4 value);
 	bool setUniform(std::string name, glm::vec2 value);
 	bool setUniform(std::string name, glm::vec3 value);
-
-	// - Asignar subrutina
-	bool setSubroutine(std::string uniformName, std::string subroutineName, GLenum shaderType, GLsizei count);
 };
\ No newline at end of file
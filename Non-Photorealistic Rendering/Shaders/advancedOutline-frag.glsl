@@ -5,18 +5,38 @@ in float dist;
 uniform float outlineThickness; // - Grosor de la silueta (mitad)
 uniform vec3 outlineColor; // - Color de la silueta
 
+#ifdef INSTANCED
+// - Contorno de la instancia (color y grosor; si son negativos, se usan los del modelo)
+flat in vec4 instanceOutline;
+#endif
+
 layout(location = 0) out vec4 FragColor;
 
 void main()
 {
+	float thickness = outlineThickness;
+	vec3 color = outlineColor;
+
+#ifdef INSTANCED
+	if (instanceOutline.w >= 0.0)
+	{
+		thickness = instanceOutline.w;
+	}
+
+	if (instanceOutline.r >= 0.0)
+	{
+		color = instanceOutline.rgb;
+	}
+#endif
+
 	float alpha = 1.0;
 	float absDist = abs(dist);
 	float tipLength = 2.0 * fwidth(absDist);
 
-	if (absDist > outlineThickness - tipLength)
+	if (absDist > thickness - tipLength)
 	{
-		alpha = 1.0 - (absDist - outlineThickness + tipLength) / tipLength; 
+		alpha = 1.0 - (absDist - thickness + tipLength) / tipLength; 
 	}
 
-    FragColor = vec4(outlineColor, alpha);
+    FragColor = vec4(color, alpha);
 }
\ No newline at end of file
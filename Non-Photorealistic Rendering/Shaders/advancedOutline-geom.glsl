@@ -14,6 +14,15 @@ uniform float lineExtension;
 
 out float dist;
 
+#ifdef INSTANCED
+// - Contorno de la instancia (color y grosor; si son negativos, se usan los del modelo)
+in vec4 vertexOutline[];
+flat out vec4 instanceOutline;
+#endif
+
+// - Grosor de la silueta de la primitiva
+float thickness;
+
 // - Determinar si la cara del tringulo es visible calculando su rea
 bool isFrontFacing(vec3 a, vec3 b, vec3 c)
 {
@@ -32,22 +41,34 @@ bool isFrontFacing(vec3 a, vec3 b, vec3 c)
 void emitEdge(vec3 v0, vec3 v1)
 {
 	vec3 vector = lineExtension * vec3(v1.xy - v0.xy, 0.0);
-	vec3 extrusion = vec3(-normalize(vector).y, normalize(vector).x, 0.0) * outlineThickness;
+	vec3 extrusion = vec3(-normalize(vector).y, normalize(vector).x, 0.0) * thickness;
 
-	dist = outlineThickness; 
+	dist = thickness; 
     gl_Position = mProjection * vec4(v0 - extrusion - vector, 1.0); 
+#ifdef INSTANCED
+	instanceOutline = vertexOutline[0];
+#endif
 	EmitVertex();
 
-	dist = -outlineThickness; 
+	dist = -thickness; 
  	gl_Position = mProjection * vec4(v0 + extrusion - vector, 1.0); 
+#ifdef INSTANCED
+	instanceOutline = vertexOutline[0];
+#endif
 	EmitVertex();
 
-	dist = outlineThickness; 
+	dist = thickness; 
  	gl_Position = mProjection * vec4(v1 - extrusion + vector, 1.0);
+#ifdef INSTANCED
+	instanceOutline = vertexOutline[0];
+#endif
 	EmitVertex();
 
-	dist = -outlineThickness; 
+	dist = -thickness; 
     gl_Position = mProjection * vec4(v1 + extrusion + vector, 1.0); 
+#ifdef INSTANCED
+	instanceOutline = vertexOutline[0];
+#endif
 	EmitVertex();
 
     EndPrimitive();
@@ -55,6 +76,16 @@ void emitEdge(vec3 v0, vec3 v1)
 
 void main()
 {
+	// - Grosor del modelo o de la instancia
+	thickness = outlineThickness;
+
+#ifdef INSTANCED
+	if (vertexOutline[0].w >= 0.0)
+	{
+		thickness = vertexOutline[0].w;
+	}
+#endif
+
 	vec3 v0 = gl_in[0].gl_Position.xyz / gl_in[0].gl_Position.w;
 	vec3 v1 = gl_in[1].gl_Position.xyz / gl_in[1].gl_Position.w;
 	vec3 v2 = gl_in[2].gl_Position.xyz / gl_in[2].gl_Position.w;
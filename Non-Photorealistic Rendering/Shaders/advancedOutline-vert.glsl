@@ -6,7 +6,20 @@ layout (location = 1) in vec3 vNormal;
 // - Matriz de modelado y visin
 uniform mat4 mModelView;
 
+#ifdef INSTANCED
+// - Atributos de instancia: matriz de modelado y contorno (color y grosor)
+layout (location = 5) in mat4 vInstanceModel;
+layout (location = 9) in vec4 vInstanceOutline;
+
+out vec4 vertexOutline;
+#endif
+
 void main()
 {
+#ifdef INSTANCED
+	vertexOutline = vInstanceOutline;
+	gl_Position = mModelView * vInstanceModel * vec4(vPosition, 1.0);
+#else
 	gl_Position = mModelView * vec4(vPosition, 1.0);
+#endif
 }
\ No newline at end of file
@@ -2,9 +2,18 @@
 
 uniform vec3 outlineColor;
 
+#ifdef INSTANCED
+// - Color del contorno de la instancia (si es negativo, se usa el del modelo)
+flat in vec3 instanceOutlineColor;
+#endif
+
 out vec4 FragColor;
 
 void main() 
 {
+#ifdef INSTANCED
+	FragColor = vec4((instanceOutlineColor.r >= 0.0) ? instanceOutlineColor : outlineColor, 1.0);
+#else
 	FragColor = vec4(outlineColor, 1.0);
+#endif
 }
\ No newline at end of file
@@ -8,16 +8,37 @@ uniform mat4 mProjection;
 uniform mat4 mvpMatrix;
 uniform float outlineThickness;
 
+#ifdef INSTANCED
+// - Atributos de instancia: matriz de modelado y contorno (color y grosor; si son negativos, se
+//   usan los del modelo)
+layout (location = 5) in mat4 vInstanceModel;
+layout (location = 9) in vec4 vInstanceOutline;
+
+flat out vec3 instanceOutlineColor;
+#endif
+
 void main() 
 {
-	vec4 position = mModelView * vec4(vPosition, 1.0);
-	vec3 normal = normalize(vec3(mvpMatrix * vec4(vNormal, 0.0)));
+#ifdef INSTANCED
+	// - Matrices y contorno de la instancia
+	mat4 modelView = mModelView * vInstanceModel;
+	mat4 mvp = mvpMatrix * vInstanceModel;
+	float thickness = (vInstanceOutline.w >= 0.0) ? vInstanceOutline.w : outlineThickness;
+	instanceOutlineColor = vInstanceOutline.rgb;
+#else
+	mat4 modelView = mModelView;
+	mat4 mvp = mvpMatrix;
+	float thickness = outlineThickness;
+#endif
+
+	vec4 position = modelView * vec4(vPosition, 1.0);
+	vec3 normal = normalize(vec3(mvp * vec4(vNormal, 0.0)));
 
 	// - Modificar posicin del vrtice utilizando su normal y el grosor del contorno
-	position.xyz += normal * outlineThickness;
+	position.xyz += normal * thickness;
 
 	// - Hacer que la relacin de tamao del contorno se mantenga igual en coordenadas de pantalla
-	vec2 offset = normalize(normal.xy) * outlineThickness * position.w;
+	vec2 offset = normalize(normal.xy) * thickness * position.w;
 	position.xy += offset;
 
 	gl_Position = mProjection * position;
@@ -28,14 +28,26 @@ uniform float quadratic; // - Factor de atenuaci
 uniform sampler2D TexSamplerDiffuse;
 uniform sampler2D TexSamplerSpecular;
 
-// - Subrutina para seleccionar el tipo de fuente luminosa a utilizar
-subroutine vec3 LightFunction(vec4);
-subroutine uniform LightFunction LightUniform;
+// - Permutacin: tipo de fuente luminosa. El renderer compila una variante por tipo de fuente
+//   con su definicin (AMBIENT_LIGHT, POINT_LIGHT, DIRECTIONAL_LIGHT o SPOT_LIGHT); sin ninguna,
+//   se compila la fuente ambiente
+#if !defined(POINT_LIGHT) && !defined(DIRECTIONAL_LIGHT) && !defined(SPOT_LIGHT)
+#define AMBIENT_LIGHT
+#endif
 
 // - Tcnica Cel-Shading
 uniform float tones;
 uniform float silhouettingFactor;
 
+#ifdef INSTANCED
+// - Parmetros de Cel-Shading de la instancia (si son negativos, se usan los del modelo)
+flat in vec2 instanceCelShading;
+#endif
+
+// - Parmetros de Cel-Shading del fragmento
+float celTones;
+float celSilhouettingFactor;
+
 layout (location = 0) out vec4 FragColor;
 
 // - Calcular factor de atenuacin de la fuente luminosa debido a la profundidad
@@ -48,8 +60,8 @@ float fatt()
 	return factor;
 }
 
+#if defined(AMBIENT_LIGHT)
 // - Calcular fuente luminosa ambiente
-subroutine(LightFunction)
 vec3 AmbientLight(vec4 texDiffuse)
 {
 	vec3 Kad;
@@ -67,10 +79,11 @@ vec3 AmbientLight(vec4 texDiffuse)
 
 	return (Ia * Kad);
 }
+#endif
 
+#if defined(POINT_LIGHT)
 // - Calcular fuente luminosa puntual
-subroutine(LightFunction)
-vec3 PointLight(vec4 texDiffuse) 
+vec3 PointLight(vec4 texDiffuse)
 {
 	// - Calcular vector normal (si la cara no mira hacia el observador, se usa la opuesta de la normal)
 	vec3 n;
@@ -141,13 +154,13 @@ vec3 PointLight(vec4 texDiffuse)
 
 	// - Componente difusa: en funcin de si el ngulo formado por la direccin de la luz y la normal
 	//   es menor o mayor, el tono ser ms o menos intenso
-	float tone = floor(cosine * tones) / tones;
+	float tone = floor(cosine * celTones) / celTones;
 	diffuse *= tone;
 
 	// - Componente especular: en funcin de si el ngulo formado por la direccin de reflexin de la luz y
 	//   la direccin de visin es menor o mayor, adems de la capacidad reflectiva del material, el tono
 	//   ser ms o menos intenso
-	tone = floor(specularFactor * tones) / tones;
+	tone = floor(specularFactor * celTones) / celTones;
 	specular *= tone;
 
 	// - Calcular color final
@@ -155,7 +168,7 @@ vec3 PointLight(vec4 texDiffuse)
 
 	// - Generar una silueta aproximada (sombreado, de color negro), en funcin del ngulo formado por 
 	//   la normal de la superficie y el vector de visin
-	if (dot(v, n) <= silhouettingFactor)
+	if (dot(v, n) <= celSilhouettingFactor)
 	{
 		// - Generar una silueta aproximada (sombreado, de color negro), en funcin del ngulo formado por 
 		//   la normal de la superficie y el vector de visin
@@ -169,10 +182,11 @@ vec3 PointLight(vec4 texDiffuse)
 
 	return color;
 }
+#endif
 
+#if defined(DIRECTIONAL_LIGHT)
 // - Calcular fuente luminosa direccional
-subroutine(LightFunction)
-vec3 DirectionalLight(vec4 texDiffuse) 
+vec3 DirectionalLight(vec4 texDiffuse)
 {
 	// - Calcular vector normal (si la cara no mira hacia el observador, se usa la opuesta de la normal)
 	vec3 n;
@@ -242,13 +256,13 @@ vec3 DirectionalLight(vec4 texDiffuse)
 
 	// - Componente difusa: en funcin de si el ngulo formado por la direccin de la luz y la normal
 	//   es menor o mayor, el tono ser ms o menos intenso
-	float tone = floor(cosine * tones) / tones;
+	float tone = floor(cosine * celTones) / celTones;
 	diffuse *= tone;
 
 	// - Componente especular: en funcin de si el ngulo formado por la direccin de reflexin de la luz y
 	//   la direccin de visin es menor o mayor, adems de la capacidad reflectiva del material, el tono
 	//   ser ms o menos intenso
-	tone = floor(specularFactor * tones) / tones;
+	tone = floor(specularFactor * celTones) / celTones;
 	specular *= tone;
 
 	// - Calcular color final
@@ -256,7 +270,7 @@ vec3 DirectionalLight(vec4 texDiffuse)
 
 	// - Generar una silueta aproximada (sombreado, de color negro), en funcin del ngulo formado por 
 	//   la normal de la superficie y el vector de visin
-	if (dot(v, n) <= silhouettingFactor)
+	if (dot(v, n) <= celSilhouettingFactor)
 	{
 		// - Generar una silueta aproximada (sombreado, de color negro), en funcin del ngulo formado por 
 		//   la normal de la superficie y el vector de visin
@@ -270,10 +284,11 @@ vec3 DirectionalLight(vec4 texDiffuse)
 
 	return color;
 }
+#endif
 
+#if defined(SPOT_LIGHT)
 // - Calcular fuente luminosa spot
-subroutine(LightFunction)
-vec3 SpotLight(vec4 texDiffuse) 
+vec3 SpotLight(vec4 texDiffuse)
 {
 	vec3 l = normalize(lightPosition - position);
 	vec3 d = lightDirection;
@@ -357,19 +372,19 @@ vec3 SpotLight(vec4 texDiffuse)
 
 	// - Componente difusa: en funcin de si el ngulo formado por la direccin de la luz y la normal
 	//   es menor o mayor, el tono ser ms o menos intenso
-	float tone = floor(cosine * tones) / tones;
+	float tone = floor(cosine * celTones) / celTones;
 	diffuse *= tone;
 
 	// - Componente especular: en funcin de si el ngulo formado por la direccin de reflexin de la luz y
 	//   la direccin de visin es menor o mayor, adems de la capacidad reflectiva del material, el tono
 	//   ser ms o menos intenso
-	tone = floor(specularFactor * tones) / tones;
+	tone = floor(specularFactor * celTones) / celTones;
 	specular *= tone;
 
 	// - Calcular color final
 	vec3 color;
 
-	if (dot(v, n) <= silhouettingFactor)
+	if (dot(v, n) <= celSilhouettingFactor)
 	{
 		// - Generar una silueta aproximada (sombreado, de color negro), en funcin del ngulo formado por 
 		//   la normal de la superficie y el vector de visin
@@ -383,12 +398,40 @@ vec3 SpotLight(vec4 texDiffuse)
 
 	return color;
 }
+#endif
+
+// - Funcin de la fuente luminosa de la permutacin
+#if defined(AMBIENT_LIGHT)
+#define LightFunction AmbientLight
+#elif defined(POINT_LIGHT)
+#define LightFunction PointLight
+#elif defined(DIRECTIONAL_LIGHT)
+#define LightFunction DirectionalLight
+#else
+#define LightFunction SpotLight
+#endif
 
 void main() 
 {
+	// - Parmetros de Cel-Shading (del modelo o de la instancia)
+	celTones = tones;
+	celSilhouettingFactor = silhouettingFactor;
+
+#ifdef INSTANCED
+	if (instanceCelShading.x >= 0.0)
+	{
+		celTones = instanceCelShading.x;
+	}
+
+	if (instanceCelShading.y >= 0.0)
+	{
+		celSilhouettingFactor = instanceCelShading.y;
+	}
+#endif
+
 	// - Samplear textura
 	vec4 texDiffuse = texture(TexSamplerDiffuse, texCoord);
 
 	// - Obtener color del fragmento aplicando la fuente luminosa seleccionada
-	FragColor = vec4(LightUniform(texDiffuse), 1.0);
+	FragColor = vec4(LightFunction(texDiffuse), 1.0);
 }
\ No newline at end of file
@@ -7,14 +7,40 @@ layout (location = 2) in vec2 vTexCoord;
 uniform mat4 mvpMatrix;
 uniform mat4 mModelView;
 
+#ifdef INSTANCED
+// - Atributos de instancia: matriz de modelado y parmetros de Cel-Shading
+layout (location = 5) in mat4 vInstanceModel;
+layout (location = 10) in vec4 vInstanceCelShading;
+#endif
+
 out vec3 position;
 out vec3 normal;
 out vec2 texCoord;
 
+#ifdef INSTANCED
+flat out vec2 instanceCelShading;
+#endif
+
+invariant gl_Position;
+
 void main() 
 {
-	normal = vec3(mModelView * vec4(vNormal, 0.0));
-	position = vec3(mModelView * vec4(vPosition, 1.0));
+#ifdef INSTANCED
+	// - Matrices de la instancia
+	mat4 modelView = mModelView * vInstanceModel;
+	mat4 mvp = mvpMatrix * vInstanceModel;
+#else
+	mat4 modelView = mModelView;
+	mat4 mvp = mvpMatrix;
+#endif
+
+	normal = vec3(modelView * vec4(vNormal, 0.0));
+	position = vec3(modelView * vec4(vPosition, 1.0));
 	texCoord = vTexCoord;
-	gl_Position = mvpMatrix * vec4(vPosition, 1.0);
+
+#ifdef INSTANCED
+	instanceCelShading = vInstanceCelShading.xy;
+#endif
+
+	gl_Position = mvp * vec4(vPosition, 1.0);
 }
\ No newline at end of file
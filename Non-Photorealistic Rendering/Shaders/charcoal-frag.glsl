@@ -3,10 +3,14 @@
 in vec2 texCoord;
 
 uniform sampler2D TexScene;
+uniform sampler2D TexDepth;
+uniform mat4 mInverseProjection;
 
-// - Tcnica Sobel Edge Detection
+// - Tcnica Sobel Edge Detection (color y profundidad)
 uniform bool enableSobel;
 uniform float threshold;
+uniform bool enableDepthEdges;
+uniform float depthThreshold;
 uniform vec3 edgeColor;
 
 // - Tcnica Charcoal
@@ -37,6 +41,38 @@ float sobelEdge(vec2 offsetX, vec2 offsetY)
 	return length(sqrt(horizontal.rgb * horizontal.rgb + vertical.rgb * vertical.rgb));
 }
 
+// - Profundidad lineal (distancia al observador en espacio de visin)
+float linearDepth(vec2 uv)
+{
+	float depth = texture(TexDepth, uv).r;
+	vec4 viewPosition = mInverseProjection * vec4(vec3(uv, depth) * 2.0 - 1.0, 1.0);
+
+	return -viewPosition.z / viewPosition.w;
+}
+
+// - Sobel edge detection sobre la profundidad lineal, relativo a la distancia del fragmento (los
+//   saltos de profundidad son contornos aunque los colores a ambos lados se parezcan)
+float sobelDepthEdge(vec2 offsetX, vec2 offsetY)
+{
+	float horizontal = 0.0;
+	horizontal += linearDepth(texCoord - offsetY) * -2.0;
+	horizontal += linearDepth(texCoord + offsetY) * 2.0;
+	horizontal += linearDepth(texCoord - offsetX - offsetY) * -1.0;
+	horizontal += linearDepth(texCoord - offsetX + offsetY) * 1.0;
+	horizontal += linearDepth(texCoord + offsetX - offsetY) * -1.0;
+	horizontal += linearDepth(texCoord + offsetX + offsetY) * 1.0;
+
+	float vertical = 0.0;
+	vertical += linearDepth(texCoord - offsetX) * 2.0;
+	vertical += linearDepth(texCoord + offsetX) * -2.0;
+	vertical += linearDepth(texCoord - offsetX - offsetY) * 1.0;
+	vertical += linearDepth(texCoord - offsetX + offsetY) * -1.0;
+	vertical += linearDepth(texCoord + offsetX - offsetY) * 1.0;
+	vertical += linearDepth(texCoord + offsetX + offsetY) * -1.0;
+
+	return sqrt(horizontal * horizontal + vertical * vertical) / linearDepth(texCoord);
+}
+
 // - Ruido aleatorio
 float randomNoise2D(vec2 uv)
 {
@@ -56,12 +92,13 @@ void main()
 
 	// - Aplicar algoritmo Sobel para detectar y dibujar los contornos
 	float edge = sobelEdge(offsetX, offsetY);
+	float depthEdge = enableDepthEdges ? sobelDepthEdge(offsetX, offsetY) : 0.0;
 
 	// - Color del fragmento
 	vec4 color;
 
 	// - Dibujar contornos/relleno
-	if (enableSobel && (edge > (threshold * 8.0)))
+	if (enableSobel && ((edge > (threshold * 8.0)) || (depthEdge > depthThreshold)))
 	{
 		color.rgb = edgeColor;
 	}
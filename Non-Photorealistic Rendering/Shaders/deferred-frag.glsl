@@ -0,0 +1,198 @@
+#version 400
+
+in vec2 texCoord;
+
+// - G-buffer (ver GBufferTarget) y matriz para reconstruir la posicin en espacio de visin
+uniform sampler2D GBufferAlbedo;
+uniform sampler2D GBufferAmbient;
+uniform sampler2D GBufferSpecular;
+uniform sampler2D GBufferNormal;
+uniform sampler2D GBufferParams;
+uniform sampler2D GBufferHatching;
+uniform sampler2D GBufferDepth;
+uniform mat4 mInverseProjection;
+
+// - Parmetros de las fuentes luminosas
+uniform vec3 Ia; // - Componente ambiente
+uniform vec3 Id; // - Componente difusa
+uniform vec3 Is; // - Componente especular
+uniform vec3 lightPosition; // - Posicin de la luz (fuentes puntual y spot)
+uniform vec3 lightDirection; // - Direccin de la luz (fuentes direccional y spot). Se pasa ya normalizada
+uniform	float cosGamma; // - Coseno del ngulo de la luz spot (en radianes)
+uniform float spotExponent; // - Exponente de concentracin de la luz de la fuente spot
+
+// - Constantes para calcular la atenuacin de la fuente luminosa
+uniform float constant; // - Factor de atenuacin constante
+uniform float linear; // - Factor de atenuacin lineal
+uniform float quadratic; // - Factor de atenuacin cuadrtico
+
+// - Permutacin: tipo de fuente luminosa (AMBIENT_LIGHT, POINT_LIGHT, DIRECTIONAL_LIGHT o SPOT_LIGHT;
+//   sin ninguna, la ambiente) y tcnica (MONOCHROME, CEL_SHADING, HATCHING o GOOCH_SHADING; sin
+//   ninguna, la realista)
+#if !defined(POINT_LIGHT) && !defined(DIRECTIONAL_LIGHT) && !defined(SPOT_LIGHT)
+#define AMBIENT_LIGHT
+#endif
+
+layout (location = 0) out vec4 FragColor;
+
+// - Datos del pxel ledos del G-buffer
+vec3 position;
+vec3 n;
+vec3 Ka;
+vec3 Kd;
+vec3 Ks;
+float shininess;
+vec4 params;
+
+// - Calcular factor de atenuacin de la fuente luminosa debido a la profundidad
+float fatt()
+{
+	// - Calcular factor de atenuacin de la fuente luminosa
+	float dist = distance(lightPosition, position);
+	float factor = min(1.0 / (constant + linear * dist + quadratic * pow(dist, 2)), 1.0);
+
+	return factor;
+}
+
+#if defined(AMBIENT_LIGHT)
+// - Calcular fuente luminosa ambiente
+vec3 LightFunction()
+{
+	return (Ia * Ka);
+}
+#else
+// - Calcular fuente luminosa puntual, direccional o spot con el modelo de la tcnica
+vec3 LightFunction()
+{
+	// - Direccin hacia la fuente luminosa y atenuacin
+#if defined(DIRECTIONAL_LIGHT)
+	vec3 l = -lightDirection;
+	float attenuation = 1.0;
+#else
+	vec3 l = normalize(lightPosition - position);
+	float attenuation = fatt();
+#endif
+
+#if defined(SPOT_LIGHT)
+	// - Usar o no el exponente para calcular el spot factor
+	if (dot(-l, lightDirection) < cosGamma)
+	{
+		attenuation = 0.0;
+	}
+	else
+	{
+		attenuation *= pow(dot(-l, lightDirection), spotExponent);
+	}
+#endif
+
+	vec3 v = normalize(-position);
+	vec3 r = reflect(-l, n);
+
+	// - Componente difusa
+	float cosine = max(dot(l, n), 0.0);
+
+#if defined(GOOCH_SHADING)
+	// - Tcnica NPR: Gooch Shading (colores fro y clido)
+	vec3 Kcool = vec3(0.0, 0.0, params.x) + params.z * Kd;
+	vec3 Kwarm = vec3(params.y, params.y, 0.0) + params.w * Kd;
+	vec3 diffuse = Id * (((1.0 + cosine) / 2) * Kcool + (1 - ((1.0 + cosine) / 2)) * Kwarm);
+#else
+	vec3 diffuse = (Id * Kd * cosine);
+#endif
+
+	// - Componente especular
+	float specularFactor = pow(max(dot(r, v), 0.0), shininess);
+	vec3 specular;
+
+	// - Evitar que aparezca brillo especular si se ilumina desde detrs de la superficie
+	if (dot(l, n) < 0.0)
+	{
+		specular = vec3(0.0);
+	}
+	else
+	{
+		specular = (Is * Ks * specularFactor);
+	}
+
+#if defined(CEL_SHADING)
+	// - Cel-Shading: tonos discretos de las componentes difusa y especular
+	float celTones = params.x;
+	diffuse *= floor(cosine * celTones) / celTones;
+	specular *= floor(specularFactor * celTones) / celTones;
+
+	// - Generar una silueta aproximada (sombreado, de color negro), en funcin del ngulo formado por
+	//   la normal de la superficie y el vector de visin
+	if (dot(v, n) <= params.y)
+	{
+		return vec3(0.0);
+	}
+#endif
+
+	return attenuation * (diffuse + specular);
+}
+#endif
+
+#if defined(HATCHING)
+// - Hatching a partir de los tonos de las texturas de hatching guardados en el G-buffer
+vec3 hatching(float intensity)
+{
+	vec3 hatchingDark = params.rgb;
+	vec3 hatchingBright = texture(GBufferHatching, texCoord).rgb;
+
+	// - Brillo del fragmento
+	vec3 brightness = vec3(max(0.0, intensity - 1.0));
+
+	// - Factor que se aplica a cada color de las texturas de hatching
+	vec3 strengthDark = clamp(vec3(0.0, -1.0, -2.0) + (intensity * 6.0), 0.0, 1.0);
+	vec3 strengthBright = clamp(vec3(-3.0, -4.0, -5.0) + (intensity * 6.0), 0.0, 1.0);
+
+	// - Corregir factores para que haya menos valores distintos de 0
+	strengthDark.xy -= strengthDark.yz;
+	strengthDark.z -= strengthBright.x;
+	strengthBright.xy -= strengthBright.zy;
+
+	// - Aplicar factor de intensidad a cada textura de hatching
+	hatchingDark *= strengthDark;
+	hatchingBright *= strengthBright;
+
+	return brightness + hatchingDark.r + hatchingDark.g + hatchingDark.b +
+						hatchingBright.r + hatchingBright.g + hatchingBright.b;
+}
+#endif
+
+void main()
+{
+	// - Pxeles sin geometra: se conserva el fondo (y su profundidad, para el skybox)
+	vec4 albedo = texture(GBufferAlbedo, texCoord);
+
+	if (albedo.a == 0.0)
+	{
+		discard;
+	}
+
+	// - Posicin en espacio de visin a partir de la profundidad. Se escribe tambin la profundidad,
+	//   para que los contornos y el skybox se dibujen contra la de la escena
+	float depth = texture(GBufferDepth, texCoord).r;
+	vec4 viewPosition = mInverseProjection * vec4(vec3(texCoord, depth) * 2.0 - 1.0, 1.0);
+	position = viewPosition.xyz / viewPosition.w;
+	gl_FragDepth = depth;
+
+	// - Material y parmetros de la tcnica
+	vec4 normalShininess = texture(GBufferNormal, texCoord);
+	n = normalize(normalShininess.xyz);
+	shininess = normalShininess.w;
+	Ka = texture(GBufferAmbient, texCoord).rgb;
+	Kd = albedo.rgb;
+	Ks = texture(GBufferSpecular, texCoord).rgb;
+	params = texture(GBufferParams, texCoord);
+
+	vec3 color = LightFunction();
+
+#if defined(HATCHING)
+	// - Obtener intensidad de color del fragmento (luminancia) y aplicar hatching
+	vec3 luminance = vec3(0.2326, 0.7152, 0.0722);
+	color = hatching(dot(color, luminance));
+#endif
+
+	FragColor = vec4(color, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,8 @@
+#version 400
+
+out vec4 FragColor;
+
+void main() 
+{
+	FragColor = vec4(1.0);
+}
\ No newline at end of file
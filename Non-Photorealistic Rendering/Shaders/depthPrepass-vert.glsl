@@ -0,0 +1,26 @@
+#version 400
+
+layout (location = 0) in vec3 vPosition;
+
+uniform mat4 mvpMatrix;
+
+#ifdef INSTANCED
+// - Atributos de instancia: matriz de modelado
+layout (location = 5) in mat4 vInstanceModel;
+#endif
+
+// - La posicin se calcula igual que en los shaders de sombreado, que tambin la declaran
+//   invariante, para que la profundidad coincida exactamente (GL_EQUAL)
+invariant gl_Position;
+
+void main() 
+{
+#ifdef INSTANCED
+	// - Matriz de la instancia
+	mat4 mvp = mvpMatrix * vInstanceModel;
+#else
+	mat4 mvp = mvpMatrix;
+#endif
+
+	gl_Position = mvp * vec4(vPosition, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,18 @@
+#version 400
+
+in vec3 normal;
+
+// - Identificador del elemento de la escena (mayor que cero)
+uniform int elementId;
+
+layout (location = 0) out vec4 ElementId;
+layout (location = 1) out vec4 Normal;
+
+void main() 
+{
+	// - Identificador codificado en los canales de 8 bits (el cero queda para el fondo)
+	ElementId = vec4(float(elementId & 255), float((elementId >> 8) & 255), float((elementId >> 16) & 255), 255.0) / 255.0;
+
+	// - Normal en espacio de visin (si la cara no mira hacia el observador, se usa la opuesta)
+	Normal = vec4(normalize(gl_FrontFacing ? normal : -normal), 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,34 @@
+#version 400
+
+layout (location = 0) in vec3 vPosition;
+layout (location = 1) in vec3 vNormal;
+
+uniform mat4 mvpMatrix;
+uniform mat4 mModelView;
+
+#ifdef INSTANCED
+// - Atributos de instancia: matriz de modelado
+layout (location = 5) in mat4 vInstanceModel;
+#endif
+
+out vec3 normal;
+
+// - La posicin se calcula igual que en los shaders de sombreado, para que la profundidad coincida
+//   con la de la escena
+invariant gl_Position;
+
+void main() 
+{
+#ifdef INSTANCED
+	// - Matrices de la instancia
+	mat4 modelView = mModelView * vInstanceModel;
+	mat4 mvp = mvpMatrix * vInstanceModel;
+#else
+	mat4 modelView = mModelView;
+	mat4 mvp = mvpMatrix;
+#endif
+
+	normal = vec3(modelView * vec4(vNormal, 0.0));
+
+	gl_Position = mvp * vec4(vPosition, 1.0);
+}
\ No newline at end of file
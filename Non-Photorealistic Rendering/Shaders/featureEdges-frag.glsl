@@ -0,0 +1,17 @@
+#version 400
+
+in float dist;
+
+// - Color y grosor (pxeles) de las lneas
+uniform vec3 lineColor;
+uniform float lineWidth;
+
+layout(location = 0) out vec4 FragColor;
+
+void main()
+{
+	// - Suavizado: el borde de la lnea se desvanece en el ltimo pxel
+	float alpha = clamp(0.5 * lineWidth + 0.5 - abs(dist), 0.0, 1.0);
+
+	FragColor = vec4(lineColor, alpha);
+}
\ No newline at end of file
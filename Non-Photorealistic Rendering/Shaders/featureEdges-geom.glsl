@@ -0,0 +1,75 @@
+#version 400
+
+layout(lines) in;
+layout(triangle_strip, max_vertices = 4) out;
+
+// - Tamao del viewport (pxeles)
+uniform vec2 viewportSize;
+
+// - Grosor de las lneas (pxeles)
+uniform float lineWidth;
+
+// - Desplazamiento de la profundidad hacia el observador (coordenadas normalizadas), para que las
+//   lneas no queden ocultas por las caras que separan
+uniform float depthBias;
+
+// - Distancia (pxeles) al centro de la lnea
+out float dist;
+
+// - Emitir un vrtice del quad desplazado en pantalla (pxeles)
+void emitVertex(vec4 position, vec2 offset, float distance)
+{
+	dist = distance;
+	gl_Position = vec4(position.xy + offset / (0.5 * viewportSize) * position.w,
+					   position.z - depthBias * position.w, position.w);
+	EmitVertex();
+}
+
+void main()
+{
+	vec4 a = gl_in[0].gl_Position;
+	vec4 b = gl_in[1].gl_Position;
+
+	// - Recortar la lnea con el plano cercano (z = -w) para poder dividir por w
+	float distanceA = a.z + a.w;
+	float distanceB = b.z + b.w;
+
+	if (distanceA < 0.0 && distanceB < 0.0)
+	{
+		return;
+	}
+
+	if (distanceA < 0.0)
+	{
+		a = mix(a, b, distanceA / (distanceA - distanceB));
+	}
+	else if (distanceB < 0.0)
+	{
+		b = mix(b, a, distanceB / (distanceB - distanceA));
+	}
+
+	// - Direccin y normal de la lnea en pantalla (pxeles)
+	vec2 screenA = a.xy / a.w * 0.5 * viewportSize;
+	vec2 screenB = b.xy / b.w * 0.5 * viewportSize;
+	vec2 direction = screenB - screenA;
+
+	if (dot(direction, direction) < 1e-8)
+	{
+		return;
+	}
+
+	direction = normalize(direction);
+	vec2 normal = vec2(-direction.y, direction.x);
+
+	// - Quad de medio grosor (ms medio pxel de suavizado) a cada lado, alargado por los extremos
+	//   para que las lneas seguidas se unan
+	float halfWidth = 0.5 * lineWidth + 0.5;
+	vec2 extension = direction * halfWidth;
+
+	emitVertex(a, -extension + normal * halfWidth, halfWidth);
+	emitVertex(a, -extension - normal * halfWidth, -halfWidth);
+	emitVertex(b, extension + normal * halfWidth, halfWidth);
+	emitVertex(b, extension - normal * halfWidth, -halfWidth);
+
+	EndPrimitive();
+}
\ No newline at end of file
@@ -0,0 +1,11 @@
+#version 400
+
+layout (location = 0) in vec3 vPosition;
+
+// - Matriz de modelado, visin y proyeccin
+uniform mat4 mvpMatrix;
+
+void main()
+{
+	gl_Position = mvpMatrix * vec4(vPosition, 1.0);
+}
\ No newline at end of file
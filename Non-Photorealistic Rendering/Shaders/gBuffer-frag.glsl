@@ -0,0 +1,115 @@
+#version 400
+
+in vec3 normal;
+in vec2 texCoord;
+
+// - Caractersticas del material
+uniform vec3 KaMaterial;
+uniform vec3 KdMaterial;
+uniform vec3 KsMaterial;
+uniform float shininess;
+
+// - Permutacin: tcnica cuyos parmetros se guardan en el G-buffer (MONOCHROME, CEL_SHADING,
+//   HATCHING o GOOCH_SHADING; sin ninguna, la realista). Las tcnicas que usan las texturas del
+//   modelo guardan su color en lugar del del material
+#if !defined(MONOCHROME) && !defined(HATCHING)
+#define MATERIAL_TEXTURES
+
+// - Samplers de texturas
+uniform sampler2D TexSamplerDiffuse;
+uniform sampler2D TexSamplerSpecular;
+#endif
+
+#if defined(CEL_SHADING)
+// - Tcnica Cel-Shading
+uniform float tones;
+uniform float silhouettingFactor;
+
+#ifdef INSTANCED
+// - Parmetros de Cel-Shading de la instancia (si son negativos, se usan los del modelo)
+flat in vec2 instanceCelShading;
+#endif
+#elif defined(GOOCH_SHADING)
+// - Tcnica Gooch Shading
+uniform vec3 Kblue;
+uniform vec3 Kyellow;
+uniform float alpha;
+uniform float beta;
+#elif defined(HATCHING)
+// - Tcnica Hatching
+uniform sampler2D hatchBright;
+uniform sampler2D hatchDark;
+uniform float density;
+uniform mat2 rotationMatrix;
+#endif
+
+// - Destinos del G-buffer (ver GBufferTarget)
+layout (location = 0) out vec4 GBufferAlbedo;
+layout (location = 1) out vec4 GBufferAmbient;
+layout (location = 2) out vec4 GBufferSpecular;
+layout (location = 3) out vec4 GBufferNormal;
+layout (location = 4) out vec4 GBufferParams;
+layout (location = 5) out vec4 GBufferHatching;
+
+void main()
+{
+	// - Normal en espacio de visin (si la cara no mira hacia el observador, se usa la opuesta)
+	vec3 n = normalize(gl_FrontFacing ? normal : -normal);
+
+	// - Colores ambiente, difuso y especular (de las texturas si las hay)
+	vec3 Ka = KaMaterial;
+	vec3 Kd = KdMaterial;
+	vec3 Ks = KsMaterial;
+
+#if defined(MATERIAL_TEXTURES)
+	vec4 texDiffuse = texture(TexSamplerDiffuse, texCoord);
+	vec4 texSpecular = texture(TexSamplerSpecular, texCoord);
+
+	if (texDiffuse.rgb != vec3(0.0))
+	{
+		Ka = texDiffuse.rgb;
+		Kd = texDiffuse.rgb;
+	}
+
+	if (texSpecular.rgb != vec3(0.0))
+	{
+		Ks = texSpecular.rgb;
+	}
+#endif
+
+	// - Parmetros de la tcnica
+	vec4 params = vec4(0.0);
+	vec3 hatchingBright = vec3(0.0);
+
+#if defined(CEL_SHADING)
+	params.xy = vec2(tones, silhouettingFactor);
+
+#ifdef INSTANCED
+	if (instanceCelShading.x >= 0.0)
+	{
+		params.x = instanceCelShading.x;
+	}
+
+	if (instanceCelShading.y >= 0.0)
+	{
+		params.y = instanceCelShading.y;
+	}
+#endif
+#elif defined(GOOCH_SHADING)
+	params = vec4(Kblue.b, Kyellow.r, alpha, beta);
+#elif defined(HATCHING)
+	// - Hatching en coordenadas de textura del objeto: se guardan los tonos de las dos texturas de
+	//   hatching y la pasada de iluminacin los combina segn la intensidad de cada fuente
+	vec2 uv = ((texCoord - vec2(0.5)) * rotationMatrix + vec2(0.5)) * density;
+	params.rgb = texture(hatchDark, uv).rgb;
+	hatchingBright = texture(hatchBright, uv).rgb;
+#endif
+
+	// - El canal alfa del albedo marca los pxeles con geometra
+	GBufferAlbedo = vec4(Kd, 1.0);
+	GBufferAmbient = vec4(Ka, 1.0);
+	GBufferSpecular = vec4(Ks, 1.0);
+	GBufferNormal = vec4(n, shininess);
+	GBufferParams = params;
+	GBufferHatching = vec4(hatchingBright, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+#version 400
+
+layout (location = 0) in vec3 vPosition;
+layout (location = 1) in vec3 vNormal;
+layout (location = 2) in vec2 vTexCoord;
+
+uniform mat4 mvpMatrix;
+uniform mat4 mModelView;
+
+#ifdef INSTANCED
+// - Atributos de instancia: matriz de modelado y parmetros de Cel-Shading
+layout (location = 5) in mat4 vInstanceModel;
+layout (location = 10) in vec4 vInstanceCelShading;
+#endif
+
+out vec3 normal;
+out vec2 texCoord;
+
+#ifdef INSTANCED
+flat out vec2 instanceCelShading;
+#endif
+
+invariant gl_Position;
+
+void main() 
+{
+#ifdef INSTANCED
+	// - Matrices de la instancia
+	mat4 modelView = mModelView * vInstanceModel;
+	mat4 mvp = mvpMatrix * vInstanceModel;
+#else
+	mat4 modelView = mModelView;
+	mat4 mvp = mvpMatrix;
+#endif
+
+	// - La posicin no se guarda: la pasada de iluminacin la reconstruye a partir de la profundidad
+	normal = vec3(modelView * vec4(vNormal, 0.0));
+	texCoord = vTexCoord;
+
+#ifdef INSTANCED
+	instanceCelShading = vInstanceCelShading.xy;
+#endif
+
+	gl_Position = mvp * vec4(vPosition, 1.0);
+}
\ No newline at end of file
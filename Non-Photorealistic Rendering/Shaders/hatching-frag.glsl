@@ -30,9 +30,12 @@ uniform sampler2D hatchDark;
 uniform float density;
 uniform mat2 rotationMatrix;
 
-// - Subrutina para seleccionar el tipo de fuente luminosa a utilizar
-subroutine vec3 LightFunction();
-subroutine uniform LightFunction LightUniform;
+// - Permutacin: tipo de fuente luminosa. El renderer compila una variante por tipo de fuente
+//   con su definicin (AMBIENT_LIGHT, POINT_LIGHT, DIRECTIONAL_LIGHT o SPOT_LIGHT); sin ninguna,
+//   se compila la fuente ambiente
+#if !defined(POINT_LIGHT) && !defined(DIRECTIONAL_LIGHT) && !defined(SPOT_LIGHT)
+#define AMBIENT_LIGHT
+#endif
 
 layout (location = 0) out vec4 FragColor;
 
@@ -46,16 +49,17 @@ float fatt()
 	return factor;
 }
 
+#if defined(AMBIENT_LIGHT)
 // - Calcular fuente luminosa ambiente
-subroutine(LightFunction)
 vec3 AmbientLight()
 {
 	return (Ia * KaMaterial);
 }
+#endif
 
+#if defined(POINT_LIGHT)
 // - Calcular fuente luminosa puntual
-subroutine(LightFunction)
-vec3 PointLight() 
+vec3 PointLight()
 {
 	// - Calcular vector normal (si la cara no mira hacia el observador, se usa la opuesta de la normal)
 	vec3 n;
@@ -102,10 +106,11 @@ vec3 PointLight()
 
 	return color;
 }
+#endif
 
+#if defined(DIRECTIONAL_LIGHT)
 // - Calcular fuente luminosa direccional
-subroutine(LightFunction)
-vec3 DirectionalLight() 
+vec3 DirectionalLight()
 {
 	// - Calcular vector normal (si la cara no mira hacia el observador, se usa la opuesta de la normal)
 	vec3 n;
@@ -151,10 +156,11 @@ vec3 DirectionalLight()
 
 	return color;
 }
+#endif
 
+#if defined(SPOT_LIGHT)
 // - Calcular fuente luminosa spot
-subroutine(LightFunction)
-vec3 SpotLight() 
+vec3 SpotLight()
 {
 	vec3 l = normalize(lightPosition - position);
 	vec3 d = lightDirection;
@@ -214,6 +220,7 @@ vec3 SpotLight()
 
 	return color;
 }
+#endif
 
 // - Hatching
 vec3 hatching(vec2 uv, float intensity)
@@ -244,10 +251,21 @@ vec3 hatching(vec2 uv, float intensity)
     return hatching;
 }
 
+// - Funcin de la fuente luminosa de la permutacin
+#if defined(AMBIENT_LIGHT)
+#define LightFunction AmbientLight
+#elif defined(POINT_LIGHT)
+#define LightFunction PointLight
+#elif defined(DIRECTIONAL_LIGHT)
+#define LightFunction DirectionalLight
+#else
+#define LightFunction SpotLight
+#endif
+
 void main()
 {
 	// - Color del fragmento, aplicada la iluminacin
-	vec3 color = LightUniform();
+	vec3 color = LightFunction();
 
 	// - Luminancia (factor para calcular el color percibido en escala de grises)
 	vec3 luminance = vec3(0.2326, 0.7152, 0.0722);
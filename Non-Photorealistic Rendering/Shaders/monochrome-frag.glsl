@@ -23,9 +23,12 @@ uniform float constant; // - Factor de atenuaci
 uniform float linear; // - Factor de atenuacin lineal
 uniform float quadratic; // - Factor de atenuacin cuadrtico
 
-// - Subrutina para seleccionar el tipo de fuente luminosa a utilizar
-subroutine vec3 LightFunction();
-subroutine uniform LightFunction LightUniform;
+// - Permutacin: tipo de fuente luminosa. El renderer compila una variante por tipo de fuente
+//   con su definicin (AMBIENT_LIGHT, POINT_LIGHT, DIRECTIONAL_LIGHT o SPOT_LIGHT); sin ninguna,
+//   se compila la fuente ambiente
+#if !defined(POINT_LIGHT) && !defined(DIRECTIONAL_LIGHT) && !defined(SPOT_LIGHT)
+#define AMBIENT_LIGHT
+#endif
 
 layout (location = 0) out vec4 FragColor;
 
@@ -39,8 +42,8 @@ float fatt()
 	return factor;
 }
 
+#if defined(AMBIENT_LIGHT)
 // - Calcular fuente luminosa ambiente
-subroutine(LightFunction)
 vec3 AmbientLight()
 {	
 	// - Asignar color ambiente
@@ -48,10 +51,11 @@ vec3 AmbientLight()
 
 	return (Ia * Kad);
 }
+#endif
 
+#if defined(POINT_LIGHT)
 // - Calcular fuente luminosa puntual
-subroutine(LightFunction)
-vec3 PointLight() 
+vec3 PointLight()
 {
 	// - Calcular vector normal (si la cara no mira hacia el observador, se usa la opuesta de la normal)
 	vec3 n;
@@ -96,10 +100,11 @@ vec3 PointLight()
 
 	return color;
 }
+#endif
 
+#if defined(DIRECTIONAL_LIGHT)
 // - Calcular fuente luminosa direccional
-subroutine(LightFunction)
-vec3 DirectionalLight() 
+vec3 DirectionalLight()
 {
 	// - Calcular vector normal (si la cara no mira hacia el observador, se usa la opuesta de la normal)
 	vec3 n;
@@ -143,10 +148,11 @@ vec3 DirectionalLight()
 
 	return color;
 }
+#endif
 
+#if defined(SPOT_LIGHT)
 // - Calcular fuente luminosa spot
-subroutine(LightFunction)
-vec3 SpotLight() 
+vec3 SpotLight()
 {
 	vec3 l = normalize(lightPosition - position);
 	vec3 d = lightDirection;
@@ -204,8 +210,20 @@ vec3 SpotLight()
 
 	return color;
 }
+#endif
+
+// - Funcin de la fuente luminosa de la permutacin
+#if defined(AMBIENT_LIGHT)
+#define LightFunction AmbientLight
+#elif defined(POINT_LIGHT)
+#define LightFunction PointLight
+#elif defined(DIRECTIONAL_LIGHT)
+#define LightFunction DirectionalLight
+#else
+#define LightFunction SpotLight
+#endif
 
 void main()
 {
-	FragColor = vec4(LightUniform(), 1.0);
+	FragColor = vec4(LightFunction(), 1.0);
 }
\ No newline at end of file
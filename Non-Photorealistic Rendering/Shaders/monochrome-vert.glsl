@@ -6,13 +6,29 @@ layout (location = 1) in vec3 vNormal;
 uniform mat4 mvpMatrix;
 uniform mat4 mModelView;
 
+#ifdef INSTANCED
+// - Atributos de instancia: matriz de modelado
+layout (location = 5) in mat4 vInstanceModel;
+#endif
+
 out vec3 position;
 out vec3 normal;
 
+invariant gl_Position;
+
 void main() 
 {
-	normal = vec3(mModelView * vec4(vNormal, 0.0));
-	position = vec3(mModelView * vec4(vPosition, 1.0));
+#ifdef INSTANCED
+	// - Matrices de la instancia
+	mat4 modelView = mModelView * vInstanceModel;
+	mat4 mvp = mvpMatrix * vInstanceModel;
+#else
+	mat4 modelView = mModelView;
+	mat4 mvp = mvpMatrix;
+#endif
+
+	normal = vec3(modelView * vec4(vNormal, 0.0));
+	position = vec3(modelView * vec4(vPosition, 1.0));
 
-	gl_Position = mvpMatrix * vec4(vPosition, 1.0);
+	gl_Position = mvp * vec4(vPosition, 1.0);
 }
\ No newline at end of file
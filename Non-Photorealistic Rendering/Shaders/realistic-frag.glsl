@@ -28,9 +28,12 @@ uniform float quadratic; // - Factor de atenuaci
 uniform sampler2D TexSamplerDiffuse;
 uniform sampler2D TexSamplerSpecular;
 
-// - Subrutina para seleccionar el tipo de fuente luminosa a utilizar
-subroutine vec3 LightFunction(vec4);
-subroutine uniform LightFunction LightUniform;
+// - Permutacin: tipo de fuente luminosa. El renderer compila una variante por tipo de fuente
+//   con su definicin (AMBIENT_LIGHT, POINT_LIGHT, DIRECTIONAL_LIGHT o SPOT_LIGHT); sin ninguna,
+//   se compila la fuente ambiente
+#if !defined(POINT_LIGHT) && !defined(DIRECTIONAL_LIGHT) && !defined(SPOT_LIGHT)
+#define AMBIENT_LIGHT
+#endif
 
 layout (location = 0) out vec4 FragColor;
 
@@ -44,8 +47,8 @@ float fatt()
 	return factor;
 }
 
+#if defined(AMBIENT_LIGHT)
 // - Calcular fuente luminosa ambiente
-subroutine(LightFunction)
 vec3 AmbientLight(vec4 texDiffuse)
 {
 	vec3 Kad;
@@ -63,10 +66,11 @@ vec3 AmbientLight(vec4 texDiffuse)
 
 	return (Ia * Kad);
 }
+#endif
 
+#if defined(POINT_LIGHT)
 // - Calcular fuente luminosa puntual
-subroutine(LightFunction)
-vec3 PointLight(vec4 texDiffuse) 
+vec3 PointLight(vec4 texDiffuse)
 {
 	// - Calcular vector normal (si la cara no mira hacia el observador, se usa la opuesta de la normal)
 	vec3 n;
@@ -138,10 +142,11 @@ vec3 PointLight(vec4 texDiffuse)
 
 	return color;
 }
+#endif
 
+#if defined(DIRECTIONAL_LIGHT)
 // - Calcular fuente luminosa direccional
-subroutine(LightFunction)
-vec3 DirectionalLight(vec4 texDiffuse) 
+vec3 DirectionalLight(vec4 texDiffuse)
 {
 	// - Calcular vector normal (si la cara no mira hacia el observador, se usa la opuesta de la normal)
 	vec3 n;
@@ -212,10 +217,11 @@ vec3 DirectionalLight(vec4 texDiffuse)
 
 	return color;
 }
+#endif
 
+#if defined(SPOT_LIGHT)
 // - Calcular fuente luminosa spot
-subroutine(LightFunction)
-vec3 SpotLight(vec4 texDiffuse) 
+vec3 SpotLight(vec4 texDiffuse)
 {
 	vec3 l = normalize(lightPosition - position);
 	vec3 d = lightDirection;
@@ -300,10 +306,22 @@ vec3 SpotLight(vec4 texDiffuse)
 
 	return color;
 }
+#endif
+
+// - Funcin de la fuente luminosa de la permutacin
+#if defined(AMBIENT_LIGHT)
+#define LightFunction AmbientLight
+#elif defined(POINT_LIGHT)
+#define LightFunction PointLight
+#elif defined(DIRECTIONAL_LIGHT)
+#define LightFunction DirectionalLight
+#else
+#define LightFunction SpotLight
+#endif
 
 void main()
 {
 	vec4 texDiffuse = texture(TexSamplerDiffuse, texCoord);
 
-	FragColor = vec4(LightUniform(texDiffuse), 1.0);
+	FragColor = vec4(LightFunction(texDiffuse), 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,93 @@
+#version 400
+
+in vec2 texCoord;
+
+// - Normal en espacio de visin, profundidad e identificador del elemento de cada pxel (de la
+//   pre-pasada del contorno o del G-buffer, que no tiene identificadores)
+uniform sampler2D TexNormal;
+uniform sampler2D TexDepth;
+uniform sampler2D TexElementId;
+uniform bool useElementIds;
+uniform mat4 mInverseProjection;
+
+// - Contorno: color, grosor (pxeles) y umbrales de las discontinuidades
+uniform vec3 outlineColor;
+uniform int outlineThickness;
+uniform float depthThreshold;
+uniform float normalThreshold;
+
+layout (location = 0) out vec4 FragColor;
+
+// - Profundidad lineal (distancia al observador en espacio de visin) de un pxel
+float linearDepth(ivec2 pixel, vec2 size, float depth)
+{
+	vec2 uv = (vec2(pixel) + 0.5) / size;
+	vec4 viewPosition = mInverseProjection * vec4(vec3(uv, depth) * 2.0 - 1.0, 1.0);
+
+	return -viewPosition.z / viewPosition.w;
+}
+
+void main()
+{
+	ivec2 size = textureSize(TexDepth, 0);
+	ivec2 pixel = ivec2(texCoord * vec2(size));
+
+	// - El contorno se dibuja en el lado ms cercano de cada discontinuidad, as que los pxeles sin
+	//   geometra (fondo) no tienen contorno
+	float depth = texelFetch(TexDepth, pixel, 0).r;
+
+	if (depth >= 1.0)
+	{
+		discard;
+	}
+
+	float z = linearDepth(pixel, vec2(size), depth);
+	vec3 n = normalize(texelFetch(TexNormal, pixel, 0).xyz);
+	vec4 id = texelFetch(TexElementId, pixel, 0);
+
+	// - Vecinos a la distancia del grosor (en cruz)
+	ivec2 offsets[4] = ivec2[](ivec2(outlineThickness, 0), ivec2(-outlineThickness, 0),
+							   ivec2(0, outlineThickness), ivec2(0, -outlineThickness));
+
+	bool edge = false;
+
+	for (int i = 0; i < 4; i++)
+	{
+		ivec2 neighbour = clamp(pixel + offsets[i], ivec2(0), size - 1);
+		float neighbourDepth = texelFetch(TexDepth, neighbour, 0).r;
+		float neighbourZ = linearDepth(neighbour, vec2(size), neighbourDepth);
+
+		// - Discontinuidad de profundidad: el vecino est ms lejos (relativo a la distancia y al grosor)
+		if ((neighbourZ - z) > (depthThreshold * z * float(outlineThickness)))
+		{
+			edge = true;
+		}
+
+		// - El fondo slo produce discontinuidades de profundidad
+		if (neighbourDepth >= 1.0)
+		{
+			continue;
+		}
+
+		// - Discontinuidad de normal (pliegues)
+		vec3 neighbourNormal = normalize(texelFetch(TexNormal, neighbour, 0).xyz);
+
+		if ((1.0 - dot(n, neighbourNormal)) > normalThreshold)
+		{
+			edge = true;
+		}
+
+		// - Elementos distintos que se tocan (el contorno queda en el ms cercano)
+		if (useElementIds && (neighbourZ >= z) && any(notEqual(texelFetch(TexElementId, neighbour, 0), id)))
+		{
+			edge = true;
+		}
+	}
+
+	if (!edge)
+	{
+		discard;
+	}
+
+	FragColor = vec4(outlineColor, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,137 @@
+#version 410
+
+// - Contexto OpenGL 4.1: los compute shaders y los shader storage buffers (con su punto de enlace
+//   en el layout) se usan como extensiones
+#extension GL_ARB_compute_shader : require
+#extension GL_ARB_shader_storage_buffer_object : require
+#extension GL_ARB_shading_language_420pack : require
+
+// - Un hilo por tringulo (con sus ndices de adyacencia)
+layout (local_size_x = 64) in;
+
+// - Vrtices de la malla (posicin y normal, seis floats por vrtice)
+layout (std430, binding = 0) readonly buffer Vertices
+{
+	float vertices[];
+};
+
+// - ndices de adyacencia de la malla (seis por tringulo)
+layout (std430, binding = 1) readonly buffer AdjacencyIndices
+{
+	uint adjacencyIndices[];
+};
+
+// - Quads de la silueta: esquinas (coordenadas de recorte) y contorno (color y grosor)
+struct SilhouetteQuad
+{
+	vec4 corners[4];
+	vec4 outline;
+};
+
+layout (std430, binding = 2) writeonly buffer SilhouetteQuads
+{
+	SilhouetteQuad quads[];
+};
+
+// - Orden de dibujo indirecto: el nmero de vrtices (seis por quad) es el contador de quads
+layout (std430, binding = 3) buffer DrawCommand
+{
+	uint vertexCount;
+	uint instanceCount;
+	uint first;
+	uint baseInstance;
+};
+
+// - Desplazamientos (en elementos) de la malla en los buffers y nmero de tringulos
+uniform int vertexOffset;
+uniform int indexOffset;
+uniform int numTriangles;
+
+// - Quads que caben en el buffer
+uniform int maxQuads;
+
+// - Matrices de modelado y visin, y de proyeccin
+uniform mat4 mModelView;
+uniform mat4 mProjection;
+
+// - Color y grosor de la silueta
+uniform vec3 outlineColor;
+uniform float outlineThickness;
+
+// - Factor utilizado para extender los quads y juntar las lneas que forman la silueta
+uniform float lineExtension;
+
+// - Posicin en coordenadas de visin de un vrtice dado su ndice de adyacencia
+vec3 viewPosition(uint adjacency)
+{
+	uint vertex = uint(vertexOffset) + adjacencyIndices[uint(indexOffset) + adjacency] * 6u;
+	vec4 position = mModelView * vec4(vertices[vertex], vertices[vertex + 1u], vertices[vertex + 2u], 1.0);
+
+	return position.xyz / position.w;
+}
+
+// - Determinar si la cara del tringulo es visible calculando su rea
+bool isFrontFacing(vec3 a, vec3 b, vec3 c)
+{
+	float area = (a.x * b.y - b.x * a.y) + (b.x * c.y - c.x * b.y) + (c.x * a.y - a.x * c.y);
+
+	return area > 0;
+}
+
+// - Aadir el quad de la arista (como el geometry shader del contorno avanzado). Si el buffer est
+//   lleno, el contador sigue avanzando pero el quad no se escribe y no se dibuja
+void emitEdge(vec3 v0, vec3 v1)
+{
+	uint quad = atomicAdd(vertexCount, 6u) / 6u;
+
+	if (quad >= uint(maxQuads))
+	{
+		return;
+	}
+
+	vec3 vector = lineExtension * vec3(v1.xy - v0.xy, 0.0);
+	vec3 extrusion = vec3(-normalize(vector).y, normalize(vector).x, 0.0) * outlineThickness;
+
+	quads[quad].corners[0] = mProjection * vec4(v0 - extrusion - vector, 1.0);
+	quads[quad].corners[1] = mProjection * vec4(v0 + extrusion - vector, 1.0);
+	quads[quad].corners[2] = mProjection * vec4(v1 - extrusion + vector, 1.0);
+	quads[quad].corners[3] = mProjection * vec4(v1 + extrusion + vector, 1.0);
+	quads[quad].outline = vec4(outlineColor, outlineThickness);
+}
+
+void main()
+{
+	uint triangle = gl_GlobalInvocationID.x;
+
+	if (triangle >= uint(numTriangles))
+	{
+		return;
+	}
+
+	uint base = triangle * 6u;
+
+	vec3 v0 = viewPosition(base);
+	vec3 v1 = viewPosition(base + 1u);
+	vec3 v2 = viewPosition(base + 2u);
+	vec3 v3 = viewPosition(base + 3u);
+	vec3 v4 = viewPosition(base + 4u);
+	vec3 v5 = viewPosition(base + 5u);
+
+	if (isFrontFacing(v0, v2, v4))
+	{
+		if (!isFrontFacing(v0, v1, v2))
+		{
+			emitEdge(v0, v2);
+		}
+
+		if (!isFrontFacing(v2, v3, v4))
+		{
+			emitEdge(v2, v4);
+		}
+
+		if (!isFrontFacing(v4, v5, v0))
+		{
+			emitEdge(v4, v0);
+		}
+	}
+}
\ No newline at end of file
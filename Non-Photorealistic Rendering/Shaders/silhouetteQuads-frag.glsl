@@ -0,0 +1,24 @@
+#version 410
+
+in float dist;
+
+// - Contorno del quad (color y grosor, la mitad)
+flat in vec4 outline;
+
+layout(location = 0) out vec4 FragColor;
+
+void main()
+{
+	float thickness = outline.w;
+
+	float alpha = 1.0;
+	float absDist = abs(dist);
+	float tipLength = 2.0 * fwidth(absDist);
+
+	if (absDist > thickness - tipLength)
+	{
+		alpha = 1.0 - (absDist - thickness + tipLength) / tipLength; 
+	}
+
+    FragColor = vec4(outline.rgb, alpha);
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+#version 410
+
+// - Contexto OpenGL 4.1: los shader storage buffers (con su punto de enlace en el layout) se usan
+//   como extensiones
+#extension GL_ARB_shader_storage_buffer_object : require
+#extension GL_ARB_shading_language_420pack : require
+
+// - Quads de la silueta escritos por el compute shader
+struct SilhouetteQuad
+{
+	vec4 corners[4];
+	vec4 outline;
+};
+
+layout (std430, binding = 2) readonly buffer SilhouetteQuads
+{
+	SilhouetteQuad quads[];
+};
+
+// - Quads que caben en el buffer
+uniform int maxQuads;
+
+out float dist;
+flat out vec4 outline;
+
+// - Esquinas de los dos tringulos de cada quad (como la tira del geometry shader)
+const int CORNERS[6] = int[](0, 1, 2, 2, 1, 3);
+
+void main()
+{
+	int quad = gl_VertexID / 6;
+	int corner = CORNERS[gl_VertexID % 6];
+
+	// - Quads que no cupieron en el buffer: primitiva degenerada
+	if (quad >= maxQuads)
+	{
+		dist = 0.0;
+		outline = vec4(0.0);
+		gl_Position = vec4(0.0, 0.0, 0.0, 1.0);
+		return;
+	}
+
+	outline = quads[quad].outline;
+	dist = (corner % 2 == 0) ? outline.w : -outline.w;
+	gl_Position = quads[quad].corners[corner];
+}
\ No newline at end of file
@@ -0,0 +1,17 @@
+#version 400
+
+layout (location = 0) in vec3 vPosition;
+layout (location = 1) in vec3 vNormal;
+
+uniform mat4 mModelView;
+
+// - Vrtice en el espacio de visin, que se captura con transform feedback (con el formato de
+//   PosNorm). La normal se transforma igual que en los shaders de sombreado, que la normalizan
+out vec3 viewPosition;
+out vec3 viewNormal;
+
+void main()
+{
+	viewPosition = vec3(mModelView * vec4(vPosition, 1.0));
+	viewNormal = vec3(mModelView * vec4(vNormal, 0.0));
+}
\ No newline at end of file
@@ -0,0 +1,308 @@
+#include "SilhouetteClusters.h"
+
+#include <algorithm>
+#include <cmath>
+
+// - Margen de los conos, para no descartar grupos con caras casi de perfil
+static const float CONE_EPSILON = 1e-3f;
+
+// - Activacin y contadores (todas las mallas)
+bool SilhouetteClusters::enabled = true;
+SilhouetteClusterStatistics SilhouetteClusters::currentFrame;
+SilhouetteClusterStatistics SilhouetteClusters::lastFrame;
+
+// - Constructor
+SilhouetteClusters::SilhouetteClusters()
+{
+	numTriangles = 0;
+}
+
+// - Construir la jerarqua. Para cada tringulo se calculan las normales (sin normalizar, en el
+//   sentido de los vrtices, como el rea del shader) de su cara central y de sus tres vecinas.
+//   Los tringulos degenerados nunca son frontales y no aaden aristas, as que no acotan los conos;
+//   los de aristas frontera (cuya vecina es la propia cara invertida) o con vecinas degeneradas
+//   aaden aristas siempre que son frontales, as que sus grupos slo se descartan si son traseros
+size_t SilhouetteClusters::build(std::vector<unsigned int> &adjacencyIndices, const std::vector<PosNorm> &vertices)
+{
+	nodes.clear();
+	numTriangles = (unsigned int) adjacencyIndices.size() / 6;
+
+	if (numTriangles == 0)
+	{
+		return 0;
+	}
+
+	std::vector<glm::vec3> centerNormals(numTriangles);
+	std::vector<glm::vec3> faceNormals(numTriangles * 3);
+	std::vector<bool> closed(numTriangles);
+	std::vector<unsigned int> order(numTriangles);
+
+	for (unsigned int i = 0; i < numTriangles; i++)
+	{
+		const unsigned int *index = &adjacencyIndices[i * 6];
+		glm::vec3 p[6];
+
+		for (unsigned int j = 0; j < 6; j++)
+		{
+			p[j] = vertices[index[j]].position;
+		}
+
+		glm::vec3 normal = glm::cross(p[2] - p[0], p[4] - p[0]);
+		centerNormals[i] = glm::length(normal) > 0.f ? glm::normalize(normal) : glm::vec3(0.f);
+
+		glm::vec3 neighbours[3] = { glm::cross(p[1] - p[0], p[2] - p[0]),
+									glm::cross(p[3] - p[2], p[4] - p[2]),
+									glm::cross(p[5] - p[4], p[0] - p[4]) };
+
+		closed[i] = index[1] != index[4] && index[3] != index[0] && index[5] != index[2];
+
+		for (unsigned int j = 0; j < 3; j++)
+		{
+			closed[i] = closed[i] && glm::length(neighbours[j]) > 0.f;
+			faceNormals[i * 3 + j] = glm::length(neighbours[j]) > 0.f ? glm::normalize(neighbours[j]) : glm::vec3(0.f);
+		}
+
+		order[i] = i;
+	}
+
+	nodes.reserve(2 * (numTriangles / LEAF_TRIANGLES + 1));
+	buildNode(order, centerNormals, faceNormals, closed, 0, numTriangles);
+
+	// - Reordenar los tringulos de las adyacencias segn el orden de las hojas
+	std::vector<unsigned int> reordered(adjacencyIndices.size());
+
+	for (unsigned int i = 0; i < numTriangles; i++)
+	{
+		std::copy(adjacencyIndices.begin() + order[i] * 6, adjacencyIndices.begin() + order[i] * 6 + 6,
+				  reordered.begin() + i * 6);
+	}
+
+	adjacencyIndices.swap(reordered);
+
+	return sizeof(SilhouetteClusterNode) * nodes.capacity();
+}
+
+// - Mtodo privado: construir el nodo de un rango de tringulos. Los tringulos se separan por la
+//   mediana de la componente de su normal central con mayor extensin, as que cada hijo tiene
+//   normales ms parecidas (conos ms estrechos)
+int SilhouetteClusters::buildNode(std::vector<unsigned int> &order, const std::vector<glm::vec3> &centerNormals,
+								  const std::vector<glm::vec3> &faceNormals, const std::vector<bool> &closed,
+								  unsigned int first, unsigned int count)
+{
+	int position = (int) nodes.size();
+	nodes.push_back(SilhouetteClusterNode());
+
+	SilhouetteClusterNode node;
+	node.firstTriangle = first;
+	node.numTriangles = count;
+	node.children[0] = node.children[1] = -1;
+
+	// - Conos del nodo: normales de los tringulos no degenerados
+	std::vector<glm::vec3> centers;
+	std::vector<glm::vec3> faces;
+	bool allClosed = true;
+	glm::vec3 minNormal(1.f), maxNormal(-1.f);
+
+	for (unsigned int i = first; i < first + count; i++)
+	{
+		unsigned int triangle = order[i];
+
+		if (centerNormals[triangle] == glm::vec3(0.f))
+		{
+			continue;
+		}
+
+		centers.push_back(centerNormals[triangle]);
+		faces.push_back(centerNormals[triangle]);
+		faces.insert(faces.end(), faceNormals.begin() + triangle * 3, faceNormals.begin() + triangle * 3 + 3);
+		allClosed = allClosed && closed[triangle];
+
+		minNormal = glm::min(minNormal, centerNormals[triangle]);
+		maxNormal = glm::max(maxNormal, centerNormals[triangle]);
+	}
+
+	// - Sin tringulos no degenerados, el nodo nunca tiene aristas de la silueta (cono vaco)
+	if (centers.empty())
+	{
+		node.centerCone.valid = true;
+		node.centerCone.sinAngle = -1.f;
+	}
+	else
+	{
+		node.centerCone = computeCone(centers);
+
+		if (allClosed)
+		{
+			node.faceCone = computeCone(faces);
+		}
+	}
+
+	// - Hijos
+	if (count > LEAF_TRIANGLES && !centers.empty())
+	{
+		glm::vec3 extent = maxNormal - minNormal;
+		int axis = (extent.x >= extent.y && extent.x >= extent.z) ? 0 : (extent.y >= extent.z ? 1 : 2);
+		unsigned int half = count / 2;
+
+		std::nth_element(order.begin() + first, order.begin() + first + half, order.begin() + first + count,
+						 [&centerNormals, axis](unsigned int a, unsigned int b)
+		{
+			return centerNormals[a][axis] < centerNormals[b][axis];
+		});
+
+		node.children[0] = buildNode(order, centerNormals, faceNormals, closed, first, half);
+		node.children[1] = buildNode(order, centerNormals, faceNormals, closed, first + half, count - half);
+	}
+
+	nodes[position] = node;
+
+	return position;
+}
+
+// - Mtodo privado: cono que contiene unas normales. El eje es la media de las normales y el
+//   semingulo el de la normal ms separada
+NormalCone SilhouetteClusters::computeCone(const std::vector<glm::vec3> &normals)
+{
+	NormalCone cone;
+	glm::vec3 sum(0.f);
+
+	for (const glm::vec3 &normal : normals)
+	{
+		sum += normal;
+	}
+
+	if (glm::length(sum) < 1e-6f)
+	{
+		return cone;
+	}
+
+	cone.axis = glm::normalize(sum);
+	float minDot = 1.f;
+
+	for (const glm::vec3 &normal : normals)
+	{
+		minDot = std::min(minDot, glm::dot(cone.axis, normal));
+	}
+
+	if (minDot <= CONE_EPSILON)
+	{
+		return cone;
+	}
+
+	cone.sinAngle = std::sqrt(std::max(0.f, 1.f - minDot * minDot));
+	cone.valid = true;
+
+	return cone;
+}
+
+// - Mtodo privado: un nodo no tiene aristas de la silueta si todas sus normales centrales forman
+//   ms de 90 con la direccin de visin (caras traseras) o si todas sus caras forman menos de 90
+//   (frontales, sin vecinas traseras)
+bool SilhouetteClusters::canCull(const SilhouetteClusterNode &node, const glm::vec3 &viewDirection)
+{
+	if (node.centerCone.valid && glm::dot(node.centerCone.axis, viewDirection) < -(node.centerCone.sinAngle + CONE_EPSILON))
+	{
+		return true;
+	}
+
+	if (node.faceCone.valid && glm::dot(node.faceCone.axis, viewDirection) > node.faceCone.sinAngle + CONE_EPSILON)
+	{
+		return true;
+	}
+
+	return false;
+}
+
+// - Mtodo privado: recorrer un nodo. Los rangos seguidos se juntan en uno
+void SilhouetteClusters::collect(int node, const glm::vec3 &viewDirection, std::vector<IndexRange> &ranges)
+{
+	const SilhouetteClusterNode &current = nodes[node];
+	currentFrame.nodesVisited++;
+
+	if (canCull(current, viewDirection))
+	{
+		currentFrame.trianglesCulled += current.numTriangles;
+		return;
+	}
+
+	if (current.children[0] < 0)
+	{
+		unsigned int firstIndex = current.firstTriangle * 6;
+
+		if (!ranges.empty() && ranges.back().firstIndex + ranges.back().count == firstIndex)
+		{
+			ranges.back().count += current.numTriangles * 6;
+		}
+		else
+		{
+			ranges.push_back(IndexRange(firstIndex, current.numTriangles * 6));
+		}
+
+		return;
+	}
+
+	collect(current.children[0], viewDirection, ranges);
+	collect(current.children[1], viewDirection, ranges);
+}
+
+// - Saber si se ha construido la jerarqua
+bool SilhouetteClusters::isBuilt()
+{
+	return !nodes.empty();
+}
+
+// - Rangos de ndices que pueden tener aristas de la silueta (todos si la jerarqua est desactivada)
+void SilhouetteClusters::select(const glm::vec3 &viewDirection, std::vector<IndexRange> &ranges)
+{
+	ranges.clear();
+	currentFrame.trianglesTested += numTriangles;
+
+	if (!enabled || nodes.empty())
+	{
+		ranges.push_back(IndexRange(0, numTriangles * 6));
+		return;
+	}
+
+	collect(0, viewDirection, ranges);
+}
+
+// - Direccin de visin en el espacio del modelo. El shader calcula el rea de cada cara con las
+//   coordenadas x e y de visin, que es la componente z de su normal en visin: con M la parte 3x3
+//   de la matriz de modelado y visin, esa componente es dot(n, det(M) * inversa(M) * (0, 0, 1))
+glm::vec3 SilhouetteClusters::getViewDirection(const glm::mat4 &mModelView)
+{
+	glm::mat3 m(mModelView);
+	float determinant = glm::determinant(m);
+
+	if (determinant == 0.f)
+	{
+		return glm::vec3(0.f);
+	}
+
+	return glm::normalize(determinant * (glm::inverse(m) * glm::vec3(0.f, 0.f, 1.f)));
+}
+
+// - Activar/desactivar la jerarqua
+void SilhouetteClusters::setEnabled(bool enabled)
+{
+	SilhouetteClusters::enabled = enabled;
+}
+
+// - Saber si la jerarqua est activada
+bool SilhouetteClusters::isEnabled()
+{
+	return enabled;
+}
+
+// - Inicio de frame: los contadores del frame en curso pasan a ser los del ltimo frame
+void SilhouetteClusters::beginFrame()
+{
+	lastFrame = currentFrame;
+	currentFrame = SilhouetteClusterStatistics();
+}
+
+// - Obtener contadores del ltimo frame completado
+const SilhouetteClusterStatistics& SilhouetteClusters::getLastFrame()
+{
+	return lastFrame;
+}
\ No newline at end of file
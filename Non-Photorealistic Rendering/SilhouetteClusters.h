@@ -0,0 +1,116 @@
+#pragma once
+
+#include <glm.hpp>
+#include <vector>
+
+#include "Structures.h"
+#include "GeometryStore.h"
+
+// - Cono de normales: eje y seno del semingulo (no es vlido si las normales se separan 90 o ms
+//   del eje, o si alguna cara no puede acotarse)
+struct NormalCone
+{
+	glm::vec3 axis;
+	float sinAngle;
+	bool valid;
+
+	NormalCone()
+	{
+		this->axis = glm::vec3(0.f);
+		this->sinAngle = 1.f;
+		this->valid = false;
+	}
+};
+
+// - Nodo de la jerarqua: tringulos (de adyacencias) que cubre, conos de las normales de sus
+//   tringulos centrales y de todas sus caras (centrales y vecinas), e hijos (-1 en las hojas)
+struct SilhouetteClusterNode
+{
+	unsigned int firstTriangle;
+	unsigned int numTriangles;
+	NormalCone centerCone;
+	NormalCone faceCone;
+	int children[2];
+};
+
+// - Contadores de la bsqueda de siluetas del ltimo frame (tringulos de adyacencias recorridos y
+//   descartados por la jerarqua)
+struct SilhouetteClusterStatistics
+{
+	unsigned int trianglesTested;
+	unsigned int trianglesCulled;
+	unsigned int nodesVisited;
+
+	SilhouetteClusterStatistics()
+	{
+		this->trianglesTested = 0;
+		this->trianglesCulled = 0;
+		this->nodesVisited = 0;
+	}
+};
+
+// - La clase SilhouetteClusters es una jerarqua de grupos de tringulos de adyacencias de una malla
+//   (un nivel de detalle), agrupados por la direccin de su normal, con un cono de normales por nodo.
+//   El contorno avanzado decide si una cara es frontal por el signo de su normal en coordenadas de
+//   visin, as que slo depende de la direccin de visin en el espacio del modelo: un grupo no
+//   puede tener aristas de la silueta si todos sus tringulos centrales son traseros, o si todas sus
+//   caras (centrales y vecinas) son frontales, y esto se comprueba con los conos de todo el grupo.
+//   Al construirla se reordenan los tringulos de las adyacencias para que cada nodo sea un rango
+//   seguido de ndices: en cada frame se recorre la jerarqua descartando subrboles completos y se
+//   dibujan (o se buscan en el compute shader) slo los rangos que pueden tener siluetas
+class SilhouetteClusters
+{
+private:
+	// - Nodos (el 0 es la raz) y nmero de tringulos
+	std::vector<SilhouetteClusterNode> nodes;
+	unsigned int numTriangles;
+
+	// - Activacin y contadores (todas las mallas)
+	static bool enabled;
+	static SilhouetteClusterStatistics currentFrame;
+	static SilhouetteClusterStatistics lastFrame;
+
+	// - Construir el nodo de un rango de tringulos (reordena order) y devolver su posicin
+	int buildNode(std::vector<unsigned int> &order, const std::vector<glm::vec3> &centerNormals,
+				  const std::vector<glm::vec3> &faceNormals, const std::vector<bool> &closed,
+				  unsigned int first, unsigned int count);
+
+	// - Cono que contiene un conjunto de normales (unitarias)
+	static NormalCone computeCone(const std::vector<glm::vec3> &normals);
+
+	// - Saber si un nodo no puede tener aristas de la silueta con una direccin de visin
+	static bool canCull(const SilhouetteClusterNode &node, const glm::vec3 &viewDirection);
+
+	// - Recorrer un nodo aadiendo los rangos de ndices que pueden tener siluetas
+	void collect(int node, const glm::vec3 &viewDirection, std::vector<IndexRange> &ranges);
+
+public:
+	// - Tringulos mximos por hoja
+	static const unsigned int LEAF_TRIANGLES = 128;
+
+	// - Constructor
+	SilhouetteClusters();
+
+	// - Construir la jerarqua de unos ndices de adyacencia (seis por tringulo), reordenando sus
+	//   tringulos. Devuelve la memoria reservada para los nodos
+	size_t build(std::vector<unsigned int> &adjacencyIndices, const std::vector<PosNorm> &vertices);
+
+	// - Saber si se ha construido
+	bool isBuilt();
+
+	// - Rangos de ndices (relativos al principio de las adyacencias) que pueden tener aristas de la
+	//   silueta con una direccin de visin (en el espacio del modelo)
+	void select(const glm::vec3 &viewDirection, std::vector<IndexRange> &ranges);
+
+	// - Direccin de visin en el espacio del modelo para la que el contorno avanzado considera
+	//   frontales las caras cuya normal forma con ella menos de 90
+	static glm::vec3 getViewDirection(const glm::mat4 &mModelView);
+
+	// - Activar la jerarqua (desactivada, se recorren todos los tringulos)
+	static void setEnabled(bool enabled);
+	static bool isEnabled();
+
+	// - Contadores: inicio de frame y contadores del ltimo frame completado
+	static void beginFrame();
+	static const SilhouetteClusterStatistics& getLastFrame();
+};
\ No newline at end of file
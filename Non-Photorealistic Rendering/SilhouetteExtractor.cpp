@@ -0,0 +1,142 @@
+#include "SilhouetteExtractor.h"
+#include "GLStateCache.h"
+
+#include <iostream>
+
+// - Orden de dibujo indirecto (glDrawArraysIndirect)
+struct DrawArraysCommand
+{
+	GLuint count;
+	GLuint instanceCount;
+	GLuint first;
+	GLuint baseInstance;
+};
+
+// - Constructor: los buffers slo se crean si el driver admite las extensiones que usan los shaders
+//   y la pasada (glMemoryBarrier es de GL_ARB_shader_image_load_store)
+SilhouetteExtractor::SilhouetteExtractor()
+{
+	supported = (GLEW_VERSION_4_3 || (GLEW_ARB_compute_shader && GLEW_ARB_shader_storage_buffer_object &&
+				 GLEW_ARB_shading_language_420pack && GLEW_ARB_shader_image_load_store)) ? true : false;
+
+	quadBuffer = 0;
+	commandBuffer = 0;
+	emptyVertexArray = 0;
+
+	if (!supported)
+	{
+		std::cout << "Compute shaders not supported by the driver: advanced outline uses the geometry shader" << std::endl;
+		return;
+	}
+
+	// - Quads: cuatro esquinas y contorno (color y grosor), cinco vec4 por quad
+	glGenBuffers(1, &quadBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, quadBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(glm::vec4) * 5 * MAX_QUADS, NULL, GL_DYNAMIC_COPY);
+
+	glGenBuffers(1, &commandBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, commandBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(DrawArraysCommand), NULL, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	glGenVertexArrays(1, &emptyVertexArray);
+
+	computeShader.defineShaderProgram("Shaders/silhouette", COMPUTE_SHADER);
+	drawShader.defineShaderProgram("Shaders/silhouetteQuads");
+}
+
+// - Destructor
+SilhouetteExtractor::~SilhouetteExtractor()
+{
+	if (!supported)
+	{
+		return;
+	}
+
+	glDeleteBuffers(1, &quadBuffer);
+	glDeleteBuffers(1, &commandBuffer);
+	GLStateCache::getInstance()->forgetVertexArray(emptyVertexArray);
+	glDeleteVertexArrays(1, &emptyVertexArray);
+}
+
+// - Saber si el driver admite los compute shaders
+bool SilhouetteExtractor::isSupported()
+{
+	return supported;
+}
+
+// - Pedir los shader programs
+bool SilhouetteExtractor::request(bool wait)
+{
+	if (!supported)
+	{
+		return false;
+	}
+
+	bool ready = computeShader.request(wait);
+	ready = drawShader.request(wait) && ready;
+
+	return ready;
+}
+
+// - Empezar una pasada
+ShaderProgram& SilhouetteExtractor::begin()
+{
+	// - Reiniciar la orden de dibujo: ningn vrtice, una instancia
+	DrawArraysCommand command = { 0, 1, 0, 0 };
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, commandBuffer);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(DrawArraysCommand), &command);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, QUAD_BINDING, quadBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, COMMAND_BINDING, commandBuffer);
+
+	computeShader.use();
+	computeShader.setUniform("maxQuads", (GLint) MAX_QUADS);
+
+	return computeShader;
+}
+
+// - Buscar las siluetas de una malla. Los buffers de la arena se enlazan completos y los
+//   desplazamientos se pasan en elementos (floats e ndices), ya que no tienen por qu cumplir el
+//   alineamiento de los shader storage buffers
+void SilhouetteExtractor::dispatch(ShaderProgram &shader, GLuint vertexBuffer, size_t vertexOffset,
+								   GLuint indexBuffer, size_t indexOffset, unsigned int numTriangles)
+{
+	if (numTriangles == 0)
+	{
+		return;
+	}
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, VERTEX_BINDING, vertexBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, INDEX_BINDING, indexBuffer);
+
+	shader.setUniform("vertexOffset", (GLint) (vertexOffset / sizeof(GLfloat)));
+	shader.setUniform("indexOffset", (GLint) (indexOffset / sizeof(GLuint)));
+	shader.setUniform("numTriangles", (GLint) numTriangles);
+
+	glDispatchCompute((numTriangles + WORK_GROUP_SIZE - 1) / WORK_GROUP_SIZE, 1, 1);
+}
+
+// - Terminar la pasada: los quads y el contador escritos por los compute shaders deben estar
+//   disponibles para el vertex shader y para la orden indirecta (y para reiniciar el contador)
+void SilhouetteExtractor::draw()
+{
+	if (!supported)
+	{
+		return;
+	}
+
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+
+	drawShader.use();
+	drawShader.setUniform("maxQuads", (GLint) MAX_QUADS);
+
+	GLStateCache::getInstance()->bindVertexArray(emptyVertexArray);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, QUAD_BINDING, quadBuffer);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+
+	glDrawArraysIndirect(GL_TRIANGLES, NULL);
+
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
\ No newline at end of file
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include "ShaderProgram.h"
+
+// - La clase SilhouetteExtractor es la alternativa al geometry shader del contorno avanzado: un
+//   compute shader recorre los ndices de adyacencia de cada malla (un hilo por tringulo), busca
+//   las aristas de la silueta y aade sus quads extruidos a un buffer con un contador atmico, que
+//   es el nmero de vrtices de una orden de dibujo indirecto. Al terminar todas las mallas, los
+//   quads se dibujan con una sola llamada a glDrawArraysIndirect, sin leer el contador en la CPU.
+//   Necesita OpenGL 4.3 o las extensiones de compute shaders, shader storage buffers, puntos de
+//   enlace en el layout (420pack) y barreras de memoria (el contexto es 4.1, y los shaders piden
+//   las extensiones con #extension): si el driver no las ofrece, el contorno avanzado usa el
+//   geometry shader
+class SilhouetteExtractor
+{
+private:
+	// - Soporte del driver
+	bool supported;
+
+	// - Buffers de los quads y de la orden de dibujo indirecto (con el contador)
+	GLuint quadBuffer;
+	GLuint commandBuffer;
+
+	// - VAO vaco (los vrtices de los quads se leen del buffer en el vertex shader)
+	GLuint emptyVertexArray;
+
+	// - Shader programs: bsqueda de siluetas (compute) y dibujado de los quads
+	ShaderProgram computeShader;
+	ShaderProgram drawShader;
+
+public:
+	// - Puntos de enlace de los shader storage buffers
+	static const GLuint VERTEX_BINDING = 0;
+	static const GLuint INDEX_BINDING = 1;
+	static const GLuint QUAD_BINDING = 2;
+	static const GLuint COMMAND_BINDING = 3;
+
+	// - Quads que caben en el buffer por pasada (las aristas que no caben no se dibujan) y tamao de
+	//   los grupos de trabajo del compute shader
+	static const unsigned int MAX_QUADS = 131072;
+	static const unsigned int WORK_GROUP_SIZE = 64;
+
+	// - Constructor
+	SilhouetteExtractor();
+
+	// - Destructor
+	~SilhouetteExtractor();
+
+	// - Saber si el driver admite los compute shaders
+	bool isSupported();
+
+	// - Pedir los shader programs (compilacin bajo demanda). Devuelve true cuando estn listos
+	bool request(bool wait);
+
+	// - Empezar una pasada: reiniciar el contador y activar el compute shader, que las mallas usan
+	//   para lanzar la bsqueda (con los uniforms del contorno de su elemento)
+	ShaderProgram& begin();
+
+	// - Buscar las siluetas de una malla: enlazar sus vrtices e ndices de adyacencia (buffers y
+	//   desplazamientos en bytes) y lanzar un hilo por tringulo
+	static void dispatch(ShaderProgram &shader, GLuint vertexBuffer, size_t vertexOffset,
+						 GLuint indexBuffer, size_t indexOffset, unsigned int numTriangles);
+
+	// - Terminar la pasada: esperar a los compute shaders y dibujar los quads
+	void draw();
+};
\ No newline at end of file
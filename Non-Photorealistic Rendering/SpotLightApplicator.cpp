@@ -27,7 +27,10 @@ void SpotLightApplicator::apply(ShaderProgram &shader, LightSource *light)
 	shader.setUniform("constant", 1.f);
 	shader.setUniform("linear", 0.f);
 	shader.setUniform("quadratic", 0.f);
+}
 
-	// - Utilizar subrutina
-	shader.setSubroutine("LightUniform", "SpotLight", GL_FRAGMENT_SHADER, 1);
+// - Obtener variante de los shader programs para la luz spot
+ShaderProgramVariant SpotLightApplicator::getVariant()
+{
+	return SPOT_LIGHT_VARIANT;
 }
\ No newline at end of file
@@ -9,6 +9,15 @@ struct PosNorm
 	glm::vec3 normal;
 };
 
+// - Estructura VBO de atributos de instancia (dibujado instanciado). Los parmetros negativos indican
+//   que se usan los del modelo
+struct InstanceData
+{
+	glm::mat4 modelMatrix;	// - Matriz de modelado (atributos 5-8)
+	glm::vec4 outline;		// - Color y grosor del contorno (atributo 9)
+	glm::vec4 celShading;	// - Tonos y factor de silueta de Cel-Shading (atributo 10)
+};
+
 
 // - Estructura de datos Half-Edge
 
@@ -79,6 +88,69 @@ struct AdvancedOutline
 	}
 };
 
+// - Contorno en espacio de pantalla: color, grosor (pxeles) y umbrales de las discontinuidades de
+//   profundidad (diferencia relativa a la distancia por pxel) y de normal (1 - coseno del ngulo)
+struct ScreenSpaceOutline
+{
+	glm::vec3 color;
+	int thickness;
+	float depthThreshold;
+	float normalThreshold;
+
+	ScreenSpaceOutline()
+	{
+		this->color = glm::vec3(0.f);
+		this->thickness = 1;
+		this->depthThreshold = 0.02f;
+		this->normalThreshold = 0.3f;
+	}
+};
+
+// - Exportacin de lneas vectoriales (SVG/PDF): tipos de aristas, ngulo diedro mnimo de los
+//   pliegues (grados) y tolerancia relativa de la prueba de profundidad
+struct LineArtSettings
+{
+	bool silhouettes;
+	bool creases;
+	bool boundaries;
+	float creaseAngle;
+	float depthTolerance;
+
+	LineArtSettings()
+	{
+		this->silhouettes = true;
+		this->creases = true;
+		this->boundaries = true;
+		this->creaseAngle = 60.f;
+		this->depthTolerance = 0.01f;
+	}
+};
+
+// - Aristas caractersticas (independientes de la vista): activacin, color y grosor (pxeles) de
+//   las lneas, y tipos de arista que se extraen: pliegues (ngulo diedro mnimo, en grados),
+//   costuras de coordenadas de textura, cambios de material y fronteras
+struct FeatureEdgeSettings
+{
+	bool enabled;
+	glm::vec3 color;
+	float width;
+	float creaseAngle;
+	bool uvSeams;
+	bool materialBoundaries;
+	bool boundaries;
+
+	FeatureEdgeSettings()
+	{
+		this->enabled = false;
+		this->color = glm::vec3(0.f);
+		this->width = 1.5f;
+		this->creaseAngle = 40.f;
+		this->uvSeams = true;
+		this->materialBoundaries = true;
+		this->boundaries = true;
+	}
+};
+
 // - Tcnica monocromo
 struct MonochromeTechnique
 {
@@ -212,6 +284,8 @@ struct CharcoalTechnique
 {
 	bool sobelFilter;
 	float threshold;
+	bool depthEdges;
+	float depthThreshold;
 	glm::vec3 edgeColor;
 	float colorMultiplier;
 	float noise;
@@ -220,6 +294,8 @@ struct CharcoalTechnique
 	{
 		this->sobelFilter = true;
 		this->threshold = 0.025f;
+		this->depthEdges = true;
+		this->depthThreshold = 0.1f;
 		this->edgeColor = glm::vec3(0.2f);
 		this->colorMultiplier = 3.f;
 		this->noise = 0.3f;
@@ -274,4 +350,17 @@ struct PixelArtTechnique
 		this->numHorizontalPixels = 200.f;
 		this->numVerticalPixels = 200.f;
 	}
+};
+
+// - Memoria ocupada por un recurso en la GPU y en CPU (bytes)
+struct MemoryUsage
+{
+	size_t gpuBytes;
+	size_t hostBytes;
+
+	MemoryUsage()
+	{
+		this->gpuBytes = 0;
+		this->hostBytes = 0;
+	}
 };
\ No newline at end of file
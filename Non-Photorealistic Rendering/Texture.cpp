@@ -1,10 +1,13 @@
 #include "Texture.h"
 #include "lodepng.h"
+#include "GLStateCache.h"
+#include "LoadProfiler.h"
 
 // - Constructor por defecto
 Texture::Texture()
 {
 	texture = 0;
+	gpuBytes = 0;
 	glGenTextures(1, &texture);
 }
 
@@ -12,6 +15,7 @@ Texture::Texture()
 Texture::Texture(std::string type, std::string path)
 {
 	texture = 0;
+	gpuBytes = 0;
 	glGenTextures(1, &texture);
 
 	this->type = type;
@@ -21,6 +25,7 @@ Texture::Texture(std::string type, std::string path)
 // - Destructor
 Texture::~Texture()
 {
+	GLStateCache::getInstance()->forgetTexture(texture);
 	glDeleteTextures(1, &texture);
 }
 
@@ -28,7 +33,9 @@ Texture::~Texture()
 void Texture::loadImage(const char *path, bool invertImage)
 {
 	/** Carga un png de disco https://lodev.org/lodepng/ */
+	LoadPhaseTimer decodeTimer("Texture decode");
 	unsigned error = lodepng::decode(image, width, height, path);
+	decodeTimer.stop(image.size());
 
 	if (error)
 	{
@@ -71,7 +78,9 @@ void Texture::loadImage(const char *path, const std::string &directory, bool inv
 	filename = directory + '/' + filename;
 
 	/** Carga un png de disco https://lodev.org/lodepng/ */
+	LoadPhaseTimer decodeTimer("Texture decode");
 	unsigned error = lodepng::decode(image, width, height, filename);
+	decodeTimer.stop(image.size());
 
 	if (error)
 	{
@@ -119,10 +128,16 @@ void Texture::defineTexture(GLenum target,
 	glTexParameteri(target, wrapS, paramWrap);
 	glTexParameteri(target, wrapT, paramWrap);
 
+	LoadPhaseTimer uploadTimer("glTexImage2D + glGenerateMipmap");
+
 	glTexImage2D(target, level, internalFormat, width, height, border, format, type, image.data());
 
 	// - Generar Mipmap automticamente
 	glGenerateMipmap(target);
+
+	// - La cadena de mipmaps ocupa aproximadamente un tercio ms que el nivel base
+	gpuBytes = image.size() + image.size() / 3;
+	uploadTimer.stop(gpuBytes);
 }
 
 // - Definir una textura dados sus parmetros (CubeMap)
@@ -139,24 +154,30 @@ void Texture::defineTexture(GLenum target, GLenum targetImage,
 	glTexParameteri(target, wrapT, paramWrap);
 	glTexParameteri(target, wrapR, paramWrap);
 
+	LoadPhaseTimer uploadTimer("glTexImage2D (cubemap face)");
 	glTexImage2D(targetImage, level, internalFormat, width, height, border, format, type, image.data());
+	gpuBytes += image.size();
+	uploadTimer.stop(image.size());
 }
 
 
-// - Enlazar unidad de textura
+// - Enlazar unidad de textura (la cach de estado evita enlazar otra vez la textura que ya tiene)
 void Texture::bindTexture(GLenum target, unsigned int unit)
 {
-	if (unit >= 0 && unit <= 47)
-	{
-		glActiveTexture(GL_TEXTURE0 + unit);
-		glBindTexture(target, texture);
-	}
+	GLStateCache::getInstance()->bindTexture(target, unit, texture);
 }
 
-// - Desenlazar unidad de textura
+// - Desenlazar unidad de textura (la unidad activa)
 void Texture::unbindTexture(GLenum target)
 {
-	glBindTexture(target, 0);
+	GLStateCache *stateCache = GLStateCache::getInstance();
+	stateCache->bindTexture(target, stateCache->getActiveUnit(), 0);
+}
+
+// - Obtener identificador de la textura
+GLuint Texture::getId()
+{
+	return texture;
 }
 
 // - Obtener imagen (en vector de char)
@@ -189,6 +210,24 @@ std::string Texture::getPath()
 	return path;
 }
 
+// - Obtener memoria ocupada en la GPU
+size_t Texture::getGPUMemory()
+{
+	return gpuBytes;
+}
+
+// - Obtener memoria ocupada por la imagen decodificada
+size_t Texture::getHostMemory()
+{
+	return image.capacity();
+}
+
+// - Liberar la imagen decodificada (la textura de la GPU no cambia)
+void Texture::releaseImage()
+{
+	std::vector<unsigned char>().swap(image);
+}
+
 // - Asignar tipo de la textura
 void Texture::setType(std::string type)
 {
@@ -16,6 +16,9 @@ private:
 	unsigned width;
 	unsigned height;
 
+	// - Memoria ocupada en la GPU por los niveles definidos
+	size_t gpuBytes;
+
 	// - Tipo de la textura
 	std::string type;
 
@@ -59,6 +62,7 @@ public:
 	void unbindTexture(GLenum target);
 
 	// - Getters
+	GLuint getId();
 	std::vector<unsigned char> getImage();
 	unsigned getWidth();
 	unsigned getHeight();
@@ -66,6 +70,13 @@ public:
 	std::string getType();
 	std::string getPath();
 
+	// - Memoria ocupada en la GPU y en CPU (imagen decodificada)
+	size_t getGPUMemory();
+	size_t getHostMemory();
+
+	// - Liberar la imagen decodificada una vez subida a la GPU
+	void releaseImage();
+
 	// - Setters
 	void setType(std::string type);
 	void setPath(std::string path);
@@ -0,0 +1,181 @@
+#include "TransformCache.h"
+
+// - Singleton (inicializacin perezosa)
+TransformCache* TransformCache::instance = nullptr;
+
+// - Constructor. El buffer empieza vaco: crece al terminar el primer frame con la cach activada
+TransformCache::TransformCache()
+{
+	enabled = false;
+
+	buffer = 0;
+	glGenBuffers(1, &buffer);
+	capacity = 0;
+	required = 0;
+	used = 0;
+
+	frame = 1;
+	view = glm::mat4(1.f);
+
+	numMeshes = 0;
+	numVertices = 0;
+
+	// - Los vrtices transformados se capturan entrelazados, con el formato de PosNorm
+	captureShader.setFeedbackVaryings({ "viewPosition", "viewNormal" });
+	captureShader.defineShaderProgram("Shaders/transformCache", TRANSFORM_FEEDBACK);
+}
+
+// - Destructor
+TransformCache::~TransformCache()
+{
+	glDeleteBuffers(1, &buffer);
+}
+
+// - Acceder al singleton
+TransformCache* TransformCache::getInstance()
+{
+	if (instance == nullptr)
+	{
+		instance = new TransformCache();
+	}
+
+	return instance;
+}
+
+// - Activar o desactivar la cach. Al desactivarla se invalida, para que los modelos no usen los
+//   vrtices de un frame anterior al volver a activarla
+void TransformCache::setEnabled(bool enabled)
+{
+	if (!enabled)
+	{
+		invalidate();
+	}
+
+	this->enabled = enabled;
+}
+
+// - Saber si la cach est activada
+bool TransformCache::isEnabled()
+{
+	return enabled;
+}
+
+// - Pedir el shader program de la transformacin
+bool TransformCache::request(bool wait)
+{
+	return captureShader.request(wait);
+}
+
+// - Empezar la transformacin del frame. El buffer se ampla con margen (una cuarta parte ms) para
+//   no volver a reservarlo en cada frame mientras aparecen mallas
+ShaderProgram& TransformCache::begin(const glm::mat4 &view)
+{
+	if (required > capacity)
+	{
+		capacity = required + required / 4;
+
+		glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, buffer);
+		glBufferData(GL_TRANSFORM_FEEDBACK_BUFFER, capacity, nullptr, GL_DYNAMIC_COPY);
+		glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, 0);
+	}
+
+	this->view = view;
+	frame++;
+	required = 0;
+	used = 0;
+	numMeshes = 0;
+	numVertices = 0;
+
+	// - Slo se capturan los vrtices: no se rasteriza ningn fragmento
+	glEnable(GL_RASTERIZER_DISCARD);
+	captureShader.use();
+
+	return captureShader;
+}
+
+// - Reservar un rango del buffer. El tamao necesario se acumula aunque no quepa, para ampliar el
+//   buffer en el siguiente frame
+bool TransformCache::allocate(unsigned int numVertices, size_t &offset)
+{
+	size_t bytes = sizeof(PosNorm) * numVertices;
+	required += bytes;
+
+	if (used + bytes > capacity)
+	{
+		return false;
+	}
+
+	offset = used;
+	used += bytes;
+
+	return true;
+}
+
+// - Transformar los vrtices de un VAO: se dibujan como puntos y el vertex shader escribe la
+//   posicin y la normal en el espacio de visin en el rango del buffer
+void TransformCache::capture(VAO *vao, unsigned int numVertices, size_t offset)
+{
+	if (numVertices == 0)
+	{
+		return;
+	}
+
+	glBindBufferRange(GL_TRANSFORM_FEEDBACK_BUFFER, 0, buffer, offset, sizeof(PosNorm) * numVertices);
+	glBeginTransformFeedback(GL_POINTS);
+	vao->drawPoints(numVertices);
+	glEndTransformFeedback();
+
+	this->numMeshes++;
+	this->numVertices += numVertices;
+}
+
+// - Terminar la transformacin del frame: desenlazar el buffer y volver a rasterizar
+void TransformCache::end()
+{
+	glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+	glDisable(GL_RASTERIZER_DISCARD);
+}
+
+// - Invalidar la cach: las mallas transformadas en frames anteriores dejan de ser vlidas
+void TransformCache::invalidate()
+{
+	frame++;
+	numMeshes = 0;
+	numVertices = 0;
+}
+
+// - Saber si la cach es vlida para una matriz de visin
+bool TransformCache::isValid(const glm::mat4 &view)
+{
+	return enabled && this->view == view;
+}
+
+// - Obtener frame de la cach
+unsigned int TransformCache::getFrame()
+{
+	return frame;
+}
+
+// - Obtener buffer de los vrtices transformados
+GLuint TransformCache::getBuffer()
+{
+	return buffer;
+}
+
+// - Obtener nmero de mallas transformadas en el frame actual
+unsigned int TransformCache::getNumMeshes()
+{
+	return numMeshes;
+}
+
+// - Obtener nmero de vrtices transformados en el frame actual
+unsigned int TransformCache::getNumVertices()
+{
+	return numVertices;
+}
+
+// - Obtener memoria del buffer (en bytes)
+size_t TransformCache::getCapacity()
+{
+	return capacity;
+}
\ No newline at end of file
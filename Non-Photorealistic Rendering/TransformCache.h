@@ -0,0 +1,92 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm.hpp>
+
+#include "ShaderProgram.h"
+#include "VAO.h"
+
+// - La clase TransformCache transforma una vez por frame los vrtices de las mallas visibles al
+//   espacio de visin (posicin y normal, con el formato de PosNorm) y los guarda en un buffer con
+//   transform feedback: un vertex shader sin rasterizacin recorre los vrtices de cada malla como
+//   puntos. Las pasadas del frame (sombreado de cada fuente luminosa, pre-pasadas y contornos) leen
+//   los vrtices transformados en lugar de los del VAO, con la matriz de modelado-visin identidad
+//   y la de proyeccin como MVP. Cada modelo reserva un rango para todas sus mallas visibles, as
+//   que sus mallas se dibujan todas desde la cach o ninguna. El buffer crece entre frames: si un
+//   modelo no cabe, se dibuja sin cach y el buffer tiene sitio en el siguiente frame. Se
+//   implementa como un singleton para que lo usen los modelos y sus mallas
+class TransformCache
+{
+private:
+	// - Singleton
+	static TransformCache* instance;
+
+	// - Constructor privado (singleton)
+	TransformCache();
+
+	// - Activacin (desactivada, las pasadas transforman los vrtices del VAO)
+	bool enabled;
+
+	// - Shader program de la transformacin (vertex shader con transform feedback)
+	ShaderProgram captureShader;
+
+	// - Buffer de los vrtices transformados, tamao reservado y necesario, y bytes usados en el
+	//   frame actual (en bytes)
+	GLuint buffer;
+	size_t capacity;
+	size_t required;
+	size_t used;
+
+	// - Frame de la cach (cambia en cada transformacin o invalidacin) y matriz de visin con la
+	//   que se transformaron los vrtices
+	unsigned int frame;
+	glm::mat4 view;
+
+	// - Mallas y vrtices transformados en el frame actual
+	unsigned int numMeshes;
+	unsigned int numVertices;
+
+public:
+	// - Acceder al singleton
+	static TransformCache* getInstance();
+
+	// - Destructor
+	~TransformCache();
+
+	// - Activar o desactivar la cach
+	void setEnabled(bool enabled);
+	bool isEnabled();
+
+	// - Pedir el shader program (compilacin bajo demanda). Devuelve true cuando est listo
+	bool request(bool wait);
+
+	// - Empezar la transformacin del frame con una matriz de visin: ampliar el buffer si en el
+	//   frame anterior no caban todos los modelos, desactivar la rasterizacin y activar el shader
+	//   program, con el que los modelos asignan su matriz de modelado-visin
+	ShaderProgram& begin(const glm::mat4 &view);
+
+	// - Reservar un rango para numVertices vrtices (desplazamiento en bytes). Devuelve false si no
+	//   cabe en el buffer
+	bool allocate(unsigned int numVertices, size_t &offset);
+
+	// - Transformar los vrtices de un VAO y guardarlos a partir de un desplazamiento reservado
+	void capture(VAO *vao, unsigned int numVertices, size_t offset);
+
+	// - Terminar la transformacin del frame
+	void end();
+
+	// - Invalidar la cach (frame sin transformacin)
+	void invalidate();
+
+	// - Saber si la cach es vlida para una matriz de visin (se transform con ella en este frame)
+	bool isValid(const glm::mat4 &view);
+
+	// - Frame de la cach y buffer de los vrtices transformados
+	unsigned int getFrame();
+	GLuint getBuffer();
+
+	// - Estadsticas del frame actual y memoria del buffer (en bytes)
+	unsigned int getNumMeshes();
+	unsigned int getNumVertices();
+	size_t getCapacity();
+};
\ No newline at end of file
@@ -1,345 +1,438 @@
 #include "VAO.h"
+#include "RenderStatistics.h"
+#include "GLStateCache.h"
+
+#include <cstddef>
 
 // - Constructor
 VAO::VAO()
 {
-	// - Se genera el VAO
+	// - Se genera el VAO. Los VBOs y los IBOs se reservan en la arena de buffers al rellenarlos
 	vao = 0;
 	glGenVertexArrays(1, &vao);
 
-	// - Se generan los VBOs
-	glGenBuffers(4, vbo);
-
-	// - Se generan los IBOs
-	glGenBuffers(2, ibo);
-	}
+	generation = BufferArena::getInstance()->getGeneration();
+	elementBuffer = 0;
+}
 
 // - Destructor
 VAO::~VAO()
 {
+	BufferArena *arena = BufferArena::getInstance();
+
+	for (unsigned int i = 0; i < vbo.size(); i++)
+	{
+		arena->release(vbo[i]);
+	}
+
+	arena->release(ibo[0]);
+	arena->release(ibo[1]);
+	arena->release(ibo[2]);
+
+	GLStateCache::getInstance()->forgetVertexArray(vao);
 	glDeleteVertexArrays(1, &vao);
-	glDeleteBuffers(4, vbo);
-	glDeleteBuffers(2, ibo);
 }
 
-// - Crear VBO (posiciones)
-void VAO::fillVBO(std::vector<glm::vec3> positions)
+// - Mtodo privado: subir un array de atributos a la arena. El primer array de un fillVBO libera
+//   los VBOs y atributos anteriores del VAO
+unsigned int VAO::fillBuffer(const void *data, size_t bytes, bool first)
 {
-	// - Siempre que se quiere usar un VAO, hay que activarlo con esta orden
-	glBindVertexArray(vao);
+	BufferArena *arena = BufferArena::getInstance();
 
-	// - 1) VBO (Posiciones y normales)
+	if (first)
+	{
+		for (unsigned int i = 0; i < vbo.size(); i++)
+		{
+			arena->release(vbo[i]);
+		}
 
-	// - Activar VBO
-	glBindBuffer(GLenum(GL_ARRAY_BUFFER), vbo[0]);
+		vbo.clear();
+		attributes.clear();
+	}
 
-	// - Aqu se indica que uno de los elementos del array entrelazado va asociado con el
-	//   layout (location = 0) en el shader, en concreto la posicin
-	glEnableVertexAttribArray(0);
+	unsigned int allocation = arena->allocate(bytes, data);
 
-	// - Aqu se describen las caractersticas del puntero que permite a la GPU acceder a
-	//   las posiciones
-	glVertexAttribPointer(0, sizeof(glm::vec3) / sizeof(GLfloat), GL_FLOAT, GL_FALSE,
-						  sizeof(glm::vec3), ((GLubyte *)NULL + (0)));
+	if (allocation != BufferArena::NO_ALLOCATION)
+	{
+		vbo.push_back(allocation);
+	}
 
-	// - Pasar al VBO el array que contiene la informacin (posiciones)
-	glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec3) * positions.size(),
-				 positions.data(), GL_STATIC_DRAW);
-}		
+	return allocation;
+}
 
-// - Crear VBO (posiciones, normales y coordenadas de textura)
-void VAO::fillVBO(std::vector<PosNorm> posAndNorms, std::vector<glm::vec2> texCoords)
+// - Mtodo privado: aadir un atributo de vrtice (los arrays vacos no tienen reserva y su
+//   atributo queda desactivado)
+void VAO::addAttribute(GLuint location, GLint components, GLsizei stride, size_t offset, unsigned int allocation)
 {
-	// - Siempre que se quiere usar un VAO, hay que activarlo con esta orden
-	glBindVertexArray(vao);
-
-	// - 1) VBO (Posiciones y normales)
-
-	// - Activar VBO
-	glBindBuffer(GLenum(GL_ARRAY_BUFFER), vbo[0]);
-
-	// - Aqu se indica que uno de los elementos del array entrelazado va asociado con el
-	//   layout (location = 0) en el shader, en concreto la posicin
-	glEnableVertexAttribArray(0);
-
-	// - Aqu se describen las caractersticas del puntero que permite a la GPU acceder a
-	//   las posiciones
-	glVertexAttribPointer(0, sizeof(glm::vec3) / sizeof(GLfloat), GL_FLOAT, GL_FALSE,
-						  sizeof(PosNorm), ((GLubyte *)NULL + (0)));
-
-	// - Aqu se indica que uno de los elementos del array entrelazado va asociado con el
-	//   layout (location = 1) en el shader, en concreto la normal
-	glEnableVertexAttribArray(1);
+	if (allocation != BufferArena::NO_ALLOCATION)
+	{
+		attributes.push_back(VertexAttribute(location, components, stride, offset, allocation));
+	}
+}
 
-	// - Aqu se describen las caractersticas del puntero que permite a la GPU acceder a
-	//   las normales
-	glVertexAttribPointer(1, sizeof(glm::vec3) / sizeof(GLfloat), GL_FLOAT, GL_FALSE,
-						  sizeof(PosNorm), ((GLubyte *)NULL + (sizeof(glm::vec3))));
+// - Mtodo privado: enlazar los atributos de vrtice con el buffer y el desplazamiento de sus reservas
+void VAO::bindAttributes()
+{
+	BufferArena *arena = BufferArena::getInstance();
+
+	// - Siempre que se quiere usar un VAO, hay que activarlo con esta orden (la cach de estado no la
+	//   repite si ya est activo)
+	GLStateCache::getInstance()->bindVertexArray(vao);
+
+	for (unsigned int i = 0; i < attributes.size(); i++)
+	{
+		const VertexAttribute &attribute = attributes[i];
+
+		// - Activar el buffer de la reserva y describir el puntero que permite a la GPU acceder al
+		//   atributo asociado con layout (location = i) en el shader
+		glBindBuffer(GL_ARRAY_BUFFER, arena->getBuffer(attribute.allocation));
+		glEnableVertexAttribArray(attribute.location);
+		glVertexAttribPointer(attribute.location, attribute.components, GL_FLOAT, GL_FALSE, attribute.stride,
+							  ((GLubyte *) NULL + arena->getOffset(attribute.allocation) + attribute.offset));
+	}
 
-	// - Pasar al VBO el array que contiene la informacin (posiciones y normales)
-	glBufferData(GL_ARRAY_BUFFER, sizeof(PosNorm) * posAndNorms.size(),
-				 posAndNorms.data(), GL_STATIC_DRAW);
+	generation = arena->getGeneration();
+	elementBuffer = 0;
+}
 
-	// - 2) VBO (Coordenadas de textura)
+// - Crear VBO (posiciones)
+void VAO::fillVBO(std::vector<glm::vec3> positions)
+{
+	// - 1) VBO (Posiciones): layout (location = 0)
+	unsigned int buffer = fillBuffer(positions.data(), sizeof(glm::vec3) * positions.size(), true);
+	addAttribute(0, sizeof(glm::vec3) / sizeof(GLfloat), sizeof(glm::vec3), 0, buffer);
 
-	// - Activar VBO
-	glBindBuffer(GLenum(GL_ARRAY_BUFFER), vbo[1]);
+	bindAttributes();
+}		
 
-	// - Aqu se indica que los elementos del array de coordenadas de textura van asociados
-	//   con el layout (location = 2) en el shader
-	glEnableVertexAttribArray(2);
+// - Crear VBO (posiciones, normales y coordenadas de textura)
+void VAO::fillVBO(std::vector<PosNorm> posAndNorms, std::vector<glm::vec2> texCoords)
+{
+	// - 1) VBO (Posiciones y normales): array entrelazado, con la posicin asociada al layout
+	//   (location = 0) y la normal al layout (location = 1)
+	unsigned int buffer = fillBuffer(posAndNorms.data(), sizeof(PosNorm) * posAndNorms.size(), true);
+	addAttribute(0, sizeof(glm::vec3) / sizeof(GLfloat), sizeof(PosNorm), 0, buffer);
+	addAttribute(1, sizeof(glm::vec3) / sizeof(GLfloat), sizeof(PosNorm), sizeof(glm::vec3), buffer);
 
-	// - Aqu se describen las caractersticas del puntero que permite a la GPU acceder a
-	//   las coordenadas de textura
-	glVertexAttribPointer(2, sizeof(glm::vec2) / sizeof(GLfloat), GL_FLOAT, GL_FALSE,
-						  sizeof(glm::vec2), ((GLubyte *)NULL + (0)));
+	// - 2) VBO (Coordenadas de textura): layout (location = 2)
+	buffer = fillBuffer(texCoords.data(), sizeof(glm::vec2) * texCoords.size(), false);
+	addAttribute(2, sizeof(glm::vec2) / sizeof(GLfloat), sizeof(glm::vec2), 0, buffer);
 
-	// - Pasar al VBO el array que contiene la informacin (coordenadas de textura)
-	glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec2) * texCoords.size(),
-				 texCoords.data(), GL_STATIC_DRAW);
+	bindAttributes();
 }
 
 // - Crear VBO (posiciones, normales, coordenadas de textura y tangentes)
 void VAO::fillVBO(std::vector<PosNorm> posAndNorms, std::vector<glm::vec2> texCoords,
 					 std::vector<glm::vec3> tangents)
 {
-	// - Siempre que se quiere usar un VAO, hay que activarlo con esta orden
-	glBindVertexArray(vao);
-
-	// - 1) VBO (Posiciones y normales)
-
-	// - Activar VBO
-	glBindBuffer(GLenum(GL_ARRAY_BUFFER), vbo[0]);
-
-	// - Aqu se indica que uno de los elementos del array entrelazado va asociado con el
-	//   layout (location = 0) en el shader, en concreto la posicin
-	glEnableVertexAttribArray(0);
+	// - 1) VBO (Posiciones y normales): array entrelazado, con la posicin asociada al layout
+	//   (location = 0) y la normal al layout (location = 1)
+	unsigned int buffer = fillBuffer(posAndNorms.data(), sizeof(PosNorm) * posAndNorms.size(), true);
+	addAttribute(0, sizeof(glm::vec3) / sizeof(GLfloat), sizeof(PosNorm), 0, buffer);
+	addAttribute(1, sizeof(glm::vec3) / sizeof(GLfloat), sizeof(PosNorm), sizeof(glm::vec3), buffer);
 
-	// - Aqu se describen las caractersticas del puntero que permite a la GPU acceder a
-	//   las posiciones
-	glVertexAttribPointer(0, sizeof(glm::vec3) / sizeof(GLfloat), GL_FLOAT, GL_FALSE,
-						  sizeof(PosNorm), ((GLubyte *)NULL + (0)));
+	// - 2) VBO (Coordenadas de textura): layout (location = 2)
+	buffer = fillBuffer(texCoords.data(), sizeof(glm::vec2) * texCoords.size(), false);
+	addAttribute(2, sizeof(glm::vec2) / sizeof(GLfloat), sizeof(glm::vec2), 0, buffer);
 
-	// - Aqu se indica que uno de los elementos del array entrelazado va asociado con el
-	//   layout (location = 1) en el shader, en concreto la normal
-	glEnableVertexAttribArray(1);
+	// - 3) VBO (Tangentes): layout (location = 3)
+	buffer = fillBuffer(tangents.data(), sizeof(glm::vec3) * tangents.size(), false);
+	addAttribute(3, sizeof(glm::vec3) / sizeof(GLfloat), sizeof(glm::vec3), 0, buffer);
 
-	// - Aqu se describen las caractersticas del puntero que permite a la GPU acceder a
-	//   las normales
-	glVertexAttribPointer(1, sizeof(glm::vec3) / sizeof(GLfloat), GL_FLOAT, GL_FALSE,
-						  sizeof(PosNorm), ((GLubyte *)NULL + (sizeof(glm::vec3))));
+	bindAttributes();
+}
 
-	// - Pasar al VBO el array que contiene la informacin (posiciones y normales)
-	glBufferData(GL_ARRAY_BUFFER, sizeof(PosNorm) * posAndNorms.size(),
-				 posAndNorms.data(), GL_STATIC_DRAW);
+// - Crear VBO (posiciones, normales, coordenadas de textura, tangentes y bitangentes)
+void VAO::fillVBO(std::vector<PosNorm> posAndNorms, std::vector<glm::vec2> texCoords,
+					 std::vector<glm::vec3> tangents, std::vector<glm::vec3> bitangents)
+{
+	// - 1) VBO (Posiciones y normales): array entrelazado, con la posicin asociada al layout
+	//   (location = 0) y la normal al layout (location = 1)
+	unsigned int buffer = fillBuffer(posAndNorms.data(), sizeof(PosNorm) * posAndNorms.size(), true);
+	addAttribute(0, sizeof(glm::vec3) / sizeof(GLfloat), sizeof(PosNorm), 0, buffer);
+	addAttribute(1, sizeof(glm::vec3) / sizeof(GLfloat), sizeof(PosNorm), sizeof(glm::vec3), buffer);
 
-	// - 2) VBO (Coordenadas de textura)
+	// - 2) VBO (Coordenadas de textura): layout (location = 2)
+	buffer = fillBuffer(texCoords.data(), sizeof(glm::vec2) * texCoords.size(), false);
+	addAttribute(2, sizeof(glm::vec2) / sizeof(GLfloat), sizeof(glm::vec2), 0, buffer);
 
-	// - Activar VBO
-	glBindBuffer(GLenum(GL_ARRAY_BUFFER), vbo[1]);
+	// - 3) VBO (Tangentes): layout (location = 3)
+	buffer = fillBuffer(tangents.data(), sizeof(glm::vec3) * tangents.size(), false);
+	addAttribute(3, sizeof(glm::vec3) / sizeof(GLfloat), sizeof(glm::vec3), 0, buffer);
 
-	// - Aqu se indica que los elementos del array de coordenadas de textura van asociados
-	//   con el layout (location = 2) en el shader
-	glEnableVertexAttribArray(2);
+	// - 4) VBO (Bitangentes): layout (location = 4)
+	buffer = fillBuffer(bitangents.data(), sizeof(glm::vec3) * bitangents.size(), false);
+	addAttribute(4, sizeof(glm::vec3) / sizeof(GLfloat), sizeof(glm::vec3), 0, buffer);
 
-	// - Aqu se describen las caractersticas del puntero que permite a la GPU acceder a
-	//   las coordenadas de textura
-	glVertexAttribPointer(2, sizeof(glm::vec2) / sizeof(GLfloat), GL_FLOAT, GL_FALSE,
-						  sizeof(glm::vec2), ((GLubyte *)NULL + (0)));
+	bindAttributes();
+}
 
-	// - Pasar al VBO el array que contiene la informacin (coordenadas de textura)
-	glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec2) * texCoords.size(),
-				 texCoords.data(), GL_STATIC_DRAW);
+// - Crear VBO del Quad (rendering a textura)
+void VAO::fillVBOQuad(std::vector<glm::vec2> vertices, std::vector<glm::vec2> texCoords)
+{
+	// - 1) VBO (Vrtices): layout (location = 0)
+	unsigned int buffer = fillBuffer(vertices.data(), sizeof(glm::vec2) * vertices.size(), true);
+	addAttribute(0, sizeof(glm::vec2) / sizeof(GLfloat), sizeof(glm::vec2), 0, buffer);
 
-	// - 3) VBO (Tangentes)
+	// - 2) VBO (Coordenadas de textura): layout (location = 1)
+	buffer = fillBuffer(texCoords.data(), sizeof(glm::vec2) * texCoords.size(), false);
+	addAttribute(1, sizeof(glm::vec2) / sizeof(GLfloat), sizeof(glm::vec2), 0, buffer);
 
-	// - Activar VBO
-	glBindBuffer(GLenum(GL_ARRAY_BUFFER), vbo[2]);
+	bindAttributes();
+}
 
-	// - Aqu se indica que los elementos del array de tangentes van asociados con el
-	//   layout (location = 3) en el shader
-	glEnableVertexAttribArray(3);
+// - Mtodo privado: rellenar un IBO. Si los ndices caben en la reserva anterior se sobrescriben;
+//   si no, se libera y se reserva de nuevo
+void VAO::fillIndices(unsigned int pos, const std::vector<GLuint> &indices)
+{
+	BufferArena *arena = BufferArena::getInstance();
+	size_t bytes = sizeof(GLuint) * indices.size();
 
-	// - Aqu se describen las caractersticas del puntero que permite a la GPU acceder a
-	//   las tangentes
-	glVertexAttribPointer(3, sizeof(glm::vec3) / sizeof(GLfloat), GL_FLOAT, GL_FALSE,
-						  sizeof(glm::vec3), ((GLubyte *)NULL + (0)));
+	if (ibo[pos] != BufferArena::NO_ALLOCATION && bytes > 0 && bytes <= arena->getSize(ibo[pos]))
+	{
+		arena->update(ibo[pos], indices.data(), bytes);
+		return;
+	}
 
-	// - Pasar al VBO el array que contiene la informacin (tangentes)
-	glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec3) * tangents.size(),
-				 tangents.data(), GL_STATIC_DRAW);
+	arena->release(ibo[pos]);
+	ibo[pos] = arena->allocate(bytes, indices.data());
+	elementBuffer = 0;
 }
 
-// - Crear VBO (posiciones, normales, coordenadas de textura, tangentes y bitangentes)
-void VAO::fillVBO(std::vector<PosNorm> posAndNorms, std::vector<glm::vec2> texCoords,
-					 std::vector<glm::vec3> tangents, std::vector<glm::vec3> bitangents)
+// - Crear IBO (malla de tringulos)
+void VAO::fillIBO(std::vector<GLuint> indices)
 {
-	// - Siempre que se quiere usar un VAO, hay que activarlo con esta orden
-	glBindVertexArray(vao);
+	fillIndices(0, indices);
+}
 
-	// - 1) VBO (Posiciones y normales)
+// - Crear IBO (adyacencia de tringulos)
+void VAO::fillIBOAdjacencies(std::vector<GLuint> indices)
+{
+	fillIndices(1, indices);
+}
 
-	// - Activar VBO
-	glBindBuffer(GLenum(GL_ARRAY_BUFFER), vbo[0]);
+// - Crear IBO (aristas caractersticas, GL_LINES)
+void VAO::fillIBOLines(const std::vector<GLuint> &indices)
+{
+	fillIndices(2, indices);
+}
 
-	// - Aqu se indica que uno de los elementos del array entrelazado va asociado con el
-	//   layout (location = 0) en el shader, en concreto la posicin
-	glEnableVertexAttribArray(0);
+// - Mtodo privado: activar el VAO. Si la arena se ha desfragmentado, las reservas han cambiado de
+//   buffer o de desplazamiento y hay que volver a enlazar los atributos
+void VAO::bind()
+{
+	if (generation != BufferArena::getInstance()->getGeneration())
+	{
+		bindAttributes();
+		return;
+	}
 
-	// - Aqu se describen las caractersticas del puntero que permite a la GPU acceder a
-	//   las posiciones
-	glVertexAttribPointer(0, sizeof(glm::vec3) / sizeof(GLfloat), GL_FLOAT, GL_FALSE,
-						  sizeof(PosNorm), ((GLubyte *)NULL + (0)));
+	// - Siempre que se quiere usar un VAO, hay que activarlo con esta orden (la cach de estado no la
+	//   repite si ya est activo)
+	GLStateCache::getInstance()->bindVertexArray(vao);
+}
 
-	// - Aqu se indica que uno de los elementos del array entrelazado va asociado con el
-	//   layout (location = 1) en el shader, en concreto la normal
-	glEnableVertexAttribArray(1);
+// - Mtodo privado: activar el IBO del modo de dibujado (el enlace forma parte del estado del VAO,
+//   as que slo se cambia si es otro buffer) y obtener el desplazamiento de sus ndices. Devuelve
+//   false si el VAO no tiene ndices para ese modo
+bool VAO::bindIndices(GLenum mode, const GLubyte *&offset)
+{
+	BufferArena *arena = BufferArena::getInstance();
+	unsigned int allocation = ibo[mode == GL_TRIANGLES_ADJACENCY ? 1 : (mode == GL_LINES ? 2 : 0)];
 
-	// - Aqu se describen las caractersticas del puntero que permite a la GPU acceder a
-	//   las normales
-	glVertexAttribPointer(1, sizeof(glm::vec3) / sizeof(GLfloat), GL_FLOAT, GL_FALSE,
-						  sizeof(PosNorm), ((GLubyte *)NULL + (sizeof(glm::vec3))));
+	if (allocation == BufferArena::NO_ALLOCATION)
+	{
+		return false;
+	}
 
-	// - Pasar al VBO el array que contiene la informacin (posiciones y normales)
-	glBufferData(GL_ARRAY_BUFFER, sizeof(PosNorm) * posAndNorms.size(),
-				 posAndNorms.data(), GL_STATIC_DRAW);
+	if (elementBuffer != arena->getBuffer(allocation))
+	{
+		elementBuffer = arena->getBuffer(allocation);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elementBuffer);
+	}
 
-	// - 2) VBO (Coordenadas de textura)
+	offset = (GLubyte *) NULL + arena->getOffset(allocation);
 
-	// - Activar VBO
-	glBindBuffer(GLenum(GL_ARRAY_BUFFER), vbo[1]);
+	return true;
+}
 
-	// - Aqu se indica que los elementos del array de coordenadas de textura van asociados
-	//   con el layout (location = 2) en el shader
-	glEnableVertexAttribArray(2);
+// - Dibujar tringulos
+void VAO::draw(unsigned int numIndices)
+{
+	bind();
+	glDrawArrays(GL_TRIANGLES, 0, numIndices);
+	RENDER_STATS_DRAW(GL_TRIANGLES, numIndices);
+}
 
-	// - Aqu se describen las caractersticas del puntero que permite a la GPU acceder a
-	//   las coordenadas de textura
-	glVertexAttribPointer(2, sizeof(glm::vec2) / sizeof(GLfloat), GL_FLOAT, GL_FALSE,
-						  sizeof(glm::vec2), ((GLubyte *)NULL + (0)));
+// - Dibujar los vrtices como puntos, sin ndices (transform feedback)
+void VAO::drawPoints(unsigned int numVertices)
+{
+	bind();
+	glDrawArrays(GL_POINTS, 0, numVertices);
+	RENDER_STATS_DRAW(GL_POINTS, numVertices);
+}
 
-	// - Pasar al VBO el array que contiene la informacin (coordenadas de textura)
-	glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec2) * texCoords.size(),
-				  texCoords.data(), GL_STATIC_DRAW);
+// - Dibujar los elementos segn el modo y la topologa especificados
+void VAO::draw(GLenum mode, std::vector<GLuint> indices)
+{
+	bind();
+	const GLubyte *offset = NULL;
 
-	// - 3) VBO (Tangentes)
+	if (!bindIndices(mode, offset))
+	{
+		return;
+	}
 
-	// - Activar VBO
-	glBindBuffer(GLenum(GL_ARRAY_BUFFER), vbo[2]);
+	glDrawElements(mode, indices.size(), GL_UNSIGNED_INT, offset);
+	RENDER_STATS_DRAW(mode, indices.size());
+}
 
-	// - Aqu se indica que los elementos del array de tangentes van asociados con el
-	//   layout (location = 3) en el shader
-	glEnableVertexAttribArray(3);
+// - Obtener identificador del VAO
+GLuint VAO::getId()
+{
+	return vao;
+}
 
-	// - Aqu se describen las caractersticas del puntero que permite a la GPU acceder a
-	//   las tangentes
-	glVertexAttribPointer(3, sizeof(glm::vec3) / sizeof(GLfloat), GL_FLOAT, GL_FALSE,
-						  sizeof(glm::vec3), ((GLubyte *)NULL + (0)));
+// - Obtener buffers y desplazamientos de los vrtices (atributo de la posicin) y de los ndices de
+//   adyacencia
+bool VAO::getAdjacencyStorage(GLuint &vertexBuffer, size_t &vertexOffset, GLuint &indexBuffer, size_t &indexOffset)
+{
+	BufferArena *arena = BufferArena::getInstance();
 
-	// - Pasar al VBO el array que contiene la informacin (tangentes)
-	glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec3) * tangents.size(),
-				 tangents.data(), GL_STATIC_DRAW);
+	if (ibo[1] == BufferArena::NO_ALLOCATION)
+	{
+		return false;
+	}
 
-	// - 4) VBO (Bitangentes)
+	for (unsigned int i = 0; i < attributes.size(); i++)
+	{
+		if (attributes[i].location == 0)
+		{
+			vertexBuffer = arena->getBuffer(attributes[i].allocation);
+			vertexOffset = arena->getOffset(attributes[i].allocation) + attributes[i].offset;
+			indexBuffer = arena->getBuffer(ibo[1]);
+			indexOffset = arena->getOffset(ibo[1]);
+
+			return true;
+		}
+	}
 
-	// - Activar VBO
-	glBindBuffer(GLenum(GL_ARRAY_BUFFER), vbo[3]);
+	return false;
+}
 
-	// - Aqu se indica que los elementos del array de bitangentes van asociados con el
-	//   layout (location = 4) en el shader
-	glEnableVertexAttribArray(4);
+// - Enlazar VBO de atributos de instancia. Los atributos avanzan una vez por instancia y empiezan en
+//   firstInstance, as que se pueden dibujar por separado grupos de instancias del mismo VBO
+void VAO::setInstanceBuffer(GLuint buffer, unsigned int firstInstance)
+{
+	bind();
 
-	// - Aqu se describen las caractersticas del puntero que permite a la GPU acceder a
-	//   las bitangentes
-	glVertexAttribPointer(4, sizeof(glm::vec3) / sizeof(GLfloat), GL_FLOAT, GL_FALSE,
-						  sizeof(glm::vec3), ((GLubyte *)NULL + (0)));
+	// - Desenlazar: desactivar los atributos de instancia
+	if (buffer == 0)
+	{
+		for (GLuint location = 5; location <= 10; location++)
+		{
+			glDisableVertexAttribArray(location);
+		}
 
-	// - Pasar al VBO el array que contiene la informacin (tangentes)
-	glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec3) * bitangents.size(),
-				 bitangents.data(), GL_STATIC_DRAW);
-}
+		return;
+	}
 
-// - Crear VBO del Quad (rendering a textura)
-void VAO::fillVBOQuad(std::vector<glm::vec2> vertices, std::vector<glm::vec2> texCoords)
-{
-	// - Siempre que se quiere usar un VAO, hay que activarlo con esta orden
-	glBindVertexArray(vao);
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
 
-	// - 1) VBO (Vrtices)
+	GLsizei stride = sizeof(InstanceData);
+	size_t base = sizeof(InstanceData) * firstInstance;
 
-	// - Activar VBO
-	glBindBuffer(GLenum(GL_ARRAY_BUFFER), vbo[0]);
+	// - Matriz de modelado: una columna por atributo (5-8)
+	for (GLuint column = 0; column < 4; column++)
+	{
+		glEnableVertexAttribArray(5 + column);
+		glVertexAttribPointer(5 + column, 4, GL_FLOAT, GL_FALSE, stride,
+							  ((GLubyte *) NULL + base + offsetof(InstanceData, modelMatrix) + sizeof(glm::vec4) * column));
+		glVertexAttribDivisor(5 + column, 1);
+	}
 
-	// - Aqu se indica que uno de los elementos del array entrelazado va asociado con el
-	//   layout (location = 0) en el shader, en concreto la posicin
-	glEnableVertexAttribArray(0);
+	// - Contorno (9) y Cel-Shading (10)
+	glEnableVertexAttribArray(9);
+	glVertexAttribPointer(9, 4, GL_FLOAT, GL_FALSE, stride, ((GLubyte *) NULL + base + offsetof(InstanceData, outline)));
+	glVertexAttribDivisor(9, 1);
 
-	// - Aqu se describen las caractersticas del puntero que permite a la GPU acceder a
-	//   las posiciones
-	glVertexAttribPointer(0, sizeof(glm::vec2) / sizeof(GLfloat), GL_FLOAT, GL_FALSE,
-						  sizeof(glm::vec2), ((GLubyte *)NULL + (0)));
+	glEnableVertexAttribArray(10);
+	glVertexAttribPointer(10, 4, GL_FLOAT, GL_FALSE, stride, ((GLubyte *) NULL + base + offsetof(InstanceData, celShading)));
+	glVertexAttribDivisor(10, 1);
+}
 
-	// - Pasar al VBO el array que contiene la informacin (vrtices)
-	glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec2) * vertices.size(),
-				 vertices.data(), GL_STATIC_DRAW);
+// - Leer la posicin (0) y la normal (1) de otro buffer. Al desenlazarlo, se vuelven a describir con
+//   las reservas de la arena del VAO
+void VAO::setVertexBuffer(GLuint buffer, size_t offset)
+{
+	bind();
 
-	// - 2) VBO (Coordenadas de textura)
+	if (buffer == 0)
+	{
+		BufferArena *arena = BufferArena::getInstance();
 
-	// - Activar VBO
-	glBindBuffer(GLenum(GL_ARRAY_BUFFER), vbo[1]);
+		for (unsigned int i = 0; i < attributes.size(); i++)
+		{
+			const VertexAttribute &attribute = attributes[i];
 
-	// - Aqu se indica que los elementos del array de coordenadas de textura van asociados
-	//   con el layout (location = 1) en el shader
-	glEnableVertexAttribArray(1);
+			if (attribute.location <= 1)
+			{
+				glBindBuffer(GL_ARRAY_BUFFER, arena->getBuffer(attribute.allocation));
+				glVertexAttribPointer(attribute.location, attribute.components, GL_FLOAT, GL_FALSE, attribute.stride,
+									  ((GLubyte *) NULL + arena->getOffset(attribute.allocation) + attribute.offset));
+			}
+		}
 
-	// - Aqu se describen las caractersticas del puntero que permite a la GPU acceder a
-	//   las coordenadas de textura
-	glVertexAttribPointer(1, sizeof(glm::vec2) / sizeof(GLfloat), GL_FLOAT, GL_FALSE,
-						  sizeof(glm::vec2), ((GLubyte *)NULL + (0)));
+		return;
+	}
 
-	// - Pasar al VBO el array que contiene la informacin (coordenadas de textura)
-	glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec2) * texCoords.size(),
-				 texCoords.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(PosNorm), ((GLubyte *) NULL + offset));
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(PosNorm), ((GLubyte *) NULL + offset + sizeof(glm::vec3)));
 }
 
-// - Crear IBO (malla de tringulos)
-void VAO::fillIBO(std::vector<GLuint> indices)
+// - Dibujar varias instancias de los elementos segn el modo y la topologa especificados
+void VAO::drawInstanced(GLenum mode, const std::vector<GLuint> &indices, unsigned int numInstances)
 {
-	// - Siempre que se quiere usar un VAO, hay que activarlo con esta orden
-	glBindVertexArray(vao);
+	bind();
+	const GLubyte *offset = NULL;
 
-	// - Activar IBO (malla de tringulos)
-	glBindBuffer(GLenum(GL_ELEMENT_ARRAY_BUFFER), ibo[0]);
+	if (!bindIndices(mode, offset))
+	{
+		return;
+	}
 
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * indices.size(),
-				 indices.data(), GL_STATIC_DRAW);
+	glDrawElementsInstanced(mode, indices.size(), GL_UNSIGNED_INT, offset, numInstances);
+	RENDER_STATS_DRAW(mode, indices.size() * numInstances);
 }
 
-// - Crear IBO (adyacencia de tringulos)
-void VAO::fillIBOAdjacencies(std::vector<GLuint> indices)
+// - Dibujar varios rangos de los ndices (relativos al principio del IBO) con glMultiDrawElements
+void VAO::drawRanges(GLenum mode, const std::vector<IndexRange> &ranges)
 {
-	// - Siempre que se quiere usar un VAO, hay que activarlo con esta orden
-	glBindVertexArray(vao);
+	if (ranges.empty())
+	{
+		return;
+	}
 
-	// - Activar IBO (malla de tringulos)
-	glBindBuffer(GLenum(GL_ELEMENT_ARRAY_BUFFER), ibo[1]);
+	bind();
+	const GLubyte *offset = NULL;
 
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * indices.size(),
-				 indices.data(), GL_STATIC_DRAW);						 
-}
+	if (!bindIndices(mode, offset))
+	{
+		return;
+	}
 
-// - Dibujar tringulos
-void VAO::draw(unsigned int numIndices)
-{
-	// - Siempre que se quiere usar un VAO, hay que activarlo con esta orden
-	glBindVertexArray(vao);
-	glDrawArrays(GL_TRIANGLES, 0, numIndices);
-}
+	std::vector<GLsizei> counts(ranges.size());
+	std::vector<const void*> offsets(ranges.size());
+	GLsizei numIndices = 0;
 
-// - Dibujar los elementos segn el modo y la topologa especificados
-void VAO::draw(GLenum mode, std::vector<GLuint> indices)
-{
-	// - Siempre que se quiere usar un VAO, hay que activarlo con esta orden
-	glBindVertexArray(vao);
-	glDrawElements(mode, indices.size(), GL_UNSIGNED_INT, NULL);
+	for (unsigned int i = 0; i < ranges.size(); i++)
+	{
+		counts[i] = (GLsizei) ranges[i].count;
+		offsets[i] = offset + sizeof(GLuint) * ranges[i].firstIndex;
+		numIndices += counts[i];
+	}
+
+	glMultiDrawElements(mode, counts.data(), GL_UNSIGNED_INT, offsets.data(), (GLsizei) ranges.size());
+	RENDER_STATS_DRAW(mode, numIndices);
 }
\ No newline at end of file
@@ -5,13 +5,57 @@
 #include <vector>
 
 #include "Structures.h"
+#include "BufferArena.h"
+#include "GeometryStore.h"
+
+// - Atributo de vrtice: posicin en el shader, formato y reserva de la arena de la que se lee
+struct VertexAttribute
+{
+	GLuint location;
+	GLint components;
+	GLsizei stride;
+	size_t offset;
+	unsigned int allocation;
+
+	VertexAttribute(GLuint location, GLint components, GLsizei stride, size_t offset, unsigned int allocation)
+	{
+		this->location = location;
+		this->components = components;
+		this->stride = stride;
+		this->offset = offset;
+		this->allocation = allocation;
+	}
+};
 
 class VAO
 {
 private:
 	GLuint vao;
-	GLuint vbo[4] = { 0, 0, 0, 0};
-	GLuint ibo[2] = { 0, 0 };
+
+	// - Reservas de la arena de buffers: VBOs (uno por array de atributos) e IBOs (topologa,
+	//   adyacencias y aristas caractersticas)
+	std::vector<unsigned int> vbo;
+	unsigned int ibo[3] = { BufferArena::NO_ALLOCATION, BufferArena::NO_ALLOCATION, BufferArena::NO_ALLOCATION };
+
+	// - Atributos de vrtice, generacin de la arena con la que se enlazaron y buffer enlazado como IBO
+	std::vector<VertexAttribute> attributes;
+	unsigned int generation;
+	GLuint elementBuffer;
+
+	// - Subir un array de atributos a la arena (liberando los anteriores si es el primero)
+	unsigned int fillBuffer(const void *data, size_t bytes, bool first);
+
+	// - Enlazar los atributos de vrtice con sus reservas
+	void addAttribute(GLuint location, GLint components, GLsizei stride, size_t offset, unsigned int allocation);
+	void bindAttributes();
+
+	// - Rellenar un IBO, reutilizando su reserva si los ndices caben
+	void fillIndices(unsigned int pos, const std::vector<GLuint> &indices);
+
+	// - Activar el VAO (volviendo a enlazar los atributos si la arena se ha desfragmentado) y el IBO
+	//   que corresponde al modo de dibujado (desplazamiento de sus ndices)
+	void bind();
+	bool bindIndices(GLenum mode, const GLubyte *&offset);
 
 public:
 	// - Constructor
@@ -36,8 +80,28 @@ public:
 	// - Rellenar IBOs
 	void fillIBO(std::vector<GLuint> indices);
 	void fillIBOAdjacencies(std::vector<GLuint> indices);
+	void fillIBOLines(const std::vector<GLuint> &indices);
+
+	// - Obtener identificador del VAO
+	GLuint getId();
+
+	// - Buffers de la arena y desplazamientos (bytes) de los vrtices (posicin y normal) y de los
+	//   ndices de adyacencia, para leerlos desde un compute shader. Devuelve false si no los hay
+	bool getAdjacencyStorage(GLuint &vertexBuffer, size_t &vertexOffset, GLuint &indexBuffer, size_t &indexOffset);
 
-	// - Dibujado
+	// - Enlazar VBO de atributos de instancia a partir de una instancia (0 para desenlazarlo)
+	void setInstanceBuffer(GLuint buffer, unsigned int firstInstance);
+
+	// - Leer la posicin y la normal de otro buffer, con el formato de PosNorm, a partir de un
+	//   desplazamiento en bytes (0 para volver a leerlas de los VBOs del VAO)
+	void setVertexBuffer(GLuint buffer, size_t offset);
+
+	// - Dibujado (los modos con adyacencias usan el IBO de adyacencias y GL_LINES el de aristas)
 	void draw(GLenum mode, std::vector<GLuint> indices);
 	void draw(unsigned int numIndices);
+	void drawPoints(unsigned int numVertices);
+	void drawInstanced(GLenum mode, const std::vector<GLuint> &indices, unsigned int numInstances);
+
+	// - Dibujar varios rangos de los ndices con una sola llamada
+	void drawRanges(GLenum mode, const std::vector<IndexRange> &ranges);
 };
\ No newline at end of file
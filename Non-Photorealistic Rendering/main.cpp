@@ -1,5 +1,11 @@
 #include "Renderer.h"
+#include "Benchmark.h"
+#include "LoadProfiler.h"
+#include "ImageStylizer.h"
+#include "ProgramBinaryCache.h"
+#include <chrono>
 #include <iostream>
+#include <stdexcept>
 #include <GL/glew.h>
 // - IMPORTANTE: El include de Glew debe llamarse siempre ANTES de llamar al de GLFW
 #include <GLFW/glfw3.h>
@@ -82,21 +88,21 @@ void key_callback(GLFWwindow *window, int key, int scancode, int action, int mod
 	// - Visualizar la escena 1, al pulsar la tecla '1'
 	if (key == GLFW_KEY_1 && action == GLFW_PRESS)
 	{
-		Renderer::getInstance()->setupScene(0);
+		Renderer::getInstance()->requestScene(0);
 		window_refresh_callback(window);
 	}
 
 	// - Visualizar la escena 1, al pulsar la tecla '2'
 	if (key == GLFW_KEY_2 && action == GLFW_PRESS)
 	{
-		Renderer::getInstance()->setupScene(1);
+		Renderer::getInstance()->requestScene(1);
 		window_refresh_callback(window);
 	}
 
 	// - Visualizar la escena 3, al pulsar la tecla '3'
 	if (key == GLFW_KEY_3 && action == GLFW_PRESS)
 	{
-		Renderer::getInstance()->setupScene(2);
+		Renderer::getInstance()->requestScene(2);
 		window_refresh_callback(window);
 	}
 
@@ -319,6 +325,22 @@ void mouse_button_callback(GLFWwindow *window, int button, int action, int mods)
 	if (action == GLFW_PRESS) 
 	{
 		std::cout << "Pulsado el boton del raton: " << button << std::endl;
+
+		// - Seleccionar el elemento bajo el cursor (si el ratn no est sobre la GUI)
+		if (button == GLFW_MOUSE_BUTTON_LEFT && !ImGui::GetIO().WantCaptureMouse)
+		{
+			double cursorX, cursorY;
+			int width, height;
+
+			glfwGetCursorPos(window, &cursorX, &cursorY);
+			glfwGetWindowSize(window, &width, &height);
+
+			if (width > 0 && height > 0)
+			{
+				Renderer::getInstance()->selectElementAt(2.f * (float) cursorX / width - 1.f,
+														 1.f - 2.f * (float) cursorY / height);
+			}
+		}
 	}
 	else if (action == GLFW_RELEASE)
 	{
@@ -351,11 +373,230 @@ void scroll_callback(GLFWwindow *window, double xoffset, double yoffset)
 	window_refresh_callback(window);
 }
 
+// - Estilizacin de imgenes de disco, sin cargar ninguna escena. Se crea un contexto OpenGL
+//   con una ventana oculta; si no es posible, se utilizan los filtros de CPU
+int stylizeImages(StylizerSettings settings)
+{
+	GLFWwindow *window = nullptr;
+	bool glContext = false;
+
+	if (!settings.forceCPU && glfwInit() == GLFW_TRUE)
+	{
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+		glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+
+		window = glfwCreateWindow(64, 64, WINDOW_TITLE.c_str(), nullptr, nullptr);
+
+		if (window != nullptr)
+		{
+			glfwMakeContextCurrent(window);
+			glewExperimental = true;
+			glContext = (glewInit() == GLEW_OK);
+		}
+
+		if (!glContext)
+		{
+			std::cout << "No OpenGL context available, using CPU filters" << std::endl;
+		}
+	}
+
+	ImageStylizer *stylizer = new ImageStylizer(settings, glContext);
+	int result = stylizer->run();
+	delete stylizer;
+
+	if (window != nullptr)
+	{
+		glfwDestroyWindow(window);
+	}
+
+	glfwTerminate();
+
+	return result;
+}
+
+// - Mostrar el uso de los argumentos (argumento desconocido, sin valor o con un valor incorrecto)
+static void printUsage()
+{
+	std::cout << "Usage: [--bench] [--bench-frames N] [--bench-output path] [--bench-baseline path.csv] "
+			  << "[--bench-threshold 0.1] [--bench-relative] [--load-profile path.json] [--gpu-budget MB] "
+			  << "[--host-budget MB] [--bvh-bench N] [--no-shader-cache] [--stylize effect img1.png ...] "
+			  << "[--stylize-output directory] [--stylize-cpu]" << std::endl;
+}
+
+// - Leer un nmero entero positivo (todo el texto del argumento)
+static int parsePositiveInt(const std::string &value)
+{
+	size_t length = 0;
+	int number = std::stoi(value, &length);
+
+	if (length != value.size() || number <= 0)
+	{
+		throw std::invalid_argument(value);
+	}
+
+	return number;
+}
+
+// - Leer un nmero real no negativo (todo el texto del argumento)
+static float parseNonNegativeFloat(const std::string &value)
+{
+	size_t length = 0;
+	float number = std::stof(value, &length);
+
+	if (length != value.size() || number < 0.f)
+	{
+		throw std::invalid_argument(value);
+	}
+
+	return number;
+}
+
 // - Funcin principal
-int main()
+//   Argumentos (opcionales) para ejecutar el benchmark en lugar de la aplicacin interactiva:
+//		--bench							Ejecutar el benchmark
+//		--bench-frames N				Frames medidos por combinacin escena/tcnica/contorno
+//		--bench-output ruta				Ruta base de los resultados (ruta.json y ruta.csv)
+//		--bench-baseline ruta.csv		Resultados de referencia con los que comparar
+//		--bench-threshold 0.1			Aumento mximo permitido respecto a la referencia
+//		--bench-relative				Comparar tiempos relativos (mquinas sin GPU, llvmpipe)
+//   Argumento (opcional) para perfilar la carga de las escenas:
+//		--load-profile ruta.json		Desglose por fase de la carga de cada modelo y escena
+//   Argumentos (opcionales) para el presupuesto de memoria de las escenas cargadas:
+//		--gpu-budget MB					Memoria de GPU (las escenas menos usadas se descargan)
+//		--host-budget MB				Memoria de CPU (primero se liberan las imgenes de las texturas)
+//   Argumento (opcional) para medir la BVH en CPU (construccin, reajuste y consultas):
+//		--bvh-bench N					Iteraciones sobre la escena 2 (habitacin y frutero)
+//   Argumento (opcional) para compilar todos los shaders (comparar el arranque sin la cach de binarios):
+//		--no-shader-cache				No cargar ni guardar binarios de los shader programs
+//   Argumentos (opcionales) para estilizar imgenes de disco en lugar de renderizar escenas:
+//		--stylize efecto img1.png ...	Aplicar halftone, dithering, pixelArt, painterly o charcoal
+//		--stylize-output directorio		Directorio de las imgenes generadas
+//		--stylize-cpu					Usar los filtros de CPU aunque haya contexto OpenGL
+int main(int argc, char **argv)
 {
 	std::cout << "Starting application..." << std::endl;
 
+	// - Inicio de la aplicacin (tiempo hasta el primer frame interactivo)
+	std::chrono::high_resolution_clock::time_point startTime = std::chrono::high_resolution_clock::now();
+
+	// - Leer argumentos del benchmark
+	bool benchmarkEnabled = false;
+	BenchmarkSettings benchmarkSettings;
+
+	// - Leer argumentos del benchmark de la BVH
+	int bvhBenchmarkIterations = 0;
+
+	// - Leer argumentos de la estilizacin de imgenes
+	bool stylizeEnabled = false;
+	StylizerSettings stylizerSettings;
+
+	// - Los argumentos desconocidos, sin valor o con un valor incorrecto terminan la aplicacin con el
+	//   uso de los argumentos
+	try
+	{
+		for (int i = 1; i < argc; i++)
+		{
+			std::string argument = argv[i];
+
+			// - Valor del argumento actual (el siguiente de la lnea de rdenes)
+			auto nextValue = [&]() -> std::string
+			{
+				if (i + 1 >= argc)
+				{
+					throw std::invalid_argument(argument);
+				}
+
+				return argv[++i];
+			};
+
+			if (argument == "--bench")
+			{
+				benchmarkEnabled = true;
+			}
+			else if (argument == "--bench-frames")
+			{
+				benchmarkSettings.frames = parsePositiveInt(nextValue());
+			}
+			else if (argument == "--bench-output")
+			{
+				benchmarkSettings.output = nextValue();
+			}
+			else if (argument == "--bench-baseline")
+			{
+				benchmarkSettings.baseline = nextValue();
+			}
+			else if (argument == "--bench-threshold")
+			{
+				benchmarkSettings.threshold = parseNonNegativeFloat(nextValue());
+			}
+			else if (argument == "--bench-relative")
+			{
+				benchmarkSettings.relative = true;
+			}
+			else if (argument == "--bvh-bench")
+			{
+				bvhBenchmarkIterations = parsePositiveInt(nextValue());
+			}
+			else if (argument == "--load-profile")
+			{
+				LoadProfiler::getInstance()->setEnabled(true, nextValue());
+			}
+			else if (argument == "--gpu-budget")
+			{
+				ResidencyManager *residency = ResidencyManager::getInstance();
+				residency->setBudget((size_t) parsePositiveInt(nextValue()) * 1024 * 1024, residency->getHostBudget());
+			}
+			else if (argument == "--host-budget")
+			{
+				ResidencyManager *residency = ResidencyManager::getInstance();
+				residency->setBudget(residency->getGPUBudget(), (size_t) parsePositiveInt(nextValue()) * 1024 * 1024);
+			}
+			else if (argument == "--no-shader-cache")
+			{
+				ProgramBinaryCache::getInstance()->setEnabled(false);
+			}
+			else if (argument == "--stylize")
+			{
+				stylizeEnabled = true;
+				stylizerSettings.effect = nextValue();
+			}
+			else if (argument == "--stylize-output")
+			{
+				stylizerSettings.outputDirectory = nextValue();
+			}
+			else if (argument == "--stylize-cpu")
+			{
+				stylizerSettings.forceCPU = true;
+			}
+			else if (stylizeEnabled && argument.compare(0, 2, "--") != 0)
+			{
+				stylizerSettings.inputs.push_back(argument);
+			}
+			else
+			{
+				throw std::invalid_argument(argument);
+			}
+		}
+	}
+	catch (const std::invalid_argument &)
+	{
+		printUsage();
+		return 1;
+	}
+	catch (const std::out_of_range &)
+	{
+		printUsage();
+		return 1;
+	}
+
+	// - Estilizacin de imgenes: la aplicacin termina al acabar
+	if (stylizeEnabled)
+	{
+		return stylizeImages(stylizerSettings);
+	}
+
 	// - Inicializar GLFW. Es un proceso que slo debe realizarse una vez
 	if (glfwInit() != GLFW_TRUE)
 	{
@@ -424,6 +665,29 @@ int main()
 	//   creacin de los elementos de la escena)
 	Renderer::getInstance()->prepareOpenGL(WIDTH, HEIGHT);
 
+	// - Benchmark: se ejecuta sin GUI y la aplicacin termina al acabar, devolviendo
+	//   un cdigo distinto de 0 si se detect alguna regresin
+	if (benchmarkEnabled)
+	{
+		Benchmark *benchmark = new Benchmark(window, Renderer::getInstance(), benchmarkSettings);
+		int benchmarkResult = benchmark->run();
+		delete benchmark;
+
+		glfwDestroyWindow(window);
+		glfwTerminate();
+		return benchmarkResult;
+	}
+
+	// - Benchmark de la BVH: la aplicacin termina al acabar
+	if (bvhBenchmarkIterations > 0)
+	{
+		Renderer::getInstance()->benchmarkBVH(bvhBenchmarkIterations);
+
+		glfwDestroyWindow(window);
+		glfwTerminate();
+		return 0;
+	}
+
 	// - ImGui: Preparar el contexto de ImGui
 	ImGui::CreateContext();
 	ImGuiIO &io = ImGui::GetIO();
@@ -434,6 +698,9 @@ int main()
 	// - ImGui: Elegir estilo de colores de la interfaz (Modo oscuro)
 	ImGui::StyleColorsDark();
 
+	// - Tiempo hasta el primer frame interactivo (se informa al mostrarlo)
+	bool firstFrame = true;
+
 	// - Ciclo de eventos de la aplicacin. La condicin de parada es que la
 	//   ventana principal deba cerrarse, por ejemplo, si el usuario pulsa el
 	//   botn de cerrar la ventana (la X)
@@ -462,6 +729,20 @@ int main()
 		//   intercambia el buffer back (que se ha estado dibujando) por el
 		//   que se mostraba hasta ahora front
 		glfwSwapBuffers(window);
+
+		// - Tiempo hasta el primer frame interactivo, con o sin la cach de binarios de los shaders
+		if (firstFrame)
+		{
+			ProgramBinaryCache *binaryCache = ProgramBinaryCache::getInstance();
+			double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+			std::cout << "Time to interactive: " << milliseconds << " ms (shader cache "
+					  << (binaryCache->isEnabled() ? "enabled" : "disabled") << ": "
+					  << binaryCache->getHits() << " programs loaded, " << binaryCache->getMisses()
+					  << " compiled, " << binaryCache->getMilliseconds() << " ms creating programs)" << std::endl;
+
+			firstFrame = false;
+		}
 	}
 
 	// - Una vez terminado el ciclo de eventos, liberar recursos, etc.